@@ -1,5 +1,8 @@
 #pragma once
 #include <Arduino.h>
+#include <Preferences.h>
+#include <TA_Relay.h>
+#include <TA_Probe.h>
 
 namespace ta {
 namespace act {
@@ -9,33 +12,80 @@ struct Pins {
   int ventPin;
 };
 
+// Compressor and vent outputs with relay minimum on/off times and interlock, persisted
+// cycle counts and optional PWM soft-start on the compressor (see TA_Relay.h).
+// set*() apply at once when the minimum times allow; service() from the loop applies
+// held switches and steps the soft-start ramp.
 class Actuators {
 public:
-  void begin(const Pins& p) {
+  void begin(const Pins& p, const RelayConfig& compressor = RelayConfig(), const RelayConfig& vent = RelayConfig()) {
     pins_ = p;
     pinMode(pins_.compressorPin, OUTPUT);
     pinMode(pins_.ventPin, OUTPUT);
-    stopAll();
+    outs_.begin(compressor, vent);
+    CycleCounts c;
+    if (loadCycles(prefs_, c)) {
+      outs_.compressor().setCycles(c.compressor);
+      outs_.vent().setCycles(c.vent);
+    }
+    savedCycles_ = totalCycles_();
+    write_(millis());
   }
 
-  void setCompressor(bool on) {
-    if (on) digitalWrite(pins_.ventPin, LOW);
-    digitalWrite(pins_.compressorPin, on ? HIGH : LOW);
+  void setCompressor(bool on) { outs_.setCompressor(on); service(millis()); }
+  void setVent(bool open) { outs_.setVent(open); service(millis()); }
+  void stopAll() { outs_.stopAll(); service(millis()); }
+
+  // Off now, minimum on time or not
+  void emergencyStop() {
+    uint32_t now = millis();
+    outs_.emergencyStop(now);
+    write_(now);
   }
 
-  void setVent(bool open) {
-    if (open) digitalWrite(pins_.compressorPin, LOW);
-    digitalWrite(pins_.ventPin, open ? HIGH : LOW);
+  void service(uint32_t now) {
+    outs_.service(now);
+    write_(now);
+    // Save while both outputs are idle: no flash write during a switch's inrush
+    if (!outs_.compressor().isOn() && !outs_.vent().isOn() &&
+        totalCycles_() - savedCycles_ >= kSaveEveryCycles) {
+      saveCounts();
+    }
   }
 
-  void stopAll() {
-    digitalWrite(pins_.compressorPin, LOW);
-    digitalWrite(pins_.ventPin, LOW);
+  bool saveCounts() {
+    CycleCounts c;
+    c.compressor = outs_.compressor().cycles();
+    c.vent = outs_.vent().cycles();
+    savedCycles_ = totalCycles_();
+    return saveCycles(prefs_, c);
   }
 
+  // Statistics
+  const RelayGuard& compressor() const { return outs_.compressor(); }
+  const RelayGuard& vent() const { return outs_.vent(); }
+
 private:
+  uint32_t totalCycles_() const { return outs_.compressor().cycles() + outs_.vent().cycles(); }
+
+  void write_(uint32_t now) {
+    const RelayGuard& comp = outs_.compressor();
+    uint8_t duty = comp.isOn() ? softStartDuty(comp.onSinceMs(now), comp.config()) : 0;
+    if (duty > 0 && duty < 255) analogWrite(pins_.compressorPin, duty);
+    else digitalWrite(pins_.compressorPin, duty ? HIGH : LOW);
+    digitalWrite(pins_.ventPin, outs_.vent().isOn() ? HIGH : LOW);
+#if TA_LATENCY_PROBES
+    if (comp.isOn() && !compDriven_) ta::probe::probes().mark(ta::probe::Hop::Actuate, micros());
+    compDriven_ = comp.isOn();
+#endif
+  }
+
   Pins pins_{};
+  GuardedPair outs_{};
+  Preferences prefs_;
+  uint32_t savedCycles_ = 0;
+  bool compDriven_ = false;   // compressor pin driven on at the last write (latency probe)
 };
 
 } // namespace act
-} // namespace ta
\ No newline at end of file
+} // namespace ta
@@ -4,18 +4,39 @@
 namespace ta { namespace app {
 
 void App::begin() {
-  // Actuators
-  actuators_.begin({9, 10});
+  // Actuators (relay-driven compressor: no soft-start)
+  ta::act::RelayConfig relay;
+  actuators_.begin({9, 10}, relay, relay);
   // Sensors
-  pressure_.begin(3, 10, 0.5f);
+  ta::calib::Calibration cal; // nominal 150 PSI part until calibrated
+  ta::calib::loadCalibration(calPrefs_, cal);
+  pressureLin_.build(cal);
+  pressure_.begin(3, 10, 0.5f, &pressureLin_);
+  ta::sensors::PowerConfig power;
+  power.currentPin = TA_POWER_CURRENT_PIN;   // hall sensor on the compressor feed
+  power.voltagePin = TA_POWER_VOLTAGE_PIN;   // supply divider
+  power_.begin(&adc_, power);
   // Controller
   ta::ctl::Config cfg; // defaults for now
+  // Never plan a burst or a pause the relay guard would have to stretch, and let bursts
+  // merge a short tail more readily as the compressor relay wears
+  if (cfg.runMinMs < relay.minOnMs) cfg.runMinMs = relay.minOnMs;
+  if (cfg.settleMs < relay.minOffMs) cfg.settleMs = relay.minOffMs;
+  cfg.relayCycleCostMs = ta::act::cycleCostMs(actuators_.compressor().cycles(), relay);
+  // Watch each finished seek for a minute before calling the tire good
+  cfg.hold.windowMs = 60000;
   controller_.begin(&actuators_, cfg);
   // Comms
   comms_.begin();
   comms_.setRequestCallback(&App::onRequestStatic_, this);
+  // Session recorder (TA_RECORD_BYTES = 0 compiles it out)
+#if TA_RECORD_BYTES
+  rec_.begin(recBuf_, sizeof(recBuf_));
+#endif
   // State
   state_.begin();
+  state_.setCalibrationHost(this);
+  state_.setPairingLink(&comms_);
   // Display (optional)
   if (ui_ && disp_) {
     const uint8_t SCREEN_ADDRESS = 0x3C;
@@ -23,27 +44,47 @@ void App::begin() {
   }
 }
 
-void App::onRequestStatic_(void* ctx, const ta::protocol::Request& req) {
-  static_cast<App*>(ctx)->onRequest_(req);
+bool App::applyCalibration(const ta::calib::Calibration& c) {
+  if (!ta::calib::saveCalibration(calPrefs_, c)) return false;
+  pressureLin_.build(c); // the filter reads through it from the next sample
+  return true;
 }
 
-void App::onRequest_(const ta::protocol::Request& req) {
-  using RK = ta::protocol::Request::Kind;
-  switch (req.kind) {
-    case RK::Idle:
-      controller_.cancel();
-      controller_.clearError();
-      break;
-    case RK::Start:
-      controller_.startSeek(req.targetPsi);
-      break;
-    case RK::Manual:
-      if (req.manual == ta::protocol::ManualCode::Vent) controller_.manualVent(true);
-      else if (req.manual == ta::protocol::ManualCode::Air) controller_.manualAirUp(true);
-      break;
-    case RK::Ping:
-      // no-op
-      break;
+bool App::onRequestStatic_(void* ctx, uint8_t slot, const ta::protocol::Request& req) {
+  return static_cast<App*>(ctx)->onRequest_(slot, req);
+}
+
+// Runs in the radio callback: queue the request for loop(), which applies it at a
+// fixed point (and so in the order a replay will). A full queue makes room for a stop.
+bool App::onRequest_(uint8_t slot, const ta::protocol::Request& req) {
+  ta::peers::QueuedRequest q;
+  q.req = req;
+  q.slot = slot;
+  q.us = (uint32_t)micros();
+  portENTER_CRITICAL(&reqMux_);
+  bool ok = reqQueue_.push(q);
+  portEXIT_CRITICAL(&reqMux_);
+  return ok;
+}
+
+// The board has no buttons of its own: a line typed on the serial console ("pair",
+// "cal", "up", ...) stands in for one. Over-long lines are cut short and rejected.
+void App::pollConsole_() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (conLen_ < sizeof(conLine_) - 1) conLine_[conLen_++] = (char)c;
+      continue;
+    }
+    if (conLen_ == 0) continue;
+    conLine_[conLen_] = 0;
+    conLen_ = 0;
+    ta::input::Event ev;
+    if (ta::input::parseConsoleButton(conLine_, ev)) {
+      state_.onButton(ev, controller_);
+    } else {
+      Serial.println("Console: left|down|up|right [hold], pair, cal");
+    }
   }
 }
 
@@ -51,19 +92,72 @@ void App::loop() {
   uint32_t now = millis();
   // Service comms
   comms_.service();
+  for (;;) {
+    ta::peers::QueuedRequest q;
+    portENTER_CRITICAL(&reqMux_);
+    bool have = reqQueue_.pop(q);
+    uint32_t dropped = reqQueue_.dropped();
+    portEXIT_CRITICAL(&reqMux_);
+    if (dropped != reqDropReported_) {
+      Serial.printf("[REQ] queue full: %lu requests dropped\n", (unsigned long)dropped);
+      reqDropReported_ = dropped;
+    }
+    if (!have) break;
+    const ta::protocol::Request& req = q.req;
+#if TA_LATENCY_PROBES
+    if (req.kind == ta::protocol::Request::Kind::Manual && !ta::protocol::isManualStop(req)) {
+      ta::probe::probes().mark(ta::probe::Hop::Recv, q.us);
+    }
+#endif
+    rec_.request(now, q.slot, req);
+    controller_.apply(req, q.slot);
+  }
   // Sensor + controller
-  float psi = pressure_.readPsi();
-  controller_.update(now, psi);
+  uint16_t centiPsi = pressure_.readCentiPsi();
+  power_.sample();
+  // Supply in the recorder's 0.01 V / 0.01 A, so a replay plans identical bursts. An
+  // unwired channel is never passed on: its pin reads noise, not a flat battery.
+  if (power_.hasVoltage()) {
+    uint16_t centiVolts = power_.centiVolts();
+    int16_t centiAmps = power_.hasCurrent() ? power_.centiAmps() : -1;
+    rec_.supplyCenti(now, centiVolts, centiAmps);
+    controller_.setSupplyCenti(centiVolts, centiAmps);
+  }
+  rec_.pressureCenti(now, centiPsi);
+  controller_.updateCentiPsi(now, centiPsi);
+  actuators_.service(now);
+#if TA_LATENCY_PROBES
+  // The board's hops; the remote prints its own, as the clocks aren't shared
+  const ta::link::LatencyStats& closed = ta::probe::probes().segment(ta::probe::Hop::Actuate);
+  if (closed.count >= latReported_ + TA_LATENCY_REPORT_EVERY) {
+    latReported_ = closed.count;
+    ta::probe::report(Serial, ta::probe::probes(), "[LAT]");
+  }
+#endif
+#if TA_RECORD_BYTES
+  // Keep the run-up to the first error of a seek on the console for replay, a line
+  // per loop so control and relay supervision keep running
+  bool inError = controller_.state() == ta::ctl::State::ERROR;
+  if (inError && !recDumped_ && !recDump_.active()) {
+    rec_.hold(true);
+    recDump_.start("[REC]");
+  }
+  recDumped_ = inError;
+  if (recDump_.active() && !recDump_.step(Serial, rec_)) rec_.hold(false);
+#endif
   // Periodic status to remote (only if paired)
   if (comms_.isPaired() && (now - lastStatusMs_ >= STATUS_INTERVAL_MS_)) {
     if (controller_.state() == ta::ctl::State::ERROR) {
-      comms_.sendError(controller_.errorByte());
+      comms_.sendError(controller_.errorByte(), controller_.errorDetail());
     } else {
-      comms_.sendStatus(controller_.statusChar(), controller_.currentPsi());
+      // Report the effective target only while it differs from the one asked for
+      float target = fabsf(controller_.tempOffsetPsi()) >= 0.01f ? controller_.targetPsi() : 0.0f;
+      comms_.sendStatus(controller_.statusChar(), controller_.currentPsi(), target);
     }
     lastStatusMs_ = now;
   }
   // Board UI state and render if display present
+  pollConsole_();
   state_.update(now, controller_, comms_);
   if (ui_) {
     ta::display::DisplayModel dm;
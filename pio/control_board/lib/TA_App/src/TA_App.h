@@ -1,20 +1,39 @@
 #pragma once
 #include <stdint.h>
+#include <Preferences.h>
 #include <TA_Protocol.h>
 #include "TA_Actuators.h"
 #include "TA_Sensors.h"
 #include "TA_Controller.h"
 #include "TA_CommsBoard.h"
 #include "TA_StateBoard.h"
+#include <TA_Replay.h>
+#include <TA_Probe.h>
 // Display optional
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "TA_Display.h"
 
+// Bytes of session recording kept in RAM (pressure every loop, supply, requests);
+// about two minutes at the default. 0 disables it.
+#ifndef TA_RECORD_BYTES
+#define TA_RECORD_BYTES 16384
+#endif
+
+// Supply sensing, only where it is wired: the ADC pin of the supply divider and of the
+// compressor current sensor (e.g. -DTA_POWER_VOLTAGE_PIN=4 -DTA_POWER_CURRENT_PIN=2).
+// -1 leaves a channel off; with no voltage the controller plans on nominal supply.
+#ifndef TA_POWER_VOLTAGE_PIN
+#define TA_POWER_VOLTAGE_PIN -1
+#endif
+#ifndef TA_POWER_CURRENT_PIN
+#define TA_POWER_CURRENT_PIN -1
+#endif
+
 namespace ta { namespace app {
 
 // Minimal orchestrator: owns subsystems and wires them together.
-class App {
+class App : private ta::stateboard::StateBoard::CalibrationHost {
 public:
   // Optionally pass a display to enable on-board UI rendering
   explicit App(Adafruit_SSD1306* disp = nullptr) : disp_(disp), ui_(disp ? new ta::display::TA_Display(*disp) : nullptr) {}
@@ -29,23 +48,52 @@ public:
   ta::stateboard::StateBoard& state() { return state_; }
 
 private:
-  static void onRequestStatic_(void* ctx, const ta::protocol::Request& req);
-  void onRequest_(const ta::protocol::Request& req);
+  static bool onRequestStatic_(void* ctx, uint8_t slot, const ta::protocol::Request& req);
+  bool onRequest_(uint8_t slot, const ta::protocol::Request& req);
+  // Serial console lines as board buttons (see ta::input::parseConsoleButton)
+  void pollConsole_();
+
+  // CalibrationHost (StateBoard's two-point flow)
+  float rawMilliVolts() override { return pressure_.milliVolts(); }
+  const ta::calib::Calibration& calibration() const override { return pressureLin_.calibration(); }
+  bool applyCalibration(const ta::calib::Calibration& c) override;
 
   // Subsystems
   ta::act::Actuators actuators_{};
   ta::sensors::PressureFilter pressure_{};
+  ta::calib::Linearizer pressureLin_{};
+  Preferences calPrefs_;
+  ta::sensors::ArduinoAdc adc_{};
+  ta::sensors::PowerSensor power_{};
   ta::ctl::Controller controller_{};
   ta::comms::BoardLink comms_{};
   ta::stateboard::StateBoard state_{};
 
+  // Session recording for replay (see TA_Replay.h)
+  ta::replay::Recorder rec_{};
+#if TA_RECORD_BYTES
+  uint8_t recBuf_[TA_RECORD_BYTES];
+  bool recDumped_ = false;
+  ta::replay::HexDump recDump_{};   // a line per loop, recording held meanwhile
+#endif
+
   // Display (optional)
   Adafruit_SSD1306* disp_ = nullptr;
   ta::display::TA_Display* ui_ = nullptr;
 
   // Timing
   uint32_t lastStatusMs_ = 0;
+  uint32_t latReported_ = 0;    // probe traces at the last latency report
+
+  // Requests from the radio callback (with their arrival in us), applied in loop()
+  ta::peers::RequestQueue reqQueue_{};
+  uint32_t reqDropReported_ = 0;
+  portMUX_TYPE reqMux_ = portMUX_INITIALIZER_UNLOCKED;
   static constexpr uint32_t STATUS_INTERVAL_MS_ = 1000;
+
+  // Console line being typed (the board has no buttons; StateBoard takes these)
+  char conLine_[16] = {0};
+  uint8_t conLen_ = 0;
 };
 
 }} // namespace ta::app
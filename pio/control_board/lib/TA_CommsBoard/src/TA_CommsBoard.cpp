@@ -1,5 +1,6 @@
 #include "TA_CommsBoard.h"
 #include <Arduino.h>
+#include <TA_Errors.h>
 
 using namespace ta::comms;
 
@@ -17,85 +18,261 @@ bool BoardLink::begin() {
   // Bind instance methods via lambdas capturing no state (function pointer compatible)
   esp_now_register_recv_cb([](const uint8_t* mac, const uint8_t* data, int len){ if (inst_) inst_->onRecv(mac, data, len); });
   esp_now_register_send_cb([](const uint8_t* /*mac*/, esp_now_send_status_t /*status*/){ /* no-op */ });
+  esp_now_set_pmk(linkCfg_.pmk);
+  if (linkCfg_.pmkIsPublicDefault) Serial.println("Pairing secret is the public default: link is obfuscated, not private.");
+  esp_wifi_get_mac(WIFI_IF_STA, selfMac_);
 
-  loadPeer_();
-  if (paired_) {
-    ensurePeer_(peer_);
-    Serial.printf("Paired remote loaded: %02X:%02X:%02X:%02X:%02X:%02X\n",
-      peer_[0],peer_[1],peer_[2],peer_[3],peer_[4],peer_[5]);
+  ta::peers::ArbiterConfig ac;
+  ac.holdMs = linkCfg_.conflictHoldMs;
+  arbiter_.begin(ac);
+
+  ta::link::ChannelPlanConfig pc;
+  pc.maxChannel = linkCfg_.maxChannel;
+  planner_.begin(pc);
+  if (loadChannel_()) {
+    setChannel_(channel_);
   } else {
-    Serial.println("Unpaired. Waiting for PairReq...");
+    // First boot: sit on the home channel and look for a quieter one
+    setChannel_(linkCfg_.homeChannel);
+    startSurvey_();
   }
+
+  loadPeers_();
+  if (!isPaired()) Serial.println("Unpaired. Waiting for PairReq...");
   return true;
 }
 
 void BoardLink::service() {
-  // (Reserved for future timers)
+  dropBroadcastPeer_(millis());
+  uint8_t join = joinChannel_;
+  if (join != 0 && !surveying_) {
+    joinChannel_ = 0;
+    if (join != channel_ && join <= linkCfg_.maxChannel) {
+      Serial.printf("Joining channel %u (asked by remote)\n", join);
+      moveToChannel_(join);
+    }
+  }
+  if (retuneRequested_ && !surveying_) {
+    retuneRequested_ = false;
+    planner_.noteLoss(channel_, 1.0f); // the remote found this channel lossy
+    startSurvey_();
+  }
+  if (surveying_) {
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return;
+    finishSurvey_(n);
+  }
 }
 
-bool BoardLink::loadPeer_() {
-  if (!prefs_.begin("trailair", true)) return false;
-  size_t len = prefs_.getBytesLength("peer");
-  if (len == 6) {
-    prefs_.getBytes("peer", peer_, 6);
-    paired_ = true;
-  }
+bool BoardLink::loadChannel_() {
+  if (!prefs_.begin(ta::pairkey::kNvsNamespace, true)) return false;
+  uint8_t ch = prefs_.getUChar("chan", 0);
   prefs_.end();
-  return paired_;
+  if (ch < 1 || ch > linkCfg_.maxChannel) return false;
+  channel_ = ch;
+  return true;
 }
 
-bool BoardLink::savePeer_(const uint8_t mac[6]) {
-  if (!prefs_.begin("trailair", false)) return false;
-  bool ok = prefs_.putBytes("peer", mac, 6) == 6;
+bool BoardLink::saveChannel_(uint8_t ch) {
+  if (!prefs_.begin(ta::pairkey::kNvsNamespace, false)) return false;
+  bool ok = prefs_.putUChar("chan", ch) == 1;
   prefs_.end();
-  if (ok) {
-    memcpy(peer_, mac, 6);
-    paired_ = true;
-  }
   return ok;
 }
 
-bool BoardLink::clearPeer_() {
-  if (!prefs_.begin("trailair", false)) return false;
-  bool ok = prefs_.remove("peer");
-  prefs_.end();
+bool BoardLink::setChannel_(uint8_t ch) {
+  esp_wifi_set_promiscuous(true);
+  bool ok = esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE) == ESP_OK;
+  esp_wifi_set_promiscuous(false);
+  if (ok) channel_ = ch;
+  return ok;
+}
+
+void BoardLink::startSurvey_() {
+  // Async scan keeps the control loop running; ESP-NOW traffic stalls until it ends
+  if (WiFi.scanNetworks(true, true) == WIFI_SCAN_FAILED) return;
+  surveying_ = true;
+}
+
+void BoardLink::finishSurvey_(int apCount) {
+  surveying_ = false;
+  planner_.clearSurvey();
+  for (int i = 0; i < apCount; ++i) planner_.addAp((uint8_t)WiFi.channel(i), (int8_t)WiFi.RSSI(i));
+  WiFi.scanDelete();
+
+  uint8_t best = planner_.pick(channel_);
+  setChannel_(channel_); // scan leaves the radio wherever it stopped
+  if (best != channel_) Serial.printf("Retune: channel %u -> %u (%d APs)\n", channel_, best, apCount);
+  moveToChannel_(best);
+}
+
+// Tell the paired remotes where we are going, then go there
+void BoardLink::moveToChannel_(uint8_t ch) {
+  if (ch != channel_) {
+    uint8_t p[2];
+    ta::protocol::packChan(p, ch);
+    for (uint8_t s = 0; s < ta::peers::kMaxPeers; ++s) {
+      if (!peers_.at(s).used) continue;
+      for (uint8_t i = 0; i < kChanAnnounceRepeats_; ++i) esp_now_send(peers_.at(s).mac, p, 2);
+    }
+  }
+  setChannel_(ch);
+  saveChannel_(ch);
+}
+
+void BoardLink::sendChan_(const uint8_t mac[6]) {
+  uint8_t p[2];
+  ta::protocol::packChan(p, channel_);
+  esp_now_send(mac, p, 2);
+}
+
+void BoardLink::loadPeers_() {
+  // A MAC saved without its LMK (older firmware) reads as unpaired
+  ta::peers::loadPeers(prefs_, peers_);
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+    const ta::peers::Peer& p = peers_.at(i);
+    if (!p.used) continue;
+    ensurePeer_(p.mac, p.lmk);
+    Serial.printf("Paired remote %u loaded: %02X:%02X:%02X:%02X:%02X:%02X\n", i,
+      p.mac[0],p.mac[1],p.mac[2],p.mac[3],p.mac[4],p.mac[5]);
+  }
+}
+
+bool BoardLink::savePeer_(uint8_t slot, const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]) {
+  bool ok = ta::pairkey::savePeer(prefs_, slot, mac, lmk);
   if (ok) {
-    paired_ = false;
-    memset(peer_, 0, 6);
+    portENTER_CRITICAL(&isrMux_);
+    peers_.set(slot, mac, lmk);
+    resetLease_(slot); // a fresh pairing may start its seq anywhere
+    portEXIT_CRITICAL(&isrMux_);
   }
   return ok;
 }
 
+void BoardLink::resetLease_(uint8_t slot) {
+  leaseSeq_[slot] = 0;
+  leaseAtMs_[slot] = 0;
+}
+
+uint8_t BoardLink::peerCount() const {
+  portENTER_CRITICAL(&isrMux_);
+  uint8_t n = peers_.count();
+  portEXIT_CRITICAL(&isrMux_);
+  return n;
+}
+
+uint8_t BoardLink::activeRemoteCount(uint32_t timeoutMs) const {
+  uint32_t now = millis();
+  portENTER_CRITICAL(&isrMux_);
+  uint8_t mask = peers_.activeMask(now, timeoutMs);
+  portEXIT_CRITICAL(&isrMux_);
+  uint8_t n = 0;
+  for (; mask; mask &= (uint8_t)(mask - 1)) n++;
+  return n;
+}
+
 void BoardLink::forget() {
-  clearPeer_();
-  Serial.println("Peer cleared. Awaiting PairReq.");
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+    ta::pairkey::clearPeer(prefs_, i);
+    const ta::peers::Peer& p = peers_.at(i);
+    if (p.used && esp_now_is_peer_exist(p.mac)) esp_now_del_peer(p.mac);
+  }
+  portENTER_CRITICAL(&isrMux_);
+  peers_.clearAll();
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) resetLease_(i);
+  portEXIT_CRITICAL(&isrMux_);
+  arbiter_.release();
+  Serial.println("Peers cleared. Awaiting PairReq.");
+}
+
+void BoardLink::openPairingWindow(uint32_t ms) {
+  pairWindowUntilMs_ = ta::time::futureTime(millis(), ms);
+  pairWindowArmed_ = ms > 0;
+  if (pairWindowArmed_) Serial.printf("Pairing window open for %lus.\n", (unsigned long)(ms / 1000));
+}
+
+bool BoardLink::pairWindowOpen_(uint32_t now) {
+  if (pairWindowArmed_ && ta::time::isTimeFor(now, pairWindowUntilMs_)) pairWindowArmed_ = false; // stays shut across a wrap
+  return !isPaired() || pairWindowArmed_;
 }
 
-void BoardLink::ensurePeer_(const uint8_t mac[6]) {
-  if (esp_now_is_peer_exist(mac)) return;
+// Register (or re-key) a remote; the radio encrypts every frame to/from it
+void BoardLink::ensurePeer_(const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]) {
   esp_now_peer_info_t pi{};
   memcpy(pi.peer_addr, mac, 6);
   pi.channel = 0;
+  pi.encrypt = true;
+  memcpy(pi.lmk, lmk, ta::pairkey::kKeyLen);
+  if (esp_now_is_peer_exist(mac)) esp_now_mod_peer(&pi);
+  else esp_now_add_peer(&pi);
+}
+
+// Pairing replies go out before the remote holds the key, so they use the broadcast peer
+void BoardLink::ensureBroadcastPeer_() {
+  uint8_t bcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+  bcastAtMs_ = millis();
+  if (bcastRegistered_) return;
+  esp_now_peer_info_t pi{};
+  memcpy(pi.peer_addr, bcast, 6);
+  pi.channel = 0;
   pi.encrypt = false;
-  esp_now_add_peer(&pi);
+  if (esp_now_is_peer_exist(bcast) || esp_now_add_peer(&pi) == ESP_OK) bcastRegistered_ = true;
 }
 
-bool BoardLink::sendStatus(char statusChar, float psi) {
-  if (!paired_) return false;
-  uint8_t p[2];
-  p[0] = (uint8_t)statusChar;
-  p[1] = (statusChar == 'E')
-         ? psi  // psi holds error code when E
-         : ta::protocol::psiToByte05(psi);
-  return esp_now_send(peer_, p, 2) == ESP_OK;
+void BoardLink::dropBroadcastPeer_(uint32_t now) {
+  if (!bcastRegistered_ || !ta::time::hasElapsed(now, bcastAtMs_, kBcastLingerMs_)) return;
+  uint8_t bcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+  esp_now_del_peer(bcast);
+  bcastRegistered_ = false;
+}
+
+// Fan a status out to every remote heard within statusFanoutMs, each in the wire
+// version it negotiated. When that is every registered peer and they all speak the
+// same version, one esp_now_send(NULL) lets the driver walk its own peer list
+// instead of N calls from the loop; otherwise unicast to the active ones.
+bool BoardLink::sendToPeers_(const ta::protocol::Response& r) {
+  uint32_t now = millis();
+  uint8_t proto[ta::peers::kMaxPeers];
+  portENTER_CRITICAL(&isrMux_);
+  uint8_t active = peers_.activeMask(now, linkCfg_.statusFanoutMs);
+  uint8_t used = peers_.usedMask();
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) proto[i] = peers_.sendProto(i);
+  portEXIT_CRITICAL(&isrMux_);
+  if (active == 0) return false;
+
+  uint8_t p[ta::protocol::kMaxPayloadLen];
+  int8_t common = -1;
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+    if (!(active & (1u << i))) continue;
+    if (common < 0) common = (int8_t)proto[i];
+    else if (common != (int8_t)proto[i]) { common = -2; break; }
+  }
+  if (active == used && common >= 0 && !bcastRegistered_) {
+    int len = ta::protocol::packResponse(p, r, (uint8_t)common);
+    return esp_now_send(nullptr, p, len) == ESP_OK;
+  }
+  bool ok = true;
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+    if (!(active & (1u << i))) continue;
+    int len = ta::protocol::packResponse(p, r, proto[i]);
+    ok = (esp_now_send(peers_.at(i).mac, p, len) == ESP_OK) && ok;
+  }
+  return ok;
+}
+
+bool BoardLink::sendStatus(char statusChar, float psi, float targetPsi) {
+  if (statusChar == 'E') return sendError((uint8_t)psi); // psi holds error code when E
+  return sendToPeers_(ta::protocol::makeStatus((ta::protocol::Status)statusChar, psi, targetPsi));
 }
 
-bool BoardLink::sendError(uint8_t errorCode) {
-  if (!paired_) return false;
+bool BoardLink::sendError(uint8_t errorCode, uint8_t detail) {
+  return sendToPeers_(ta::protocol::makeError(errorCode, detail));
+}
+
+bool BoardLink::sendPong(const uint8_t mac[6], uint8_t seq) {
   uint8_t p[2];
-  p[0] = 'E';
-  p[1] = errorCode;
-  return esp_now_send(peer_, p, 2) == ESP_OK;
+  ta::protocol::packPong(p, seq);
+  return esp_now_send(mac, p, 2) == ESP_OK;
 }
 
 void BoardLink::handlePairReq_(const uint8_t* mac, uint8_t group) {
@@ -103,44 +280,164 @@ void BoardLink::handlePairReq_(const uint8_t* mac, uint8_t group) {
     Serial.println("PairReq wrong group");
     return;
   }
-  if (!paired_) {
-    savePeer_(mac);
-    ensurePeer_(mac);
-    uint8_t ack[2]; ta::protocol::packPairAck(ack, groupId_);
-    esp_now_send(peer_, ack, 2);
-    Serial.println("Paired (saved); Ack sent.");
-  } else {
-    if (memcmp(mac, peer_, 6) == 0) {
-      uint8_t ack[2]; ta::protocol::packPairAck(ack, groupId_);
-      esp_now_send(peer_, ack, 2);
-      Serial.println("Re-Ack existing peer");
-    } else {
-      uint8_t busy[2]; ta::protocol::packPairBusy(busy, 1);
-      esp_now_send(mac, busy, 2);
-      Serial.println("Busy: already paired.");
+  uint32_t now = millis();
+  portENTER_CRITICAL(&isrMux_);
+  int8_t slot = peers_.find(mac);
+  int8_t freeSlot = peers_.freeSlot();
+  portEXIT_CRITICAL(&isrMux_);
+  bool known = slot >= 0;
+  if (!known) {
+    slot = pairWindowOpen_(now) ? freeSlot : -1;
+    if (slot < 0) {
+      sendBusy_();
+      Serial.println(freeSlot < 0 ? "Busy: peer table full." : "Busy: pairing window closed.");
+      return;
     }
   }
+  // Fresh nonce per pairing (re-pairing rotates the key), reused for retries in the same window
+  bool retry = known && pairNonce_[slot] != 0 &&
+               !ta::time::hasElapsed(now, pairNonceAtMs_[slot], linkCfg_.pairTimeoutMs);
+  // Re-keying a known remote replaces its stored key, so it takes the board-side
+  // confirm too: a spoofed PairReq would otherwise lock the real remote out
+  if (known && !retry && !pairWindowOpen_(now)) {
+    sendBusy_();
+    Serial.println("Busy: pairing window closed.");
+    return;
+  }
+  if (!retry) {
+    pairNonce_[slot] = esp_random();
+    pairNonceAtMs_[slot] = now;
+  }
+  uint8_t lmk[ta::pairkey::kKeyLen];
+  ta::pairkey::deriveLmk(linkCfg_.pmk, mac, selfMac_, groupId_, pairNonce_[slot], lmk);
+  if (!retry && !savePeer_((uint8_t)slot, mac, lmk)) return; // a retry derives the key already stored
+  sendPairReply_(mac, pairNonce_[slot]);
+  ensurePeer_(mac, lmk);
+  sendChan_(mac); // first encrypted frame
+  Serial.printf(retry ? "Re-Ack remote %d\n" : "Paired remote %d (saved); Key + Ack sent.\n", slot);
+}
+
+// A refused requester isn't a registered peer, which ESP-NOW won't unicast to:
+// broadcast, like the pair key. Only a remote that is pairing acts on it.
+void BoardLink::sendBusy_() {
+  uint8_t bcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+  ensureBroadcastPeer_();
+  uint8_t busy[2]; ta::protocol::packPairBusy(busy, 1);
+  esp_now_send(bcast, busy, 2);
+}
+
+void BoardLink::sendPairReply_(const uint8_t mac[6], uint32_t nonce) {
+  uint8_t bcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+  ensureBroadcastPeer_();
+  ta::protocol::PairKey k;
+  k.groupId = groupId_;
+  k.nonce = nonce;
+  memcpy(k.target, mac, 6);
+  uint8_t key[ta::protocol::kPairKeyLen];
+  ta::protocol::packPairKey(key, k);
+  esp_now_send(bcast, key, sizeof(key));
+  uint8_t ack[2]; ta::protocol::packPairAck(ack, groupId_);
+  esp_now_send(bcast, ack, 2);
 }
 
 void BoardLink::onRecv(const uint8_t* mac, const uint8_t* data, int len) {
   using namespace ta::protocol;
-  if (len == 2 && isPairingFrame(data, len)) {
-    PairMsg pm;
-    if (parsePair(data, len, pm) && pm.op == PairOp::Req) {
-      handlePairReq_(mac, pm.value);
-    }
+  Frame f;
+  if (!decodeFrame(data, len, Dir::ToBoard, f)) return;
+  if (f.cls == FrameClass::Pair) {
+    if (f.pair.op == PairOp::Req) handlePairReq_(mac, f.pair.value);
+    return;
+  }
+
+  portENTER_CRITICAL(&isrMux_);
+  int8_t slot = peers_.find(mac);
+  uint8_t proto = slot >= 0 ? peers_.at((uint8_t)slot).proto : kProtoUnknown;
+  portEXIT_CRITICAL(&isrMux_);
+  if (slot < 0) return;
+
+  // Version negotiation: the remote's answer settles it. Until then it is treated as
+  // v1 and asked again on its traffic every kHelloRetryMs_, so a lost Hello (or answer)
+  // costs a few seconds of v1 rather than the rest of the boot. An old remote never
+  // answers and stays v1.
+  if (f.cls == FrameClass::Link && f.link == LinkOp::Hello) {
+    portENTER_CRITICAL(&isrMux_);
+    peers_.setProto((uint8_t)slot, negotiate(f.linkValue));
+    portEXIT_CRITICAL(&isrMux_);
+    helloAtMs_[slot] = 0;
     return;
   }
-  if (!paired_ || memcmp(mac, peer_, 6) != 0) return;
-  if (len != 2) return;
+  uint32_t rxMs = millis();
+  bool ask = proto == kProtoUnknown ||
+             (helloAtMs_[slot] != 0 && ta::time::hasElapsed(rxMs, helloAtMs_[slot], kHelloRetryMs_));
+  if (ask) {
+    if (proto == kProtoUnknown) {
+      portENTER_CRITICAL(&isrMux_);
+      peers_.setProto((uint8_t)slot, kProtoV1);
+      portEXIT_CRITICAL(&isrMux_);
+    }
+    helloAtMs_[slot] = rxMs | 1; // 0 means settled
+    uint8_t h[2]; packHello(h);
+    esp_now_send(mac, h, 2);
+  }
 
-  Request req;
-  if (!parseRequest(data, len, req)) return;
+  if (f.cls == FrameClass::Link) {
+    // Handled in service(): a request to survey, or to join the channel the remote's
+    // other boards are on
+    if (f.link != LinkOp::Chan) return;
+    if (f.linkValue == kChanRetuneRequest) retuneRequested_ = true;
+    else joinChannel_ = f.linkValue;
+    return;
+  }
 
-  // Write lastRxMs_ atomically
+  const Request& req = f.req;
+  uint32_t now = millis();
   portENTER_CRITICAL(&isrMux_);
-  lastRxMs_ = millis();
+  peers_.touch((uint8_t)slot, now);
   portEXIT_CRITICAL(&isrMux_);
 
-  if (reqCb_) reqCb_(reqCtx_, req);
-}
\ No newline at end of file
+  // Echo pings straight from the radio callback so the remote measures link RTT,
+  // not our loop period. They are not commands, so the loop never sees them.
+  if (req.kind == Request::Kind::Ping) {
+    sendPong(mac, req.seq);
+    return;
+  }
+
+  // Manual lease frames are acknowledged from here too, resends included (our ack may
+  // be what got lost). One older than the remote's latest is a straggler: a grant
+  // arriving after its stop must not restart the output.
+  uint8_t ack[2];
+  if (req.leased) {
+    packLeaseAck(ack, req.seq);
+    bool recent = leaseAtMs_[slot] != 0 && !ta::time::hasElapsed(now, leaseAtMs_[slot], kLeaseSeqWindowMs_);
+    if (recent && (int8_t)(req.seq - leaseSeq_[slot]) < 0) {
+      esp_now_send(mac, ack, 2);
+      return;
+    }
+  }
+
+  // Two remotes asking for different things: first one wins, the other is told why.
+  // A lease stop for a lease another remote holds is acked and dropped.
+  ta::peers::CommandArbiter::Verdict verdict = arbiter_.admit(slot, req, now);
+  if (verdict == ta::peers::CommandArbiter::Verdict::Ignore) {
+    esp_now_send(mac, ack, 2);
+    return;
+  }
+  if (verdict == ta::peers::CommandArbiter::Verdict::Conflict) {
+    uint8_t p[kMaxPayloadLen];
+    portENTER_CRITICAL(&isrMux_);
+    uint8_t v = peers_.sendProto((uint8_t)slot);
+    portEXIT_CRITICAL(&isrMux_);
+    int len = packResponse(p, makeError(ta::errors::CONFLICT), v);
+    esp_now_send(mac, p, len);
+    return;
+  }
+
+  // The ack goes out only once the loop is sure to apply the request: an acked stop
+  // the remote stops resending must not be lost to a full queue
+  if (reqCb_ && !reqCb_(reqCtx_, (uint8_t)slot, req)) return;
+  if (req.leased) {
+    leaseSeq_[slot] = req.seq;
+    leaseAtMs_[slot] = now;
+    esp_now_send(mac, ack, 2);
+  }
+}
@@ -6,66 +6,123 @@
 #include <Preferences.h>
 #include "TA_Protocol.h"
 #include "TA_Time.h"  // Overflow-safe time utilities
+#include "TA_ChannelPlan.h"
+#include "TA_PairKey.h"
+#include "TA_PeerTable.h"
+#include <TA_Config.h>
 
 namespace ta {
 namespace comms {
 
 using ta::protocol::Request;
 
-typedef void (*RequestCallback)(void* ctx, const Request& req);
+// Called from the radio callback with each admitted command and the peer slot it came
+// from (pings are answered here and not passed on). Returns false if it could not take
+// the request; a manual lease is then left unacknowledged so the remote resends it.
+typedef bool (*RequestCallback)(void* ctx, uint8_t slot, const Request& req);
 
 class BoardLink {
 public:
   bool begin();
-  void service(); // no-op now (placeholder)
-
-  // Pairing / persistence
-  bool isPaired() const { return paired_; }
-  void forget();
-
-  // Status
-  bool sendStatus(char statusChar, float psi);
-  bool sendError(uint8_t errorCode);
+  void service(); // runs channel surveys / retunes
+
+  // Channel management
+  uint8_t channel() const { return channel_; }
+  bool isSurveying() const { return surveying_; }
+  void requestRetune() { retuneRequested_ = true; }
+
+  // Pairing / persistence (up to ta::peers::kMaxPeers remotes)
+  bool isPaired() const { return peerCount() > 0; }
+  uint8_t peerCount() const;
+  void forget(); // all remotes
+  // Let additional remotes pair into free slots for a while (an empty table always
+  // accepts). Only a board-side confirm opens it; a paired board never does on its own.
+  void openPairingWindow(uint32_t ms);
+
+  // Status goes to every recently heard remote
+  // targetPsi > 0 adds the effective seek target (extended v2 status)
+  bool sendStatus(char statusChar, float psi, float targetPsi = 0.0f);
+  bool sendError(uint8_t errorCode, uint8_t detail = 0);
+  bool sendPong(const uint8_t mac[6], uint8_t seq);
 
   // Registration
   void setRequestCallback(RequestCallback cb, void* ctx) { reqCb_ = cb; reqCtx_ = ctx; }
 
-  // Returns true if a remote is paired AND has sent something recently.
-  bool isRemoteActive(uint32_t timeoutMs = 3000) const {
-    if (!paired_) return false;
-    
-    // Read lastRxMs_ atomically
-    uint32_t lastRx;
-    portENTER_CRITICAL(&isrMux_);
-    lastRx = lastRxMs_;
-    portEXIT_CRITICAL(&isrMux_);
-    
-    if (lastRx == 0) return false;
-    return ta::time::hasElapsed(millis(), lastRx, 0) && !ta::time::hasElapsed(millis(), lastRx, timeoutMs);
-  }
+  // Returns true if any paired remote has sent something recently.
+  bool isRemoteActive(uint32_t timeoutMs = 3000) const { return activeRemoteCount(timeoutMs) > 0; }
+  uint8_t activeRemoteCount(uint32_t timeoutMs) const;
 
 private:
   static void onRecvStatic(const uint8_t* mac, const uint8_t* data, int len);
   static void onSentStatic(const uint8_t* mac, esp_now_send_status_t status);
   void onRecv(const uint8_t* mac, const uint8_t* data, int len);
 
-  bool loadPeer_();
-  bool savePeer_(const uint8_t mac[6]);
-  bool clearPeer_();
+  void loadPeers_();
+  bool savePeer_(uint8_t slot, const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]);
+  void resetLease_(uint8_t slot); // caller holds isrMux_
   void handlePairReq_(const uint8_t* mac, uint8_t group);
-
-  void ensurePeer_(const uint8_t mac[6]);
+  void sendPairReply_(const uint8_t mac[6], uint32_t nonce);
+  void sendBusy_();
+  bool pairWindowOpen_(uint32_t now);
+
+  void ensurePeer_(const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]);
+  void ensureBroadcastPeer_();
+  void dropBroadcastPeer_(uint32_t now);
+  bool sendToPeers_(const ta::protocol::Response& r);
+
+  bool loadChannel_();
+  bool saveChannel_(uint8_t ch);
+  bool setChannel_(uint8_t ch);
+  void startSurvey_();
+  void finishSurvey_(int apCount);
+  void moveToChannel_(uint8_t ch);
+  void sendChan_(const uint8_t mac[6]);
 
   Preferences prefs_;
-  bool paired_ = false;
-  uint8_t peer_[6] = {0};
+  uint8_t selfMac_[6] = {0};
   uint8_t groupId_ = 0x01;
 
+  // Paired remotes. Each has its own LMK (derived from the provisioned PMK at pairing and
+  // stored next to its MAC). Repeated PairReqs from one remote within a pairing window
+  // reuse its nonce so a late duplicate can't rotate the key under a remote that finished.
+  ta::peers::PeerTable peers_{};
+  ta::peers::CommandArbiter arbiter_{};
+  uint32_t pairNonce_[ta::peers::kMaxPeers] = {0};
+  uint32_t pairNonceAtMs_[ta::peers::kMaxPeers] = {0};
+  uint32_t pairWindowUntilMs_ = 0;
+  volatile bool pairWindowArmed_ = false;
+
+  // When each remote still assumed v1 was last sent a Hello (0 once it answered; radio
+  // callback only)
+  uint32_t helloAtMs_[ta::peers::kMaxPeers] = {0};
+  static constexpr uint32_t kHelloRetryMs_ = 5000;
+
+  // Latest manual lease sequence per remote (radio callback only). Older ones are
+  // dropped while it is recent; past that window a remote that rebooted starts over.
+  // Forgetting or (re)pairing a slot clears it at once.
+  uint8_t leaseSeq_[ta::peers::kMaxPeers] = {0};
+  uint32_t leaseAtMs_[ta::peers::kMaxPeers] = {0};
+  static constexpr uint32_t kLeaseSeqWindowMs_ = 4000;
+
+  // The broadcast peer is only registered while pairing replies are going out; otherwise
+  // esp_now_send(NULL) would also put status frames on the air unencrypted.
+  volatile bool bcastRegistered_ = false;
+  volatile uint32_t bcastAtMs_ = 0;
+  static constexpr uint32_t kBcastLingerMs_ = 2000;
+
+  // Channel
+  ta::cfg::LinkShared linkCfg_{};
+  ta::link::ChannelPlanner planner_{};
+  uint8_t channel_ = 0;
+  bool surveying_ = false;
+  volatile bool retuneRequested_ = false;
+  volatile uint8_t joinChannel_ = 0;  // a multi-board remote asked us onto its channel
+  static constexpr uint8_t kChanAnnounceRepeats_ = 3;
+
   RequestCallback reqCb_ = nullptr;
   void* reqCtx_ = nullptr;
 
-  volatile uint32_t lastRxMs_ = 0; // millis() of last valid packet from remote
-  portMUX_TYPE isrMux_ = portMUX_INITIALIZER_UNLOCKED; // Mutex for ISR safety
+  mutable portMUX_TYPE isrMux_ = portMUX_INITIALIZER_UNLOCKED; // guards peers_ against the radio callback
 
   static BoardLink* inst_;
 };
@@ -1,44 +1,76 @@
 #pragma once
 #include <Arduino.h>
 #include <vector>
+#include <TA_Power.h>
+#include <TA_Calib.h>
 
 namespace ta {
 namespace sensors {
 
+// Board ADC for PowerSensor (calibrated millivolts)
+class ArduinoAdc : public IAdc {
+public:
+  int readMilliVolts(int pin) override { return analogReadMilliVolts(pin); }
+};
+
+// Moving average of the transducer's millivolts over the last `samples` readings,
+// converted to PSI through the board's calibration (ta::calib::Linearizer). The sum
+// is kept in integer millivolts, so a read costs the same whatever the window (the
+// leak-down monitor reads it every loop) and never drifts.
 class PressureFilter {
 public:
-  void begin(int analogPin, int samples, float noiseThreshPsi) {
+  void begin(int analogPin, int samples, float noiseThreshPsi, const ta::calib::Linearizer* lin = nullptr) {
     pin_ = analogPin;
     capacity_ = samples;
-    noiseThresh_ = noiseThreshPsi;
+    noiseThreshCenti_ = (uint16_t)lroundf(noiseThreshPsi * 100.0f);
+    lin_ = lin ? lin : &nominal_();
     count_ = idx_ = 0;
+    sum_ = 0;
+    buffer_.clear();
   }
 
-  float readPsi() {
+  // Takes effect from the next read (e.g. after a field calibration)
+  void setLinearizer(const ta::calib::Linearizer* lin) { lin_ = lin ? lin : &nominal_(); }
+
+  float readPsi() { return readCentiPsi() / 100.0f; }
+
+  // The same reading in hundredths of a PSI, integer all the way from the ADC
+  uint16_t readCentiPsi() {
     int mV = analogReadMilliVolts(pin_);
-    float volts = mV / 1000.0f;
-    float psi = (volts - 0.5f) * (150.0f / 4.0f);
-    if (psi < 0) psi = 0;
-    if (psi > 150) psi = 150;
-    if (capacity_ == 0) return psi;
-    if (buffer_.size() != (size_t)capacity_) buffer_.resize(capacity_, psi);
-    buffer_[idx_] = psi;
-    idx_ = (idx_ + 1) % capacity_;
-    if (count_ < capacity_) count_++;
-    float sum = 0;
-    for (int i = 0; i < count_; ++i) sum += buffer_[i];
-    float avg = sum / count_;
-    if (avg < noiseThresh_) return 0.0f;
-    return avg;
+    if (capacity_ == 0) {
+      sum_ = mV;
+      count_ = 1;
+    } else {
+      if (buffer_.size() != (size_t)capacity_) buffer_.resize(capacity_, 0);
+      if (count_ == capacity_) sum_ -= buffer_[idx_];
+      else count_++;
+      buffer_[idx_] = (uint16_t)mV;
+      sum_ += mV;
+      idx_ = (idx_ + 1) % capacity_;
+    }
+    int32_t mv16 = ((sum_ << ta::calib::kMvFracBits) + count_ / 2) / count_;
+    uint16_t centi = (lin_ ? *lin_ : nominal_()).centiPsi16(mv16);
+    return centi < noiseThreshCenti_ ? 0 : centi;
   }
 
+  // Averaged transducer output behind the last reading (calibration capture)
+  float milliVolts() const { return count_ ? (float)sum_ / count_ : 0.0f; }
+
 private:
   int pin_ = -1;
   int capacity_ = 0;
   int count_ = 0;
   int idx_ = 0;
-  float noiseThresh_ = 0.5f;
-  std::vector<float> buffer_;
+  int32_t sum_ = 0;
+  uint16_t noiseThreshCenti_ = 50;
+  std::vector<uint16_t> buffer_;
+  const ta::calib::Linearizer* lin_ = nullptr;
+
+  // 0.5-4.5 V, 150 PSI: the part the board shipped with
+  static const ta::calib::Linearizer& nominal_() {
+    static const ta::calib::Linearizer lin;
+    return lin;
+  }
 };
 
 } // namespace sensors
@@ -13,6 +13,8 @@ void StateBoard::begin(const Config& cfg) {
   uicfg.maxPsi = cfg_.ui.maxPsi;
   uicfg.defaultTargetPsi = cfg_.ui.defaultTargetPsi;
   uicfg.stepSmall = cfg_.ui.stepSmall;
+  uicfg.stepLarge = cfg_.ui.stepLarge;
+  uicfg.repeatLargeAfterMs = cfg_.ui.repeatLargeAfterMs;
   uicfg.doneHoldMs = cfg_.ui.doneHoldMs;
   uicfg.errorAutoClearMs = cfg_.ui.errorAutoClearMs;
   ui_.begin(uicfg);
@@ -47,19 +49,79 @@ static ta::ui::Action toAct(ta::input::Action a) {
     case ta::input::Action::Released:return ta::ui::Action::Released;
     case ta::input::Action::Click:   return ta::ui::Action::Click;
     case ta::input::Action::LongHold:return ta::ui::Action::LongHold;
+    case ta::input::Action::Repeat:  return ta::ui::Action::Repeat;
   }
   return ta::ui::Action::Click;
 }
 
 ta::ui::ButtonEvent StateBoard::toUiBtn_(const ta::input::Event& ev) {
-  return ta::ui::ButtonEvent{ toBtn(ev.id), toAct(ev.action) };
+  return ta::ui::ButtonEvent{ toBtn(ev.id), toAct(ev.action), ev.heldMs };
 }
 
 void StateBoard::onButton(const ta::input::Event& ev, ta::ctl::Controller& controller) {
+  if (onCalButton_(ev, controller)) return;
+  if (pairLink_ && ev.id == ta::input::ButtonId::Left && ev.action == ta::input::Action::LongHold &&
+      ui_.view() == ta::ui::View::Idle && controller.state() == ta::ctl::State::IDLE) {
+    pairLink_->openPairingWindow(cfg_.link.boardPairWindowMs);
+    return;
+  }
   BoardActions act; act.ctl = &controller;
   ui_.onButton(toUiBtn_(ev), act);
 }
 
+// Calibration flow; true when it consumed the event
+bool StateBoard::onCalButton_(const ta::input::Event& ev, ta::ctl::Controller& controller) {
+  using ta::input::Action;
+  using ta::input::ButtonId;
+  if (calStep_ == CalStep::None) {
+    // Only from idle with the outputs off: the zero point needs the sensor at rest
+    if (calHost_ && ev.id == ButtonId::Right && ev.action == Action::LongHold &&
+        ui_.view() == ta::ui::View::Idle && controller.state() == ta::ctl::State::IDLE) {
+      cal_.begin(calHost_->calibration());
+      calStep_ = CalStep::Zero;
+      calRefPsi_ = 0;
+      calFailed_ = false;
+      return true;
+    }
+    return false;
+  }
+
+  // Holding Up/Down repeats the reference step, accelerating like the target does
+  if (ev.action == Action::Repeat && calStep_ == CalStep::Span &&
+      (ev.id == ButtonId::Up || ev.id == ButtonId::Down)) {
+    float step = ta::ui::repeatStepPsi(ui_.config(), ev.heldMs);
+    calRefPsi_ += ev.id == ButtonId::Up ? step : -step;
+    if (calRefPsi_ < 0) calRefPsi_ = 0;
+    return true;
+  }
+  if (ev.action != Action::Click) return true;
+  switch (ev.id) {
+    case ButtonId::Left:
+      calStep_ = CalStep::None;
+      break;
+    case ButtonId::Up:
+    case ButtonId::Down:
+      if (calStep_ == CalStep::Span) {
+        calRefPsi_ += ev.id == ButtonId::Up ? cfg_.ui.stepSmall : -cfg_.ui.stepSmall;
+        if (calRefPsi_ < 0) calRefPsi_ = 0;
+      }
+      break;
+    case ButtonId::Right:
+      if (calStep_ == CalStep::Zero) {
+        cal_.setLow(calHost_->rawMilliVolts());
+        calRefPsi_ = ui_.targetPsi();
+        calStep_ = CalStep::Span;
+      } else {
+        cal_.setHigh(calHost_->rawMilliVolts(), calRefPsi_);
+        ta::calib::Calibration c;
+        calFailed_ = !cal_.solve(c) || !calHost_->applyCalibration(c);
+        calStep_ = CalStep::None;
+      }
+      break;
+  }
+  return true;
+}
+
 void StateBoard::update(uint32_t now,
                         ta::ctl::Controller& controller,
                         const ta::comms::BoardLink& link) {
@@ -72,9 +134,9 @@ void StateBoard::buildDisplayModel(ta::display::DisplayModel& m,
                                    const ta::ctl::Controller& controller,
                                    const ta::comms::BoardLink& link,
                                    uint32_t now) const {
-  // PSI
+  // PSI (while calibrating, the target shows the reference being entered)
   m.currentPSI = controller.currentPsi();
-  m.targetPSI  = ui_.targetPsi();
+  m.targetPSI  = calStep_ != CalStep::None ? calRefPsi_ : ui_.targetPsi();
 
   // Link icon
   m.link = (link.isPaired() && link.isRemoteActive(cfg_.link.remoteActiveTimeoutMs))
@@ -6,6 +6,7 @@
 #include "TA_Display.h"
 #include <TA_UI.h>
 #include <TA_Config.h>
+#include <TA_Calib.h>
 
 namespace ta {
   namespace stateboard {
@@ -15,16 +16,33 @@ namespace ta {
       struct Config {
         ta::cfg::UiShared ui;      // shared UI config
         ta::cfg::LinkShared link;  // shared link config (timeouts, pairing)
-        float stepPsiLarge = 5.0f;       // optional extra step not used by shared UI
       };
 
-      enum class UiState { Idle, Manual, Seeking, Error };
+      enum class UiState { Idle, Manual, Seeking, Error, Calibrating };
+
+      // Two-point pressure calibration, run from the board's console: "cal" while idle,
+      // "right" with the sensor open to air (Zero), pump to a pressure read off a
+      // trusted gauge, set that value with "up"/"down" and "right" again (Span).
+      // "left" aborts. The app owns the sensor and the stored record.
+      enum class CalStep { None, Zero, Span };
+
+      // Adding a remote to a paired board is confirmed here: long-hold Left while idle
+      // opens the link's pairing window for cfg.link.boardPairWindowMs. The board has no
+      // buttons, so App feeds these from the serial console: "pair" is the long-hold
+      // Left, "cal" the long-hold Right, "left"/"down"/"up"/"right" click.
+
+      struct CalibrationHost {
+        virtual ~CalibrationHost() = default;
+        virtual float rawMilliVolts() = 0;                                  // averaged sensor output
+        virtual const ta::calib::Calibration& calibration() const = 0;
+        virtual bool applyCalibration(const ta::calib::Calibration& c) = 0; // save and use
+      };
 
       // Overloads instead of default arg (avoids compiler issue)
       void begin();                // uses internal default Config()
       void begin(const Config& cfg);
 
-      // Button events forwarded from sketch (same ordering as remote: Left, Down, Up, Right).
+      // Button events forwarded from App's serial console (same ordering as remote: Left, Down, Up, Right).
       void onButton(const ta::input::Event& ev, ta::ctl::Controller& controller);
 
       // Called each loop.
@@ -39,7 +57,15 @@ namespace ta {
                              uint32_t now) const;
 
       float targetPsi() const { return ui_.targetPsi(); }
+
+      void setCalibrationHost(CalibrationHost* host) { calHost_ = host; }
+      void setPairingLink(ta::comms::BoardLink* link) { pairLink_ = link; }
+      CalStep calStep() const { return calStep_; }
+      float calReferencePsi() const { return calRefPsi_; }
+      bool lastCalibrationFailed() const { return calFailed_; }
+
       UiState uiState() const {
+        if (calStep_ != CalStep::None) return UiState::Calibrating;
         using V = ta::ui::View;
         switch (ui_.view()) {
           case V::Idle: return UiState::Idle;
@@ -58,6 +84,7 @@ namespace ta {
         void cancel() override { if (ctl) ctl->cancel(); }
         void clearError() override { if (ctl) ctl->clearError(); }
         void startSeek(float targetPsi) override { if (ctl) ctl->startSeek(targetPsi); }
+        void retarget(float targetPsi) override { if (ctl) ctl->retarget(targetPsi); }
         void manualVent(bool on) override { if (ctl) ctl->manualVent(on); }
         void manualAirUp(bool on) override { if (ctl) ctl->manualAirUp(on); }
       };
@@ -65,6 +92,15 @@ namespace ta {
       Config cfg_{};
       ta::ui::UiStateMachine ui_{};
 
+      // Calibration flow
+      bool onCalButton_(const ta::input::Event& ev, ta::ctl::Controller& controller);
+      CalibrationHost* calHost_ = nullptr;
+      CalStep calStep_ = CalStep::None;
+      ta::calib::TwoPointCal cal_{};
+      float calRefPsi_ = 0;
+      bool calFailed_ = false;
+      ta::comms::BoardLink* pairLink_ = nullptr;
+
       // helper conversions
       static ta::ui::Ctrl toUiCtrl_(ta::ctl::State s);
       static ta::ui::ButtonEvent toUiBtn_(const ta::input::Event& ev);
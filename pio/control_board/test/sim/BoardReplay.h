@@ -0,0 +1,181 @@
+#pragma once
+/**
+ * Record/replay harness for native tests and workstation replays of field dumps.
+ *
+ * BoardSession runs a Controller against a PlantSim in the same order as
+ * ta::app::App::loop (queued requests, supply, pressure, update) while recording,
+ * so its recording is what a board would have captured. BoardReplay feeds a
+ * recording back into a fresh Controller; RemoteReplay feeds a remote's buttons and
+ * board status into the shared UI state machine and board set. Both log the
+ * compressor/vent edges or views they produce for comparison.
+ *
+ * Shared by test suites via #include "../sim/BoardReplay.h" (not a suite itself).
+ */
+#include <TA_Replay.h>
+#include <TA_UI.h>
+#include <TA_BoardSet.h>
+#include <vector>
+#include "PlantSim.h"
+
+namespace ta {
+namespace sim {
+
+// An output change and when it happened
+struct Edge {
+  uint32_t ms;
+  bool comp;
+  bool vent;
+  bool operator==(const Edge& o) const { return ms == o.ms && comp == o.comp && vent == o.vent; }
+};
+
+// Logs output edges, optionally passing them on to a plant
+class EdgeLog : public ta::ctl::IOutputs {
+public:
+  explicit EdgeLog(ta::ctl::IOutputs* next = nullptr) : next_(next) {}
+  void setCompressor(bool on) override { if (on) vent_ = false; comp_ = on; log_(); if (next_) next_->setCompressor(on); }
+  void setVent(bool open) override { if (open) comp_ = false; vent_ = open; log_(); if (next_) next_->setVent(open); }
+  void stopAll() override { comp_ = vent_ = false; log_(); if (next_) next_->stopAll(); }
+  void emergencyStop() override { comp_ = vent_ = false; log_(); if (next_) next_->emergencyStop(); }
+  bool compressorRunning() const override { return next_ ? next_->compressorRunning() : comp_; }
+
+  uint32_t now = 0;
+  std::vector<Edge> edges;
+
+private:
+  void log_() {
+    if (!edges.empty() && edges.back().comp == comp_ && edges.back().vent == vent_) return;
+    edges.push_back(Edge{ now, comp_, vent_ });
+  }
+  ta::ctl::IOutputs* next_;
+  bool comp_ = false;
+  bool vent_ = false;
+};
+
+// A board's loop on the plant, recording as App does
+class BoardSession {
+public:
+  BoardSession(const ta::ctl::Config& cfg, const PlantConfig& plant, uint8_t* recBuf, size_t recLen)
+      : plant_(plant), out_(&plant_) {
+    ctl_.begin(&out_, cfg);
+    rec_.begin(recBuf, recLen);
+  }
+
+  void request(const ta::protocol::Request& r) { pending_.push_back(r); }
+
+  // One loop at `now`, then the plant runs until the next
+  void loop(uint32_t now, uint32_t stepMs) {
+    out_.now = now;
+    for (const ta::protocol::Request& r : pending_) {
+      rec_.request(now, 0, r);
+      ctl_.apply(r);
+    }
+    pending_.clear();
+    float volts = ta::replay::centi(plant_.volts());
+    float amps = ta::replay::centi(plant_.amps());
+    float psi = ta::protocol::psiToU16_01(plant_.psi()) / 100.0f; // the sensor's resolution
+    rec_.supply(now, volts, amps);
+    rec_.pressure(now, psi);
+    ctl_.setSupply(volts, amps);
+    ctl_.update(now, psi);
+    plant_.step(stepMs);
+  }
+
+  ta::ctl::Controller& controller() { return ctl_; }
+  PlantSim& plant() { return plant_; }
+  const ta::replay::Recorder& recorder() const { return rec_; }
+  const std::vector<Edge>& edges() const { return out_.edges; }
+
+private:
+  PlantSim plant_;
+  EdgeLog out_;
+  ta::ctl::Controller ctl_;
+  ta::replay::Recorder rec_;
+  std::vector<ta::protocol::Request> pending_;
+};
+
+// Drives a Controller from a board recording
+class BoardReplay : public ta::replay::Sink {
+public:
+  explicit BoardReplay(const ta::ctl::Config& cfg) { ctl_.begin(&out_, cfg); }
+
+  void onRequest(uint32_t now, uint8_t slot, const ta::protocol::Request& req) override { out_.now = now; ctl_.apply(req, slot); }
+  void onSupply(uint32_t, float volts, float amps) override { ctl_.setSupply(volts, amps); }
+  void onPressure(uint32_t now, float psi) override {
+    out_.now = now;
+    ctl_.update(now, psi);
+    loops_++;
+    if (ctl_.state() == ta::ctl::State::ERROR && errorMs_ == 0) errorMs_ = now;
+  }
+
+  ta::ctl::Controller& controller() { return ctl_; }
+  const std::vector<Edge>& edges() const { return out_.edges; }
+  uint32_t loops() const { return loops_; }
+  uint32_t firstErrorMs() const { return errorMs_; }
+
+private:
+  EdgeLog out_;
+  ta::ctl::Controller ctl_;
+  uint32_t loops_ = 0;
+  uint32_t errorMs_ = 0;
+};
+
+// Drives the shared UI from a remote recording. Commands the UI issues are counted,
+// not sent anywhere: the boards' answers are in the recording.
+class RemoteReplay : public ta::replay::Sink, private ta::ui::DeviceActions {
+public:
+  explicit RemoteReplay(const ta::ui::UiConfig& cfg) { ui_.begin(cfg); }
+
+  void onButton(uint32_t now, const ta::input::Event& e) override {
+    ta::ui::ButtonEvent be{ (ta::ui::Button)e.id, toUiAction(e.action), e.heldMs };
+    ui_.onButton(be, *this);
+    ui_.update(now, *this, ctrl_());
+  }
+  void onResponse(uint32_t now, uint8_t board, const ta::protocol::Response& r) override {
+    boards_.onStatus(board, r);
+    ui_.update(now, *this, ctrl_());
+  }
+
+  static ta::ui::Action toUiAction(ta::input::Action a) {
+    switch (a) {
+      case ta::input::Action::Pressed:  return ta::ui::Action::Pressed;
+      case ta::input::Action::Released: return ta::ui::Action::Released;
+      case ta::input::Action::Click:    return ta::ui::Action::Click;
+      case ta::input::Action::LongHold: return ta::ui::Action::LongHold;
+      case ta::input::Action::Repeat:   return ta::ui::Action::Repeat;
+    }
+    return ta::ui::Action::Click;
+  }
+
+  const ta::ui::UiStateMachine& ui() const { return ui_; }
+  const ta::peers::BoardStatusSet& boards() const { return boards_; }
+  int seeks = 0;
+  int cancels = 0;
+  float lastSeekPsi = 0;
+
+private:
+  ta::ui::Ctrl ctrl_() const {
+    ta::peers::BoardView v = boards_.view(0xFF);
+    if (!v.valid) return ta::ui::Ctrl::Idle;
+    switch (v.status) {
+      case ta::protocol::Status::AirUp:    return ta::ui::Ctrl::AirUp;
+      case ta::protocol::Status::Venting:  return ta::ui::Ctrl::Venting;
+      case ta::protocol::Status::Checking: return ta::ui::Ctrl::Checking;
+      case ta::protocol::Status::Error:    return ta::ui::Ctrl::Error;
+      case ta::protocol::Status::Idle:     break;
+    }
+    return ta::ui::Ctrl::Idle;
+  }
+
+  // DeviceActions
+  void cancel() override { cancels++; }
+  void clearError() override { cancels++; }
+  void startSeek(float psi) override { seeks++; lastSeekPsi = psi; }
+  void manualVent(bool) override {}
+  void manualAirUp(bool) override {}
+
+  ta::ui::UiStateMachine ui_;
+  ta::peers::BoardStatusSet boards_;
+};
+
+} // namespace sim
+} // namespace ta
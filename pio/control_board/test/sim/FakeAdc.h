@@ -0,0 +1,41 @@
+#pragma once
+/**
+ * Native ADC source for sensor tests: each pin returns whatever millivolts the test
+ * (or a plant sim) last set on it, plus optional ripple alternating sign on each read
+ * of a pin.
+ */
+#include <TA_Power.h>
+#include <map>
+
+namespace ta {
+namespace sim {
+
+class FakeAdc : public ta::sensors::IAdc {
+public:
+  int readMilliVolts(int pin) override {
+    reads_++;
+    int mv = mv_.count(pin) ? mv_[pin] : 0;
+    bool& up = phase_[pin];
+    up = !up;
+    return mv + (up ? ripple_ : -ripple_);
+  }
+
+  void set(int pin, int mv) { mv_[pin] = mv; }
+  void setRipple(int mv) { ripple_ = mv; }
+  int reads() const { return reads_; }
+
+  // Drive a PowerSensor's pins from a supply voltage and current
+  void setSupply(const ta::sensors::PowerConfig& cfg, float volts, float amps) {
+    if (cfg.voltagePin >= 0) set(cfg.voltagePin, (int)(volts * 1000.0f / cfg.voltageDivider + 0.5f));
+    if (cfg.currentPin >= 0) set(cfg.currentPin, (int)(cfg.currentZeroMv + amps * cfg.currentMvPerAmp + 0.5f));
+  }
+
+private:
+  std::map<int, int> mv_;
+  std::map<int, bool> phase_;
+  int ripple_ = 0;
+  int reads_ = 0;
+};
+
+} // namespace sim
+} // namespace ta
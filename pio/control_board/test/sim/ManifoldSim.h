@@ -0,0 +1,131 @@
+#pragma once
+/**
+ * Native manifold plant for scheduler tests: one compressor and vent on a common
+ * gallery, a valve per tire, and the same pneumatics and motor model as PlantSim.
+ * Tires can differ in volume (a larger tire fills and vents proportionally slower).
+ *
+ * TireOutputs drives a single tire of the manifold as plain IOutputs, so a
+ * single-tire Controller can seek tires one after another as a baseline.
+ */
+#include <TA_Manifold.h>
+#include "PlantSim.h"
+
+namespace ta {
+namespace sim {
+
+class ManifoldSim : public ta::ctl::IManifoldOutputs {
+public:
+  ManifoldSim(uint8_t tires, const float* startPsi, const float* volume = nullptr,
+              const PlantConfig& cfg = PlantConfig())
+      : cfg_(cfg), n_(tires > ta::ctl::kMaxTires ? ta::ctl::kMaxTires : tires), motor_(cfg) {
+    for (uint8_t i = 0; i < n_; ++i) {
+      psi_[i] = startPsi[i];
+      vol_[i] = volume ? volume[i] : 1.0f;
+    }
+  }
+
+  // IManifoldOutputs (compressor/vent interlocked as on the board)
+  uint8_t tireCount() const override { return n_; }
+  void setValve(uint8_t tire, bool open) override {
+    if (tire >= n_) return;
+    if (open) valves_ |= (uint8_t)(1u << tire); else valves_ &= (uint8_t)~(1u << tire);
+    valveSwitches_++;
+  }
+  void setCompressor(bool on) override { if (on) vent_ = false; if (on && !comp_) starts_++; comp_ = on; }
+  void setVent(bool open) override { if (open) comp_ = false; vent_ = open; }
+  void stopAll() override { comp_ = false; vent_ = false; valves_ = 0; }
+  bool compressorRunning() const override { return comp_; }
+
+  void step(uint32_t dtMs) {
+    float dt = dtMs / 1000.0f;
+    int open = 0;
+    for (uint8_t i = 0; i < n_; ++i) if (valves_ & (1u << i)) open++;
+    float linePsi = 0;
+    for (uint8_t i = 0; i < n_; ++i) {
+      if (!(valves_ & (1u << i))) continue;
+      if (comp_) {
+        // Flow splits between open tires; pressure rises inversely with volume
+        float rate = cfg_.fillPsiPerSec * (1.0f - psi_[i] / cfg_.stallPsi) / (open * vol_[i]);
+        if (rate > 0) psi_[i] += rate * dt;
+        if (psi_[i] > linePsi) linePsi = psi_[i];
+      }
+      if (vent_) psi_[i] -= psi_[i] * cfg_.ventPerSec / vol_[i] * dt;
+    }
+    if (comp_) onMs_ += dtMs;
+    motor_.step(dt, comp_, linePsi);
+  }
+
+  const float* psi() const { return psi_; }
+  float psi(uint8_t i) const { return psi_[i]; }
+  bool valveOpen(uint8_t i) const { return valves_ & (1u << i); }
+  uint8_t valves() const { return valves_; }
+  bool compressorOn() const { return comp_; }
+  bool ventOpen() const { return vent_; }
+  float peakC() const { return motor_.peak(); }
+  bool tripped() const { return motor_.tripped(); }
+  uint32_t compressorOnMs() const { return onMs_; }
+  uint32_t compressorStarts() const { return starts_; }
+  uint32_t valveSwitches() const { return valveSwitches_; }
+
+private:
+  PlantConfig cfg_;
+  uint8_t n_;
+  float psi_[ta::ctl::kMaxTires] = {};
+  float vol_[ta::ctl::kMaxTires] = {};
+  MotorSim motor_;
+  uint8_t valves_ = 0;
+  bool comp_ = false;
+  bool vent_ = false;
+  uint32_t onMs_ = 0;
+  uint32_t starts_ = 0;
+  uint32_t valveSwitches_ = 0;
+};
+
+// One tire of the manifold as single-tire outputs: its valve follows compressor/vent
+class TireOutputs : public ta::ctl::IOutputs {
+public:
+  TireOutputs(ManifoldSim& sim, uint8_t tire) : sim_(sim), tire_(tire) {}
+  void setCompressor(bool on) override { sim_.setValve(tire_, on); sim_.setCompressor(on); }
+  void setVent(bool open) override { sim_.setValve(tire_, open); sim_.setVent(open); }
+  void stopAll() override { sim_.stopAll(); }
+  bool compressorRunning() const override { return sim_.compressorOn(); }
+
+private:
+  ManifoldSim& sim_;
+  uint8_t tire_;
+};
+
+// Run the scheduler until every tire is done (or timeoutMs passes); returns the time taken
+inline uint32_t runManifold(ta::ctl::ManifoldScheduler& sched, ManifoldSim& sim, uint32_t& now,
+                            uint32_t timeoutMs = 3UL * 60UL * 60UL * 1000UL, uint32_t stepMs = 50) {
+  uint32_t start = now;
+  while (now - start < timeoutMs) {
+    sim.step(stepMs);
+    now += stepMs;
+    sched.update(now, sim.psi());
+    if (sched.state() == ta::ctl::State::IDLE || sched.state() == ta::ctl::State::ERROR) break;
+  }
+  return now - start;
+}
+
+// Baseline: the same tires seeked one after another by a single-tire Controller each
+inline uint32_t runSerial(ManifoldSim& sim, const ta::ctl::Config& cfg, const float* targets,
+                          uint32_t& now, uint32_t stepMs = 50) {
+  uint32_t start = now;
+  for (uint8_t i = 0; i < sim.tireCount(); ++i) {
+    TireOutputs out(sim, i);
+    ta::ctl::Controller ctl;
+    ctl.begin(&out, cfg);
+    ctl.update(now, sim.psi(i));
+    ctl.startSeek(targets[i]);
+    while (ctl.state() != ta::ctl::State::IDLE && ctl.state() != ta::ctl::State::ERROR) {
+      sim.step(stepMs);
+      now += stepMs;
+      ctl.update(now, sim.psi(i));
+    }
+  }
+  return now - start;
+}
+
+} // namespace sim
+} // namespace ta
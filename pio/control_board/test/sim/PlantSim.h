@@ -0,0 +1,135 @@
+#pragma once
+/**
+ * Native plant simulation for controller tests: one compressor and vent valve on a
+ * tire, with a first-order motor temperature model standing in for the real
+ * compressor's thermal behaviour. Implements ta::ctl::IOutputs so a Controller
+ * drives it directly; step() advances physics.
+ *
+ * Shared by test suites via #include "../sim/PlantSim.h" (not a suite itself).
+ */
+#include <TA_Controller.h>
+#include <math.h>
+
+namespace ta {
+namespace sim {
+
+struct PlantConfig {
+  float startPsi = 10.0f;
+  // Pneumatics
+  float fillPsiPerSec = 0.08f;     // compressor into an empty tire (large tire, small pump)
+  float stallPsi = 150.0f;         // compressor can't push past this
+  float ventPerSec = 0.02f;        // vent removes this fraction of gauge pressure per second
+  float leakPsiPerMin = 0.0f;      // slow leak (valve core, bead), at any pressure
+  // Motor temperature: heats at heatCPerSec * (1 + psi/100) while running,
+  // cools toward ambient with time constant coolTauSec
+  float ambientC = 25.0f;
+  float heatCPerSec = 0.15f;
+  float coolTauSec = 600.0f;
+  float tripC = 105.0f;            // thermal cutout of a typical 12 V compressor
+  // Supply: pump speed (fill rate) follows loaded volts / nominalVolts
+  float supplyVolts = 13.5f;       // at rest; ~12.2 for a battery with the engine off
+  float nominalVolts = 13.5f;
+  float sourceOhms = 0.05f;        // battery and wiring: loaded volts sag by amps * this
+  float ampsBase = 12.0f;          // running current, rising with line pressure
+  float ampsPerPsi = 0.15f;
+  float stallVolts = 8.0f;         // below this (loaded) the motor can't turn the pump over
+};
+
+// Motor temperature shared by the single-tire and manifold plants
+class MotorSim {
+public:
+  explicit MotorSim(const PlantConfig& cfg) : cfg_(cfg), c_(cfg.ambientC), peak_(cfg.ambientC) {}
+
+  void step(float dt, bool on, float linePsi) {
+    if (on) c_ += cfg_.heatCPerSec * (1.0f + linePsi / 100.0f) * dt;
+    c_ -= (c_ - cfg_.ambientC) * (dt / cfg_.coolTauSec);
+    if (c_ > peak_) peak_ = c_;
+    if (c_ >= cfg_.tripC) tripped_ = true;
+  }
+
+  float c() const { return c_; }
+  float peak() const { return peak_; }
+  bool tripped() const { return tripped_; }
+
+private:
+  PlantConfig cfg_;
+  float c_;
+  float peak_;
+  bool tripped_ = false;
+};
+
+class PlantSim : public ta::ctl::IOutputs {
+public:
+  explicit PlantSim(const PlantConfig& cfg = PlantConfig())
+      : cfg_(cfg), psi_(cfg.startPsi), motor_(cfg), supplyVolts_(cfg.supplyVolts) {}
+
+  // IOutputs (same interlock as ta::act::Actuators)
+  void setCompressor(bool on) override { if (on) vent_ = false; if (on && !comp_) starts_++; comp_ = on; }
+  void setVent(bool open) override { if (open) comp_ = false; vent_ = open; }
+  void stopAll() override { comp_ = false; vent_ = false; }
+  bool compressorRunning() const override { return comp_; }
+
+  void step(uint32_t dtMs) {
+    float dt = dtMs / 1000.0f;
+    bool running = comp_ && connected_;
+    if (running && volts() >= cfg_.stallVolts) {
+      float rate = cfg_.fillPsiPerSec * (1.0f - psi_ / cfg_.stallPsi) * volts() / cfg_.nominalVolts;
+      if (rate > 0) psi_ += rate * dt;
+    }
+    if (comp_) onMs_ += dtMs;
+    if (vent_) psi_ -= psi_ * cfg_.ventPerSec * dt;
+    if (psi_ > 0) psi_ -= cfg_.leakPsiPerMin / 60.0f * dt;
+    if (psi_ < 0) psi_ = 0;
+    motor_.step(dt, running, psi_);
+  }
+
+  // Supply seen at the board, and the compressor's draw
+  float amps() const { return comp_ && connected_ ? cfg_.ampsBase + cfg_.ampsPerPsi * psi_ : 0.0f; }
+  float volts() const { return supplyVolts_ - amps() * cfg_.sourceOhms; }
+  void setSupplyVolts(float v) { supplyVolts_ = v; }
+  // false: the relay clicks but the motor gets nothing (blown fuse, loose plug)
+  void setConnected(bool c) { connected_ = c; }
+
+  // Move the hose to another tire (back-to-back axles)
+  void setPsi(float psi) { psi_ = psi; }
+
+  float psi() const { return psi_; }
+  float motorC() const { return motor_.c(); }
+  float peakC() const { return motor_.peak(); }
+  bool tripped() const { return motor_.tripped(); }
+  bool compressorOn() const { return comp_; }
+  bool ventOpen() const { return vent_; }
+  uint32_t compressorOnMs() const { return onMs_; }
+  uint32_t compressorStarts() const { return starts_; }
+  const PlantConfig& config() const { return cfg_; }
+
+private:
+  PlantConfig cfg_;
+  float psi_;
+  MotorSim motor_;
+  float supplyVolts_;
+  bool connected_ = true;
+  bool comp_ = false;
+  bool vent_ = false;
+  uint32_t onMs_ = 0;
+  uint32_t starts_ = 0;
+};
+
+// Run a controller against the plant until it leaves the seek (or timeoutMs passes).
+// Returns the time taken; now is advanced in place.
+inline uint32_t runSeek(ta::ctl::Controller& ctl, PlantSim& plant, uint32_t& now, float target,
+                        uint32_t timeoutMs = 3UL * 60UL * 60UL * 1000UL, uint32_t stepMs = 50) {
+  ctl.update(now, plant.psi());
+  ctl.startSeek(target);
+  uint32_t start = now;
+  while (now - start < timeoutMs) {
+    plant.step(stepMs);
+    now += stepMs;
+    ctl.update(now, plant.psi());
+    if (ctl.state() == ta::ctl::State::IDLE || ctl.state() == ta::ctl::State::ERROR) break;
+  }
+  return now - start;
+}
+
+} // namespace sim
+} // namespace ta
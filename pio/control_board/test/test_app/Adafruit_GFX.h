@@ -0,0 +1,3 @@
+#pragma once
+// Headless: App is built without a display here
+class Adafruit_GFX {};
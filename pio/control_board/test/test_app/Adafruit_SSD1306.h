@@ -0,0 +1,4 @@
+#pragma once
+// Headless: App is built without a display here
+#include "Adafruit_GFX.h"
+class Adafruit_SSD1306 : public Adafruit_GFX {};
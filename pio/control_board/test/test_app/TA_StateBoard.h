@@ -0,0 +1,3 @@
+#pragma once
+// The board's own libraries (lib_ignore'd in native_test)
+#include "../../lib/TA_StateBoard/src/TA_StateBoard.h"
@@ -0,0 +1,3 @@
+#pragma once
+// Shared with the remote's test_fuzz
+#include "../../../remote/test/test_fuzz/WiFi.h"
@@ -0,0 +1,309 @@
+/**
+ * Unit tests for TA_App
+ * Runs the whole control board (App with its comms, controller and board UI) against
+ * a real remote link in one host loopback, for what only shows with everything wired:
+ * adding a second remote to a paired board from the serial console, and keeping a
+ * known remote's key when a PairReq for it arrives with no board-side confirm,
+ * calibration entered from the console, one remote's lease stop leaving another
+ * remote's manual running, and supply sensing left off when it isn't wired
+ */
+
+#include <Arduino.h>
+#include <gtest/gtest.h>
+#include <deque>
+#include <memory>
+#include <string>
+
+// The firmware under test, built against the stub headers in this folder (the
+// controller as the device builds it, on the board's Actuators)
+#undef UNIT_TEST
+#include "../../../../pioLib/TA_Controller/src/TA_Controller.cpp"
+#include "../../../../pioLib/TA_UI/src/TA_UI.cpp"
+#include "../../lib/TA_CommsBoard/src/TA_CommsBoard.cpp"
+#include "../../lib/TA_StateBoard/src/TA_StateBoard.cpp"
+#include "../../lib/TA_App/src/TA_App.cpp"
+#include "../../../remote/lib/TA_Comms/src/TA_Comms.cpp"
+
+// Headless: App only touches the display when it is given one
+namespace ta { namespace display {
+bool TA_Display::begin(uint8_t, bool) { return true; }
+void TA_Display::render(const DisplayModel&) {}
+} }
+
+using ta::comms::PairEvent;
+
+static constexpr uint32_t kRemoteLoopMs = 5;
+static constexpr uint32_t kAirMs = 3;
+
+// ============================================================================
+// Board and remote in one loopback
+// ============================================================================
+class AppRig {
+public:
+    FakeDevice boardDev, remoteDev;
+    std::unique_ptr<ta::app::App> app;
+    std::unique_ptr<ta::comms::EspNowLink> remote;
+    uint32_t now = 1;
+    std::vector<PairEvent> pairEvents;
+
+    const uint8_t boardMac[6]   = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    const uint8_t remoteAMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};   // paired, off
+    const uint8_t remoteBMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x03};   // the one we run
+
+    // The board already has remote A; remote B is new
+    void begin() {
+        ta::cfg::LinkShared cfg;
+        uint8_t lmk[ta::pairkey::kKeyLen];
+        ta::pairkey::deriveLmk(cfg.pmk, remoteAMac, boardMac, 0x01, 0xC0FFEE, lmk);
+        memcpy(boardDev.mac, boardMac, 6);
+        memcpy(remoteDev.mac, remoteBMac, 6);
+        sync_();
+
+        selectDevice(boardDev);
+        Preferences p;
+        ta::pairkey::savePeer(p, 0, remoteAMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        app.reset(new ta::app::App());
+        app->begin();
+
+        selectDevice(remoteDev);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        remote.reset(new ta::comms::EspNowLink());
+        remote->setPmk(cfg.pmk);
+        remote->setPairCallback(&AppRig::onPair_, this);
+        remote->begin(nullptr);
+        run(500);
+    }
+
+    // Type a line on the board's serial console
+    void console(const char* line) { boardDev.serialIn += line; boardDev.serialIn += '\n'; }
+
+    // Remote B tries to pair; true once the board acked it, false on Busy or timeout
+    bool pairRemote(uint32_t limitMs) {
+        pairEvents.clear();
+        selectDevice(remoteDev);
+        remote->startPairing(0x01, limitMs);
+        for (uint32_t ms = 0; ms < limitMs + 100 && remote->isPairing(); ms += kRemoteLoopMs) run(kRemoteLoopMs);
+        for (PairEvent e : pairEvents) if (e == PairEvent::Acked) return true;
+        return false;
+    }
+    bool sawPairEvent(PairEvent ev) const {
+        for (PairEvent e : pairEvents) if (e == ev) return true;
+        return false;
+    }
+
+    // A frame the board hears straight off the air (a remote we don't run, or a spoofer)
+    void boardHears(const uint8_t* fromMac, const uint8_t* data, int len) {
+        selectDevice(boardDev);
+        boardDev.deliver(fromMac, data, len);
+    }
+    bool boardSentBusy() const {
+        for (const SentFrame& f : boardTx_) {
+            if (f.len == 2 && f.data[0] == (uint8_t)ta::protocol::PairOp::Busy) return true;
+        }
+        return false;
+    }
+    std::string storedKey(uint8_t slot) {
+        selectDevice(boardDev);
+        Preferences p;
+        uint8_t mac[6], lmk[ta::pairkey::kKeyLen];
+        if (!ta::pairkey::loadPeer(p, slot, mac, lmk)) return "";
+        return std::string((const char*)lmk, sizeof(lmk));
+    }
+
+    // 1 ms steps: air, the remote's loop every kRemoteLoopMs and App's loop whenever
+    // its own delay(10) is over
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; ++i) {
+            now++;
+            sync_();
+            deliverDue_();
+            if (now % kRemoteLoopMs == 0) {
+                selectDevice(remoteDev);
+                remote->service();
+                launch_(remoteDev, boardDev, remoteBMac);
+            }
+            if ((int32_t)(now - boardNextMs_) >= 0) {
+                selectDevice(boardDev);
+                app->loop();
+                boardNextMs_ = boardDev.nowMs;
+                boardDev.nowMs = now;
+                launch_(boardDev, remoteDev, boardMac);
+            }
+        }
+    }
+
+private:
+    struct InFlight { uint32_t at; FakeDevice* to; const uint8_t* fromMac; SentFrame f; };
+
+    void sync_() { boardDev.nowMs = remoteDev.nowMs = now; }
+
+    void launch_(FakeDevice& from, FakeDevice& to, const uint8_t* fromMac) {
+        static const uint8_t kBcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        for (const SentFrame& f : from.tx) {
+            bool bcast = f.broadcast || memcmp(f.mac, kBcast, 6) == 0;
+            if (!bcast && memcmp(f.mac, to.mac, 6) != 0) continue;
+            air_.push_back(InFlight{ now + kAirMs, &to, fromMac, f });
+        }
+        if (&from == &boardDev) boardTx_.insert(boardTx_.end(), from.tx.begin(), from.tx.end());
+        from.tx.clear();
+    }
+    void deliverDue_() {
+        while (!air_.empty() && air_.front().at <= now) {
+            InFlight m = air_.front();
+            air_.pop_front();
+            selectDevice(*m.to);
+            m.to->deliver(m.fromMac, m.f.data, (int)m.f.len);
+        }
+    }
+
+    static void onPair_(void* ctx, PairEvent ev, const uint8_t*) {
+        static_cast<AppRig*>(ctx)->pairEvents.push_back(ev);
+    }
+
+    std::deque<InFlight> air_;
+    std::vector<SentFrame> boardTx_;    // everything the board sent, oldest first
+    uint32_t boardNextMs_ = 0;
+};
+
+// ============================================================================
+// Adding a remote
+// ============================================================================
+TEST(AppPairing, PairedBoard_RefusesANewRemote) {
+    AppRig rig;
+    rig.begin();
+    EXPECT_FALSE(rig.pairRemote(3000));
+    EXPECT_TRUE(rig.sawPairEvent(PairEvent::Busy));
+    selectDevice(rig.boardDev);
+    EXPECT_EQ(rig.app->comms().peerCount(), 1u);
+}
+
+TEST(AppPairing, ConsolePair_SecondRemotePairs) {
+    AppRig rig;
+    rig.begin();
+    EXPECT_FALSE(rig.pairRemote(3000));
+
+    rig.console("pair");
+    rig.run(50);
+    EXPECT_TRUE(rig.pairRemote(3000));
+    selectDevice(rig.boardDev);
+    EXPECT_EQ(rig.app->comms().peerCount(), 2u);
+}
+
+TEST(AppPairing, UnknownConsoleLine_OpensNothing) {
+    AppRig rig;
+    rig.begin();
+    rig.console("pear");
+    rig.console("right");
+    rig.run(50);
+    EXPECT_FALSE(rig.pairRemote(3000));
+    selectDevice(rig.boardDev);
+    EXPECT_EQ(rig.app->comms().peerCount(), 1u);
+}
+
+// ============================================================================
+// Re-keying a known remote
+// ============================================================================
+TEST(AppPairing, KnownMacOutsideWindow_KeyKept) {
+    AppRig rig;
+    rig.begin();
+    std::string key = rig.storedKey(0);
+    ASSERT_FALSE(key.empty());
+
+    // Someone replays remote A's MAC with a PairReq while nobody confirmed anything
+    uint8_t req[ta::protocol::kPayloadLen] = {0};
+    ta::protocol::packPairReq(req, 0x01);
+    rig.boardHears(rig.remoteAMac, req, sizeof(req));
+    rig.run(50);
+    EXPECT_TRUE(rig.boardSentBusy());
+    EXPECT_EQ(rig.storedKey(0), key);
+}
+
+TEST(AppPairing, KnownMacInsideWindow_Rekeyed) {
+    AppRig rig;
+    rig.begin();
+    std::string key = rig.storedKey(0);
+
+    rig.console("pair");
+    rig.run(50);
+    uint8_t req[ta::protocol::kPayloadLen] = {0};
+    ta::protocol::packPairReq(req, 0x01);
+    rig.boardHears(rig.remoteAMac, req, sizeof(req));
+    rig.run(50);
+    EXPECT_FALSE(rig.boardSentBusy());
+    EXPECT_NE(rig.storedKey(0), key);
+}
+
+// ============================================================================
+// Two remotes
+// ============================================================================
+TEST(AppTwoRemotes, LeaseStopFromOtherRemote_ManualKeepsRunning) {
+    AppRig rig;
+    rig.begin();
+    rig.console("pair");
+    rig.run(50);
+    ASSERT_TRUE(rig.pairRemote(3000));
+    rig.run(2000);
+
+    // Remote B (slot 1) holds Air
+    selectDevice(rig.remoteDev);
+    ASSERT_TRUE(rig.remote->holdManual((uint8_t)ta::protocol::ManualCode::Air));
+    rig.run(100);
+    ASSERT_EQ(rig.app->controller().state(), ta::ctl::State::AIRUP);
+
+    // Remote A (slot 0) lets go of a hold of its own that the board never started
+    ta::protocol::Request stop;
+    stop.kind = ta::protocol::Request::Kind::Manual;
+    stop.manual = ta::protocol::ManualCode::Air;
+    stop.leased = true;
+    stop.leaseMs = 0;
+    stop.seq = 7;
+    uint8_t f[ta::protocol::kMaxPayloadLen];
+    int len = ta::protocol::packRequest(f, stop, ta::protocol::kProtoV2);
+    rig.boardHears(rig.remoteAMac, f, len);
+    rig.run(100);
+    EXPECT_EQ(rig.app->controller().state(), ta::ctl::State::AIRUP);
+
+    selectDevice(rig.remoteDev);
+    rig.remote->releaseManual();
+    rig.run(100);
+    EXPECT_EQ(rig.app->controller().state(), ta::ctl::State::IDLE);
+}
+
+// ============================================================================
+// Supply sensing
+// ============================================================================
+TEST(AppPower, Unwired_PlansOnNominalSupply) {
+    AppRig rig;
+    rig.boardDev.adcMv[2] = 0;   // floating pins where a sensor could go
+    rig.boardDev.adcMv[4] = 0;
+    rig.begin();
+    rig.run(200);
+    EXPECT_FLOAT_EQ(rig.app->controller().powerFactor(), 1.0f);
+}
+
+// ============================================================================
+// Calibration from the console
+// ============================================================================
+TEST(AppCalibration, ConsoleCal_StepsThroughZeroAndSpan) {
+    using Step = ta::stateboard::StateBoard::CalStep;
+    AppRig rig;
+    rig.begin();
+    rig.console("cal");
+    rig.run(50);
+    EXPECT_EQ(rig.app->state().calStep(), Step::Zero);
+    rig.console("right");
+    rig.run(50);
+    EXPECT_EQ(rig.app->state().calStep(), Step::Span);
+    rig.console("left");
+    rig.run(50);
+    EXPECT_EQ(rig.app->state().calStep(), Step::None);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,310 @@
+/**
+ * Unit tests for TA_Calib
+ * Tests the pressure transducer calibration record (offset/gain and piecewise
+ * tables), the fixed-point lookup against the float reference, the two-point field
+ * calibration and the NVS record format
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Calib.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstring>
+
+using namespace ta::calib;
+
+// ============================================================================
+// Fake NVS - same interface subset as Arduino Preferences
+// ============================================================================
+class FakePrefs {
+public:
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+    std::string ns;
+    bool readOnly = false;
+    int writes = 0;
+
+    bool begin(const char* name, bool ro = false) { ns = name; readOnly = ro; return true; }
+    void end() {}
+
+    size_t getBytesLength(const char* key) {
+        auto it = nvs[ns].find(key);
+        return it == nvs[ns].end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        auto it = nvs[ns].find(key);
+        if (it == nvs[ns].end() || it->second.size() > len) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (readOnly) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(buf);
+        nvs[ns][key] = std::vector<uint8_t>(p, p + len);
+        writes++;
+        return len;
+    }
+};
+
+// A sensor that isn't straight: flattens toward the top of its range
+static Calibration curvedTable() {
+    Calibration c = forSensor(150.0f);
+    c.points = 5;
+    c.table[0] = {500, 0.0f};
+    c.table[1] = {1500, 38.0f};
+    c.table[2] = {2500, 76.5f};
+    c.table[3] = {3500, 113.0f};
+    c.table[4] = {4500, 148.0f};
+    return c;
+}
+
+// The formula PressureFilter used before calibration existed
+static float legacyPsi(int mv) {
+    float psi = (mv / 1000.0f - 0.5f) * (150.0f / 4.0f);
+    return psi < 0 ? 0 : (psi > 150 ? 150 : psi);
+}
+
+// ============================================================================
+// Linearizer Tests
+// ============================================================================
+TEST(Linearizer, Default_MatchesLegacyFormula) {
+    Linearizer lin;
+    for (int mv = 0; mv <= 5000; mv += 7) {
+        EXPECT_NEAR(lin.psi((float)mv), legacyPsi(mv), 0.011f) << mv << " mV";
+    }
+}
+
+TEST(Linearizer, SensorRanges_FullScaleAtFourPointFiveVolts) {
+    for (float fs : {100.0f, 150.0f, 200.0f}) {
+        Linearizer lin;
+        lin.build(forSensor(fs));
+        EXPECT_NEAR(lin.psi(500.0f), 0.0f, 0.01f);
+        EXPECT_NEAR(lin.psi(2500.0f), fs / 2, 0.01f);
+        EXPECT_NEAR(lin.psi(4500.0f), fs, 0.01f);
+    }
+}
+
+TEST(Linearizer, Clamped_ZeroToFullScale) {
+    Linearizer lin;
+    lin.build(forSensor(100.0f));
+    EXPECT_FLOAT_EQ(lin.psi(0.0f), 0.0f);
+    EXPECT_FLOAT_EQ(lin.psi(300.0f), 0.0f);
+    EXPECT_FLOAT_EQ(lin.psi(4900.0f), 100.0f);
+    EXPECT_FLOAT_EQ(lin.psi(9000.0f), 100.0f);
+    EXPECT_FLOAT_EQ(lin.psi(-20.0f), 0.0f);
+}
+
+TEST(Linearizer, Table_MatchesFloatReference) {
+    Calibration c = curvedTable();
+    ASSERT_TRUE(isValid(c));
+    Linearizer lin;
+    lin.build(c);
+    for (int mv = 500; mv <= 4500; mv += 3) {
+        EXPECT_NEAR(lin.psi((float)mv), psiAt(c, (float)mv), 0.02f) << mv << " mV";
+    }
+    // Past the ends the first/last segment continues
+    EXPECT_NEAR(psiAt(c, 4600.0f), 151.5f, 0.01f);
+    EXPECT_FLOAT_EQ(lin.psi(4600.0f), 150.0f);
+}
+
+TEST(Linearizer, SubMillivoltResolution) {
+    // A 10-sample average lands between millivolts; 1 mV is 0.0375 PSI
+    Linearizer lin;
+    float a = lin.psi(1000.0f);
+    float b = lin.psi(1000.5f);
+    float c = lin.psi(1001.0f);
+    EXPECT_GT(b, a);
+    EXPECT_LT(b, c);
+    EXPECT_NEAR(b - a, 0.019f, 0.011f);
+}
+
+TEST(Linearizer, IntegerInput_SameAsFloat) {
+    Linearizer lin;
+    lin.build(curvedTable());
+    for (int mv = 0; mv <= 5200; mv += 11) {
+        EXPECT_EQ(lin.centiPsi(mv), lin.centiPsi16(mv << kMvFracBits));
+        EXPECT_NEAR(lin.centiPsi(mv) / 100.0f, lin.psi((float)mv), 0.001f);
+    }
+}
+
+TEST(Linearizer, Throughput) {
+    // The lookup is what runs every loop; the float path is what it replaces
+    Linearizer lin;
+    Calibration c = curvedTable();
+    lin.build(c);
+    const int n = 2000000;
+    volatile uint32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) sink = sink + lin.centiPsi16((i * 37) & 0xFFFF);
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float fsink = 0;
+    for (int i = 0; i < n; ++i) fsink = fsink + psiAt(c, ((i * 37) & 0xFFFF) / 16.0f);
+    auto t2 = std::chrono::steady_clock::now();
+    double lutNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    double floatNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+    printf("[calib] lookup %.2f ns/read, float table walk %.2f ns/read\n", lutNs, floatNs);
+    EXPECT_GT(sink, 0u);
+}
+
+// ============================================================================
+// Validation Tests
+// ============================================================================
+TEST(Calibration, Invalid_Rejected) {
+    Calibration c;
+    c.psiPerMv = 0;
+    EXPECT_FALSE(isValid(c));
+    c = Calibration();
+    c.points = 1;
+    EXPECT_FALSE(isValid(c));
+    c = curvedTable();
+    c.table[2].mv = 1400; // not ascending
+    EXPECT_FALSE(isValid(c));
+    c = curvedTable();
+    c.table[3].psi = 70.0f; // falling
+    EXPECT_FALSE(isValid(c));
+    c = Calibration();
+    c.fullScalePsi = 0;
+    EXPECT_FALSE(isValid(c));
+}
+
+TEST(Calibration, OutOfRecordRange_Rejected) {
+    Calibration c = curvedTable();
+    c.table[0].psi = -1.0f;
+    EXPECT_FALSE(isValid(c));
+    c = curvedTable();
+    c.table[c.points - 1].psi = 700.0f;
+    EXPECT_FALSE(isValid(c));
+    c = curvedTable();
+    c.table[0].psi = NAN;
+    EXPECT_FALSE(isValid(c));
+    c = Calibration();
+    c.fullScalePsi = 655.4f;
+    EXPECT_FALSE(isValid(c));
+
+    // The top of the range still packs exactly
+    c.fullScalePsi = kMaxRecordPsi;
+    ASSERT_TRUE(isValid(c));
+    uint8_t b[kRecordMaxLen];
+    size_t len = packRecord(b, c);
+    Calibration back;
+    ASSERT_TRUE(parseRecord(b, len, back));
+    EXPECT_FLOAT_EQ(back.fullScalePsi, kMaxRecordPsi);
+}
+
+// ============================================================================
+// Two-Point Calibration Tests
+// ============================================================================
+TEST(TwoPoint, CorrectsOffsetAndGainError) {
+    // This part reads 30 mV high at zero and is 2% hot on span
+    auto sensorMv = [](float psi) { return 530.0f + psi * (4000.0f / 150.0f) * 1.02f; };
+    Linearizer nominal;
+    EXPECT_GT(fabsf(nominal.psi(sensorMv(40.0f)) - 40.0f), 1.0f);
+
+    TwoPointCal cal;
+    cal.begin(forSensor(150.0f));
+    cal.setLow(sensorMv(0.0f));
+    cal.setHigh(sensorMv(40.0f), 40.0f);
+    Calibration c;
+    ASSERT_TRUE(cal.solve(c));
+    EXPECT_FLOAT_EQ(c.fullScalePsi, 150.0f);
+    Linearizer lin;
+    lin.build(c);
+    for (float psi : {5.0f, 20.0f, 40.0f, 80.0f, 120.0f}) {
+        EXPECT_NEAR(lin.psi(sensorMv(psi)), psi, 0.02f) << psi;
+    }
+}
+
+TEST(TwoPoint, ReplacesTable) {
+    TwoPointCal cal;
+    cal.begin(curvedTable());
+    cal.setLow(500.0f);
+    cal.setHigh(1566.7f, 40.0f);
+    Calibration c;
+    ASSERT_TRUE(cal.solve(c));
+    EXPECT_EQ(c.points, 0);
+}
+
+TEST(TwoPoint, MissingOrClosePoints_Refused) {
+    TwoPointCal cal;
+    cal.begin(forSensor(150.0f));
+    Calibration c;
+    EXPECT_FALSE(cal.solve(c));
+    cal.setLow(500.0f);
+    EXPECT_FALSE(cal.solve(c));
+    cal.setHigh(600.0f, 4.0f);   // 100 mV, 4 PSI apart
+    EXPECT_FALSE(cal.solve(c));
+    cal.setHigh(480.0f, 40.0f);  // falling: hose not connected
+    EXPECT_FALSE(cal.solve(c));
+    cal.setHigh(1560.0f, 40.0f);
+    EXPECT_TRUE(cal.solve(c));
+}
+
+// ============================================================================
+// Record / NVS Tests
+// ============================================================================
+TEST(CalibNvs, Linear_RoundTrip) {
+    FakePrefs prefs;
+    Calibration c = forSensor(200.0f);
+    c.offsetMv = 512.25f;
+    c.psiPerMv = 0.0493f;
+    ASSERT_TRUE(saveCalibration(prefs, c));
+    EXPECT_EQ(prefs.nvs[kNvsNamespace][kNvsRecord].size(), kRecordHeaderLen + 1);
+    Calibration r;
+    ASSERT_TRUE(loadCalibration(prefs, r));
+    EXPECT_FLOAT_EQ(r.offsetMv, 512.25f);
+    EXPECT_FLOAT_EQ(r.psiPerMv, 0.0493f);
+    EXPECT_FLOAT_EQ(r.fullScalePsi, 200.0f);
+    EXPECT_EQ(r.points, 0);
+}
+
+TEST(CalibNvs, Table_RoundTrip) {
+    FakePrefs prefs;
+    Calibration c = curvedTable();
+    ASSERT_TRUE(saveCalibration(prefs, c));
+    Calibration r;
+    ASSERT_TRUE(loadCalibration(prefs, r));
+    ASSERT_EQ(r.points, c.points);
+    for (int i = 0; i < c.points; ++i) {
+        EXPECT_EQ(r.table[i].mv, c.table[i].mv);
+        EXPECT_NEAR(r.table[i].psi, c.table[i].psi, 0.005f);
+    }
+}
+
+TEST(CalibNvs, NothingStored_KeepsDefault) {
+    FakePrefs prefs;
+    Calibration r = forSensor(100.0f);
+    EXPECT_FALSE(loadCalibration(prefs, r));
+    EXPECT_FLOAT_EQ(r.fullScalePsi, 100.0f);
+}
+
+TEST(CalibNvs, Corrupt_Rejected) {
+    FakePrefs prefs;
+    ASSERT_TRUE(saveCalibration(prefs, curvedTable()));
+    std::vector<uint8_t>& rec = prefs.nvs[kNvsNamespace][kNvsRecord];
+    rec[5] ^= 0x10;
+    Calibration r;
+    EXPECT_FALSE(loadCalibration(prefs, r));
+    rec[5] ^= 0x10;
+    rec[0] = kRecordVersion + 1;
+    EXPECT_FALSE(loadCalibration(prefs, r));
+    rec[0] = kRecordVersion;
+    rec.pop_back();
+    EXPECT_FALSE(loadCalibration(prefs, r));
+}
+
+TEST(CalibNvs, Invalid_NotSaved) {
+    FakePrefs prefs;
+    Calibration c;
+    c.psiPerMv = -1.0f;
+    EXPECT_FALSE(saveCalibration(prefs, c));
+    EXPECT_EQ(prefs.writes, 0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
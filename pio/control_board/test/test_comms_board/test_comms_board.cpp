@@ -259,9 +259,10 @@ TEST_F(CommsBoardTest, RequestCallback_NotInvokedWhenUnpaired) {
     ASSERT_TRUE(link->begin());
     
     bool callbackInvoked = false;
-    link->setRequestCallback([](void* ctx, const ta::protocol::Request& req) {
+    link->setRequestCallback([](void* ctx, uint8_t slot, const ta::protocol::Request& req) {
         bool* invoked = static_cast<bool*>(ctx);
         *invoked = true;
+        return true;
     }, &callbackInvoked);
     
     uint8_t packet[2];
@@ -282,9 +283,10 @@ TEST_F(CommsBoardTest, Protocol_IgnoresInvalidPackets) {
     ASSERT_TRUE(link->begin());
     
     bool callbackInvoked = false;
-    link->setRequestCallback([](void* ctx, const ta::protocol::Request& req) {
+    link->setRequestCallback([](void* ctx, uint8_t slot, const ta::protocol::Request& req) {
         bool* invoked = static_cast<bool*>(ctx);
         *invoked = true;
+        return true;
     }, &callbackInvoked);
     
     // Send invalid packet (wrong length)
@@ -298,9 +300,10 @@ TEST_F(CommsBoardTest, Protocol_IgnoresPacketsFromWrongPeer) {
     ASSERT_TRUE(link->begin());
     
     bool callbackInvoked = false;
-    link->setRequestCallback([](void* ctx, const ta::protocol::Request& req) {
+    link->setRequestCallback([](void* ctx, uint8_t slot, const ta::protocol::Request& req) {
         bool* invoked = static_cast<bool*>(ctx);
         *invoked = true;
+        return true;
     }, &callbackInvoked);
     
     // Valid packet but from wrong peer
@@ -1,11 +1,14 @@
 /**
  * Unit tests for TA_Controller
- * Tests state machine logic, PSI seeking, error handling, and manual control
+ * Tests state machine logic, PSI seeking, retargeting, pressure-dependent rate curves,
+ * error handling, and manual control
  */
 
 #include <gtest/gtest.h>
 #include <TA_Controller.h>
 #include <cmath>
+#include <TA_Relay.h>
+#include "../sim/PlantSim.h"
 
 using namespace ta::ctl;
 
@@ -19,6 +22,7 @@ public:
     int compressorCalls = 0;
     int ventCalls = 0;
     int stopCalls = 0;
+    int emergencyCalls = 0;
 
     void setCompressor(bool on) override {
         compressorOn = on;
@@ -36,10 +40,17 @@ public:
         stopCalls++;
     }
 
+    void emergencyStop() override {
+        stopAll();
+        emergencyCalls++;
+    }
+
+    bool compressorRunning() const override { return compressorOn; }
+
     void reset() {
         compressorOn = false;
         ventOpen = false;
-        compressorCalls = ventCalls = stopCalls = 0;
+        compressorCalls = ventCalls = stopCalls = emergencyCalls = 0;
     }
 };
 
@@ -219,6 +230,143 @@ TEST_F(ControllerTest, Manual_TimesOutWithoutRefresh) {
     EXPECT_FALSE(outputs.compressorOn);
 }
 
+static ta::protocol::Request leased(ta::protocol::ManualCode code, uint16_t leaseMs) {
+    ta::protocol::Request r;
+    r.kind = ta::protocol::Request::Kind::Manual;
+    r.manual = code;
+    r.leased = true;
+    r.leaseMs = leaseMs;
+    return r;
+}
+
+TEST_F(ControllerTest, ManualLease_RunsForLeaseThenStops) {
+    controller.update(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 1500));
+    controller.update(1500, 10.0f);
+    EXPECT_TRUE(outputs.compressorOn);           // well past the v1 refresh timeout
+    controller.update(1510, 10.0f);
+    EXPECT_EQ(controller.state(), State::IDLE);
+    EXPECT_FALSE(outputs.compressorOn);
+}
+
+TEST_F(ControllerTest, ManualLease_RenewalExtends) {
+    controller.update(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Vent, 1500));
+    controller.update(1000, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Vent, 1500));
+    controller.update(2400, 10.0f);
+    EXPECT_TRUE(outputs.ventOpen);
+    controller.update(2510, 10.0f);
+    EXPECT_FALSE(outputs.ventOpen);
+}
+
+TEST_F(ControllerTest, ManualLease_CappedByConfig) {
+    controller.update(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 60000));
+    controller.update(cfg.manualLeaseMaxMs + 10, 10.0f);
+    EXPECT_FALSE(outputs.compressorOn);
+}
+
+TEST_F(ControllerTest, ManualLease_StopEndsManual) {
+    controller.update(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 1500));
+    controller.apply(leased(ta::protocol::ManualCode::Air, 0));
+    EXPECT_EQ(controller.state(), State::IDLE);
+    EXPECT_FALSE(outputs.compressorOn);
+}
+
+TEST_F(ControllerTest, ManualLease_StopLeavesSeekRunning) {
+    controller.update(0, 10.0f);
+    controller.startSeek(20.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 0));   // late stop from an earlier hold
+    EXPECT_EQ(controller.state(), State::AIRUP);
+    EXPECT_FLOAT_EQ(controller.targetPsi(), 20.0f);
+}
+
+TEST_F(ControllerTest, ManualLease_StopFromOtherRemoteKeepsManual) {
+    controller.update(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 1500), 0);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 0), 1);
+    EXPECT_EQ(controller.state(), State::AIRUP);
+    EXPECT_TRUE(outputs.compressorOn);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 0), 0);
+    EXPECT_FALSE(outputs.compressorOn);
+}
+
+TEST_F(ControllerTest, ManualLease_StopLeavesLocalManual) {
+    controller.update(0, 10.0f);
+    controller.manualVent(true);                                   // the board's own button
+    controller.apply(leased(ta::protocol::ManualCode::Vent, 0), 0);
+    EXPECT_TRUE(outputs.ventOpen);
+}
+
+// ============================================================================
+// Relay Guard Tests - outputs behind minimum on/off times, as on the board
+// ============================================================================
+class GuardedOutputs : public IOutputs {
+public:
+    uint32_t now = 0;
+    ta::act::GuardedPair pair;
+
+    explicit GuardedOutputs(uint32_t minOnMs) {
+        ta::act::RelayConfig rc;
+        rc.minOnMs = minOnMs;
+        rc.minOffMs = 100;
+        pair.begin(rc, rc);
+    }
+    void setCompressor(bool on) override { pair.setCompressor(on); pair.service(now); }
+    void setVent(bool open) override { pair.setVent(open); pair.service(now); }
+    void stopAll() override { pair.stopAll(); pair.service(now); }
+    void emergencyStop() override { pair.emergencyStop(now); }
+    bool compressorRunning() const override { return pair.compressor().isOn(); }
+};
+
+class ControllerGuardTest : public ControllerTest {
+protected:
+    GuardedOutputs guarded{2000};
+
+    void SetUp() override {
+        ControllerTest::SetUp();
+        controller.begin(&guarded, cfg);
+    }
+    void step(uint32_t t, float psi) {
+        guarded.now = t;
+        guarded.pair.service(t);
+        controller.update(t, psi);
+    }
+};
+
+TEST_F(ControllerGuardTest, Cancel_CutsRelayInsideMinOn) {
+    step(0, 10.0f);
+    controller.startSeek(20.0f);
+    step(100, 10.1f);
+    ASSERT_TRUE(guarded.compressorRunning());
+    controller.cancel();
+    EXPECT_FALSE(guarded.compressorRunning());
+    EXPECT_EQ(guarded.pair.compressor().forced(), 1u);
+}
+
+TEST_F(ControllerGuardTest, LeaseExpiry_CutsRelayInsideMinOn) {
+    step(0, 10.0f);
+    controller.apply(leased(ta::protocol::ManualCode::Air, 300));
+    step(310, 10.2f);
+    EXPECT_EQ(controller.state(), State::IDLE);
+    EXPECT_FALSE(guarded.compressorRunning());
+}
+
+TEST_F(ControllerGuardTest, SeekStop_HeldByGuard_DutyCountsTheHeldRun) {
+    step(0, 10.0f);
+    controller.startSeek(10.6f);
+    step(200, 10.6f);                              // at target: a normal, guarded stop
+    EXPECT_EQ(controller.state(), State::CHECKING);
+    EXPECT_TRUE(guarded.compressorRunning());      // still inside minOnMs
+    float heat = controller.duty().heatFraction();
+    step(1000, 10.6f);
+    EXPECT_GT(controller.duty().heatFraction(), heat);
+    step(2100, 10.6f);
+    EXPECT_FALSE(guarded.compressorRunning());
+}
+
 // Note: Manual refresh test removed - relies on millis() which is stubbed to 0 in tests
 // Manual watchdog is tested implicitly through timeout test above
 
@@ -388,6 +536,291 @@ TEST_F(ControllerTest, RateLearning_ImprovesBurstTiming) {
     EXPECT_NE(controller.state(), State::ERROR);
 }
 
+TEST_F(ControllerTest, RelayCycleCost_FinishesInOneLongerBurst) {
+    // Learn ~0.9 psi/s from two 500 ms bursts, then leave 1.5 psi: ~1430 ms of running,
+    // more than runMaxMs (1000)
+    auto learn = [&](Controller& c, uint32_t& time) {
+        c.update(time, 10.0f);
+        c.startSeek(12.5f);
+        time += 550; c.update(time, 10.5f);
+        time += 150; c.update(time, 10.5f);
+        time += 550; c.update(time, 11.0f);
+        time += 150; c.update(time, 11.0f);
+        ASSERT_EQ(c.state(), State::AIRUP);
+    };
+
+    uint32_t time = 0;
+    learn(controller, time);
+    time += 1010;
+    controller.update(time, 11.0f);
+    EXPECT_EQ(controller.state(), State::CHECKING); // split: a tail burst follows
+
+    Config wear = cfg;
+    wear.relayCycleCostMs = 500;
+    Controller merged;
+    merged.begin(&outputs, wear);
+    time = 0;
+    learn(merged, time);
+    time += 1010;
+    merged.update(time, 11.0f);
+    EXPECT_EQ(merged.state(), State::AIRUP);        // tail merged into this burst
+    time += 450;
+    merged.update(time, 11.0f);
+    EXPECT_EQ(merged.state(), State::CHECKING);
+}
+
+// ============================================================================
+// Retarget Tests
+// ============================================================================
+// Seek 10 -> 20 psi on a plant, change the target to 25 after changeAtMs (by a Start
+// the board receives, or by cancel + start), and count the settles from there on
+struct RetargetRun {
+    uint32_t settles = 0;
+    uint32_t ms = 0;
+    float finalPsi = 0;
+};
+
+static RetargetRun seekWithChange(const Config& cfg, bool cancelFirst, uint32_t changeAtMs) {
+    ta::sim::PlantConfig pc;
+    pc.fillPsiPerSec = 1.0f;
+    pc.heatCPerSec = 0.0f;
+    ta::sim::PlantSim plant(pc);
+    Controller c;
+    c.begin(&plant, cfg);
+    uint32_t now = 0;
+    c.update(now, plant.psi());
+    c.startSeek(20.0f);
+    RetargetRun r;
+    bool changed = false;
+    State prev = c.state();
+    while (now < 120000) {
+        plant.step(10);
+        now += 10;
+        c.update(now, plant.psi());
+        if (!changed && now >= changeAtMs) {
+            changed = true;
+            ta::protocol::Request start;
+            start.kind = ta::protocol::Request::Kind::Start;
+            start.targetPsi = 25.0f;
+            if (cancelFirst) c.cancel();
+            c.apply(start);
+            r.ms = now;
+        }
+        if (changed && c.state() == State::CHECKING && prev != State::CHECKING) r.settles++;
+        prev = c.state();
+        if (c.state() == State::ERROR || (changed && c.state() == State::IDLE)) break;
+    }
+    r.ms = now - r.ms;
+    r.finalPsi = plant.psi();
+    return r;
+}
+
+TEST_F(ControllerTest, Retarget_MidFill_KeepsLearnedRates) {
+    cfg.runMaxMs = 20000;
+    cfg.psiTol = 0.3f;
+    cfg.duty.enabled = false;
+    cfg.maxContinuousMs = 60000;
+    for (uint32_t at = 1000; at <= 6000; at += 1000) {
+        RetargetRun kept = seekWithChange(cfg, false, at);
+        RetargetRun restarted = seekWithChange(cfg, true, at);
+        EXPECT_NEAR(kept.finalPsi, 25.0f, cfg.psiTol);
+        EXPECT_NEAR(restarted.finalPsi, 25.0f, cfg.psiTol);
+        // Restarting relearns the rate with blind bursts, a settle each
+        EXPECT_LT(kept.settles, restarted.settles) << "changed at " << at << " ms";
+        EXPECT_LE(kept.ms, restarted.ms);
+    }
+}
+
+TEST_F(ControllerTest, Retarget_BelowPressureWhileFilling_EndsRunThenVents) {
+    controller.update(0, 10.0f);
+    controller.startSeek(20.0f);
+    controller.update(100, 15.0f);
+    controller.retarget(12.0f);
+    EXPECT_EQ(controller.state(), State::CHECKING);
+    EXPECT_FALSE(outputs.compressorOn);
+    controller.update(100 + cfg.settleMs + 10, 15.0f);
+    EXPECT_EQ(controller.state(), State::VENTING);
+}
+
+TEST_F(ControllerTest, Retarget_WhileSettling_PlansFromNewTarget) {
+    controller.update(0, 10.0f);
+    controller.startSeek(20.0f);
+    controller.update(cfg.burstMsInit + 10, 19.9f);   // within tolerance: settle
+    ASSERT_EQ(controller.state(), State::CHECKING);
+    controller.retarget(25.0f);
+    EXPECT_EQ(controller.state(), State::CHECKING);
+    controller.update(cfg.burstMsInit + cfg.settleMs + 20, 19.9f);
+    EXPECT_EQ(controller.state(), State::AIRUP);
+    EXPECT_FLOAT_EQ(controller.targetPsi(), 25.0f);
+}
+
+TEST_F(ControllerTest, Retarget_NotSeeking_StartsSeek) {
+    controller.update(0, 10.0f);
+    controller.retarget(20.0f);
+    EXPECT_EQ(controller.state(), State::AIRUP);
+    EXPECT_TRUE(outputs.compressorOn);
+}
+
+// ============================================================================
+// Rate Curve Tests
+// ============================================================================
+// Phases from `from` to `to` in steps of `step`, each with its exact mean rate on a
+// plant whose rate at p is rate(p)
+template <class F>
+static seek::RateCurve<float> fitCurve(bool rises, float from, float to, float step, F rate) {
+    seek::RateCurve<float> c;
+    c.reset(rises, 2.0f);
+    for (float p = from; (step > 0) ? p < to : p > to; p += step) {
+        float sec = 0;
+        for (int i = 0; i < 1000; ++i) sec += fabsf(step) / 1000 / rate(p + step * (i + 0.5f) / 1000);
+        c.add(p, p + step, fabsf(step) / sec);
+    }
+    return c;
+}
+
+TEST(RateCurve, PumpCurve_FitsFallingRate) {
+    auto pump = [](float p) { return 1.5f * (1.0f - p / 60.0f); };
+    seek::RateCurve<float> c = fitCurve(false, 10.0f, 30.0f, 2.0f, pump);
+    EXPECT_NEAR(c.slope(), -1.5f / 60.0f, 0.001f);
+    EXPECT_NEAR(c.at(45.0f), pump(45.0f), 0.02f);
+    float exact = 60.0f / 1.5f * logf((60.0f - 30.0f) / (60.0f - 45.0f));
+    EXPECT_NEAR(c.seconds(30.0f, 45.0f), exact, exact * 0.02f);
+    // The constant-rate learner: the mean rate of the fill so far
+    EXPECT_LT(30.0f / c.mean() * 15.0f / 30.0f, exact * 0.75f);
+}
+
+TEST(RateCurve, OrificeVent_FitsRisingRate) {
+    auto vent = [](float p) { return 0.4f * sqrtf(p); };
+    seek::RateCurve<float> c = fitCurve(true, 45.0f, 30.0f, -2.5f, vent);
+    EXPECT_GT(c.slope(), 0.0f);
+    float exact = 2.0f * (sqrtf(30.0f) - sqrtf(15.0f)) / 0.4f;
+    EXPECT_NEAR(c.seconds(30.0f, 15.0f), exact, exact * 0.05f);
+    EXPECT_GT(15.0f / c.mean(), 0.0f);
+    EXPECT_LT(15.0f / c.mean(), exact * 0.85f);              // constant rate: cut short
+}
+
+TEST(RateCurve, FlatUntilPhasesSpread) {
+    seek::RateCurve<float> c;
+    c.reset(false, 2.0f);
+    c.add(20.0f, 20.5f, 1.0f);
+    c.add(20.5f, 21.0f, 0.8f);
+    EXPECT_TRUE(c.flat());
+    EXPECT_FLOAT_EQ(c.mean(), 0.9f);
+    EXPECT_FLOAT_EQ(c.at(40.0f), 0.9f);
+    c.add(24.0f, 26.0f, 0.6f);
+    EXPECT_FALSE(c.flat());
+    EXPECT_LT(c.at(40.0f), c.at(20.0f));
+}
+
+TEST(RateCurve, WrongSignForDirection_StaysFlat) {
+    seek::RateCurve<float> c;
+    c.reset(false, 2.0f);                                   // a pump can't speed up with pressure
+    c.add(10.0f, 12.0f, 0.5f);
+    c.add(20.0f, 22.0f, 0.7f);
+    EXPECT_TRUE(c.flat());
+}
+
+TEST(RateCurve, Extrapolation_HeldNearMean) {
+    seek::RateCurve<float> c;
+    c.reset(false, 2.0f);
+    c.add(10.0f, 12.0f, 1.0f);
+    c.add(14.0f, 16.0f, 0.5f);
+    EXPECT_FLOAT_EQ(c.at(200.0f), c.mean() / 16);
+    EXPECT_FLOAT_EQ(c.at(-200.0f), c.mean() * 16);
+}
+
+// Seek on a plant whose pump stalls at 60 psi and whose vent flow is proportional to
+// gauge pressure, with the curve (or a constant rate: spread never reached)
+struct CurveSeek {
+    State end = State::IDLE;
+    uint32_t settles = 0;
+    uint32_t ms = 0;
+    float psi = 0;
+};
+
+static CurveSeek seekCurvedPlant(Config cfg, bool curve, float startPsi, float target) {
+    if (!curve) cfg.rateCurveMinSpreadPsi = 1e6f;
+    ta::sim::PlantConfig pc;
+    pc.startPsi = startPsi;
+    pc.fillPsiPerSec = 1.5f;
+    pc.stallPsi = 60.0f;
+    pc.ventPerSec = 0.08f;
+    pc.heatCPerSec = 0.0f;
+    ta::sim::PlantSim plant(pc);
+    Controller c;
+    c.begin(&plant, cfg);
+    uint32_t now = 0;
+    c.update(now, plant.psi());
+    c.startSeek(target);
+    CurveSeek r;
+    State prev = c.state();
+    while (now < 600000 && c.isSeeking()) {
+        plant.step(10);
+        now += 10;
+        c.update(now, ta::protocol::psiToU16_01(plant.psi()) / 100.0f);
+        if (c.state() == State::CHECKING && prev != State::CHECKING) r.settles++;
+        prev = c.state();
+    }
+    r.end = c.state();
+    r.ms = now;
+    r.psi = plant.psi();
+    return r;
+}
+
+class RateCurveSeekTest : public ControllerTest {
+protected:
+    void SetUp() override {
+        ControllerTest::SetUp();
+        cfg.psiTol = 0.2f;
+        cfg.settleMs = 500;
+        cfg.burstMsInit = 1500;
+        cfg.runMaxMs = 30000;
+        cfg.maxContinuousMs = 120000;
+        cfg.duty.enabled = false;
+    }
+};
+
+TEST_F(RateCurveSeekTest, Fill_FewerCorrectiveBursts) {
+    const float targets[] = { 30.0f, 40.0f, 48.0f };
+    for (float t : targets) {
+        CurveSeek fitted = seekCurvedPlant(cfg, true, 10.0f, t);
+        CurveSeek flat = seekCurvedPlant(cfg, false, 10.0f, t);
+        printf("[CURVE] fill 10 -> %.0f psi: %u settles / %u ms fitted, %u / %u constant\n",
+               t, fitted.settles, fitted.ms, flat.settles, flat.ms);
+        EXPECT_NEAR(fitted.psi, t, cfg.psiTol + 0.01f);
+        EXPECT_NEAR(flat.psi, t, cfg.psiTol + 0.01f);
+        EXPECT_LE(fitted.settles, flat.settles) << t;
+    }
+}
+
+TEST_F(RateCurveSeekTest, Vent_FewerCorrectiveBursts) {
+    const float targets[] = { 30.0f, 20.0f, 12.0f };
+    for (float t : targets) {
+        CurveSeek fitted = seekCurvedPlant(cfg, true, 50.0f, t);
+        CurveSeek flat = seekCurvedPlant(cfg, false, 50.0f, t);
+        printf("[CURVE] vent 50 -> %.0f psi: %u settles / %u ms fitted, %u / %u constant\n",
+               t, fitted.settles, fitted.ms, flat.settles, flat.ms);
+        EXPECT_NEAR(fitted.psi, t, cfg.psiTol + 0.01f);
+        EXPECT_NEAR(flat.psi, t, cfg.psiTol + 0.01f);
+        EXPECT_LE(fitted.settles, flat.settles) << t;
+    }
+}
+
+TEST_F(RateCurveSeekTest, ExcessiveTime_PredictedFromCurve) {
+    // 10 -> 57 psi takes nearly 2 min against this pump's back-pressure
+    cfg.maxPsi = 60.0f;
+    cfg.maxContinuousMs = 90000;
+    CurveSeek fitted = seekCurvedPlant(cfg, true, 10.0f, 57.0f);
+    CurveSeek flat = seekCurvedPlant(cfg, false, 10.0f, 57.0f);
+    printf("[CURVE] fill 10 -> 57 psi: %s after %u ms fitted, %s after %u ms constant\n",
+           fitted.end == State::ERROR ? "EXCESSIVE_TIME" : "done", fitted.ms,
+           flat.end == State::ERROR ? "EXCESSIVE_TIME" : "done", flat.ms);
+    EXPECT_EQ(fitted.end, State::ERROR);
+    EXPECT_LT(fitted.ms, cfg.maxContinuousMs / 2);          // called once the bursts spread
+    // The constant rate misjudges it and only gives up after the budget is long gone
+    EXPECT_GT(flat.ms, cfg.maxContinuousMs);
+}
+
 // ============================================================================
 // Main function
 // ============================================================================
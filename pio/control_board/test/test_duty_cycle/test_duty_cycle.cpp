@@ -0,0 +1,296 @@
+/**
+ * Unit tests for TA_DutyCycle
+ * Tests the compressor thermal budget, the controller's run-permit gate (shortened
+ * bursts, inserted rests, manual cut-off), and back-to-back fills in the native
+ * plant sim against a modelled motor temperature
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Controller.h>
+#include "../sim/PlantSim.h"
+
+using namespace ta::ctl;
+using ta::sim::PlantSim;
+using ta::sim::PlantConfig;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class DutyCycleTest : public ::testing::Test {
+protected:
+    DutyCycle duty;
+    DutyConfig cfg;
+
+    void SetUp() override {
+        cfg.budgetMs = 10000;
+        cfg.ratedDuty = 0.5f;      // one ms of rest cools one ms of running
+        cfg.resumeFraction = 0.5f;
+        cfg.ratedPsi = 100.0f;
+        cfg.loadGain = 0.0f;       // plain on-time unless a test sets it
+        cfg.stallFactor = 2.0f;
+        cfg.stallEpsPsi = 0.05f;
+        cfg.stallWindowMs = 1000;
+        duty.begin(cfg);
+    }
+
+    // Run (on) or rest for ms at psi, in 100 ms updates; psiPerSec rises while on
+    float run(uint32_t& now, bool on, uint32_t ms, float psi, float psiPerSec = 1.0f) {
+        for (uint32_t t = 0; t < ms; t += 100) {
+            duty.update(now, on, psi);
+            now += 100;
+            if (on) psi += psiPerSec * 0.1f;
+        }
+        duty.update(now, on, psi);
+        return psi;
+    }
+};
+
+class ControllerDutyTest : public ::testing::Test {
+protected:
+    PlantSim plant{fastPlant()};
+    Controller ctl;
+    Config cfg;
+    uint32_t now = 0;
+
+    static PlantConfig fastPlant() {
+        PlantConfig p;
+        p.startPsi = 10.0f;
+        p.fillPsiPerSec = 1.0f;
+        return p;
+    }
+
+    void SetUp() override {
+        cfg.psiTol = 0.2f;
+        cfg.settleMs = 100;
+        cfg.burstMsInit = 500;
+        cfg.runMinMs = 100;
+        cfg.runMaxMs = 1000;
+        cfg.duty.budgetMs = 3000;
+        cfg.duty.ratedDuty = 0.5f;
+        cfg.duty.loadGain = 0.0f;
+        cfg.duty.stallWindowMs = 100000; // no stall heating unless a test wants it
+        ctl.begin(&plant, cfg);
+    }
+
+    void advance(uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 10) {
+            plant.step(10);
+            now += 10;
+            ctl.update(now, plant.psi());
+        }
+    }
+};
+
+// ============================================================================
+// Thermal Budget Tests
+// ============================================================================
+TEST_F(DutyCycleTest, Cold_FullBudgetAvailable) {
+    EXPECT_FALSE(duty.mustRest());
+    EXPECT_EQ(duty.allowedRunMs(0.0f), 10000u);
+    EXPECT_FLOAT_EQ(duty.heatFraction(), 0.0f);
+}
+
+TEST_F(DutyCycleTest, OnTime_AccumulatesAcrossBursts) {
+    uint32_t now = 0;
+    run(now, true, 2000, 10.0f);
+    run(now, false, 500, 12.0f);
+    run(now, true, 2000, 12.0f);
+    EXPECT_EQ(duty.totalOnMs(), 4000u);
+    EXPECT_EQ(duty.starts(), 2u);
+    EXPECT_NEAR(duty.heatFraction(), 0.35f, 0.02f); // 4000 on - 500 rest at 1:1
+}
+
+TEST_F(DutyCycleTest, RatedDuty_HoldsSteady) {
+    uint32_t now = 0;
+    run(now, true, 3000, 10.0f);
+    float before = duty.heatFraction();
+    for (int i = 0; i < 5; ++i) {
+        run(now, true, 1000, 10.0f);
+        run(now, false, 1000, 10.0f);
+    }
+    EXPECT_NEAR(duty.heatFraction(), before, 0.02f);
+}
+
+TEST_F(DutyCycleTest, LoadGain_HeatsFasterAtPressure) {
+    cfg.loadGain = 1.0f;
+    duty.begin(cfg);
+    EXPECT_EQ(duty.allowedRunMs(100.0f), 5000u);
+    uint32_t now = 0;
+    run(now, true, 1000, 100.0f, 0.0f);
+    EXPECT_NEAR(duty.heatFraction(), 0.2f, 0.02f);
+}
+
+TEST_F(DutyCycleTest, Stall_HeatsFasterWhenPressureIsFlat) {
+    uint32_t now = 0;
+    run(now, true, 3000, 30.0f, 0.0f); // flat: stalled after the first window
+    EXPECT_TRUE(duty.stalled());
+    EXPECT_GT(duty.heatFraction(), 0.45f);
+
+    DutyCycle rising;
+    rising.begin(cfg);
+    uint32_t t = 0;
+    for (int i = 0; i <= 30; ++i) { rising.update(t, true, 30.0f + i * 0.1f); t += 100; }
+    EXPECT_FALSE(rising.stalled());
+    EXPECT_NEAR(rising.heatFraction(), 0.3f, 0.02f);
+}
+
+TEST_F(DutyCycleTest, Budget_ForcesRestWithHysteresis) {
+    uint32_t now = 0;
+    run(now, true, 10000, 10.0f);
+    EXPECT_TRUE(duty.mustRest());
+    EXPECT_EQ(duty.allowedRunMs(10.0f), 0u);
+    EXPECT_EQ(duty.forcedRests(), 1u);
+    uint32_t rest = duty.restMs();
+    EXPECT_NEAR((float)rest, 5000.0f, 200.0f);
+
+    run(now, false, rest / 2, 10.0f);
+    EXPECT_TRUE(duty.mustRest());   // below budget but not yet at resume
+    run(now, false, rest / 2 + 100, 10.0f);
+    EXPECT_FALSE(duty.mustRest());
+    EXPECT_GT(duty.allowedRunMs(10.0f), 4000u);
+}
+
+TEST_F(DutyCycleTest, Permit_CutOnceThenRestThenCarry) {
+    uint32_t now = 0;
+    run(now, true, 7000, 10.0f);
+    EXPECT_EQ(duty.permit(10.0f, 2000, 500, 4000), 2000u);
+    uint32_t got = duty.permit(10.0f, 5000, 500, 4000);
+    EXPECT_NEAR((float)got, 3000.0f, 150.0f);        // cut to the budget left
+    EXPECT_NEAR((float)duty.carryMs(), 2000.0f, 150.0f);
+    run(now, true, got, 10.0f);
+    run(now, false, 300, 10.0f);
+    EXPECT_EQ(duty.permit(10.0f, 5000, 100, 4000), 0u); // second cut before a rest: rest
+    run(now, false, duty.restMs(), 10.0f);
+    // Back at the resume level; a burst longer than the whole budget is cut again, not refused
+    EXPECT_GT(duty.permit(10.0f, 20000, 500, 4000), 4000u);
+}
+
+TEST_F(DutyCycleTest, Disabled_NeverLimits) {
+    cfg.enabled = false;
+    duty.begin(cfg);
+    uint32_t now = 0;
+    run(now, true, 30000, 10.0f);
+    EXPECT_FALSE(duty.mustRest());
+    EXPECT_EQ(duty.allowedRunMs(10.0f), UINT32_MAX);
+    EXPECT_EQ(duty.totalOnMs(), 30000u); // still counted
+}
+
+// ============================================================================
+// Controller Run-Permit Tests
+// ============================================================================
+TEST_F(ControllerDutyTest, Seek_InsertsRestInsteadOfErroring) {
+    ctl.update(now, plant.psi());
+    ctl.startSeek(20.0f); // ~10 s of running against a 3 s budget
+    bool rested = false;
+    for (int i = 0; i < 6000 && ctl.state() != State::IDLE && ctl.state() != State::ERROR; ++i) {
+        advance(10);
+        if (ctl.isResting()) {
+            rested = true;
+            EXPECT_EQ(ctl.state(), State::CHECKING);
+            EXPECT_FALSE(plant.compressorOn());
+        }
+    }
+    EXPECT_TRUE(rested);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    EXPECT_EQ(ctl.error(), ErrorCode::NONE);
+    EXPECT_NEAR(plant.psi(), 20.0f, 0.5f);
+}
+
+TEST_F(ControllerDutyTest, Burst_ClippedToRemainingBudget) {
+    cfg.burstMsInit = 5000;
+    cfg.runMaxMs = 5000;
+    ctl.begin(&plant, cfg);
+    ctl.update(now, plant.psi());
+    ctl.startSeek(40.0f);
+    ASSERT_EQ(ctl.state(), State::AIRUP);
+    advance(2900);
+    EXPECT_EQ(ctl.state(), State::AIRUP);
+    advance(300);
+    EXPECT_NE(ctl.state(), State::AIRUP); // ended at the 3 s budget, not the 5 s burst
+    EXPECT_LE(plant.compressorOnMs(), 3100u);
+}
+
+TEST_F(ControllerDutyTest, HotAtStart_RestsBeforeFirstBurst) {
+    ctl.update(now, plant.psi());
+    ctl.manualAirUp(true);
+    for (int i = 0; i < 40; ++i) { ctl.manualAirUp(true); advance(100); }
+    EXPECT_FALSE(plant.compressorOn()); // manual cut at the budget
+    EXPECT_EQ(ctl.state(), State::IDLE);
+
+    ctl.startSeek(45.0f);
+    EXPECT_TRUE(ctl.isResting());
+    EXPECT_EQ(ctl.state(), State::CHECKING);
+    EXPECT_FALSE(plant.compressorOn());
+}
+
+TEST_F(ControllerDutyTest, Manual_RefusedWhileResting) {
+    ctl.update(now, plant.psi());
+    for (int i = 0; i < 40; ++i) { ctl.manualAirUp(true); advance(100); }
+    ASSERT_TRUE(ctl.duty().mustRest());
+    ctl.manualAirUp(true);
+    EXPECT_FALSE(plant.compressorOn());
+    ctl.manualVent(true);
+    EXPECT_TRUE(plant.ventOpen()); // venting is never limited
+}
+
+TEST_F(ControllerDutyTest, Cancel_EndsRest) {
+    ctl.update(now, plant.psi());
+    for (int i = 0; i < 40; ++i) { ctl.manualAirUp(true); advance(100); }
+    ctl.startSeek(45.0f);
+    ASSERT_TRUE(ctl.isResting());
+    ctl.cancel();
+    EXPECT_FALSE(ctl.isResting());
+    EXPECT_EQ(ctl.state(), State::IDLE);
+}
+
+// ============================================================================
+// Plant Sim: back-to-back axles
+// ============================================================================
+static float fillAxles(Controller& ctl, PlantSim& plant, int tires, float from, float to, uint32_t& now, bool& allOk) {
+    allOk = true;
+    for (int i = 0; i < tires; ++i) {
+        plant.setPsi(from);
+        ta::sim::runSeek(ctl, plant, now, to);
+        allOk = allOk && ctl.state() == State::IDLE && fabsf(plant.psi() - to) < 0.5f;
+        ta::sim::runSeek(ctl, plant, now, to, 5000); // settle reading before moving the hose
+    }
+    return plant.peakC();
+}
+
+TEST(DutyCycleSim, BackToBackAxles_StayBelowTripAndFinish) {
+    PlantSim plant;
+    Controller ctl;
+    Config cfg;
+    ctl.begin(&plant, cfg);
+    uint32_t now = 0;
+    bool ok;
+    float peak = fillAxles(ctl, plant, 4, 10.0f, 40.0f, now, ok);
+    printf("[sim] managed: peak %.1f C, %u rests, %.0f min on / %.0f min total\n", peak,
+           (unsigned)ctl.duty().forcedRests(), plant.compressorOnMs() / 60000.0, now / 60000.0);
+    EXPECT_TRUE(ok);
+    EXPECT_FALSE(plant.tripped());
+    EXPECT_LT(peak, plant.config().tripC);
+    EXPECT_GT(ctl.duty().forcedRests(), 0u);
+    EXPECT_EQ(ctl.error(), ErrorCode::NONE);
+}
+
+TEST(DutyCycleSim, Unmanaged_SameJobTripsTheMotor) {
+    PlantSim plant;
+    Controller ctl;
+    Config cfg;
+    cfg.duty.enabled = false;
+    ctl.begin(&plant, cfg);
+    uint32_t now = 0;
+    bool ok;
+    float peak = fillAxles(ctl, plant, 4, 10.0f, 40.0f, now, ok);
+    printf("[sim] unmanaged: peak %.1f C, %.0f min total\n", peak, now / 60000.0);
+    EXPECT_TRUE(plant.tripped()); // the scenario is one the budget actually has to handle
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,3 @@
+// Include TA_Controller implementation for native tests (fixed-point build)
+#define TA_FIXED_POINT 1
+#include "../../../../pioLib/TA_Controller/src/TA_Controller.cpp"
@@ -0,0 +1,397 @@
+/**
+ * Unit tests for TA_Fixed
+ * Tests the Q16.16 type against float, the seek math (rate learning, run planning,
+ * the EXCESSIVE_TIME prediction), the duty-cycle budget and the hold monitor run in
+ * both types on the same inputs, and the controller built with TA_FIXED_POINT
+ * seeking a plant (also on a weak supply), then benchmarks the two seek-math kernels
+ */
+
+#define TA_FIXED_POINT 1
+
+#include <gtest/gtest.h>
+#include <TA_Fixed.h>
+#include <TA_SeekMath.h>
+#include <TA_DutyCycle.h>
+#include <TA_HoldMonitor.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "../sim/PlantSim.h"
+
+using ta::fx::Fixed;
+using namespace ta::ctl;
+
+static constexpr double kLsb = 1.0 / Fixed::kOne;
+
+static double d(Fixed v) { return (double)v.raw() * kLsb; }
+
+// ============================================================================
+// Fixed
+// ============================================================================
+TEST(Fixed, FloatRoundTrip_WithinHalfLsb) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> any(-30000.0f, 30000.0f);
+    for (int i = 0; i < 10000; ++i) {
+        float f = any(rng);
+        EXPECT_NEAR(d(Fixed::fromFloat(f)), f, kLsb / 2 + fabs(f) * 1e-7) << f;
+    }
+    EXPECT_EQ(Fixed::fromFloat(1.5f).raw(), 3 * Fixed::kOne / 2);
+    EXPECT_FLOAT_EQ(Fixed::fromInt(-7).toFloat(), -7.0f);
+}
+
+TEST(Fixed, Arithmetic_WithinOneLsbOfExact) {
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> psi(-200.0, 200.0);
+    std::uniform_real_distribution<double> rate(0.01, 20.0);
+    for (int i = 0; i < 10000; ++i) {
+        Fixed a = Fixed::fromFloat((float)psi(rng));
+        Fixed b = Fixed::fromFloat((float)rate(rng));
+        EXPECT_NEAR(d(a + b), d(a) + d(b), kLsb / 2);
+        EXPECT_NEAR(d(a - b), d(a) - d(b), kLsb / 2);
+        EXPECT_NEAR(d(a * b), d(a) * d(b), kLsb);
+        EXPECT_NEAR(d(a / b), d(a) / d(b), kLsb);
+        EXPECT_NEAR(d(a * 7), d(a) * 7, kLsb / 2);
+        EXPECT_NEAR(d(b / 3), d(b) / 3, kLsb);
+    }
+}
+
+TEST(Fixed, OutOfRange_Saturates) {
+    Fixed big = Fixed::fromInt(30000);
+    EXPECT_EQ((big + big).raw(), INT32_MAX);
+    EXPECT_EQ((-big - big).raw(), INT32_MIN);
+    EXPECT_EQ((big * big).raw(), INT32_MAX);
+    EXPECT_EQ((Fixed::fromInt(1) / Fixed()).raw(), INT32_MAX);       // a zero rate
+    EXPECT_EQ((Fixed::fromInt(-1) / Fixed()).raw(), INT32_MIN);
+    EXPECT_EQ(Fixed::fromFloat(1e9f).raw(), INT32_MAX);
+    EXPECT_EQ(ta::fx::msToSecFixed(0xFFFFFFFFu).raw(), INT32_MAX);
+}
+
+TEST(Fixed, Rounding_MatchesLroundf) {
+    const float vals[] = { 0.0f, 0.49f, 0.5f, 1.5f, 2.5f, -0.5f, -1.5f, -2.49f, 99.999f };
+    for (float v : vals) {
+        EXPECT_EQ(Fixed::fromFloat(v).roundToInt(), lroundf(v)) << v;
+    }
+    EXPECT_EQ(Fixed::ratio(1, 3).raw(), 21845);
+    EXPECT_EQ(Fixed::ratio(2, 3).raw(), 43691);
+    EXPECT_EQ(Fixed::ratio(-2, 3).raw(), -43691);
+}
+
+TEST(Fixed, Conversions_MatchFloatBuild) {
+    for (int32_t c = 0; c <= 20000; ++c) {
+        ASSERT_NEAR(d(ta::fx::centiToReal(c)), c / 100.0, kLsb / 2);
+    }
+    for (uint32_t ms = 0; ms <= 600000; ms += 7) {
+        ASSERT_NEAR(d(ta::fx::msToSec(ms)), ms / 1000.0, kLsb / 2);
+    }
+    EXPECT_EQ(ta::fx::secToMs(Fixed::fromFloat(2.5f)), 2500u);
+    EXPECT_EQ(ta::fx::secToMs(Fixed::fromFloat(-1.0f)), 0u);
+    EXPECT_EQ(ta::fx::secToMs(2.5f), 2500u);
+}
+
+// ============================================================================
+// Seek math - the same call in float and Fixed
+// ============================================================================
+TEST(SeekMath, LearnedRate_WithinTolerance) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dpsi(0.1f, 20.0f);
+    std::uniform_int_distribution<uint32_t> dtMs(300, 60000);
+    std::uniform_real_distribution<float> factor(0.6f, 1.3f);
+    for (int run = 0; run < 500; ++run) {
+        float mf = 0;
+        Fixed mx;
+        for (int n = 0; n < 12; ++n) {
+            float dp = roundf(dpsi(rng) * 100.0f) / 100.0f;    // sensor resolution
+            uint32_t ms = dtMs(rng);
+            float f = factor(rng);
+            mf = seek::learn(mf, n, seek::rateSample(dp, ms / 1000.0f) / f);
+            mx = seek::learn(mx, n, seek::rateSample(Fixed::ratio((int32_t)lroundf(dp * 100.0f), 100),
+                                                     ta::fx::msToSecFixed(ms)) / Fixed::fromFloat(f));
+        }
+        ASSERT_NEAR(d(mx), mf, 4 * kLsb + mf * 1e-4) << "run " << run;
+    }
+}
+
+TEST(SeekMath, PlannedRun_WithinTolerance) {
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> remaining(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> rate(0.05f, 20.0f);
+    const float margin = 0.2f;
+    for (int i = 0; i < 20000; ++i) {
+        float rem = roundf(remaining(rng) * 100.0f) / 100.0f;
+        float r = rate(rng);
+        unsigned long aimF = seek::aimMs(rem, margin, r);
+        unsigned long aimX = seek::aimMs(Fixed::fromFloat(rem), Fixed::fromFloat(margin), Fixed::fromFloat(r));
+        ASSERT_NEAR((double)aimX, (double)aimF, 1.0 + aimF * 1e-3) << rem << " @ " << r;
+        unsigned long fullF = seek::fullMs(rem, r);
+        unsigned long fullX = seek::fullMs(Fixed::fromFloat(rem), Fixed::fromFloat(r));
+        ASSERT_NEAR((double)fullX, (double)fullF, 1.0 + fullF * 1e-3) << rem << " @ " << r;
+    }
+}
+
+TEST(SeekMath, RateCurve_WithinTolerance) {
+    seek::RateCurve<float> cf;
+    seek::RateCurve<Fixed> cx;
+    cf.reset(false, 2.0f);
+    cx.reset(false, Fixed::fromInt(2));
+    for (int i = 0; i < 10; ++i) {
+        float p0 = 10.0f + 3.0f * i, p1 = p0 + 2.5f;
+        float r = 1.5f * (1.0f - (p0 + p1) / 120.0f);
+        cf.add(p0, p1, r);
+        cx.add(Fixed::fromFloat(p0), Fixed::fromFloat(p1), Fixed::fromFloat(r));
+    }
+    ASSERT_FALSE(cx.flat());
+    EXPECT_NEAR(d(cx.slope()), cf.slope(), 1e-3 * fabs(cf.slope()));
+    for (float from = 10.0f; from < 50.0f; from += 5.0f) {
+        unsigned long msF = seek::aimMs(cf, from, 55.0f, 0.2f, 0.9f);
+        unsigned long msX = seek::aimMs(cx, Fixed::fromFloat(from), Fixed::fromInt(55),
+                                        Fixed::fromFloat(0.2f), Fixed::fromFloat(0.9f));
+        EXPECT_NEAR((double)msX, (double)msF, 1.0 + msF * 1e-3) << from;
+    }
+}
+
+TEST(SeekMath, InsideMargin_NoRun) {
+    EXPECT_EQ(seek::aimMs(Fixed::fromFloat(0.1f), Fixed::fromFloat(0.2f), Fixed::fromInt(1)), 0u);
+    EXPECT_EQ(seek::aimMs(0.1f, 0.2f, 1.0f), 0u);
+}
+
+TEST(SeekMath, NoLearnedRate_PinsRatherThanWraps) {
+    // A zero rate must read as "forever", which the controller caps, not as a short run
+    EXPECT_GT(seek::fullMs(Fixed::fromInt(10), Fixed()), 30000000ul);
+}
+
+// ============================================================================
+// Duty cycle and hold monitor - the same trace in float and Fixed
+// ============================================================================
+TEST(DutyHold, FixedBuild_UsesTheFixedInstantiations) {
+    EXPECT_TRUE((std::is_same<DutyCycle, BasicDutyCycle<Fixed>>::value));
+    EXPECT_TRUE((std::is_same<HoldMonitor, BasicHoldMonitor<Fixed>>::value));
+}
+
+TEST(DutyHold, DutyBudget_WithinTolerance) {
+    DutyConfig cfg;
+    cfg.budgetMs = 60000;
+    BasicDutyCycle<float> df;
+    BasicDutyCycle<Fixed> dx;
+    df.begin(cfg);
+    dx.begin(cfg);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> runMs(2000, 20000);
+    std::vector<uint32_t> restAtF, restAtX;     // when each build forced a rest
+    uint32_t now = 0;
+    int32_t centi = 1500;
+    for (int burst = 0; burst < 40; ++burst) {
+        // A fill that rises, then stalls against a full tire, cut short by a forced
+        // rest (the float build's call drives both), then the pause before the next
+        uint32_t run = runMs(rng), stallAfter = run / 2;
+        for (uint32_t t = 0; t <= run && !df.mustRest(); t += 10, now += 10) {
+            if (t < stallAfter) centi += 1;
+            df.update(now, true, centi / 100.0f);
+            dx.update(now, true, ta::fx::centiToReal(centi));
+            ASSERT_EQ(dx.stalled(), df.stalled()) << now;
+            if (dx.forcedRests() > restAtX.size()) restAtX.push_back(now);
+            if (df.forcedRests() > restAtF.size()) restAtF.push_back(now);
+        }
+        float psi = centi / 100.0f;
+        Fixed psiX = ta::fx::centiToReal(centi);
+        EXPECT_NEAR(dx.heatFraction(), df.heatFraction(), 1e-3f) << now;
+        EXPECT_NEAR((double)dx.allowedRunMs(psiX), (double)df.allowedRunMs(psi),
+                    2.0 + df.allowedRunMs(psi) * 1e-3) << now;
+        EXPECT_NEAR((double)dx.restMs(), (double)df.restMs(), 2.0 + df.restMs() * 1e-3) << now;
+        uint32_t rest = std::max(run / 2, df.restMs());
+        for (uint32_t t = 0; t <= rest; t += 10, now += 10) {
+            df.update(now, false, psi);
+            dx.update(now, false, psiX);
+        }
+        centi = 1500 + (centi - 1500) / 2;
+    }
+    ASSERT_GT(restAtF.size(), 1u);
+    ASSERT_EQ(restAtX.size(), restAtF.size());
+    for (size_t i = 0; i < restAtF.size(); ++i) {
+        EXPECT_NEAR((double)restAtX[i], (double)restAtF[i], 20.0) << i;
+    }
+}
+
+TEST(DutyHold, HoldVerdicts_WithinTolerance) {
+    HoldConfig cfg;
+    cfg.windowMs = 60000;
+    const float rates[] = { 0.0f, 0.3f, 0.8f, 1.2f, 3.0f, -0.5f };    // psi/min lost
+    for (float r : rates) {
+        BasicHoldMonitor<float> hf;
+        BasicHoldMonitor<Fixed> hx;
+        hf.begin(cfg);
+        hx.begin(cfg);
+        hf.start(0, 32.0f);
+        hx.start(0, Fixed::fromInt(32));
+        BasicHoldMonitor<float>::Verdict vf = BasicHoldMonitor<float>::Verdict::NONE;
+        BasicHoldMonitor<Fixed>::Verdict vx = BasicHoldMonitor<Fixed>::Verdict::NONE;
+        for (uint32_t now = 0; now <= cfg.windowMs && hf.active(); now += 10) {
+            int32_t centi = (int32_t)lroundf(3200.0f - r * now / 600.0f);   // sensor resolution
+            vf = hf.update(now, centi / 100.0f);
+            vx = hx.update(now, ta::fx::centiToReal(centi));
+            ASSERT_EQ((int)vx, (int)vf) << r << " psi/min at " << now;
+        }
+        EXPECT_NE((int)vf, (int)BasicHoldMonitor<float>::Verdict::NONE) << r;
+        EXPECT_NEAR(hx.leakPsiPerMin(), hf.leakPsiPerMin(), 0.01f + hf.leakPsiPerMin() * 1e-2f) << r;
+        EXPECT_NEAR(hf.leakPsiPerMin(), r > 0 ? r : 0.0f, 0.05f) << r;
+    }
+}
+
+// ============================================================================
+// Controller in the fixed-point build
+// ============================================================================
+struct SeekResult {
+    State end = State::IDLE;
+    float psi = 0;
+    uint32_t ms = 0;
+};
+
+// withSupply: the plant's volts and amps handed over in centi units, as the board does
+static SeekResult seekOnPlant(const Config& cfg, const ta::sim::PlantConfig& pc, float target,
+                              bool withSupply = false) {
+    ta::sim::PlantSim plant(pc);
+    Controller c;
+    c.begin(&plant, cfg);
+    uint32_t now = 0;
+    c.updateCentiPsi(now, ta::protocol::psiToU16_01(plant.psi()));
+    c.startSeek(target);
+    while (now < 600000 && c.isSeeking()) {
+        plant.step(10);
+        now += 10;
+        if (withSupply) c.setSupplyCenti((uint16_t)lroundf(plant.volts() * 100.0f), (int16_t)lroundf(plant.amps() * 100.0f));
+        c.updateCentiPsi(now, ta::protocol::psiToU16_01(plant.psi()));
+    }
+    return { c.state(), plant.psi(), now };
+}
+
+TEST(FixedController, SeeksReachTarget) {
+    Config cfg;
+    cfg.psiTol = 0.3f;
+    cfg.runMaxMs = 20000;
+    cfg.maxContinuousMs = 120000;
+    cfg.duty.enabled = false;
+    const float fills[] = { 0.5f, 1.0f, 3.0f };
+    const float targets[] = { 5.0f, 18.0f, 25.0f, 40.0f };
+    for (float fill : fills) {
+        ta::sim::PlantConfig pc;
+        pc.fillPsiPerSec = fill;
+        pc.ventPerSec = 0.1f;
+        pc.heatCPerSec = 0.0f;
+        for (float t : targets) {
+            SeekResult r = seekOnPlant(cfg, pc, t);
+            EXPECT_NE(r.end, State::ERROR) << fill << " psi/s to " << t;
+            EXPECT_NEAR(r.psi, t, cfg.psiTol + 0.005f) << fill << " psi/s to " << t;
+        }
+    }
+}
+
+TEST(FixedController, WeakSupply_ReachesTargetWithoutError) {
+    Config cfg;
+    cfg.psiTol = 0.3f;
+    cfg.runMaxMs = 20000;
+    cfg.maxContinuousMs = 120000;
+    cfg.duty.enabled = false;
+    ta::sim::PlantConfig pc;
+    pc.fillPsiPerSec = 1.0f;
+    pc.ventPerSec = 0.1f;
+    pc.heatCPerSec = 0.0f;
+    pc.supplyVolts = 11.0f;   // engine off, tired battery
+    for (float t : { 18.0f, 35.0f }) {
+        SeekResult r = seekOnPlant(cfg, pc, t, true);
+        EXPECT_NE(r.end, State::ERROR) << t;
+        EXPECT_NEAR(r.psi, t, cfg.psiTol + 0.005f) << t;
+    }
+}
+
+TEST(FixedController, PowerFactor_FromCentiVolts) {
+    ta::sim::PlantSim plant;
+    Controller c;
+    c.begin(&plant, Config());
+    EXPECT_FLOAT_EQ(c.powerFactor(), 1.0f);
+    c.setSupplyCenti(1080);
+    EXPECT_NEAR(c.powerFactor(), 0.8f, 2 * kLsb);
+    c.setSupplyCenti(100);
+    EXPECT_NEAR(c.powerFactor(), 0.3f, 2 * kLsb);
+    c.setSupply(12.345f, 3.0f);   // float entry: rounded to 0.01 V
+    EXPECT_NEAR(c.powerFactor(), 1235 / 1350.0f, 2 * kLsb);
+}
+
+TEST(FixedController, FloatEntryPoint_QuantisedLikeSensor) {
+    ta::sim::PlantSim plant;
+    Controller a, b;
+    a.begin(&plant, Config());
+    b.begin(&plant, Config());
+    a.update(0, 23.456f);
+    b.updateCentiPsi(0, 2346);
+    EXPECT_FLOAT_EQ(a.currentPsi(), b.currentPsi());
+    EXPECT_NEAR(a.currentPsi(), 23.46f, 1e-4f);
+}
+
+// ============================================================================
+// Benchmark - host figures only: the host has an FPU, so float is not paying the
+// soft-float calls it costs on the ESP32-C3, and the gap there is wider
+// ============================================================================
+static double kernelNsFixed(Fixed& sink) {
+    const int kRuns = 200000;
+    Fixed mean;
+    unsigned long acc = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRuns; ++i) {
+        Fixed dPsi = ta::fx::centiToReal(100 + (i & 1023));
+        Fixed dt = ta::fx::msToSec(800 + (uint32_t)(i & 4095));
+        Fixed f = ta::fx::centiToReal(80 + (i & 31));
+        mean = seek::learn(mean, i & 7, seek::rateSample(dPsi, dt) / f);
+        Fixed rem = ta::fx::centiToReal(2500 - (i & 2047));
+        acc += seek::aimMs(rem, ta::fx::centiToReal(20), mean) + seek::fullMs(rem, mean);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    sink = mean;
+    if (acc == 1) sink = Fixed();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / kRuns;
+}
+
+// centiToReal and msToSec are the fixed-point ones here; these are the float build's
+namespace floatbuild {
+inline float centiToReal(int32_t c) { return c / 100.0f; }
+inline float msToSec(uint32_t ms) { return ms / 1000.0f; }
+}
+
+static double kernelNsFloat(float& sink) {
+    const int kRuns = 200000;
+    float mean = 0;
+    unsigned long acc = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRuns; ++i) {
+        float dPsi = floatbuild::centiToReal(100 + (i & 1023));
+        float dt = floatbuild::msToSec(800 + (uint32_t)(i & 4095));
+        float f = floatbuild::centiToReal(80 + (i & 31));
+        mean = seek::learn(mean, i & 7, seek::rateSample(dPsi, dt) / f);
+        float rem = floatbuild::centiToReal(2500 - (i & 2047));
+        acc += seek::aimMs(rem, floatbuild::centiToReal(20), mean) + seek::fullMs(rem, mean);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    sink = mean;
+    if (acc == 1) sink = 0;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / kRuns;
+}
+
+TEST(FixedBench, SeekKernel_FloatVsFixed) {
+    float sf = 0;
+    Fixed sx;
+    double nsF = kernelNsFloat(sf);
+    double nsX = kernelNsFixed(sx);
+    std::printf("[BENCH] seek kernel (sample, learn, plan, predict): float %.1f ns, Q16.16 %.1f ns (host)\n",
+                nsF, nsX);
+    EXPECT_NEAR(d(sx), sf, 4 * kLsb + sf * 1e-4);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
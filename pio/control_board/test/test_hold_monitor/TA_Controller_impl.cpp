@@ -0,0 +1,2 @@
+// Include TA_Controller implementation for native tests
+#include "../../../../pioLib/TA_Controller/src/TA_Controller.cpp"
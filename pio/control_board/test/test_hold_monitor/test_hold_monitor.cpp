@@ -0,0 +1,268 @@
+/**
+ * Unit tests for TA_HoldMonitor
+ * Tests the post-seek leak-down check: the running least-squares fit on synthetic
+ * pressure traces (steady, noisy, cooling, leaking), and the controller's hold phase
+ * against a leaking plant, including the LEAK error and its rate detail
+ */
+
+#include <gtest/gtest.h>
+#include <TA_HoldMonitor.h>
+#include <TA_Controller.h>
+#include "../sim/PlantSim.h"
+
+using namespace ta::ctl;
+using ta::sim::PlantSim;
+using ta::sim::PlantConfig;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class HoldMonitorTest : public ::testing::Test {
+protected:
+    HoldMonitor mon;
+    HoldConfig cfg;
+
+    void SetUp() override {
+        cfg.windowMs = 60000;
+        cfg.minMs = 10000;
+        cfg.sampleMs = 250;
+        cfg.leakPsiPerMin = 1.0f;
+        cfg.minDropPsi = 0.2f;
+        mon.begin(cfg);
+    }
+
+    // Feed psi(t) every 50 ms until a verdict; returns it and the time it came at
+    template <typename F>
+    HoldMonitor::Verdict run(F psiAt, uint32_t& at) {
+        mon.start(0, psiAt(0));
+        for (uint32_t t = 50; t <= 120000; t += 50) {
+            HoldMonitor::Verdict v = mon.update(t, psiAt(t));
+            if (v != HoldMonitor::Verdict::NONE) { at = t; return v; }
+        }
+        at = 0;
+        return HoldMonitor::Verdict::NONE;
+    }
+};
+
+// Controller seeking a plant, then left alone while it holds
+class HoldControllerTest : public ::testing::Test {
+protected:
+    Controller ctl;
+    Config cfg;
+    uint32_t now = 0;
+
+    void SetUp() override {
+        cfg.duty.enabled = false;
+        cfg.hold.windowMs = 60000;
+    }
+
+    // A small tire: fills fast enough that a leak doesn't hold the seek up
+    static PlantConfig plantConfig(float leakPsiPerMin = 0.0f) {
+        PlantConfig p;
+        p.fillPsiPerSec = 0.5f;
+        p.leakPsiPerMin = leakPsiPerMin;
+        return p;
+    }
+
+    void seek(PlantSim& plant, float target) {
+        ctl.begin(&plant, cfg);
+        ta::sim::runSeek(ctl, plant, now, target);
+    }
+
+    // Advance with the outputs untouched for ms
+    void idle(PlantSim& plant, uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 50) {
+            plant.step(50);
+            now += 50;
+            ctl.update(now, plant.psi());
+        }
+    }
+};
+
+// ============================================================================
+// Fit Tests
+// ============================================================================
+TEST_F(HoldMonitorTest, Off_WhenWindowZero) {
+    cfg.windowMs = 0;
+    mon.begin(cfg);
+    mon.start(0, 35.0f);
+    EXPECT_FALSE(mon.active());
+    EXPECT_EQ(mon.update(1000, 30.0f), HoldMonitor::Verdict::NONE);
+}
+
+TEST_F(HoldMonitorTest, Steady_HoldsAtWindowEnd) {
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t) { return 35.0f; }, at), HoldMonitor::Verdict::HOLDING);
+    EXPECT_EQ(at, 60000u);
+    EXPECT_FLOAT_EQ(mon.leakPsiPerMin(), 0.0f);
+    EXPECT_FALSE(mon.active());
+    EXPECT_EQ(mon.samples(), 241); // one per sampleMs, both ends included
+}
+
+TEST_F(HoldMonitorTest, FastLeak_CalledEarly) {
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t t) { return 35.0f - 3.0f * t / 60000.0f; }, at), HoldMonitor::Verdict::LEAK);
+    EXPECT_EQ(at, cfg.minMs); // 0.5 psi gone by then, past minDropPsi
+    EXPECT_NEAR(mon.leakPsiPerMin(), 3.0f, 0.01f);
+}
+
+TEST_F(HoldMonitorTest, SlowLeak_WaitsForEnoughDrop) {
+    // 1.2 psi/min: over the threshold from the start, but 0.2 psi takes 10 s to lose
+    cfg.minDropPsi = 0.5f;
+    mon.begin(cfg);
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t t) { return 35.0f - 1.2f * t / 60000.0f; }, at), HoldMonitor::Verdict::LEAK);
+    EXPECT_NEAR(at, 25000u, 300u);
+    EXPECT_NEAR(mon.leakPsiPerMin(), 1.2f, 0.01f);
+}
+
+TEST_F(HoldMonitorTest, Noise_NotALeak) {
+    // +-0.15 psi ADC noise on a steady tire
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t t) { return 35.0f + ((t / 250) % 2 ? 0.15f : -0.15f); }, at),
+              HoldMonitor::Verdict::HOLDING);
+    EXPECT_LT(mon.leakPsiPerMin(), 0.1f);
+}
+
+TEST_F(HoldMonitorTest, Cooling_NotALeak) {
+    // Pumped air cooling: 0.4 psi lost, mostly in the first half minute
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t t) { return 35.0f + 0.4f * expf(-(float)t / 20000.0f); }, at),
+              HoldMonitor::Verdict::HOLDING);
+    EXPECT_LT(mon.leakPsiPerMin(), cfg.leakPsiPerMin);
+}
+
+TEST_F(HoldMonitorTest, Rising_RateZero) {
+    uint32_t at;
+    EXPECT_EQ(run([](uint32_t t) { return 35.0f + 2.0f * t / 60000.0f; }, at), HoldMonitor::Verdict::HOLDING);
+    EXPECT_FLOAT_EQ(mon.leakPsiPerMin(), 0.0f);
+}
+
+TEST_F(HoldMonitorTest, BetweenSamples_FitUntouched) {
+    mon.start(0, 35.0f);
+    uint32_t t = 0;
+    for (; t <= cfg.minMs + 1000; t += cfg.sampleMs) mon.update(t, 35.0f);
+    int n = mon.samples();
+    float rate = mon.leakPsiPerMin();
+    // Readings between samples (a glitch here) neither refit nor call a verdict
+    for (uint32_t dt = 10; dt < cfg.sampleMs; dt += 10) {
+        EXPECT_EQ(mon.update(t - cfg.sampleMs + dt, 20.0f), HoldMonitor::Verdict::NONE);
+    }
+    EXPECT_EQ(mon.samples(), n);
+    EXPECT_FLOAT_EQ(mon.leakPsiPerMin(), rate);
+    EXPECT_TRUE(mon.active());
+}
+
+TEST_F(HoldMonitorTest, Stop_EndsWithoutVerdict) {
+    mon.start(0, 35.0f);
+    mon.update(5000, 30.0f);
+    mon.stop();
+    EXPECT_EQ(mon.update(20000, 20.0f), HoldMonitor::Verdict::NONE);
+}
+
+// ============================================================================
+// Controller Tests
+// ============================================================================
+TEST_F(HoldControllerTest, Off_ByDefault) {
+    cfg.hold = HoldConfig();
+    PlantSim plant(plantConfig());
+    seek(plant, 30.0f);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    EXPECT_FALSE(ctl.isHolding());
+    idle(plant, 60000);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+}
+
+TEST_F(HoldControllerTest, LeakingTire_SeekStopsChasingTarget) {
+    // Each burst reaches the target and the settle leaks it back out: after a few
+    // rounds the seek ends near target instead of clicking the relay forever, and
+    // the hold check takes over
+    PlantSim plant(plantConfig(3.0f));
+    seek(plant, 30.0f);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    EXPECT_TRUE(ctl.isHolding());
+    EXPECT_NEAR(plant.psi(), 30.0f, 0.3f);
+    EXPECT_LT(plant.compressorStarts(), 25u);
+}
+
+TEST_F(HoldControllerTest, LeakingTire_HoldOff_LeakErrorNotIdle) {
+    // Without the hold check, the same cut-off must not leave the tire short of
+    // target looking done
+    cfg.hold = HoldConfig();
+    PlantSim plant(plantConfig(3.0f));
+    seek(plant, 30.0f);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::LEAK);
+    EXPECT_NEAR(ctl.errorDetail(), 30, 5);   // 0.1 psi/min over the last settle
+    EXPECT_FALSE(plant.compressorOn());
+    EXPECT_LT(plant.compressorStarts(), 25u);
+}
+
+TEST_F(HoldControllerTest, DefaultConfig_FastLeak_LeakErrorNotIdle) {
+    cfg = Config();
+    PlantSim plant(plantConfig(12.0f));
+    seek(plant, 30.0f);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::LEAK);
+    EXPECT_NEAR(ctl.errorDetail(), 120, 10);
+}
+
+TEST_F(HoldControllerTest, SoundTire_HoldsThenIdle) {
+    PlantSim plant(plantConfig());
+    seek(plant, 30.0f);
+    ASSERT_EQ(ctl.state(), State::IDLE);
+    EXPECT_TRUE(ctl.isHolding());
+    EXPECT_EQ(ctl.statusChar(), 'I');
+    idle(plant, 61000);
+    EXPECT_FALSE(ctl.isHolding());
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    EXPECT_EQ(ctl.error(), ErrorCode::NONE);
+}
+
+TEST_F(HoldControllerTest, LeakingTire_LeakErrorWithRate) {
+    PlantSim plant(plantConfig(2.0f));
+    seek(plant, 30.0f);
+    ASSERT_EQ(ctl.state(), State::IDLE);
+    uint32_t start = now;
+    while (ctl.state() == State::IDLE && now - start < 61000) idle(plant, 50);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::LEAK);
+    EXPECT_EQ(ctl.errorByte(), ta::errors::LEAK);
+    EXPECT_LE(now - start, cfg.hold.minMs + 100);
+    EXPECT_NEAR(ctl.leakPsiPerMin(), 2.0f, 0.05f);
+    EXPECT_EQ(ctl.errorDetail(), 20);
+    EXPECT_FALSE(plant.compressorOn()); // reported, not topped up
+
+    ctl.clearError();
+    EXPECT_EQ(ctl.errorDetail(), 0);
+}
+
+TEST_F(HoldControllerTest, Cancel_StopsHold) {
+    PlantSim plant(plantConfig(2.0f));
+    seek(plant, 30.0f);
+    ctl.cancel();
+    EXPECT_FALSE(ctl.isHolding());
+    idle(plant, 61000);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+}
+
+TEST_F(HoldControllerTest, SeekToCurrentPressure_IsALeakCheck) {
+    PlantConfig p = plantConfig(2.0f);
+    p.startPsi = 30.0f;
+    PlantSim plant(p);
+    ctl.begin(&plant, cfg);
+    ctl.update(now, plant.psi());
+    ctl.startSeek(30.0f);
+    EXPECT_TRUE(ctl.isHolding());
+    EXPECT_EQ(plant.compressorStarts(), 0u);
+    idle(plant, 20000);
+    EXPECT_EQ(ctl.error(), ErrorCode::LEAK);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
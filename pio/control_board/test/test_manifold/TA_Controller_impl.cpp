@@ -0,0 +1,3 @@
+// Include TA_Controller implementations for native tests
+#include "../../../../pioLib/TA_Controller/src/TA_Controller.cpp"
+#include "../../../../pioLib/TA_Controller/src/TA_Manifold.cpp"
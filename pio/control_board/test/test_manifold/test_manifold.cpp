@@ -0,0 +1,349 @@
+/**
+ * Unit tests for TA_Manifold
+ * Tests multi-tire seeks through a valve manifold: compressor time-sharing by
+ * deficit, parallel vents, per-tire failures, the shared duty-cycle permit, and
+ * total trailer time against one-tire-at-a-time seeks in the native plant sim
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Manifold.h>
+#include "../sim/ManifoldSim.h"
+
+using namespace ta::ctl;
+using ta::sim::ManifoldSim;
+using ta::sim::PlantConfig;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class ManifoldTest : public ::testing::Test {
+protected:
+    Config cfg;
+    uint32_t now = 0;
+
+    static PlantConfig fastPlant() {
+        PlantConfig p;
+        p.fillPsiPerSec = 1.0f;
+        p.ventPerSec = 0.05f;
+        return p;
+    }
+
+    void SetUp() override {
+        cfg.psiTol = 0.2f;
+        cfg.settleMs = 200;
+        cfg.burstMsInit = 1000;
+        cfg.runMinMs = 200;
+        cfg.runMaxMs = 2000;
+        cfg.duty.enabled = false;
+    }
+
+    void start(ManifoldScheduler& s, ManifoldSim& sim, float target, uint8_t mask = 0xFF) {
+        s.begin(&sim, cfg);
+        s.update(now, sim.psi());
+        s.startSeek(target, mask);
+    }
+
+    void advance(ManifoldScheduler& s, ManifoldSim& sim, uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 10) {
+            sim.step(10);
+            now += 10;
+            s.update(now, sim.psi());
+        }
+    }
+
+    static int openValves(const ManifoldSim& sim) {
+        int n = 0;
+        for (uint8_t i = 0; i < sim.tireCount(); ++i) n += sim.valveOpen(i) ? 1 : 0;
+        return n;
+    }
+};
+
+// ============================================================================
+// Basic Tests
+// ============================================================================
+TEST_F(ManifoldTest, Begin_EverythingClosed) {
+    float p[3] = {20, 25, 30};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    s.begin(&sim, cfg);
+    EXPECT_EQ(s.tireCount(), 3);
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_EQ(sim.valves(), 0);
+    EXPECT_FALSE(sim.compressorOn());
+}
+
+TEST_F(ManifoldTest, AtTarget_TiresStayIdle) {
+    float p[3] = {30.1f, 29.9f, 40.0f};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f, 0x03);
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_EQ(s.activeMask(), 0);
+    EXPECT_EQ(s.statusChar(), 'I');
+}
+
+TEST_F(ManifoldTest, Targets_ClampedPerTire) {
+    float p[2] = {20, 20};
+    float t[2] = {80, 1};
+    ManifoldSim sim(2, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    s.begin(&sim, cfg);
+    s.update(now, sim.psi());
+    s.startSeek(t, 0x03);
+    EXPECT_FLOAT_EQ(s.tire(0).target, cfg.maxPsi);
+    EXPECT_FLOAT_EQ(s.tire(1).target, cfg.minPsi);
+}
+
+// ============================================================================
+// Compressor Time-Sharing Tests
+// ============================================================================
+TEST_F(ManifoldTest, Fill_LargestDeficitFirst) {
+    float p[3] = {30, 20, 25};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 35.0f);
+    EXPECT_EQ(s.state(), State::AIRUP);
+    EXPECT_EQ(s.tire(1).state, TireState::AIRUP);
+    EXPECT_EQ(sim.valves(), 0x02);
+    EXPECT_TRUE(sim.compressorOn());
+}
+
+TEST_F(ManifoldTest, Fill_OneTireOnTheCompressorAtATime) {
+    float p[4] = {20, 22, 24, 26};
+    ManifoldSim sim(4, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    for (int i = 0; i < 4000 && s.state() != State::IDLE; ++i) {
+        advance(s, sim, 10);
+        if (sim.compressorOn()) { EXPECT_EQ(openValves(sim), 1); }
+    }
+    EXPECT_EQ(s.state(), State::IDLE);
+}
+
+TEST_F(ManifoldTest, Fill_NextTireFillsWhileFirstSettles) {
+    float p[2] = {20, 21};
+    ManifoldSim sim(2, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    ASSERT_EQ(s.tire(0).state, TireState::AIRUP);
+    advance(s, sim, cfg.burstMsInit + 10);
+    EXPECT_EQ(s.tire(0).state, TireState::SETTLING);
+    EXPECT_EQ(s.tire(1).state, TireState::AIRUP);
+    EXPECT_TRUE(sim.compressorOn());
+    EXPECT_EQ(sim.compressorStarts(), 1u); // handed over without stopping
+}
+
+TEST_F(ManifoldTest, Fill_AllTiresReachTarget) {
+    float p[4] = {18, 24, 27, 29};
+    float v[4] = {1.0f, 1.0f, 1.5f, 0.8f};
+    ManifoldSim sim(4, p, v, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 32.0f);
+    ta::sim::runManifold(s, sim, now, 10UL * 60UL * 1000UL, 10);
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_EQ(s.error(), ErrorCode::NONE);
+    for (uint8_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(sim.psi(i), 32.0f, 0.5f) << "tire " << (int)i;
+        EXPECT_GE(s.tire(i).upSamples, 1);
+    }
+    EXPECT_EQ(sim.valves(), 0);
+    EXPECT_FALSE(sim.compressorOn());
+}
+
+// ============================================================================
+// Vent Tests
+// ============================================================================
+TEST_F(ManifoldTest, Vent_BatchedInParallel) {
+    float p[3] = {40, 42, 38};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    EXPECT_EQ(s.state(), State::VENTING);
+    EXPECT_EQ(sim.valves(), 0x07);
+    EXPECT_TRUE(sim.ventOpen());
+    ta::sim::runManifold(s, sim, now, 10UL * 60UL * 1000UL, 10);
+    for (uint8_t i = 0; i < 3; ++i) EXPECT_NEAR(sim.psi(i), 30.0f, 0.5f);
+}
+
+TEST_F(ManifoldTest, Vent_GoesFirstAndFillWaitsForGallery) {
+    float p[2] = {20, 40};
+    ManifoldSim sim(2, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    EXPECT_EQ(s.tire(1).state, TireState::VENTING);
+    EXPECT_EQ(s.tire(0).state, TireState::READY);
+    EXPECT_FALSE(sim.compressorOn());
+    advance(s, sim, cfg.burstMsInit + 10);
+    EXPECT_EQ(s.tire(1).state, TireState::SETTLING);
+    EXPECT_EQ(s.tire(0).state, TireState::AIRUP);
+    EXPECT_FALSE(sim.ventOpen());
+}
+
+TEST_F(ManifoldTest, Vent_NeverSharesGalleryWithCompressor) {
+    float p[4] = {20, 40, 25, 36};
+    ManifoldSim sim(4, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    for (int i = 0; i < 6000 && s.state() != State::IDLE; ++i) {
+        advance(s, sim, 10);
+        EXPECT_FALSE(sim.compressorOn() && sim.ventOpen());
+        if (!sim.compressorOn() && !sim.ventOpen()) { EXPECT_EQ(sim.valves(), 0); }
+    }
+    EXPECT_EQ(s.state(), State::IDLE);
+}
+
+// ============================================================================
+// Failure / Cancel Tests
+// ============================================================================
+TEST_F(ManifoldTest, StuckTire_FailsAloneOthersFinish) {
+    float p[3] = {20, 22, 24};
+    float v[3] = {1.0f, 1e6f, 1.0f}; // tire 1: blocked line, pressure never moves
+    ManifoldSim sim(3, p, v, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    ta::sim::runManifold(s, sim, now, 10UL * 60UL * 1000UL, 10);
+    EXPECT_EQ(s.state(), State::ERROR);
+    EXPECT_EQ(s.error(), ErrorCode::NO_CHANGE);
+    EXPECT_EQ(s.tire(1).state, TireState::ERROR);
+    EXPECT_NEAR(sim.psi(0), 30.0f, 0.5f);
+    EXPECT_NEAR(sim.psi(2), 30.0f, 0.5f);
+    EXPECT_EQ(s.statusChar(), 'E');
+}
+
+TEST_F(ManifoldTest, Cancel_ClosesEverything) {
+    float p[3] = {20, 40, 25};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    advance(s, sim, 500);
+    s.cancel();
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_EQ(sim.valves(), 0);
+    EXPECT_FALSE(sim.compressorOn());
+    EXPECT_FALSE(sim.ventOpen());
+}
+
+TEST_F(ManifoldTest, Cancel_ForcesOffOutputsItDidNotSet) {
+    // A valve and the vent left open behind the scheduler's back (a glitch, a manual
+    // test): cancel stops them too, as Controller's emergency stop would
+    float p[3] = {20, 20, 20};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f, 0x01);
+    advance(s, sim, 100);
+    ASSERT_TRUE(sim.compressorOn());
+    sim.setValve(2, true);
+    s.cancel();
+    EXPECT_EQ(sim.valves(), 0);
+    EXPECT_FALSE(sim.compressorOn());
+    EXPECT_FALSE(sim.ventOpen());
+}
+
+TEST_F(ManifoldTest, ClockWrap_BurstsRunTheirLength) {
+    // millis() wraps during the first burst: its end, just past the wrap, is not
+    // already due
+    now = 0xFFFFFFFFu - 300;
+    float p[2] = {20, 40};
+    ManifoldSim sim(2, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    ASSERT_EQ(s.tire(1).state, TireState::VENTING);
+    advance(s, sim, 100);
+    EXPECT_EQ(s.tire(1).state, TireState::VENTING);
+    advance(s, sim, cfg.burstMsInit);
+    EXPECT_NE(s.tire(1).state, TireState::VENTING);
+    ta::sim::runManifold(s, sim, now, 120000, 10);
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_NEAR(sim.psi(0), 30.0f, 0.5f);
+    EXPECT_NEAR(sim.psi(1), 30.0f, 0.5f);
+}
+
+TEST_F(ManifoldTest, Reseek_SingleTireLeavesOthersAlone) {
+    float p[3] = {30, 30, 30};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f);
+    s.startSeek(34.0f, 0x04);
+    EXPECT_EQ(s.activeMask(), 0x04);
+    ta::sim::runManifold(s, sim, now, 60000, 10);
+    EXPECT_NEAR(sim.psi(0), 30.0f, 0.01f);
+    EXPECT_NEAR(sim.psi(2), 34.0f, 0.5f);
+}
+
+// ============================================================================
+// Duty Cycle Tests
+// ============================================================================
+TEST_F(ManifoldTest, Duty_RestPausesFillsButNotVents) {
+    cfg.duty.enabled = true;
+    cfg.duty.budgetMs = 3000;
+    cfg.duty.ratedDuty = 0.5f;
+    cfg.duty.loadGain = 0.0f;
+    cfg.duty.stallWindowMs = 100000;
+    float p[3] = {20, 21, 30};
+    ManifoldSim sim(3, p, nullptr, fastPlant());
+    ManifoldScheduler s;
+    start(s, sim, 30.0f, 0x03);
+    for (int i = 0; i < 2000 && !s.isResting(); ++i) advance(s, sim, 10);
+    ASSERT_TRUE(s.isResting());
+    EXPECT_EQ(s.state(), State::CHECKING);
+    EXPECT_FALSE(sim.compressorOn());
+
+    // A vent asked for mid-rest goes ahead; fills stay paused
+    s.startSeek(25.0f, 0x04);
+    EXPECT_EQ(s.tire(2).state, TireState::VENTING);
+    EXPECT_TRUE(sim.ventOpen());
+    EXPECT_EQ(sim.valves(), 0x04);
+
+    bool filledWhileResting = false;
+    for (int i = 0; i < 20000 && s.state() != State::IDLE && s.state() != State::ERROR; ++i) {
+        advance(s, sim, 10);
+        if (s.isResting() && sim.compressorOn()) filledWhileResting = true;
+    }
+    EXPECT_FALSE(filledWhileResting);
+    EXPECT_EQ(s.state(), State::IDLE);
+    EXPECT_NEAR(sim.psi(0), 30.0f, 0.5f);
+    EXPECT_NEAR(sim.psi(1), 30.0f, 0.5f);
+    EXPECT_NEAR(sim.psi(2), 25.0f, 0.5f);
+}
+
+// ============================================================================
+// Plant Sim: whole trailer vs one tire at a time
+// ============================================================================
+TEST(ManifoldSimTest, Trailer_FasterThanSerialSeeks) {
+    // Duty cycle off in both runs: the comparison is scheduling only (a fresh serial
+    // Controller per tire wouldn't carry the motor's heat over between tires)
+    Config cfg;
+    cfg.duty.enabled = false;
+    const float start[4] = {22, 25, 38, 36};
+    const float vol[4] = {1.0f, 1.0f, 1.2f, 1.2f};
+    const float targets[4] = {32, 32, 32, 32};
+
+    ManifoldSim serialSim(4, start, vol);
+    uint32_t now = 0;
+    uint32_t serialMs = ta::sim::runSerial(serialSim, cfg, targets, now);
+
+    ManifoldSim sim(4, start, vol);
+    ManifoldScheduler s;
+    s.begin(&sim, cfg);
+    now = 0;
+    s.update(now, sim.psi());
+    s.startSeek(targets, 0x0F);
+    uint32_t parMs = ta::sim::runManifold(s, sim, now);
+
+    printf("[sim] trailer: serial %.0f s, manifold %.0f s (%.0f%%)\n", serialMs / 1000.0,
+           parMs / 1000.0, 100.0 * parMs / serialMs);
+    EXPECT_EQ(s.state(), State::IDLE);
+    for (uint8_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(sim.psi(i), 32.0f, 0.5f);
+        EXPECT_NEAR(serialSim.psi(i), 32.0f, 0.5f);
+    }
+    EXPECT_LT(parMs, serialMs * 0.85);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,324 @@
+/**
+ * Unit tests for TA_PeerTable
+ * Tests the multi-remote peer table, its NVS slot persistence (against a fake
+ * Preferences), the conflict policy for commands from several remotes, and the
+ * request queue between the radio callback and the loop
+ */
+
+#include <gtest/gtest.h>
+#include <TA_PeerTable.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ta::peers;
+using ta::protocol::Request;
+using ta::protocol::ManualCode;
+
+// ============================================================================
+// Fake Preferences - same surface as Arduino's Preferences, backed by a map
+// ============================================================================
+class FakePrefs {
+public:
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+    std::string ns;
+    bool readOnly = false;
+
+    bool begin(const char* name, bool ro = false) { ns = name; readOnly = ro; return true; }
+    void end() {}
+
+    size_t getBytesLength(const char* key) {
+        auto it = nvs[ns].find(key);
+        return it == nvs[ns].end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        auto it = nvs[ns].find(key);
+        if (it == nvs[ns].end() || it->second.size() > len) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (readOnly) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(buf);
+        nvs[ns][key] = std::vector<uint8_t>(p, p + len);
+        return len;
+    }
+    bool remove(const char* key) { return !readOnly && nvs[ns].erase(key) > 0; }
+};
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class PeerTableTest : public ::testing::Test {
+protected:
+    PeerTable table;
+    uint8_t mac[kMaxPeers + 1][6];
+    uint8_t lmk[kMaxPeers + 1][16];
+
+    void SetUp() override {
+        for (uint8_t i = 0; i <= kMaxPeers; ++i) {
+            for (uint8_t b = 0; b < 6; ++b) mac[i][b] = (uint8_t)(0x10 * (i + 1) + b);
+            memset(lmk[i], 0xA0 + i, 16);
+        }
+    }
+};
+
+class ArbiterTest : public ::testing::Test {
+protected:
+    CommandArbiter arb;
+
+    void SetUp() override {
+        ArbiterConfig cfg;
+        cfg.holdMs = 1500;
+        arb.begin(cfg);
+    }
+
+    static Request start(float psi) { Request r; r.kind = Request::Kind::Start; r.targetPsi = psi; return r; }
+    static Request manual(ManualCode c) { Request r; r.kind = Request::Kind::Manual; r.manual = c; return r; }
+    static Request idle() { Request r; r.kind = Request::Kind::Idle; return r; }
+    static Request ping() { Request r; r.kind = Request::Kind::Ping; return r; }
+};
+
+// ============================================================================
+// Peer Table Tests
+// ============================================================================
+TEST_F(PeerTableTest, Empty_NoPeers) {
+    EXPECT_EQ(table.count(), 0);
+    EXPECT_EQ(table.find(mac[0]), -1);
+    EXPECT_EQ(table.freeSlot(), 0);
+}
+
+TEST_F(PeerTableTest, Fill_ToCapacityThenFull) {
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+        int8_t s = table.freeSlot();
+        ASSERT_EQ(s, i);
+        table.set((uint8_t)s, mac[i], lmk[i]);
+    }
+    EXPECT_EQ(table.count(), kMaxPeers);
+    EXPECT_EQ(table.freeSlot(), -1);
+    EXPECT_EQ(table.find(mac[2]), 2);
+    EXPECT_EQ(table.find(mac[kMaxPeers]), -1);
+}
+
+TEST_F(PeerTableTest, Clear_FreesSlotForReuse) {
+    table.set(0, mac[0], lmk[0]);
+    table.set(1, mac[1], lmk[1]);
+    table.clear(0);
+    EXPECT_EQ(table.freeSlot(), 0);
+    EXPECT_EQ(table.find(mac[1]), 1);
+}
+
+TEST_F(PeerTableTest, Activity_PerSlotMask) {
+    table.set(0, mac[0], lmk[0]);
+    table.set(1, mac[1], lmk[1]);
+    table.set(2, mac[2], lmk[2]);
+    table.touch(0, 2000);
+    table.touch(2, 4000);
+    EXPECT_EQ(table.usedMask(), 0x07);
+    EXPECT_EQ(table.activeMask(4500, 3000), 0x05);
+    EXPECT_EQ(table.activeMask(5000, 3000), 0x04); // slot 0 went quiet
+    EXPECT_FALSE(table.isActive(1, 4500, 3000));   // never heard
+}
+
+TEST_F(PeerTableTest, Rekey_SameMacKeepsActivity) {
+    table.set(0, mac[0], lmk[0]);
+    table.touch(0, 1000);
+    table.set(0, mac[0], lmk[1]);
+    EXPECT_TRUE(table.isActive(0, 1500, 3000));
+    EXPECT_EQ(table.at(0).lmk[0], lmk[1][0]);
+    table.set(0, mac[1], lmk[1]); // different remote in this slot
+    EXPECT_FALSE(table.isActive(0, 1500, 3000));
+}
+
+TEST_F(PeerTableTest, Proto_V1UntilNegotiatedResetOnNewMac) {
+    table.set(0, mac[0], lmk[0]);
+    EXPECT_EQ(table.sendProto(0), ta::protocol::kProtoV1);
+    table.setProto(0, ta::protocol::kProtoV2);
+    table.set(0, mac[0], lmk[1]);
+    EXPECT_EQ(table.sendProto(0), ta::protocol::kProtoV2); // re-key keeps it
+    table.set(0, mac[1], lmk[1]);
+    EXPECT_EQ(table.at(0).proto, ta::protocol::kProtoUnknown);
+    EXPECT_EQ(table.sendProto(0), ta::protocol::kProtoV1);
+}
+
+TEST_F(PeerTableTest, Nvs_SlotsRoundTrip) {
+    FakePrefs prefs;
+    ta::pairkey::savePeer(prefs, 0, mac[0], lmk[0]);
+    ta::pairkey::savePeer(prefs, 2, mac[2], lmk[2]);
+    EXPECT_EQ(loadPeers(prefs, table), 2);
+    EXPECT_EQ(table.find(mac[0]), 0);
+    EXPECT_EQ(table.find(mac[2]), 2);
+    EXPECT_EQ(table.freeSlot(), 1);
+    EXPECT_EQ(memcmp(table.at(2).lmk, lmk[2], 16), 0);
+}
+
+TEST_F(PeerTableTest, Nvs_SingleRemotePairingCarriesOver) {
+    FakePrefs prefs;
+    ta::pairkey::savePeer(prefs, mac[0], lmk[0]); // single-peer form
+    EXPECT_EQ(prefs.nvs["trailair"].count("peer"), 1u);
+    EXPECT_EQ(loadPeers(prefs, table), 1);
+    EXPECT_EQ(table.find(mac[0]), 0);
+}
+
+TEST_F(PeerTableTest, Nvs_ClearOneSlotLeavesOthers) {
+    FakePrefs prefs;
+    ta::pairkey::savePeer(prefs, 0, mac[0], lmk[0]);
+    ta::pairkey::savePeer(prefs, 1, mac[1], lmk[1]);
+    ta::pairkey::clearPeer(prefs, 0);
+    EXPECT_EQ(loadPeers(prefs, table), 1);
+    EXPECT_EQ(table.find(mac[1]), 1);
+    EXPECT_EQ(table.find(mac[0]), -1);
+}
+
+// ============================================================================
+// Conflict Policy Tests
+// ============================================================================
+TEST_F(ArbiterTest, SingleRemote_AlwaysAccepted) {
+    EXPECT_EQ(arb.admit(0, start(30), 0), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.admit(0, start(35), 100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.admit(0, manual(ManualCode::Air), 200), CommandArbiter::Verdict::Accept);
+}
+
+TEST_F(ArbiterTest, DifferentCommandWithinHold_Conflict) {
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, start(35), 500), CommandArbiter::Verdict::Conflict);
+    EXPECT_EQ(arb.admit(1, manual(ManualCode::Vent), 600), CommandArbiter::Verdict::Conflict);
+    EXPECT_EQ(arb.owner(600), 0);
+}
+
+TEST_F(ArbiterTest, SameCommand_NotAConflict) {
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, start(30), 200), CommandArbiter::Verdict::Accept);
+}
+
+TEST_F(ArbiterTest, AfterHold_OtherRemoteTakesOver) {
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, start(35), 1600), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.owner(1600), 1);
+}
+
+TEST_F(ArbiterTest, HeldManual_RenewsOwnership) {
+    for (uint32_t t = 0; t <= 3000; t += 300) arb.admit(0, manual(ManualCode::Air), t);
+    EXPECT_EQ(arb.admit(1, manual(ManualCode::Vent), 3100), CommandArbiter::Verdict::Conflict);
+}
+
+TEST_F(ArbiterTest, Stop_AlwaysWinsAndReleases) {
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, idle(), 100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.owner(100), -1);
+    EXPECT_EQ(arb.admit(1, start(35), 200), CommandArbiter::Verdict::Accept);
+}
+
+TEST_F(ArbiterTest, LeaseStop_Releases) {
+    Request grant = manual(ManualCode::Air);
+    grant.leased = true;
+    grant.leaseMs = 1500;
+    Request stop = grant;
+    stop.leaseMs = 0;
+    arb.admit(0, grant, 0);
+    EXPECT_EQ(arb.admit(0, stop, 100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.owner(100), -1);
+    EXPECT_EQ(arb.admit(1, manual(ManualCode::Vent), 200), CommandArbiter::Verdict::Accept);
+}
+
+TEST_F(ArbiterTest, LeaseStop_FromOtherRemote_Ignored) {
+    Request grant = manual(ManualCode::Air);
+    grant.leased = true;
+    grant.leaseMs = 1500;
+    Request stop = grant;
+    stop.leaseMs = 0;
+    arb.admit(0, grant, 0);
+    EXPECT_EQ(arb.admit(1, stop, 100), CommandArbiter::Verdict::Ignore);
+    EXPECT_EQ(arb.owner(100), 0);
+    EXPECT_EQ(arb.leaseOwner(), 0);
+    EXPECT_EQ(arb.admit(1, stop, 2000), CommandArbiter::Verdict::Ignore);   // past the hold too
+    EXPECT_EQ(arb.admit(0, stop, 2100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.leaseOwner(), -1);
+}
+
+TEST_F(ArbiterTest, LeaseStop_NoLeaseRunning_Accepted) {
+    Request stop = manual(ManualCode::Air);
+    stop.leased = true;
+    stop.leaseMs = 0;
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, stop, 100), CommandArbiter::Verdict::Accept);
+}
+
+TEST_F(ArbiterTest, Idle_EndsAnotherRemotesLease) {
+    Request grant = manual(ManualCode::Air);
+    grant.leased = true;
+    grant.leaseMs = 1500;
+    arb.admit(0, grant, 0);
+    EXPECT_EQ(arb.admit(1, idle(), 100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.leaseOwner(), -1);
+}
+
+TEST_F(ArbiterTest, Ping_NeverConflictsOrTakesOwnership) {
+    arb.admit(0, start(30), 0);
+    EXPECT_EQ(arb.admit(1, ping(), 100), CommandArbiter::Verdict::Accept);
+    EXPECT_EQ(arb.owner(100), 0);
+}
+
+// ============================================================================
+// Request Queue Tests
+// ============================================================================
+static QueuedRequest queued(const Request& r, uint32_t us = 0) { QueuedRequest q; q.req = r; q.us = us; return q; }
+
+TEST_F(ArbiterTest, Queue_FifoUntilFull) {
+    RequestQueue q;
+    for (uint32_t i = 0; i < RequestQueue::kCapacity; ++i) {
+        QueuedRequest in = queued(start(30), i);
+        in.slot = (uint8_t)(kMaxPeers - 1 - i % kMaxPeers);
+        EXPECT_TRUE(q.push(in));
+    }
+    QueuedRequest out;
+    for (uint32_t i = 0; i < RequestQueue::kCapacity; ++i) {
+        ASSERT_TRUE(q.pop(out));
+        EXPECT_EQ(out.us, i);
+        EXPECT_EQ(out.slot, kMaxPeers - 1 - i % kMaxPeers);   // sender kept for the recorder
+    }
+    EXPECT_FALSE(q.pop(out));
+    EXPECT_EQ(q.dropped(), 0u);
+}
+
+TEST_F(ArbiterTest, Queue_FullOfCommands_StopEvictsOldestCommand) {
+    RequestQueue q;
+    for (uint32_t i = 0; i < RequestQueue::kCapacity; ++i) q.push(queued(manual(ManualCode::Air), i));
+    Request stop = manual(ManualCode::Air);
+    stop.leased = true;
+    stop.leaseMs = 0;
+    EXPECT_TRUE(q.push(queued(stop, 99)));
+    EXPECT_EQ(q.dropped(), 1u);
+    QueuedRequest out, last;
+    ASSERT_TRUE(q.pop(out));
+    EXPECT_EQ(out.us, 1u);                       // the oldest went
+    while (q.pop(out)) last = out;
+    EXPECT_TRUE(RequestQueue::isStop(last.req)); // the stop is applied last
+}
+
+TEST_F(ArbiterTest, Queue_StopsSurviveCommandFlood) {
+    RequestQueue q;
+    q.push(queued(idle(), 1));
+    for (uint32_t i = 0; i < 10; ++i) EXPECT_TRUE(q.push(queued(start(30 + i), 10 + i)));
+    QueuedRequest out;
+    ASSERT_TRUE(q.pop(out));
+    EXPECT_EQ(out.us, 1u);
+    EXPECT_EQ(q.dropped(), 7u);
+}
+
+TEST_F(ArbiterTest, Queue_AllStops_CommandRefused) {
+    RequestQueue q;
+    for (uint32_t i = 0; i < RequestQueue::kCapacity; ++i) q.push(queued(idle(), i));
+    EXPECT_FALSE(q.push(queued(start(30))));
+    EXPECT_TRUE(q.push(queued(idle(), 42)));    // a newer stop replaces the oldest
+    EXPECT_EQ(q.dropped(), 2u);
+    EXPECT_EQ(q.size(), +RequestQueue::kCapacity);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,302 @@
+/**
+ * Unit tests for TA_Power
+ * Tests compressor current / supply voltage scaling and smoothing from a fake ADC,
+ * and the controller's supply-aware rate model: slow fills on a weak battery are not
+ * errors, while a stalled motor, a dead circuit and a leaking hose are told apart
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Power.h>
+#include <TA_Controller.h>
+#include "../sim/FakeAdc.h"
+#include "../sim/PlantSim.h"
+
+using namespace ta::sensors;
+using namespace ta::ctl;
+using ta::sim::FakeAdc;
+using ta::sim::PlantSim;
+using ta::sim::PlantConfig;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class PowerSensorTest : public ::testing::Test {
+protected:
+    FakeAdc adc;
+    PowerSensor power;
+    PowerConfig cfg;
+
+    void SetUp() override {
+        cfg.currentPin = 2;
+        cfg.voltagePin = 4;
+        cfg.currentZeroMv = 1650.0f;
+        cfg.currentMvPerAmp = 40.0f;
+        cfg.voltageDivider = 5.7f;
+        cfg.alpha = 0.2f;
+        power.begin(&adc, cfg);
+    }
+};
+
+// Board loop in miniature: plant -> ADC -> PowerSensor -> Controller
+class SupplyTest : public ::testing::Test {
+protected:
+    FakeAdc adc;
+    PowerSensor power;
+    PowerConfig pcfg;
+    Controller ctl;
+    Config cfg;
+    uint32_t now = 0;
+
+    void SetUp() override {
+        pcfg.currentPin = 2;
+        pcfg.voltagePin = 4;
+        power.begin(&adc, pcfg);
+        cfg.duty.enabled = false;
+    }
+
+    // Seek with the supply fed to the controller (or not) until it finishes
+    void seek(PlantSim& plant, float target, bool withSupply, uint32_t timeoutMs = 4UL * 3600UL * 1000UL) {
+        ctl.begin(&plant, cfg);
+        ctl.update(now, plant.psi());
+        ctl.startSeek(target);
+        uint32_t start = now;
+        while (now - start < timeoutMs) {
+            plant.step(50);
+            now += 50;
+            adc.setSupply(pcfg, plant.volts(), plant.amps());
+            power.sample();
+            if (withSupply) ctl.setSupply(power.volts(), power.hasCurrent() ? power.amps() : -1.0f);
+            ctl.update(now, plant.psi());
+            if (ctl.state() == State::IDLE || ctl.state() == State::ERROR) break;
+        }
+    }
+};
+
+// ============================================================================
+// Sensor Tests
+// ============================================================================
+TEST_F(PowerSensorTest, NoSample_NothingKnown) {
+    EXPECT_FALSE(power.hasVoltage());
+    EXPECT_FALSE(power.hasCurrent());
+}
+
+TEST_F(PowerSensorTest, Scaling_VoltsAndAmps) {
+    adc.setSupply(cfg, 12.6f, 20.0f);
+    power.sample();
+    EXPECT_NEAR(power.volts(), 12.6f, 0.01f);
+    EXPECT_NEAR(power.amps(), 20.0f, 0.05f);
+    EXPECT_NEAR(power.watts(), 252.0f, 1.0f);
+    EXPECT_EQ(adc.reads(), 2);
+}
+
+TEST_F(PowerSensorTest, Centi_WhatTheControllerTakes) {
+    adc.setSupply(cfg, 12.6f, 20.0f);
+    for (int i = 0; i < 10; ++i) power.sample();
+    EXPECT_EQ(power.centiVolts(), 1260);
+    EXPECT_EQ(power.centiAmps(), 2000);
+    EXPECT_NEAR(power.volts(), power.centiVolts() / 100.0f, 0.005f);
+}
+
+TEST_F(PowerSensorTest, Current_NegativeClampedToZero) {
+    adc.set(cfg.currentPin, 1600); // offset drift below zero
+    power.sample();
+    EXPECT_FLOAT_EQ(power.amps(), 0.0f);
+}
+
+TEST_F(PowerSensorTest, Ripple_Smoothed) {
+    adc.setSupply(cfg, 12.0f, 25.0f);
+    adc.setRipple(200); // +-5 A of commutation ripple
+    for (int i = 0; i < 50; ++i) power.sample();
+    EXPECT_NEAR(power.amps(), 25.0f, 1.0f);
+}
+
+TEST_F(PowerSensorTest, Step_FollowedWithinAFewSamples) {
+    adc.setSupply(cfg, 13.8f, 0.0f);
+    power.sample();
+    adc.setSupply(cfg, 11.5f, 30.0f); // compressor kicks in
+    for (int i = 0; i < 25; ++i) power.sample();
+    EXPECT_NEAR(power.volts(), 11.5f, 0.05f);
+    EXPECT_NEAR(power.amps(), 30.0f, 0.3f);
+}
+
+TEST_F(PowerSensorTest, DisabledChannel_NotRead) {
+    cfg.currentPin = -1;
+    power.begin(&adc, cfg);
+    adc.setSupply(cfg, 12.0f, 0.0f);
+    power.sample();
+    EXPECT_TRUE(power.hasVoltage());
+    EXPECT_FALSE(power.hasCurrent());
+    EXPECT_EQ(adc.reads(), 1);
+}
+
+// ============================================================================
+// Controller Supply Tests
+// ============================================================================
+TEST_F(SupplyTest, PowerFactor_OneUntilSupplyKnown) {
+    PlantSim plant;
+    ctl.begin(&plant, cfg);
+    EXPECT_FLOAT_EQ(ctl.powerFactor(), 1.0f);
+    ctl.setSupply(cfg.nominalVolts * 0.8f);
+    EXPECT_FLOAT_EQ(ctl.powerFactor(), 0.8f);
+    ctl.setSupply(1.0f);
+    EXPECT_FLOAT_EQ(ctl.powerFactor(), 0.3f); // clamped
+}
+
+TEST_F(SupplyTest, Begin_ForgetsSupply) {
+    PlantSim plant;
+    ctl.begin(&plant, cfg);
+    ctl.setSupply(9.0f, 20.0f);
+    ctl.begin(&plant, cfg);
+    EXPECT_FLOAT_EQ(ctl.powerFactor(), 1.0f);
+}
+
+TEST_F(SupplyTest, WeakBattery_SlowFillIsNotAnError) {
+    // Big tire on a cold battery: at ~65% speed the fill is predicted past
+    // maxContinuousMs, but at nominal power it isn't
+    PlantConfig p;
+    p.fillPsiPerSec = 0.03f;
+    p.supplyVolts = 9.8f;
+
+    PlantSim blind(p);
+    seek(blind, 45.0f, false);
+    EXPECT_EQ(ctl.error(), ErrorCode::EXCESSIVE_TIME);
+
+    PlantSim plant(p);
+    seek(plant, 45.0f, true);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    EXPECT_EQ(ctl.error(), ErrorCode::NONE);
+    EXPECT_NEAR(plant.psi(), 45.0f, 0.5f);
+    EXPECT_LT(ctl.powerFactor(), 0.75f);
+}
+
+TEST_F(SupplyTest, SupplyDrops_NextBurstRescaled) {
+    // Rates learned with the engine running; it stops during the settle before the first
+    // continuous burst. That burst must be planned for the weaker supply, not fall short.
+    PlantConfig p;
+    p.fillPsiPerSec = 0.5f;
+    p.supplyVolts = 14.2f;
+    cfg.runMaxMs = 60000;
+    cfg.burstMsInit = 4000;
+
+    auto run = [&](bool withSupply, float& psiAfter, int& bursts) {
+        PlantSim plant(p);
+        now = 0;
+        power.begin(&adc, pcfg);
+        ctl.begin(&plant, cfg);
+        ctl.update(now, plant.psi());
+        ctl.startSeek(25.0f);
+        bursts = 1;
+        State last = ctl.state();
+        psiAfter = -1;
+        while (ctl.state() != State::IDLE && ctl.state() != State::ERROR && now < 600000) {
+            plant.step(50);
+            now += 50;
+            if (last == State::CHECKING && bursts == 2) plant.setSupplyVolts(11.8f);
+            adc.setSupply(pcfg, plant.volts(), plant.amps());
+            power.sample();
+            if (withSupply) ctl.setSupply(power.volts(), power.amps());
+            ctl.update(now, plant.psi());
+            if (last != State::AIRUP && ctl.state() == State::AIRUP) bursts++;
+            if (last == State::AIRUP && ctl.state() == State::CHECKING && bursts == 3) psiAfter = plant.psi();
+            last = ctl.state();
+        }
+    };
+
+    float blindPsi, awarePsi;
+    int blindBursts, awareBursts;
+    run(false, blindPsi, blindBursts);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+    run(true, awarePsi, awareBursts);
+    // Target 25: the aware burst lands within a psi of its aim, the blind one well short.
+    // (The blind run's curve then reads the drop as back-pressure and catches up, so
+    // the burst counts don't tell them apart: see the next test.)
+    EXPECT_NEAR(awarePsi, 25.0f - cfg.aimMarginPsi, 1.0f);
+    EXPECT_LT(blindPsi, awarePsi - 1.0f);
+    EXPECT_EQ(ctl.state(), State::IDLE);
+}
+
+TEST_F(SupplyTest, SupplyDrop_CurveKeepsTheBackPressureSlope) {
+    // The pump slows with back-pressure; the supply drops after the second burst. Rates
+    // are fitted per unit of power, so with the supply known the curve learns the same
+    // slope as on a steady supply; unseen, the drop is taken for back-pressure.
+    PlantConfig p;
+    p.fillPsiPerSec = 0.5f;
+    p.supplyVolts = 14.2f;
+    cfg.runMaxMs = 60000;
+    cfg.burstMsInit = 4000;
+
+    auto slopeAfter3 = [&](bool drop, bool withSupply) {
+        PlantSim plant(p);
+        now = 0;
+        power.begin(&adc, pcfg);
+        ctl.begin(&plant, cfg);
+        ctl.update(now, plant.psi());
+        ctl.startSeek(35.0f);
+        int bursts = 1;
+        State last = ctl.state();
+        while (ctl.state() != State::IDLE && ctl.state() != State::ERROR && now < 600000) {
+            plant.step(50);
+            now += 50;
+            if (drop && last == State::CHECKING && bursts == 2) plant.setSupplyVolts(11.8f);
+            adc.setSupply(pcfg, plant.volts(), plant.amps());
+            power.sample();
+            if (withSupply) ctl.setSupply(power.volts(), power.amps());
+            ctl.update(now, plant.psi());
+            if (last != State::AIRUP && ctl.state() == State::AIRUP && ++bursts == 4) break;
+            last = ctl.state();
+        }
+        EXPECT_FALSE(ctl.fillCurve().flat());
+        return ta::fx::toFloat(ctl.fillCurve().slope());
+    };
+
+    float steady = slopeAfter3(false, true);
+    float aware = slopeAfter3(true, true);
+    float blind = slopeAfter3(true, false);
+    EXPECT_LT(steady, 0.0f);
+    EXPECT_NEAR(aware, steady, 0.25f * -steady);
+    EXPECT_LT(blind, 2.0f * steady);
+}
+
+TEST_F(SupplyTest, DeadCircuit_NoLoadAfterOneBurst) {
+    PlantSim plant;
+    plant.setConnected(false);
+    seek(plant, 30.0f, true);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::NO_LOAD);
+    EXPECT_EQ(plant.compressorStarts(), 1u);
+}
+
+TEST_F(SupplyTest, DeadCircuit_WithoutCurrentChannel_NoChange) {
+    pcfg.currentPin = -1;
+    power.begin(&adc, pcfg);
+    PlantSim plant;
+    plant.setConnected(false);
+    seek(plant, 30.0f, true);
+    EXPECT_EQ(ctl.error(), ErrorCode::NO_CHANGE);
+}
+
+TEST_F(SupplyTest, StalledOnFlatBattery_LowSupply) {
+    PlantConfig p;
+    p.supplyVolts = 8.5f; // sags under the motor's load below stallVolts
+    PlantSim plant(p);
+    seek(plant, 30.0f, true);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::LOW_SUPPLY);
+}
+
+TEST_F(SupplyTest, LeakingHose_StillNoChange) {
+    PlantConfig p;
+    p.fillPsiPerSec = 0.0f; // air goes out the hose, supply and current are healthy
+    PlantSim plant(p);
+    seek(plant, 30.0f, true);
+    EXPECT_EQ(ctl.state(), State::ERROR);
+    EXPECT_EQ(ctl.error(), ErrorCode::NO_CHANGE);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
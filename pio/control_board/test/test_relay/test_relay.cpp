@@ -0,0 +1,277 @@
+/**
+ * Unit tests for TA_Relay
+ * Tests relay minimum on/off times, the compressor/vent interlock, cycle counting
+ * and its NVS persistence, soft-start ramp and the wear-based cycle cost
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Relay.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstring>
+
+using namespace ta::act;
+
+// ============================================================================
+// Fake NVS - same interface subset as Arduino Preferences
+// ============================================================================
+class FakePrefs {
+public:
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+    std::string ns;
+    bool readOnly = false;
+    int writes = 0;
+
+    bool begin(const char* name, bool ro = false) { ns = name; readOnly = ro; return true; }
+    void end() {}
+
+    size_t getBytesLength(const char* key) {
+        auto it = nvs[ns].find(key);
+        return it == nvs[ns].end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        auto it = nvs[ns].find(key);
+        if (it == nvs[ns].end() || it->second.size() > len) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (readOnly) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(buf);
+        nvs[ns][key] = std::vector<uint8_t>(p, p + len);
+        writes++;
+        return len;
+    }
+};
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class RelayGuardTest : public ::testing::Test {
+protected:
+    RelayGuard relay;
+    RelayConfig cfg;
+
+    void SetUp() override {
+        cfg.minOnMs = 500;
+        cfg.minOffMs = 1000;
+        relay.begin(cfg);
+    }
+};
+
+class GuardedPairTest : public ::testing::Test {
+protected:
+    GuardedPair outs;
+    RelayConfig cfg;
+
+    void SetUp() override {
+        cfg.minOnMs = 500;
+        cfg.minOffMs = 500;
+        outs.begin(cfg, cfg);
+        outs.service(0);
+    }
+};
+
+// ============================================================================
+// Minimum Time Tests
+// ============================================================================
+TEST_F(RelayGuardTest, FirstSwitchOn_Immediate) {
+    relay.request(true);
+    EXPECT_TRUE(relay.service(100));
+    EXPECT_TRUE(relay.isOn());
+    EXPECT_EQ(relay.cycles(), 1u);
+}
+
+TEST_F(RelayGuardTest, Off_HeldUntilMinOnTime) {
+    relay.request(true);
+    relay.service(0);
+    relay.request(false);
+    EXPECT_FALSE(relay.service(200));
+    EXPECT_TRUE(relay.isOn());
+    EXPECT_FALSE(relay.service(499));
+    EXPECT_TRUE(relay.service(500));
+    EXPECT_FALSE(relay.isOn());
+    EXPECT_EQ(relay.deferred(), 1u); // one held switch, however many polls
+    EXPECT_EQ(relay.onMs(), 500u);
+}
+
+TEST_F(RelayGuardTest, On_HeldUntilMinOffTime) {
+    relay.request(true);
+    relay.service(0);
+    relay.request(false);
+    relay.service(600);
+    relay.request(true);
+    EXPECT_FALSE(relay.service(1000));
+    EXPECT_TRUE(relay.service(1600));
+    EXPECT_EQ(relay.cycles(), 2u);
+}
+
+TEST_F(RelayGuardTest, RequestWithdrawnWhileHeld_NoSwitchNoCycle) {
+    relay.request(true);
+    relay.service(0);
+    relay.request(false);
+    relay.service(100);
+    relay.request(true);  // controller changed its mind inside the minimum on time
+    relay.service(600);
+    EXPECT_TRUE(relay.isOn());
+    EXPECT_EQ(relay.cycles(), 1u);
+}
+
+TEST_F(RelayGuardTest, ForceOff_BypassesGuardAndIsCounted) {
+    relay.request(true);
+    relay.service(0);
+    EXPECT_TRUE(relay.forceOff(100));
+    EXPECT_FALSE(relay.isOn());
+    EXPECT_EQ(relay.forced(), 1u);
+    EXPECT_FALSE(relay.wanted());
+}
+
+// ============================================================================
+// Interlock Tests
+// ============================================================================
+TEST_F(GuardedPairTest, NeverBothOn) {
+    outs.setCompressor(true);
+    outs.service(0);
+    ASSERT_TRUE(outs.compressor().isOn());
+    outs.setVent(true);
+    for (uint32_t t = 0; t <= 2000; t += 10) {
+        outs.service(t);
+        EXPECT_FALSE(outs.compressor().isOn() && outs.vent().isOn());
+    }
+    EXPECT_TRUE(outs.vent().isOn());
+}
+
+TEST_F(GuardedPairTest, VentWaitsForCompressorMinOn) {
+    outs.setCompressor(true);
+    outs.service(0);
+    outs.setVent(true);
+    outs.service(200);
+    EXPECT_TRUE(outs.compressor().isOn());
+    EXPECT_FALSE(outs.vent().isOn());
+    outs.service(500);
+    EXPECT_FALSE(outs.compressor().isOn());
+    EXPECT_TRUE(outs.vent().isOn()); // same pass as the release
+}
+
+TEST_F(GuardedPairTest, StopAll_RespectsGuardEmergencyDoesNot) {
+    outs.setCompressor(true);
+    outs.service(0);
+    outs.stopAll();
+    outs.service(100);
+    EXPECT_TRUE(outs.compressor().isOn());
+    outs.emergencyStop(150);
+    EXPECT_FALSE(outs.compressor().isOn());
+    EXPECT_FALSE(outs.vent().isOn());
+}
+
+TEST_F(GuardedPairTest, BurstCheckCycle_OneCyclePerBurst) {
+    // Controller-style: 1 s bursts with 1 s settles
+    uint32_t t = 0;
+    for (int i = 0; i < 10; ++i) {
+        outs.setCompressor(true);  outs.service(t); t += 1000;
+        outs.stopAll();            outs.service(t); t += 1000;
+    }
+    EXPECT_EQ(outs.compressor().cycles(), 10u);
+    EXPECT_EQ(outs.compressor().deferred(), 0u);
+    EXPECT_EQ(outs.vent().cycles(), 0u);
+}
+
+TEST_F(GuardedPairTest, RapidToggling_Throttled) {
+    uint32_t t = 0;
+    for (int i = 0; i < 100; ++i) {
+        outs.setCompressor(i % 2 == 0);
+        outs.service(t);
+        t += 50;
+    }
+    for (; t < 6000; t += 50) outs.service(t);
+    // 5 s of 50 ms toggling, at most one on per (minOn + minOff)
+    EXPECT_LE(outs.compressor().cycles(), 6u);
+    EXPECT_GT(outs.compressor().deferred(), 0u);
+}
+
+// ============================================================================
+// Soft-Start / Wear Tests
+// ============================================================================
+TEST(SoftStart, RampsFromStartDutyToFull) {
+    RelayConfig cfg;
+    cfg.softStart = true;
+    cfg.rampMs = 400;
+    cfg.startDuty = 80;
+    EXPECT_EQ(softStartDuty(0, cfg), 80);
+    EXPECT_GT(softStartDuty(200, cfg), 80);
+    EXPECT_LT(softStartDuty(200, cfg), 255);
+    EXPECT_LE(softStartDuty(100, cfg), softStartDuty(300, cfg));
+    EXPECT_EQ(softStartDuty(400, cfg), 255);
+    cfg.softStart = false;
+    EXPECT_EQ(softStartDuty(0, cfg), 255); // relay: straight on
+}
+
+TEST(RelayWear, CycleCostGrowsWithWear) {
+    RelayConfig cfg;
+    cfg.ratedCycles = 1000;
+    cfg.cycleCostMs = 1000;
+    EXPECT_EQ(cycleCostMs(0, cfg), 1000u);
+    EXPECT_EQ(cycleCostMs(500, cfg), 2500u);
+    EXPECT_EQ(cycleCostMs(1000, cfg), 4000u);
+    EXPECT_EQ(cycleCostMs(5000, cfg), 4000u);
+    EXPECT_FLOAT_EQ(wearFraction(250, cfg), 0.25f);
+}
+
+// ============================================================================
+// NVS Tests
+// ============================================================================
+TEST(RelayNvs, Cycles_RoundTrip) {
+    FakePrefs prefs;
+    CycleCounts c;
+    EXPECT_FALSE(loadCycles(prefs, c));
+    c.compressor = 123456;
+    c.vent = 0x01020304;
+    ASSERT_TRUE(saveCycles(prefs, c));
+    CycleCounts r;
+    ASSERT_TRUE(loadCycles(prefs, r));
+    EXPECT_EQ(r.compressor, 123456u);
+    EXPECT_EQ(r.vent, 0x01020304u);
+    EXPECT_EQ(prefs.nvs[kNvsNamespace].count(kNvsCycles), 1u);
+}
+
+TEST(RelayNvs, WrongLength_Ignored) {
+    FakePrefs prefs;
+    uint8_t junk[3] = {1, 2, 3};
+    prefs.begin(kNvsNamespace);
+    prefs.putBytes(kNvsCycles, junk, sizeof(junk));
+    CycleCounts c;
+    EXPECT_FALSE(loadCycles(prefs, c));
+    EXPECT_EQ(c.compressor, 0u);
+}
+
+TEST(RelayNvs, CountsCarryAcrossBoots) {
+    FakePrefs prefs;
+    RelayConfig cfg;
+    GuardedPair a;
+    a.begin(cfg, cfg);
+    uint32_t t = 0;
+    for (int i = 0; i < 40; ++i) {
+        a.setCompressor(true); a.service(t); t += 1000;
+        a.stopAll();           a.service(t); t += 1000;
+    }
+    CycleCounts c{a.compressor().cycles(), a.vent().cycles()};
+    saveCycles(prefs, c);
+
+    GuardedPair b;
+    b.begin(cfg, cfg);
+    CycleCounts r;
+    ASSERT_TRUE(loadCycles(prefs, r));
+    b.compressor().setCycles(r.compressor);
+    b.setCompressor(true);
+    b.service(0);
+    EXPECT_EQ(b.compressor().cycles(), 41u);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
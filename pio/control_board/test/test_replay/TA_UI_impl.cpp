@@ -0,0 +1,2 @@
+// Include TA_UI implementation for native tests
+#include "../../../../pioLib/TA_UI/src/TA_UI.cpp"
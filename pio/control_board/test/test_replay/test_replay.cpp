@@ -0,0 +1,430 @@
+/**
+ * Unit tests for TA_Replay
+ * Tests the session recorder's encoding and ring, the console hex dump, and
+ * deterministic replay: a board session on the native plant replayed into a fresh
+ * Controller, and a remote's buttons and board status replayed into the shared UI.
+ *
+ * A captured dump can be replayed here too: TA_REPLAY_FILE=<console log> runs it
+ * through a default-config Controller and prints what it did.
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Replay.h>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "../sim/BoardReplay.h"
+
+using namespace ta::replay;
+using ta::protocol::Request;
+using ta::protocol::Response;
+using ta::protocol::Status;
+using ta::sim::BoardReplay;
+using ta::sim::BoardSession;
+using ta::sim::PlantConfig;
+using ta::sim::RemoteReplay;
+
+// Collects everything a replay delivers
+struct RecordingSink : Sink {
+  std::vector<Record> seen;
+  void onButton(uint32_t now, const ta::input::Event& e) override {
+    Record r; r.kind = Kind::Button; r.ms = now; r.button = e; seen.push_back(r);
+  }
+  void onRequest(uint32_t now, uint8_t slot, const Request& req) override {
+    Record r; r.kind = Kind::Request; r.ms = now; r.slot = slot; r.request = req; seen.push_back(r);
+  }
+  void onResponse(uint32_t now, uint8_t board, const Response& resp) override {
+    Record r; r.kind = Kind::Response; r.ms = now; r.slot = board; r.response = resp; seen.push_back(r);
+  }
+  void onPressure(uint32_t now, float psi) override {
+    Record r; r.kind = Kind::Pressure; r.ms = now; r.centiPsi = ta::protocol::psiToU16_01(psi); seen.push_back(r);
+  }
+  void onSupply(uint32_t now, float volts, float amps) override {
+    Record r; r.kind = Kind::Supply; r.ms = now; r.volts = volts; r.amps = amps; seen.push_back(r);
+  }
+};
+
+// Collects console output the way dumpHex writes it
+struct StringOut {
+  std::string text;
+  void print(const char* s) { text += s; }
+  void println(const char* s) { text += s; text += "\n"; }
+};
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+class ReplayTest : public ::testing::Test {
+protected:
+    uint8_t ring[4096];
+    Recorder rec;
+    std::vector<uint8_t> snap;
+
+    void SetUp() override {
+        rec.begin(ring, sizeof(ring));
+    }
+
+    std::vector<Record> playBack() {
+        snap.assign(rec.snapshotSize(), 0);
+        EXPECT_EQ(rec.snapshot(snap.data(), snap.size()), snap.size());
+        RecordingSink sink;
+        EXPECT_GE(play(snap.data(), snap.size(), sink), 0);
+        return sink.seen;
+    }
+};
+
+// ============================================================================
+// Encoding
+// ============================================================================
+TEST_F(ReplayTest, EachKind_RoundTrips) {
+    ta::input::Event e{ ta::input::ButtonId::Up, ta::input::Action::Repeat, 0, 1750 };
+    Request start; start.kind = Request::Kind::Start; start.targetPsi = 35.5f;
+    Request air; air.kind = Request::Kind::Manual; air.manual = ta::protocol::ManualCode::Air;
+    Response ok = ta::protocol::makeStatus(Status::AirUp, 31.27f);
+    ok.targetCentiPsi = 3380;
+    Response err; err.status = Status::Error; err.value = 4; err.detail = 12;
+
+    rec.pressure(1000, 31.27f);
+    rec.supply(1000, 12.84f, 14.31f);
+    rec.button(1010, e);
+    rec.request(1020, 2, start);
+    rec.request(1020, 1, air);
+    rec.response(1500, 3, ok);
+    rec.response(2500, 0, err);
+    rec.supply(2600, 13.5f, -1.0f);
+
+    std::vector<Record> r = playBack();
+    ASSERT_EQ(r.size(), 8u);
+    EXPECT_EQ(r[0].ms, 1000u);
+    EXPECT_EQ(r[0].centiPsi, 3127);
+    EXPECT_FLOAT_EQ(r[1].volts, 12.84f);
+    EXPECT_FLOAT_EQ(r[1].amps, 14.31f);
+    EXPECT_EQ(r[2].ms, 1010u);
+    EXPECT_EQ(r[2].button.id, ta::input::ButtonId::Up);
+    EXPECT_EQ(r[2].button.action, ta::input::Action::Repeat);
+    EXPECT_EQ(r[2].button.heldMs, 1750u);
+    EXPECT_EQ(r[3].slot, 2);
+    EXPECT_EQ(r[3].request.kind, Request::Kind::Start);
+    EXPECT_FLOAT_EQ(r[3].request.targetPsi, 35.5f);
+    EXPECT_EQ(r[4].request.kind, Request::Kind::Manual);
+    EXPECT_EQ(r[4].request.manual, ta::protocol::ManualCode::Air);
+    EXPECT_EQ(r[5].slot, 3);
+    EXPECT_EQ(r[5].response.status, Status::AirUp);
+    EXPECT_EQ(r[5].response.centiPsi, 3127);
+    EXPECT_EQ(r[5].response.targetCentiPsi, 3380);
+    EXPECT_EQ(r[6].response.status, Status::Error);
+    EXPECT_EQ(r[6].response.value, 4);
+    EXPECT_EQ(r[6].response.detail, 12);
+    EXPECT_EQ(r[7].ms, 2600u);
+    EXPECT_LT(r[7].amps, 0.0f);
+}
+
+TEST_F(ReplayTest, LeasedManual_RoundTrips) {
+    Request grant; grant.kind = Request::Kind::Manual; grant.manual = ta::protocol::ManualCode::Vent;
+    grant.leased = true; grant.seq = 201; grant.leaseMs = 1500;
+    Request stop = grant; stop.seq = 202; stop.leaseMs = 0;
+    rec.request(100, 0, grant);
+    rec.request(900, 0, stop);
+
+    std::vector<Record> r = playBack();
+    ASSERT_EQ(r.size(), 2u);
+    EXPECT_TRUE(r[0].request.leased);
+    EXPECT_EQ(r[0].request.manual, ta::protocol::ManualCode::Vent);
+    EXPECT_EQ(r[0].request.seq, 201);
+    EXPECT_EQ(r[0].request.leaseMs, 1500);
+    EXPECT_TRUE(ta::protocol::isManualStop(r[1].request));
+    EXPECT_EQ(r[1].request.seq, 202);
+}
+
+TEST_F(ReplayTest, UnchangedPressure_IsOneByteTick) {
+    rec.pressure(0, 30.0f);
+    size_t first = rec.used();
+    for (uint32_t t = 10; t <= 1000; t += 10) rec.pressure(t, 30.0f);
+    EXPECT_EQ(rec.used() - first, 100u);
+
+    std::vector<Record> r = playBack();
+    ASSERT_EQ(r.size(), 101u);
+    EXPECT_EQ(r.back().ms, 1000u);
+    EXPECT_EQ(r.back().centiPsi, 3000);
+}
+
+TEST_F(ReplayTest, UnchangedSupply_NotLogged) {
+    rec.supply(0, 13.5f, 0.0f);
+    size_t first = rec.used();
+    rec.supply(50, 13.5f, 0.0f);
+    EXPECT_EQ(rec.used(), first);
+    rec.supply(100, 13.49f, 0.0f);
+    EXPECT_GT(rec.used(), first);
+}
+
+TEST_F(ReplayTest, LongGaps_KeepExactTime) {
+    rec.pressure(0, 10.0f);
+    rec.pressure(30, 10.0f);                 // inline
+    rec.pressure(61, 10.0f);                 // just past inline
+    rec.pressure(61 + 3600000, 80.0f);       // an hour later
+    std::vector<Record> r = playBack();
+    ASSERT_EQ(r.size(), 4u);
+    EXPECT_EQ(r[1].ms, 30u);
+    EXPECT_EQ(r[2].ms, 61u);
+    EXPECT_EQ(r[3].ms, 3600061u);
+    EXPECT_EQ(r[3].centiPsi, 8000);
+}
+
+TEST_F(ReplayTest, TimeAcrossWrap_Continues) {
+    rec.pressure(0xFFFFFFF0u, 20.0f);
+    rec.pressure(0x20u, 20.5f);
+    std::vector<Record> r = playBack();
+    ASSERT_EQ(r.size(), 2u);
+    EXPECT_EQ(r[1].ms, 0x20u);
+}
+
+// ============================================================================
+// Ring
+// ============================================================================
+TEST_F(ReplayTest, FullRing_KeepsNewestWithAbsoluteValues) {
+    uint8_t small[256];
+    rec.begin(small, sizeof(small));
+    for (int i = 0; i < 1000; ++i) rec.pressure((uint32_t)i * 50, 10.0f + i * 0.37f);
+    EXPECT_GT(rec.dropped(), 0u);
+    EXPECT_LE(rec.used(), sizeof(small));
+
+    std::vector<Record> r = playBack();
+    ASSERT_FALSE(r.empty());
+    EXPECT_EQ(r.back().ms, 999u * 50);
+    for (const Record& x : r) {
+        ASSERT_EQ(x.ms % 50, 0u);
+        int i = (int)(x.ms / 50);
+        EXPECT_EQ(x.centiPsi, ta::protocol::psiToU16_01(10.0f + i * 0.37f)) << "at " << x.ms;
+    }
+}
+
+TEST_F(ReplayTest, BufferTooSmall_RecordsNothing) {
+    uint8_t tiny[16];
+    rec.begin(tiny, sizeof(tiny));
+    EXPECT_FALSE(rec.enabled());
+    rec.pressure(0, 10.0f);
+    EXPECT_EQ(rec.used(), 0u);
+}
+
+// ============================================================================
+// Damaged input
+// ============================================================================
+TEST_F(ReplayTest, Corrupt_Rejected) {
+    Request start; start.kind = Request::Kind::Start; start.targetPsi = 40.0f;
+    rec.pressure(0, 10.0f);
+    rec.request(5, 0, start);
+    playBack();
+    RecordingSink sink;
+
+    std::vector<uint8_t> bad = snap;
+    bad[0] = 'X';
+    EXPECT_EQ(play(bad.data(), bad.size(), sink), -1);
+
+    bad = snap;
+    bad.pop_back();                                     // truncated target
+    EXPECT_EQ(play(bad.data(), bad.size(), sink), -1);
+
+    bad = snap;
+    bad.push_back((uint8_t)(7 << 5));                   // unknown kind
+    EXPECT_EQ(play(bad.data(), bad.size(), sink), -1);
+
+    EXPECT_EQ(play(snap.data(), 4, sink), -1);
+}
+
+// ============================================================================
+// Console dump
+// ============================================================================
+TEST_F(ReplayTest, HexDump_ParsesBackOutOfNoisyLog) {
+    for (int i = 0; i < 200; ++i) rec.pressure((uint32_t)i * 50, 10.0f + i * 0.1f);
+    StringOut out;
+    dumpHex(out, rec, "[REC]");
+    std::string log = "[CTL] state ERROR\nboot noise\n" + out.text + "[APP] after\n";
+    // Interleave another module's line mid-dump
+    size_t cut = log.find("[REC]", log.find("[REC]") + 1);
+    log.insert(cut, "[RADIO] retry 2\n");
+
+    std::vector<uint8_t> parsed(rec.snapshotSize() + 64);
+    size_t n = parseHex(log.c_str(), "[REC]", parsed.data(), parsed.size());
+    snap.assign(rec.snapshotSize(), 0);
+    rec.snapshot(snap.data(), snap.size());
+    ASSERT_EQ(n, snap.size());
+    EXPECT_EQ(0, memcmp(parsed.data(), snap.data(), n));
+}
+
+TEST_F(ReplayTest, HexDump_StepsMatchOneShotWhileHeld) {
+    for (int i = 0; i < 200; ++i) rec.pressure((uint32_t)i * 50, 10.0f + i * 0.1f);
+    StringOut whole;
+    dumpHex(whole, rec, "[REC]");
+
+    // A line per loop; the loop keeps recording, which the hold keeps out
+    StringOut out;
+    HexDump d;
+    d.start("[REC]");
+    rec.hold(true);
+    int loops = 0;
+    for (uint32_t now = 10000; d.step(out, rec); now += 10, ++loops) {
+        EXPECT_LE(std::count(out.text.begin(), out.text.end(), '\n'), loops + 1);
+        rec.pressure(now, 30.0f);
+        rec.supply(now, 12.0f, 5.0f);
+    }
+    rec.hold(false);
+    EXPECT_EQ(out.text, whole.text);
+    EXPECT_GT(loops, 1);
+    EXPECT_FALSE(d.active());
+
+    // Recording resumes where it left off
+    size_t used = rec.used();
+    rec.pressure(20000, 31.0f);
+    EXPECT_GT(rec.used(), used);
+}
+
+// ============================================================================
+// Board session replay
+// ============================================================================
+class BoardReplayTest : public ::testing::Test {
+protected:
+    std::vector<uint8_t> ring = std::vector<uint8_t>(256 * 1024);
+    ta::ctl::Config cfg;
+
+    static PlantConfig fastPlant() {
+        PlantConfig p;
+        p.startPsi = 12.0f;
+        p.fillPsiPerSec = 0.5f;
+        p.leakPsiPerMin = 0.05f;
+        return p;
+    }
+
+    static Request startAt(float psi) {
+        Request r; r.kind = Request::Kind::Start; r.targetPsi = psi; return r;
+    }
+
+    std::vector<uint8_t> snapshotOf(const BoardSession& s) {
+        std::vector<uint8_t> out(s.recorder().snapshotSize());
+        s.recorder().snapshot(out.data(), out.size());
+        return out;
+    }
+};
+
+TEST_F(BoardReplayTest, Seek_ReplaysToIdenticalOutputs) {
+    BoardSession live(cfg, fastPlant(), ring.data(), ring.size());
+    uint32_t now = 0;
+    live.request(startAt(32.0f));
+    bool left = false;
+    for (; now < 20UL * 60UL * 1000UL; now += 50) {
+        live.loop(now, 50);
+        if (now > 0 && live.controller().state() == ta::ctl::State::IDLE) { left = true; break; }
+    }
+    ASSERT_TRUE(left) << "seek never finished";
+    EXPECT_NEAR(live.plant().psi(), 32.0f, 1.0f);
+    ASSERT_EQ(live.recorder().dropped(), 0u);
+
+    std::vector<uint8_t> snap = snapshotOf(live);
+    BoardReplay replay(cfg);
+    ASSERT_GT(play(snap.data(), snap.size(), replay), 0);
+    EXPECT_EQ(replay.loops(), now / 50 + 1);
+    EXPECT_EQ(replay.controller().state(), live.controller().state());
+    ASSERT_EQ(replay.edges().size(), live.edges().size());
+    EXPECT_TRUE(replay.edges() == live.edges());
+    EXPECT_GT(live.edges().size(), 2u);
+}
+
+TEST_F(BoardReplayTest, CancelAndManual_ReplayToIdenticalOutputs) {
+    BoardSession live(cfg, fastPlant(), ring.data(), ring.size());
+    Request vent; vent.kind = Request::Kind::Manual; vent.manual = ta::protocol::ManualCode::Vent;
+    Request idle;
+    for (uint32_t now = 0; now < 120000; now += 50) {
+        if (now == 1000) live.request(startAt(40.0f));
+        if (now == 30000) live.request(idle);
+        if (now == 40000) live.request(vent);
+        if (now == 45000) live.request(idle);
+        if (now == 50000) live.plant().setSupplyVolts(12.1f);
+        if (now == 60000) live.request(startAt(20.0f));
+        live.loop(now, 50);
+    }
+    std::vector<uint8_t> snap = snapshotOf(live);
+    BoardReplay replay(cfg);
+    ASSERT_GT(play(snap.data(), snap.size(), replay), 0);
+    EXPECT_EQ(replay.controller().state(), live.controller().state());
+    EXPECT_TRUE(replay.edges() == live.edges());
+}
+
+TEST_F(BoardReplayTest, Replay_RunsFarFasterThanRealTime) {
+    BoardSession live(cfg, fastPlant(), ring.data(), ring.size());
+    const uint32_t kSessionMs = 30UL * 60UL * 1000UL;
+    live.request(startAt(60.0f));
+    for (uint32_t now = 0; now < kSessionMs; now += 50) live.loop(now, 50);
+    std::vector<uint8_t> snap = snapshotOf(live);
+
+    BoardReplay replay(cfg);
+    auto t0 = std::chrono::steady_clock::now();
+    long records = play(snap.data(), snap.size(), replay);
+    double hostMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ASSERT_GT(records, 0);
+    double speedup = kSessionMs / (hostMs > 0.001 ? hostMs : 0.001);
+    printf("[REPLAY] %ld records, %zu bytes, %.1f min in %.2f ms (%.0fx real time)\n",
+           records, snap.size(), kSessionMs / 60000.0, hostMs, speedup);
+    EXPECT_GT(speedup, 100.0);
+    EXPECT_TRUE(replay.edges() == live.edges());
+}
+
+// ============================================================================
+// Remote session replay
+// ============================================================================
+TEST_F(ReplayTest, RemoteSession_DrivesUiLikeTheDevice) {
+    using ta::input::ButtonId;
+    using ta::input::Action;
+    rec.button(100, ta::input::Event{ ButtonId::Up, Action::Click, 1, 0 });
+    rec.button(400, ta::input::Event{ ButtonId::Right, Action::Click, 1, 0 });
+    Response airUp = ta::protocol::makeStatus(Status::AirUp, 30.0f);
+    rec.response(1000, 0, airUp);
+    rec.response(2000, 1, ta::protocol::makeStatus(Status::Checking, 30.5f));
+    rec.response(9000, 0, ta::protocol::makeStatus(Status::Idle, 33.0f));
+    rec.response(9500, 1, ta::protocol::makeStatus(Status::Idle, 33.1f));
+    playBack();
+
+    ta::ui::UiConfig ucfg;
+    RemoteReplay remote(ucfg);
+    ASSERT_EQ(play(snap.data(), snap.size(), remote), 6);
+    EXPECT_EQ(remote.seeks, 1);
+    EXPECT_FLOAT_EQ(remote.lastSeekPsi, ucfg.defaultTargetPsi + ucfg.stepSmall);
+    EXPECT_EQ(remote.ui().view(), ta::ui::View::Idle);
+    EXPECT_EQ(remote.boards().view(0xFF).boards, 2);
+    EXPECT_FLOAT_EQ(remote.boards().view(0xFF).psi, 33.0f);
+}
+
+// ============================================================================
+// Field dump (optional)
+// ============================================================================
+TEST(ReplayFile, FromEnvironment) {
+    const char* path = getenv("TA_REPLAY_FILE");
+    if (!path) GTEST_SKIP() << "set TA_REPLAY_FILE to a console log with a [REC] dump";
+    FILE* f = fopen(path, "rb");
+    ASSERT_NE(f, nullptr) << path;
+    std::string text;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) text.append(buf, n);
+    fclose(f);
+
+    std::vector<uint8_t> snap(text.size() / 2 + 1);
+    snap.resize(parseHex(text.c_str(), "[REC]", snap.data(), snap.size()));
+    BoardReplay replay{ ta::ctl::Config() };
+    long records = play(snap.data(), snap.size(), replay);
+    ASSERT_GE(records, 0) << "no readable [REC] dump in " << path;
+    printf("[REPLAY] %ld records, %u loops, %zu output changes, final state %d, first error at %u ms\n",
+           records, replay.loops(), replay.edges().size(), (int)replay.controller().state(),
+           replay.firstErrorMs());
+    for (const ta::sim::Edge& e : replay.edges()) {
+        printf("[REPLAY] %10u ms  comp=%d vent=%d\n", e.ms, e.comp, e.vent);
+    }
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
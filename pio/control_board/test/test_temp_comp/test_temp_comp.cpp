@@ -0,0 +1,144 @@
+/**
+ * Unit tests for TA_TempComp
+ * Tests the ideal-gas hot/cold pressure conversion against a reference table, the
+ * guards on missing or implausible readings, and the controller applying the
+ * correction to its target when a seek starts
+ */
+
+#include <gtest/gtest.h>
+#include <TA_TempComp.h>
+#include <TA_Controller.h>
+#include "../sim/PlantSim.h"
+
+using namespace ta::ctl;
+using ta::sim::PlantSim;
+using ta::sim::PlantConfig;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class TempCompControllerTest : public ::testing::Test {
+protected:
+    PlantSim plant;
+    Controller ctl;
+    Config cfg;
+    uint32_t now = 0;
+
+    void SetUp() override {
+        cfg.duty.enabled = false;
+        ctl.begin(&plant, cfg);
+        ctl.update(now, plant.psi());
+    }
+};
+
+// Reference: (P_cold + 14.696) * (T_tire + 273.15) / (T_amb + 273.15) - 14.696
+struct RefRow { float coldPsi, ambientC, tireC, hotPsi; };
+static const RefRow kRef[] = {
+    { 35.0f,  20.0f,  50.0f, 40.086f },   // after highway driving
+    { 35.0f,  20.0f,  20.0f, 35.000f },   // cold tire: no change
+    { 32.0f,   0.0f,  40.0f, 38.838f },   // winter, warm tire
+    { 45.0f,  30.0f,  70.0f, 52.877f },   // light truck, summer
+    { 30.0f,  25.0f,  10.0f, 27.751f },   // tire colder than the day will be
+    { 80.0f,  15.0f,  60.0f, 94.789f },   // trailer
+    { 20.0f, -10.0f,  25.0f, 24.615f },   // aired down in the cold
+};
+
+// ============================================================================
+// Conversion Tests
+// ============================================================================
+TEST(TempComp, HotPsi_MatchesReferenceTable) {
+    for (const RefRow& r : kRef) {
+        EXPECT_NEAR(hotPsi(r.coldPsi, r.ambientC, r.tireC), r.hotPsi, 0.005f)
+            << r.coldPsi << " psi, " << r.ambientC << " C -> " << r.tireC << " C";
+    }
+}
+
+TEST(TempComp, ColdPsi_InvertsHotPsi) {
+    for (const RefRow& r : kRef) {
+        EXPECT_NEAR(coldPsi(r.hotPsi, r.ambientC, r.tireC), r.coldPsi, 0.005f);
+    }
+}
+
+TEST(TempComp, RuleOfThumb_AboutOnePsiPerTenFahrenheit) {
+    // 10 F = 5.56 C at a 32 psi placard, 70 F day
+    float d = hotPsi(32.0f, 21.1f, 26.67f) - 32.0f;
+    EXPECT_NEAR(d, 0.88f, 0.05f);
+}
+
+TEST(TempComp, Offset_ZeroWithoutReadings) {
+    TempCompConfig c;
+    EXPECT_FLOAT_EQ(tempOffsetPsi(35.0f, NAN, 50.0f, c), 0.0f);
+    EXPECT_FLOAT_EQ(tempOffsetPsi(35.0f, 20.0f, NAN, c), 0.0f);
+}
+
+TEST(TempComp, Offset_ZeroForImplausibleReadings) {
+    TempCompConfig c;
+    EXPECT_FLOAT_EQ(tempOffsetPsi(35.0f, 20.0f, 250.0f, c), 0.0f);  // open thermistor
+    EXPECT_FLOAT_EQ(tempOffsetPsi(35.0f, -60.0f, 20.0f, c), 0.0f);
+    // 80 psi trailer tire at 20 -> 110 C: a 29 psi correction is not believed
+    EXPECT_FLOAT_EQ(tempOffsetPsi(80.0f, 20.0f, 110.0f, c), 0.0f);
+}
+
+TEST(TempComp, Offset_BothDirections) {
+    TempCompConfig c;
+    EXPECT_NEAR(tempOffsetPsi(35.0f, 20.0f, 50.0f, c), 5.086f, 0.005f);
+    EXPECT_NEAR(tempOffsetPsi(30.0f, 25.0f, 10.0f, c), -2.249f, 0.005f);
+}
+
+// ============================================================================
+// Controller Tests
+// ============================================================================
+TEST_F(TempCompControllerTest, NoTemperatures_TargetAsAsked) {
+    ctl.startSeek(35.0f);
+    EXPECT_FLOAT_EQ(ctl.targetPsi(), 35.0f);
+    EXPECT_FLOAT_EQ(ctl.requestedPsi(), 35.0f);
+    EXPECT_FLOAT_EQ(ctl.tempOffsetPsi(), 0.0f);
+}
+
+TEST_F(TempCompControllerTest, HotTire_TargetRaised) {
+    ctl.setTemperatures(20.0f, 50.0f);
+    ctl.startSeek(35.0f);
+    EXPECT_NEAR(ctl.targetPsi(), 40.086f, 0.005f);
+    EXPECT_FLOAT_EQ(ctl.requestedPsi(), 35.0f);
+    EXPECT_NEAR(ctl.tempOffsetPsi(), 5.086f, 0.005f);
+}
+
+TEST_F(TempCompControllerTest, AppliedAtSeekStartOnly) {
+    ctl.setTemperatures(20.0f, 50.0f);
+    ctl.startSeek(35.0f);
+    float target = ctl.targetPsi();
+    ctl.setTemperatures(20.0f, 30.0f); // tire cooling while it fills
+    plant.step(50);
+    ctl.update(50, plant.psi());
+    EXPECT_FLOAT_EQ(ctl.targetPsi(), target);
+}
+
+TEST_F(TempCompControllerTest, CompensatedTarget_ClampedToMax) {
+    ctl.setTemperatures(20.0f, 60.0f);
+    ctl.startSeek(48.0f);
+    EXPECT_FLOAT_EQ(ctl.targetPsi(), cfg.maxPsi);
+}
+
+TEST_F(TempCompControllerTest, HotFill_CoolsToPlacard) {
+    // Fill hot, then let the tire cool to ambient: it should end at the cold target
+    ctl.setTemperatures(20.0f, 50.0f);
+    ta::sim::runSeek(ctl, plant, now, 35.0f);
+    ASSERT_EQ(ctl.state(), State::IDLE);
+    EXPECT_NEAR(coldPsi(plant.psi(), 20.0f, 50.0f), 35.0f, 0.2f);
+}
+
+TEST_F(TempCompControllerTest, Cancel_ClearsTargets) {
+    ctl.setTemperatures(20.0f, 50.0f);
+    ctl.startSeek(35.0f);
+    ctl.cancel();
+    EXPECT_FLOAT_EQ(ctl.targetPsi(), 0.0f);
+    EXPECT_FLOAT_EQ(ctl.tempOffsetPsi(), 0.0f);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -34,7 +34,11 @@ namespace ta {
         bool TA_BatteryMonitor::update() {
             // Read mV at pin (ADC), then convert to battery-side mV using divider ratio
             uint32_t mvPin = analogReadMilliVolts(pin_);
+#if TA_FIXED_POINT
+            int mvBatt = (int)(((int64_t)mvPin * divider_.raw() + ta::fx::Fixed::kOne / 2) >> ta::fx::Fixed::kFracBits);
+#else
             int mvBatt = (int)lroundf((float)mvPin * cfg_.dividerRatio);
+#endif
 
             // Update rolling average
             pushSample_(mvBatt);
@@ -75,6 +79,12 @@ namespace ta {
         }
 
         void TA_BatteryMonitor::recomputePercent_() {
+#if TA_FIXED_POINT
+            int pct = filteredMv_ <= emptyMv_ ? 0
+                    : filteredMv_ >= emptyMv_ + spanMv_ ? 100
+                    : ((filteredMv_ - emptyMv_) * 100 + spanMv_ / 2) / spanMv_;
+            percent_ = pct;
+#else
             float v = voltage();
             float denom = (cfg_.vFull - cfg_.vEmpty);
             if (denom <= 0.01f) denom = 0.01f;
@@ -84,6 +94,7 @@ namespace ta {
             if (pct > 100.0f) pct = 100.0f;
 
             percent_ = (int)lroundf(pct);
+#endif
         }
 
         void TA_BatteryMonitor::clampConfig_() {
@@ -94,6 +105,12 @@ namespace ta {
             if (cfg_.vFull <= cfg_.vEmpty) cfg_.vFull = cfg_.vEmpty + 0.1f;
             if (cfg_.lowPercent < 0) cfg_.lowPercent = 0;
             if (cfg_.lowPercent > 100) cfg_.lowPercent = 100;
+#if TA_FIXED_POINT
+            divider_ = ta::fx::Fixed::fromFloat(cfg_.dividerRatio);
+            emptyMv_ = (int)lroundf(cfg_.vEmpty * 1000.0f);
+            spanMv_ = (int)lroundf((cfg_.vFull - cfg_.vEmpty) * 1000.0f);
+            if (spanMv_ < 10) spanMv_ = 10;
+#endif
         }
 
     } // namespace battery
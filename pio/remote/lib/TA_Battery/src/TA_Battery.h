@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include <TA_Fixed.h>
 
 namespace ta {
     namespace battery {
@@ -31,7 +32,11 @@ namespace ta {
                 float voltage()      const { return filteredMv_ / 1000.0f; }
                 int   percent()      const { return percent_; }
                 bool  isLow()        const { return percent_ <= cfg_.lowPercent; }
+#if TA_FIXED_POINT
+                bool  isCritical()   const { return filteredMv_ <= emptyMv_; }
+#else
                 bool  isCritical()   const { return voltage() <= cfg_.vEmpty; } // at or below protection threshold
+#endif
                 bool  hasFix()       const { return hasFix_; }
 
                 // Maintenance
@@ -62,6 +67,13 @@ namespace ta {
                 int filteredMv_ = 0;   // battery-side mV after deadbanded average
                 int percent_    = 0;
                 bool hasFix_    = false;
+
+#if TA_FIXED_POINT
+                // From cfg_ in clampConfig_, so update() stays in integers
+                ta::fx::Fixed divider_;
+                int emptyMv_ = 0;
+                int spanMv_  = 0;
+#endif
         };
         
     } // namespace battery
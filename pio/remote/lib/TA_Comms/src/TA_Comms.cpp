@@ -6,8 +6,8 @@ namespace ta {
 
         EspNowLink* EspNowLink::s_instance_ = nullptr;
 
-        static const char* kPrefsNs  = "trailair";
-        static const char* kPrefsKey = "peer";
+        static const char* kPrefsNs  = ta::pairkey::kNvsNamespace;
+        static const char* kPrefsChan = "chan";
 
         EspNowLink::EspNowLink() {
             s_instance_ = this;
@@ -26,62 +26,93 @@ namespace ta {
 
             esp_now_register_recv_cb(&EspNowLink::onRecvStatic);
             esp_now_register_send_cb(&EspNowLink::onSentStatic);
+            esp_now_set_pmk(pmk_);
+            esp_wifi_get_mac(WIFI_IF_STA, selfMac_);
 
             inited_ = true;
-            isConnected_ = false;
-            isConnecting_ = false;
-            lastSeenMs_ = 0;
-            pingBackoffMs_ = 200;
-            nextPingAtMs_ = 0;
+            conns_.begin(connCfg_);
+            rxMask_ = statusMask_ = pongMask_ = leaseAckMask_ = 0;
 
-            // Try persisted peer first
-            loadPeerFromNVS();
+            // Last channel the primary board was heard on, else the shared home channel
+            if (!loadChannel_()) storedChannel_ = homeChannel_;
+            setChannel_(storedChannel_);
 
-            if (!hasPeer_ && peerMac) {
-                memcpy(peer_, peerMac, 6);
-                hasPeer_ = true;
-            }
+            // Try persisted boards first
+            loadPeersFromNVS();
 
-            if (hasPeer_) {
-                if (!ensurePeer_()) {
+            if (!hasPeer() && peerMac) {
+                uint8_t noKey[ta::pairkey::kKeyLen] = {0};
+                boards_.set(0, peerMac, noKey);
+                keyedMask_ = 0;
+                if (!registerPeer_(peerMac, nullptr)) {
         #if TA_COMMS_DEBUG
                     Serial.println("Failed to add peer");
         #endif
                     return false;
                 }
-        #if TA_COMMS_DEBUG
-                Serial.printf("ESP-NOW peer ready %02X:%02X:%02X:%02X:%02X:%02X\n",
-                    peer_[0],peer_[1],peer_[2],peer_[3],peer_[4],peer_[5]);
-        #endif
             }
 
         #if TA_COMMS_DEBUG
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                const ta::peers::Peer& b = boards_.at(i);
+                if (!b.used) continue;
+                Serial.printf("ESP-NOW board %u ready %02X:%02X:%02X:%02X:%02X:%02X (%s)\n", i,
+                    b.mac[0],b.mac[1],b.mac[2],b.mac[3],b.mac[4],b.mac[5], isEncrypted(i) ? "encrypted" : "open");
+            }
             Serial.println("ESP-NOW initialized");
         #endif
             return true;
         }
 
-        bool EspNowLink::ensurePeer_() {
-            if (!hasPeer_) return false;
-            if (esp_now_is_peer_exist(peer_)) return true;
-            esp_now_peer_info_t peerInfo = {};
-            memcpy(peerInfo.peer_addr, peer_, 6);
-            peerInfo.channel = 0;
-            peerInfo.encrypt = false;
-            return esp_now_add_peer(&peerInfo) == ESP_OK;
+        // Add or update the peer; with an LMK the radio encrypts (CCMP) every frame to/from it
+        bool EspNowLink::registerPeer_(const uint8_t mac[6], const uint8_t* lmk) {
+            esp_now_peer_info_t pi = {};
+            memcpy(pi.peer_addr, mac, 6);
+            pi.channel = 0;
+            pi.encrypt = lmk != nullptr;
+            if (lmk) memcpy(pi.lmk, lmk, ta::pairkey::kKeyLen);
+            if (esp_now_is_peer_exist(mac)) return esp_now_mod_peer(&pi) == ESP_OK;
+            return esp_now_add_peer(&pi) == ESP_OK;
+        }
+
+        int8_t EspNowLink::primary_() const {
+            uint8_t used = boards_.usedMask();
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) if (used & (1u << i)) return (int8_t)i;
+            return -1;
+        }
+
+        bool EspNowLink::sendTo_(uint8_t board, const uint8_t* payload, size_t len) {
+            if (!inited_ || board >= ta::peers::kMaxPeers) return false;
+            const ta::peers::Peer& b = boards_.at(board);
+            if (!b.used) return false;
+        #if TA_COMMS_BENCH
+            benchSentUs_ = micros();
+        #endif
+            return esp_now_send(b.mac, payload, len) == ESP_OK;
         }
 
+        // Unicast to every board in the target (each frame is encrypted with that board's key)
         bool EspNowLink::sendRaw_(const uint8_t payload[ta::protocol::kPayloadLen]) {
-            if (!inited_) return false;
-            if (!ensurePeer_()) return false;
-            return esp_now_send(peer_, payload, ta::protocol::kPayloadLen) == ESP_OK;
+            uint8_t mask = boards_.usedMask() & ta::peers::targetMask(target_);
+            bool any = false;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (mask & (1u << i)) any |= sendTo_(i, payload);
+            }
+            return any;
         }
 
+        // Each board gets the target in the wire version it negotiated (0.01 PSI on v2)
         bool EspNowLink::sendStart(float targetPsi) {
-            uint8_t p[ta::protocol::kPayloadLen];
+            uint8_t p[ta::protocol::kMaxPayloadLen];
             ta::protocol::Request r; r.kind = ta::protocol::Request::Kind::Start; r.targetPsi = targetPsi;
-            ta::protocol::packRequest(p, r);
-            return sendRaw_(p);
+            uint8_t mask = boards_.usedMask() & ta::peers::targetMask(target_);
+            bool any = false;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (!(mask & (1u << i))) continue;
+                int len = ta::protocol::packRequest(p, r, boards_.sendProto(i));
+                any |= sendTo_(i, p, (size_t)len);
+            }
+            return any;
         }
         bool EspNowLink::sendCancel() {
             uint8_t p[ta::protocol::kPayloadLen];
@@ -93,19 +124,217 @@ namespace ta {
             uint8_t p[ta::protocol::kPayloadLen];
             ta::protocol::Request r; r.kind = ta::protocol::Request::Kind::Manual; r.manual = static_cast<ta::protocol::ManualCode>(code);
             ta::protocol::packRequest(p, r);
+        #if TA_LATENCY_PROBES
+            ta::probe::probes().mark(ta::probe::Hop::Send, micros());
+        #endif
             return sendRaw_(p);
         }
+
+        void EspNowLink::setManualTiming(const ta::link::LeaseConfig& lease, uint32_t repeatMs) {
+            for (ta::link::ManualLease& l : lease_) l.begin(lease);
+            manualRepeatMs_ = repeatMs;
+        }
+
+        bool EspNowLink::holdManual(uint8_t code) {
+            uint32_t now = ta::time::getMillis();
+        #if TA_LATENCY_PROBES
+            ta::probe::probes().mark(ta::probe::Hop::Send, micros());
+        #endif
+            uint8_t mask = boards_.usedMask() & ta::peers::targetMask(target_);
+            manualHeld_ = true;
+            manualCode_ = code;
+            legacyMask_ = 0;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (!(mask & (1u << i))) continue;
+                if (boards_.sendProto(i) >= ta::protocol::kProtoV2) lease_[i].hold(code, now);
+                else legacyMask_ |= (uint8_t)(1u << i);
+            }
+            bool any = false;
+            if (legacyMask_) {
+                any = sendLegacyManual_(legacyMask_, true);
+                legacySentMs_ = now;
+            }
+            serviceManual_(now);
+            for (const ta::link::ManualLease& l : lease_) any |= l.holding();
+            return any;
+        }
+
+        void EspNowLink::releaseManual() {
+            uint32_t now = ta::time::getMillis();
+            manualHeld_ = false;
+            for (ta::link::ManualLease& l : lease_) l.release(now);
+            if (legacyMask_) sendLegacyManual_(legacyMask_, false);
+            legacyMask_ = 0;
+            serviceManual_(now);
+        }
+
+        // v1 boards: Manual to keep their refresh watchdog fed, Idle to stop
+        bool EspNowLink::sendLegacyManual_(uint8_t mask, bool on) {
+            uint8_t p[ta::protocol::kPayloadLen];
+            ta::protocol::Request r;
+            r.kind = on ? ta::protocol::Request::Kind::Manual : ta::protocol::Request::Kind::Idle;
+            r.manual = static_cast<ta::protocol::ManualCode>(manualCode_);
+            ta::protocol::packRequest(p, r);
+            bool any = false;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (mask & (1u << i)) any |= sendTo_(i, p);
+            }
+            return any;
+        }
+
+        // Grants, renewals, stops and their resends; RTO paces the resends
+        void EspNowLink::serviceManual_(uint32_t now) {
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                ta::link::ManualLease& l = lease_[i];
+                if (!l.active() || l.poll(now, lq_[i].rtoMs()) == ta::link::ManualLease::Send::None) continue;
+                ta::protocol::Request r;
+                r.kind = ta::protocol::Request::Kind::Manual;
+                r.manual = static_cast<ta::protocol::ManualCode>(l.code());
+                r.leased = true;
+                r.seq = l.seq();
+                r.leaseMs = l.leaseMs();
+                uint8_t p[ta::protocol::kMaxPayloadLen];
+                int len = ta::protocol::packRequest(p, r, ta::protocol::kProtoV2);
+                sendTo_(i, p, (size_t)len);
+            }
+            if (legacyMask_ && ta::time::hasElapsed(now, legacySentMs_, manualRepeatMs_)) {
+                sendLegacyManual_(legacyMask_, true);
+                legacySentMs_ = now;
+            }
+        }
+
         bool EspNowLink::sendPing() {
+            bool any = false;
+            uint8_t mask = boards_.usedMask() & ta::peers::targetMask(target_);
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (mask & (1u << i)) any |= sendPing_(i);
+            }
+            return any;
+        }
+        bool EspNowLink::sendPing_(uint8_t board) {
             uint8_t p[ta::protocol::kPayloadLen];
             ta::protocol::Request r; r.kind = ta::protocol::Request::Kind::Ping;
+            r.seq = lq_[board].nextSeq();
             ta::protocol::packRequest(p, r);
-            return sendRaw_(p);
+            if (!sendTo_(board, p)) return false;
+            lq_[board].onPingSent(r.seq, ta::time::getMillis());
+            return true;
+        }
+
+        void EspNowLink::setAdaptiveTiming(bool on, const ta::link::LinkQualityConfig& cfg) {
+            adaptive_ = on;
+            for (ta::link::LinkQuality& q : lq_) q.begin(cfg);
+            adaptTiming_();
+        }
+
+        // The connection tracker has one timing for every board: the slowest paired
+        // board's, so none of them is dropped on a faster one's timeout
+        void EspNowLink::adaptTiming_() {
+            uint8_t used = boards_.usedMask();
+            int8_t slowest = -1;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (!(used & (1u << i))) continue;
+                if (slowest < 0 || lq_[i].connectionTimeoutMs() > lq_[slowest].connectionTimeoutMs()) slowest = (int8_t)i;
+            }
+            const ta::link::LinkQuality& q = lq_[slowest < 0 ? 0 : slowest];
+            connCfg_.timeoutMs = q.connectionTimeoutMs();
+            connCfg_.backoffStartMs = q.pingBackoffStartMs();
+            connCfg_.backoffMaxMs = q.pingBackoffMaxMs();
+            applyTiming_();
+        }
+
+        void EspNowLink::setChannelConfig(uint8_t homeChannel, uint8_t maxChannel, uint8_t sweepAfterPings,
+                                          const ta::link::RetuneConfig& retune) {
+            homeChannel_ = homeChannel;
+            maxChannel_ = maxChannel;
+            sweepAfterPings_ = sweepAfterPings;
+            retune_.begin(retune);
+        }
+
+        bool EspNowLink::setChannel_(uint8_t ch) {
+            if (ch < 1 || ch > ta::link::kMaxWifiChannel) return false;
+            esp_wifi_set_promiscuous(true);
+            bool ok = esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE) == ESP_OK;
+            esp_wifi_set_promiscuous(false);
+            if (ok) channel_ = ch;
+            return ok;
+        }
+
+        bool EspNowLink::loadChannel_() {
+            if (!prefs_.begin(kPrefsNs, true)) return false;
+            uint8_t ch = prefs_.getUChar(kPrefsChan, 0);
+            prefs_.end();
+            if (ch < 1 || ch > maxChannel_) return false;
+            storedChannel_ = ch;
+            return true;
+        }
+
+        bool EspNowLink::saveChannel_(uint8_t ch) {
+            if (!prefs_.begin(kPrefsNs, false)) return false;
+            bool ok = prefs_.putUChar(kPrefsChan, ch) == 1;
+            prefs_.end();
+            if (ok) storedChannel_ = ch;
+            return ok;
+        }
+
+        // Ask the other boards to join ch. They are still on our current channel, so this
+        // has to go out before we move. Returns true if anything was sent.
+        bool EspNowLink::forwardChannel_(uint8_t ch, uint8_t exceptBoard) {
+            uint8_t p[ta::protocol::kPayloadLen];
+            ta::protocol::packChan(p, ch);
+            bool sent = false;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (i == exceptBoard || !boards_.at(i).used) continue;
+                for (uint8_t r = 0; r < kChanJoinRepeats_; ++r) sent |= sendTo_(i, p);
+            }
+            return sent;
+        }
+
+        void EspNowLink::serviceChannel_(uint32_t now) {
+            // Primary board advertised (pairing) or moved (retune) its channel; the others follow
+            uint8_t adv = pendingChan_;
+            if (adv != 0) {
+                pendingChan_ = 0;
+                // Never follow an advert outside the region's channels (the board checks joins the same way)
+                if (adv != channel_ && adv <= maxChannel_) {
+                    int8_t prim = primary_();
+                    bool forwarded = forwardChannel_(adv, prim < 0 ? ta::peers::kAllBoards : (uint8_t)prim);
+                    switchTo_ = adv;
+                    switchAtMs_ = forwarded ? ta::time::futureTime(now, kChanSwitchDelayMs_) : now;
+                }
+            }
+            if (switchTo_ != 0 && ta::time::isTimeFor(now, switchAtMs_)) {
+                uint8_t ch = switchTo_;
+                switchTo_ = 0;
+                if (ch != channel_) {
+                    setChannel_(ch);
+                    for (ta::link::LinkQuality& q : lq_) q.reset();
+                    retune_.reset();
+        #if TA_COMMS_DEBUG
+                    Serial.printf("Channel -> %u\n", ch);
+        #endif
+                }
+            }
+
+            if (conns_.connectedMask() != 0) {
+                sweepStep_ = 0;
+                if (channel_ != storedChannel_ && switchTo_ == 0) saveChannel_(channel_);
+            }
+            int8_t prim = primary_();
+            if (prim >= 0 && conns_.isConnected((uint8_t)prim)) {
+                if (retune_.update(now, lq_[prim].lossRatio(), lq_[prim].pingsSent())) {
+                    uint8_t p[ta::protocol::kPayloadLen];
+                    ta::protocol::packChan(p, ta::protocol::kChanRetuneRequest);
+                    sendTo_((uint8_t)prim, p);
+        #if TA_COMMS_DEBUG
+                    Serial.printf("Requesting retune (loss %.2f)\n", lq_[prim].lossRatio());
+        #endif
+                }
+            }
         }
 
         void EspNowLink::requestReconnect() {
-            if (isConnected_) return;
-            isConnecting_ = true;
-            nextPingAtMs_ = 0; // send immediately
+            conns_.requestReconnect(boards_.usedMask(), ta::time::getMillis());
         }
 
         // Emit helper
@@ -126,59 +355,54 @@ namespace ta {
             if (pairCb_) pairCb_(pairCtx_, ev, mac);
         }
 
-        bool EspNowLink::loadPeerFromNVS() {
-            if (!prefs_.begin(kPrefsNs, true)) return false;
-            size_t len = prefs_.getBytesLength(kPrefsKey);
-            if (len == 6) {
-                uint8_t mac[6];
-                prefs_.getBytes(kPrefsKey, mac, 6);
-                prefs_.end();
-                if (esp_now_is_peer_exist(mac)) {
-                memcpy(peer_, mac, 6);
-                hasPeer_ = true;
-                return true;
-                }
-                // (re)add peer
-                esp_now_peer_info_t pi = {};
-                memcpy(pi.peer_addr, mac, 6);
-                pi.channel = 0;
-                pi.encrypt = false;
-                if (esp_now_add_peer(&pi) == ESP_OK) {
-                memcpy(peer_, mac, 6);
-                hasPeer_ = true;
-                return true;
-                }
-            } else {
-                prefs_.end();
+        uint8_t EspNowLink::loadPeersFromNVS() {
+            // A MAC saved without its LMK (older firmware) reads as unpaired
+            ta::peers::PeerTable loaded;
+            ta::peers::loadPeers(prefs_, loaded);
+            uint8_t n = 0;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                const ta::peers::Peer& b = loaded.at(i);
+                if (!b.used || !registerPeer_(b.mac, b.lmk)) continue;
+                portENTER_CRITICAL(&isrMux_);
+                boards_.set(i, b.mac, b.lmk);
+                portEXIT_CRITICAL(&isrMux_);
+                keyedMask_ |= (uint8_t)(1u << i);
+                conns_.clear(i);
+                n++;
             }
-            return false;
+            return n;
         }
 
-        bool EspNowLink::savePeerToNVS(const uint8_t mac[6]) {
-            if (!mac) return false;
-            if (!prefs_.begin(kPrefsNs, false)) return false;
-            bool ok = prefs_.putBytes(kPrefsKey, mac, 6) == 6;
-            prefs_.end();
+        bool EspNowLink::savePeerToNVS(uint8_t board, const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]) {
+            if (!mac || !lmk || board >= ta::peers::kMaxPeers) return false;
+            bool ok = ta::pairkey::savePeer(prefs_, board, mac, lmk);
             if (ok) {
-                hasPeer_ = true;
-                memcpy(peer_, mac, 6);
+                portENTER_CRITICAL(&isrMux_);
+                boards_.set(board, mac, lmk);
+                portEXIT_CRITICAL(&isrMux_);
+                lq_[board].reset();   // a new board in the slot: none of the old RTT applies
+                keyedMask_ |= (uint8_t)(1u << board);
                 emitPairEvent_(PairEvent::Saved, mac);
             }
             return ok;
         }
 
-        bool EspNowLink::clearPeerFromNVS() {
-            if (!prefs_.begin(kPrefsNs, false)) return false;
-            bool ok = prefs_.remove(kPrefsKey);
-            prefs_.end();
-            if (ok) {
-                if (hasPeer_) {
-                    esp_now_del_peer(peer_);
-                }
-                hasPeer_ = false;
-                uint8_t zero[6] = {0};
-                emitPairEvent_(PairEvent::Cleared, zero);
+        bool EspNowLink::clearPeersFromNVS() {
+            bool ok = true;
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                if (!boards_.at(i).used) continue;
+                ok &= ta::pairkey::clearPeer(prefs_, i);
+                esp_now_del_peer(boards_.at(i).mac);
+                portENTER_CRITICAL(&isrMux_);
+                boards_.clear(i);
+                portEXIT_CRITICAL(&isrMux_);
+                conns_.clear(i);
+                lq_[i].reset();
             }
+            keyedMask_ = 0;
+            target_ = ta::peers::kAllBoards;
+            uint8_t zero[6] = {0};
+            emitPairEvent_(PairEvent::Cleared, zero);
             return ok;
         }
 
@@ -200,23 +424,32 @@ namespace ta {
             pairingTimeoutAt_ = ta::time::futureTime(ta::time::getMillis(), timeoutMs);
             nextPairReqAt_ = 0;
             pairReqIntervalMs_ = 500;
+            haveKeyNonce_ = false;
+            ackPending_ = false;
             ensureBroadcastPeer_();
-            emitPairEvent_(PairEvent::Started, peer_);
+            emitPairEvent_(PairEvent::Started, keyFrom_);
             return true;
         }
 
         void EspNowLink::cancelPairing() {
             if (!pairing_) return;
-            pairing_ = false;
-            emitPairEvent_(PairEvent::Canceled, peer_);
+            stopPairing_(PairEvent::Canceled, nullptr);
         }
 
         void EspNowLink::stopPairing_(PairEvent finalEv, const uint8_t* mac) {
             pairing_ = false;
-            emitPairEvent_(finalEv, mac ? mac : peer_);
+            // The request sweep left the radio wherever it stopped; go back to the boards we have
+            if (finalEv != PairEvent::Acked && hasPeer()) {
+                switchTo_ = storedChannel_;
+                switchAtMs_ = 0;
+                requestReconnect();
+            }
+            emitPairEvent_(finalEv, mac ? mac : keyFrom_);
         }
 
         bool EspNowLink::sendPairReq_() {
+            // Rotate through channels: an unpaired board sits wherever its survey put it
+            setChannel_(ta::link::sweepChannel(storedChannel_, sweepStep_++, maxChannel_));
             uint8_t p[ta::protocol::kPayloadLen];
             ta::protocol::packPairReq(p, pairingGroupId_);
             uint8_t bcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
@@ -229,20 +462,10 @@ namespace ta {
 
             switch (pm.op) {
                 case PairOp::Ack:
-                    if (pm.value == pairingGroupId_) {
-                        stopPairing_(PairEvent::Acked, mac);   // Acked first
-                        savePeerToNVS(mac);                    // then Saved event
-                        // add peer if needed
-                        if (!esp_now_is_peer_exist(mac)) {
-                            esp_now_peer_info_t pi = {};
-                            memcpy(pi.peer_addr, mac, 6);
-                            pi.channel = 0;
-                            pi.encrypt = false;
-                            esp_now_add_peer(&pi);
-                        }
-                        memcpy(peer_, mac, 6);
-                        hasPeer_ = true;
-                        requestReconnect(); // start normal connection attempts
+                    // Only from the board whose Key frame we hold (Acks go out as broadcasts);
+                    // the table is updated from the loop
+                    if (pm.value == pairingGroupId_ && haveKeyNonce_ && memcmp(mac, keyFrom_, 6) == 0) {
+                        ackPending_ = true;
                     }
                     break;
                 case PairOp::Busy:
@@ -253,35 +476,128 @@ namespace ta {
             }
         }
 
+        void EspNowLink::finishPairing_(uint32_t now) {
+            ackPending_ = false;
+            uint8_t mac[6];
+            memcpy(mac, keyFrom_, 6);
+            int8_t slot = boards_.find(mac);         // re-pairing a known board re-keys its slot
+            if (slot < 0) slot = boards_.freeSlot();
+            if (slot < 0) {
+                stopPairing_(PairEvent::Busy, mac);  // no room for another board
+                return;
+            }
+            bool first = (boards_.usedMask() & ~(1u << slot)) == 0;
+
+            uint8_t lmk[ta::pairkey::kKeyLen];
+            ta::pairkey::deriveLmk(pmk_, selfMac_, mac, pairingGroupId_, keyNonce_, lmk);
+            sweepStep_ = 0;
+            stopPairing_(PairEvent::Acked, mac);        // Acked first
+            registerPeer_(mac, lmk);
+            conns_.clear((uint8_t)slot);
+            savePeerToNVS((uint8_t)slot, mac, lmk);     // then Saved event
+            if (first) {
+                pendingChan_ = channel_; // found it here; persisted once connected
+            } else if (channel_ != storedChannel_) {
+                // Found it on another channel: bring it over to where the other boards are
+                uint8_t p[ta::protocol::kPayloadLen];
+                ta::protocol::packChan(p, storedChannel_);
+                for (uint8_t r = 0; r < kChanJoinRepeats_; ++r) sendTo_((uint8_t)slot, p);
+                switchTo_ = storedChannel_;
+                switchAtMs_ = ta::time::futureTime(now, kChanSwitchDelayMs_);
+            }
+            requestReconnect(); // start normal connection attempts
+        }
+
+        // Hand what the radio callback captured over to loop-side state
+        void EspNowLink::drainRx_() {
+            uint8_t heard, statuses, pongs, leaseAcks;
+            uint32_t at[ta::peers::kMaxPeers];
+            uint32_t pongAt[ta::peers::kMaxPeers];
+            uint8_t pongSeq[ta::peers::kMaxPeers];
+            uint32_t leaseAt[ta::peers::kMaxPeers];
+            uint8_t leaseSeq[ta::peers::kMaxPeers];
+            ta::protocol::Response st[ta::peers::kMaxPeers];
+            portENTER_CRITICAL(&isrMux_);
+            heard = rxMask_; statuses = statusMask_; pongs = pongMask_; leaseAcks = leaseAckMask_;
+            rxMask_ = statusMask_ = pongMask_ = leaseAckMask_ = 0;
+            memcpy(at, rxAtMs_, sizeof(at));
+            memcpy(pongAt, pongAtMs_, sizeof(pongAt));
+            memcpy(pongSeq, pongSeq_, sizeof(pongSeq));
+            memcpy(leaseAt, leaseAckAtMs_, sizeof(leaseAt));
+            memcpy(leaseSeq, leaseAckSeq_, sizeof(leaseSeq));
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) st[i] = rxStatus_[i];
+            portEXIT_CRITICAL(&isrMux_);
+
+            for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                uint8_t bit = (uint8_t)(1u << i);
+                if (heard & bit) conns_.heard(i, at[i]);
+                if (pongs & bit) lq_[i].onPong(pongSeq[i], pongAt[i]);
+                if (leaseAcks & bit) lease_[i].onAck(leaseSeq[i], leaseAt[i]);
+                if ((statuses & bit) && cb_) cb_(cbCtx_, i, st[i]);
+            }
+        }
+
+        void EspNowLink::serviceLinkQuality_(uint32_t now) {
+            for (ta::link::LinkQuality& q : lq_) q.expire(now);
+            if (adaptive_) adaptTiming_();
+
+            // Keepalive pings keep the RTT estimate fresh while connected
+            uint8_t up = conns_.connectedMask();
+            if (up && keepalivePingMs_ > 0 && ta::time::isTimeFor(now, nextKeepaliveAtMs_)) {
+                for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) if (up & (1u << i)) sendPing_(i);
+                nextKeepaliveAtMs_ = ta::time::futureTime(now, keepalivePingMs_);
+            }
+        }
+
         void EspNowLink::service() {
             uint32_t now = ta::time::getMillis();
+            drainRx_();
+            serviceManual_(now);
 
             // Skip ping logic while pairing (optional)
             if (!pairing_) {
-                // Read lastSeenMs_ atomically
-                uint32_t lastSeen;
-                portENTER_CRITICAL(&isrMux_);
-                lastSeen = lastSeenMs_;
-                portEXIT_CRITICAL(&isrMux_);
+                serviceLinkQuality_(now);
+                serviceChannel_(now);
 
-                if (isConnected_ && ta::time::hasElapsed(now, lastSeen, connectionTimeoutMs_)) {
-                    isConnected_ = false;
+                uint8_t used = boards_.usedMask();
+                uint8_t wasUp = conns_.connectedMask();
+                uint8_t due = conns_.service(now, used);
         #if TA_COMMS_DEBUG
-                    Serial.println("Connection lost.");
-        #endif
+                uint8_t lost = wasUp & (uint8_t)~conns_.connectedMask();
+                for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) {
+                    if (lost & (1u << i)) Serial.printf("Board %u lost (timeout %u ms).\n", i, (unsigned)connCfg_.timeoutMs);
                 }
-                if (isConnecting_ && !isConnected_) {
-                    if (ta::time::isTimeFor(now, nextPingAtMs_)) {
-                        sendPing();
-                        nextPingAtMs_ = ta::time::futureTime(now, pingBackoffMs_);
-                        pingBackoffMs_ = min(pingBackoffMs_ * 2, pingBackoffMaxMs_);
+        #else
+                (void)wasUp;
+        #endif
+                if (due) {
+                    // Boards may have retuned while we were away: search other channels, but
+                    // only while none is reachable on this one
+                    if (conns_.connectedMask() == 0 && switchTo_ == 0 && conns_.minUnanswered(used) > sweepAfterPings_) {
+                        setChannel_(ta::link::sweepChannel(storedChannel_, ++sweepStep_, maxChannel_));
                     }
+                    for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) if (due & (1u << i)) sendPing_(i);
                 }
             }
 
+        #if TA_COMMS_BENCH
+            ta::link::LatencyStats snap;
+            portENTER_CRITICAL(&isrMux_);
+            if (sendLatency_.count >= 100) { snap = sendLatency_; sendLatency_.reset(); }
+            portEXIT_CRITICAL(&isrMux_);
+            if (snap.count) {
+                // send->ack covers our encrypt + airtime + peer decrypt/ack; srtt adds the pong path
+                Serial.printf("[BENCH] send->ack us: min %u mean %u p99 %u max %u (n=%u, %s) srtt %.1f ms\n",
+                    (unsigned)snap.minUs, (unsigned)snap.meanUs(), (unsigned)snap.p99Us(), (unsigned)snap.maxUs,
+                    (unsigned)snap.count, keyedMask_ ? "encrypted" : "open", lq_[primary_() < 0 ? 0 : primary_()].srttMs());
+            }
+        #endif
+
             if (pairing_) {
-                if (ta::time::isTimeFor(now, pairingTimeoutAt_)) {
-                    stopPairing_(PairEvent::Timeout, peer_);
+                if (ackPending_) {
+                    finishPairing_(now);
+                } else if (ta::time::isTimeFor(now, pairingTimeoutAt_)) {
+                    stopPairing_(PairEvent::Timeout, nullptr);
                 } else if (ta::time::isTimeFor(now, nextPairReqAt_)) {
                     sendPairReq_();
                     nextPairReqAt_ = ta::time::futureTime(now, pairReqIntervalMs_);
@@ -298,32 +614,97 @@ namespace ta {
 
         void EspNowLink::onRecv(const uint8_t* mac, const uint8_t* data, int len) {
           using namespace ta::protocol;
-
-          // Pairing frames
-          if (isPairingFrame(data, len)) {
-            PairMsg pm;
-            if (parsePair(data, len, pm)) {
-              handlePairFrame_(mac, pm);
+          Frame f;
+          if (!decodeFrame(data, len, Dir::ToRemote, f)) return;
+
+          if (f.cls == FrameClass::Pair) {
+            // Key-derivation nonce addressed to us; the Ack that follows completes pairing
+            if (f.pair.op == PairOp::Key) {
+              const PairKey& pk = f.key;
+              if (pairing_ && pk.groupId == pairingGroupId_ && memcmp(pk.target, selfMac_, 6) == 0) {
+                memcpy(keyFrom_, mac, 6);
+                keyNonce_ = pk.nonce;
+                haveKeyNonce_ = true;
+              }
               return;
             }
+            handlePairFrame_(mac, f.pair);
+            return;
           }
 
-          // Normal status
-          Response sm;
-          if (!parseResponse(data, len, sm)) return;
-
-          // Write lastSeenMs_ atomically
+          int8_t slot;
+          bool fromPrimary;
           portENTER_CRITICAL(&isrMux_);
-          lastSeenMs_ = millis();
+          slot = boards_.find(mac);
+          fromPrimary = slot >= 0 && slot == primary_();
           portEXIT_CRITICAL(&isrMux_);
+          if (slot < 0) return;
+          uint8_t bit = (uint8_t)(1u << slot);
 
-          isConnected_ = true;
-          isConnecting_ = false;
+          if (f.cls == FrameClass::Link) {
+            switch (f.link) {
+              case LinkOp::Hello: {
+                // Version offer from a board: settle on the lower of the two and answer with ours
+                portENTER_CRITICAL(&isrMux_);
+                boards_.setProto((uint8_t)slot, negotiate(f.linkValue));
+                portEXIT_CRITICAL(&isrMux_);
+                uint8_t h[2]; packHello(h);
+                esp_now_send(mac, h, 2);
+                return;
+              }
+              case LinkOp::Chan:
+                // Channel advert from the primary board (value 0 is a request, only boards act on it)
+                if (f.linkValue != kChanRetuneRequest && fromPrimary) pendingChan_ = f.linkValue;
+                return;
+              case LinkOp::Pong: {
+                // Pong: proof of life plus an RTT sample (processed in service())
+                uint32_t nowMs = millis();
+                portENTER_CRITICAL(&isrMux_);
+                rxAtMs_[slot] = nowMs;
+                pongSeq_[slot] = f.linkValue;
+                pongAtMs_[slot] = nowMs;
+                rxMask_ |= bit;
+                pongMask_ |= bit;
+                portEXIT_CRITICAL(&isrMux_);
+                return;
+              }
+              case LinkOp::Lease: {
+                // The board has our manual lease frame (handed to lease_ in service())
+                uint32_t nowMs = millis();
+                portENTER_CRITICAL(&isrMux_);
+                rxAtMs_[slot] = nowMs;
+                leaseAckSeq_[slot] = f.linkValue;
+                leaseAckAtMs_[slot] = nowMs;
+                rxMask_ |= bit;
+                leaseAckMask_ |= bit;
+                portEXIT_CRITICAL(&isrMux_);
+                return;
+              }
+            }
+            return;
+          }
 
-          if (cb_) cb_(cbCtx_, sm);
+          // Normal status; the latest per board is delivered from service()
+          portENTER_CRITICAL(&isrMux_);
+          rxAtMs_[slot] = millis();
+          rxStatus_[slot] = f.resp;
+          rxMask_ |= bit;
+          statusMask_ |= bit;
+          portEXIT_CRITICAL(&isrMux_);
         }
 
-        void EspNowLink::onSent(const uint8_t* /*mac*/, esp_now_send_status_t status) {
+        void EspNowLink::onSent(const uint8_t* mac, esp_now_send_status_t status) {
+            (void)mac; (void)status; // only the bench and debug builds look at them
+            #if TA_COMMS_BENCH
+            uint32_t sentUs = benchSentUs_;
+            if (sentUs != 0 && boards_.find(mac) >= 0) {
+                uint32_t us = micros() - sentUs;
+                portENTER_CRITICAL(&isrMux_);
+                sendLatency_.add(us);
+                portEXIT_CRITICAL(&isrMux_);
+                benchSentUs_ = 0;
+            }
+            #endif
             #if TA_COMMS_DEBUG
             Serial.printf("Last Packet Send Status: %s\n", status == ESP_NOW_SEND_SUCCESS ? "Success" : "Fail");
             #endif
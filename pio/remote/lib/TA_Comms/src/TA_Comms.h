@@ -5,11 +5,23 @@
 #include <esp_now.h>
 #include <Preferences.h>
 #include "TA_Protocol.h"
+#include "TA_LinkQuality.h"
+#include "TA_Lease.h"
+#include "TA_ChannelPlan.h"
+#include "TA_PairKey.h"
+#include "TA_PeerTable.h"
+#include "TA_BoardSet.h"
+#include "TA_Probe.h"
 
 #ifndef TA_COMMS_DEBUG
 #define TA_COMMS_DEBUG 1
 #endif
 
+// Measure esp_now_send() -> send-callback latency of peer frames and print it
+#ifndef TA_COMMS_BENCH
+#define TA_COMMS_BENCH 0
+#endif
+
 namespace ta {
     namespace comms {
 
@@ -26,52 +38,87 @@ namespace ta {
         using ta::protocol::Response;
         using ta::protocol::Request;
 
-        typedef void (*StatusCallback)(void* ctx, const Response& msg);
+        // board: peer slot the status came from (0..ta::peers::kMaxPeers-1)
+        typedef void (*StatusCallback)(void* ctx, uint8_t board, const Response& msg);
         typedef void (*PairCallback)(void* ctx, PairEvent ev, const uint8_t mac[6]);
 
         class EspNowLink {
             public:
                 EspNowLink();
 
-                // Setup WIFI STA, init ESP-NOW, register peer and callbacks
+                // Setup WIFI STA, init ESP-NOW, register peers and callbacks.
+                // A peerMac given here (no pairing, no key) is registered unencrypted in slot 0
+                // when nothing is paired.
                 bool begin(const uint8_t peerMac[6]);
 
-                // Send commands
+                // Primary master key shared with the board firmware (call before begin)
+                void setPmk(const uint8_t pmk[ta::pairkey::kKeyLen]) { memcpy(pmk_, pmk, sizeof(pmk_)); }
+                bool isEncrypted(uint8_t board) const { return board < ta::peers::kMaxPeers && (keyedMask_ & (1u << board)); }
+
+                // Boards (up to ta::peers::kMaxPeers, e.g. front and rear axle). Each has its own
+                // connection/backoff state; the lowest paired slot is the primary, whose channel
+                // the remote follows and the others are asked to join.
+                uint8_t boardCount() const { return boards_.count(); }
+                uint8_t boardMask() const { return boards_.usedMask(); }
+                uint8_t connectedMask() const { return conns_.connectedMask(); }
+                bool isBoardConnected(uint8_t board) const { return conns_.isConnected(board); }
+
+                // Commands go to one board or to ta::peers::kAllBoards (default)
+                void setTarget(uint8_t board) { target_ = board; }
+                uint8_t target() const { return target_; }
+
+                // Send commands to the target
                 bool sendStart(float targetPsi);
                 bool sendCancel();
                 bool sendManual(uint8_t code);
                 bool sendPing();
 
-                // Reconnect ping logic with backoff (call service() in loop)
+                // Manual control while a button is held. v2 boards get a lease (granted, renewed
+                // and stopped with acknowledged frames); v1 boards the plain Manual frame every
+                // repeatMs, then Idle. Kept up by service().
+                void setManualTiming(const ta::link::LeaseConfig& lease, uint32_t repeatMs);
+                bool holdManual(uint8_t code);
+                void releaseManual();
+                bool isHoldingManual() const { return manualHeld_; }
+                const ta::link::ManualLease& manualLease(uint8_t board) const { return lease_[board]; }
+
+                // Reconnect ping logic with per-board backoff (call service() in loop; never blocks)
                 void requestReconnect();
                 void service();
 
                 // Connection state (derived from lastSeen + timeout)
-                void setConnectionTimeoutMs(uint32_t ms) { connectionTimeoutMs_ = ms; }
-                void setPingBackoffStartMs(uint32_t ms) { pingBackoffMs_ = ms; }
+                void setConnectionTimeoutMs(uint32_t ms) { connCfg_.timeoutMs = ms; applyTiming_(); }
+                void setPingBackoffStartMs(uint32_t ms) { connCfg_.backoffStartMs = ms; applyTiming_(); }
                 void setPairReqIntervalMs(uint32_t ms) { pairReqIntervalMs_ = ms; }
-                bool isConnected() const { return isConnected_; }
-                bool isConnecting() const { return isConnecting_; }
-                uint32_t lastSeenMs() const { 
-                    uint32_t val;
-                    portENTER_CRITICAL(&isrMux_);
-                    val = lastSeenMs_;
-                    portEXIT_CRITICAL(&isrMux_);
-                    return val;
-                }
-
-                // App callback when a valid status packet arrives
+                // Adaptive timing: derive timeout/backoff from measured RTT and loss
+                // (setters above become the initial values used before any samples)
+                void setAdaptiveTiming(bool on, const ta::link::LinkQualityConfig& cfg);
+                void setKeepalivePingMs(uint32_t ms) { keepalivePingMs_ = ms; }
+                uint32_t connectionTimeoutMs() const { return connCfg_.timeoutMs; }
+                const ta::link::LinkQuality& linkQuality(uint8_t board) const { return lq_[board < ta::peers::kMaxPeers ? board : 0]; }
+
+                // Channel management: follow the board's channel, sweep when it can't be
+                // reached, and ask it to retune when sustained loss crosses the threshold
+                void setChannelConfig(uint8_t homeChannel, uint8_t maxChannel, uint8_t sweepAfterPings,
+                                      const ta::link::RetuneConfig& retune);
+                uint8_t channel() const { return channel_; }
+                // True when any board of the current target is connected / being searched for
+                bool isConnected() const { return (conns_.connectedMask() & ta::peers::targetMask(target_)) != 0; }
+                bool isConnecting() const { return (conns_.connectingMask() & ta::peers::targetMask(target_)) != 0; }
+                uint32_t lastSeenMs(uint8_t board) const { return conns_.at(board).lastSeenMs; }
+
+                // App callback when a valid status packet arrives (called from service())
                 void setStatusCallback(StatusCallback cb, void* ctx) {
                     cb_ = cb; cbCtx_ = ctx;
                 }
 
-                // Persistence
-                bool loadPeerFromNVS();
-                bool savePeerToNVS(const uint8_t mac[6]);
-                bool clearPeerFromNVS();
-                bool hasPeer() const { return hasPeer_; }
+                // Persistence (board slot n uses NVS slot n)
+                uint8_t loadPeersFromNVS();
+                bool savePeerToNVS(uint8_t board, const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]);
+                bool clearPeersFromNVS();
+                bool hasPeer() const { return boards_.count() > 0; }
 
-                // Pairing
+                // Pairing (adds a board, or re-keys one already paired; fails when the table is full)
                 bool startPairing(uint8_t groupId, uint32_t timeoutMs);
                 void cancelPairing();
                 bool isPairing() const { return pairing_; }
@@ -84,38 +131,94 @@ namespace ta {
                 void onRecv(const uint8_t* mac, const uint8_t* data, int len);
                 void onSent(const uint8_t* mac, esp_now_send_status_t status);
 
-                bool ensurePeer_();
+                bool registerPeer_(const uint8_t mac[6], const uint8_t* lmk);
+                bool sendTo_(uint8_t board, const uint8_t* payload, size_t len = ta::protocol::kPayloadLen);
                 bool sendRaw_(const uint8_t payload[ta::protocol::kPayloadLen]);
+                bool sendPing_(uint8_t board);
+                int8_t primary_() const;
+                void applyTiming_() { conns_.setTiming(connCfg_.timeoutMs, connCfg_.backoffStartMs, connCfg_.backoffMaxMs); }
+                void adaptTiming_();
+                void drainRx_();
+                void serviceManual_(uint32_t now);
+                bool sendLegacyManual_(uint8_t mask, bool on);
 
                 void emitPairEvent_(PairEvent ev, const uint8_t mac[6]);
 
                 void handlePairFrame_(const uint8_t* mac, const ta::protocol::PairMsg& pm);
                 void stopPairing_(PairEvent finalEv, const uint8_t* mac);
+                void finishPairing_(uint32_t now);
 
                 bool sendPairReq_();
                 void ensureBroadcastPeer_();
 
+                void serviceLinkQuality_(uint32_t now);
+                void serviceChannel_(uint32_t now);
+                bool forwardChannel_(uint8_t ch, uint8_t exceptBoard);
+                bool setChannel_(uint8_t ch);
+                bool loadChannel_();
+                bool saveChannel_(uint8_t ch);
+
             private:
                 static EspNowLink* s_instance_;
 
-                uint8_t peer_[6] = {0};
+                uint8_t selfMac_[6] = {0};
                 bool inited_ = false;
 
-                // Connection tracking
-                volatile uint32_t lastSeenMs_ = 0;
-                portMUX_TYPE isrMux_ = portMUX_INITIALIZER_UNLOCKED; // Mutex for ISR safety
-                uint32_t connectionTimeoutMs_ = 5000; // ms
-                bool isConnected_ = false;
-                bool isConnecting_ = false;
-
-                // Reconnect backoff
-                uint32_t nextPingAtMs_ = 0;
-                uint32_t pingBackoffMs_ = 200;
-                const uint32_t pingBackoffMaxMs_ = 2000;
+                // Paired boards. Encryption: provisioned PMK, per-board LMK derived at pairing
+                // and kept with the MAC (keyedMask_ bit set). Written from the loop only, under
+                // isrMux_ so the radio callback can look senders up.
+                ta::peers::PeerTable boards_{};
+                uint8_t keyedMask_ = 0;
+                uint8_t pmk_[ta::pairkey::kKeyLen] = {0};
+                uint8_t target_ = ta::peers::kAllBoards;
+
+                // Per-board connection tracking and reconnect backoff (loop only)
+                ta::peers::ConnConfig connCfg_{};
+                ta::peers::BoardConnSet conns_{};
+                mutable portMUX_TYPE isrMux_ = portMUX_INITIALIZER_UNLOCKED; // Mutex for ISR safety
+
+                // Radio callback -> loop handoff, one entry per board (guarded by isrMux_)
+                uint32_t rxAtMs_[ta::peers::kMaxPeers] = {0};
+                ta::protocol::Response rxStatus_[ta::peers::kMaxPeers];
+                uint8_t pongSeq_[ta::peers::kMaxPeers] = {0};
+                uint32_t pongAtMs_[ta::peers::kMaxPeers] = {0};
+                volatile uint8_t rxMask_ = 0;      // heard
+                volatile uint8_t statusMask_ = 0;  // status waiting for the app
+                volatile uint8_t pongMask_ = 0;    // pong waiting for that board's lq_
+                uint8_t leaseAckSeq_[ta::peers::kMaxPeers] = {0};
+                uint32_t leaseAckAtMs_[ta::peers::kMaxPeers] = {0};
+                volatile uint8_t leaseAckMask_ = 0; // lease ack waiting for lease_
+
+                // RTT / loss estimation per board: each has its own path and its own pings
+                ta::link::LinkQuality lq_[ta::peers::kMaxPeers];
+                bool adaptive_ = false;
+                uint32_t keepalivePingMs_ = 0;
+                uint32_t nextKeepaliveAtMs_ = 0;
+
+                // Manual: a lease per v2 board, the resend stream for v1 boards (loop only)
+                ta::link::ManualLease lease_[ta::peers::kMaxPeers];
+                uint32_t manualRepeatMs_ = 300;
+                bool manualHeld_ = false;
+                uint8_t manualCode_ = 0;
+                uint8_t legacyMask_ = 0;
+                uint32_t legacySentMs_ = 0;
+
+                // Channel
+                uint8_t channel_ = 1;          // radio channel right now
+                uint8_t storedChannel_ = 1;    // last channel the board was heard on (NVS)
+                uint8_t homeChannel_ = 1;
+                uint8_t maxChannel_ = 11;
+                uint8_t sweepAfterPings_ = 4;
+                uint8_t sweepStep_ = 0;
+                volatile uint8_t pendingChan_ = 0; // advert from the primary board, applied in service()
+                volatile uint8_t switchTo_ = 0;    // channel change waiting for forwarded joins to go out
+                volatile uint32_t switchAtMs_ = 0;
+                static constexpr uint8_t kChanJoinRepeats_ = 3;
+                static constexpr uint32_t kChanSwitchDelayMs_ = 30;
+                ta::link::RetuneGovernor retune_;
 
                 // Persistence
                 Preferences prefs_;
-                bool hasPeer_ = false;
 
                 // Pairing
                 bool pairing_ = false;
@@ -123,6 +226,15 @@ namespace ta {
                 uint32_t nextPairReqAt_ = 0;
                 uint32_t pairReqIntervalMs_ = 500;
                 uint8_t pairingGroupId_ = 0x01;
+                bool haveKeyNonce_ = false;     // Key frame seen for this pairing attempt
+                uint8_t keyFrom_[6] = {0};
+                uint32_t keyNonce_ = 0;
+                volatile bool ackPending_ = false; // Ack from keyFrom_, completed in service()
+
+        #if TA_COMMS_BENCH
+                volatile uint32_t benchSentUs_ = 0;
+                ta::link::LatencyStats sendLatency_;
+        #endif
 
                 // Callback
                 StatusCallback cb_ = nullptr;
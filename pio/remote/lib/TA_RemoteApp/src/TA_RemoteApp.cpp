@@ -19,26 +19,54 @@ void RemoteApp::begin() {
     ui_->begin(SCREEN_ADDRESS, true);
   }
 
+  // Session recorder (TA_RECORD_BYTES = 0 compiles it out)
+#if TA_RECORD_BYTES
+  rec_.begin(recBuf_, sizeof(recBuf_));
+#endif
+
   // Buttons -> state
   buttons_.begin();
   buttons_.subscribe([](void* ctx, const ta::input::Event& e){
     auto* self = static_cast<RemoteApp*>(ctx);
     self->lastButtonPressedMs_ = ta::time::getMillis();
+    self->rec_.button(self->lastButtonPressedMs_, e);
     self->state_.onButton(e);
   }, this);
 
   // Wakeup setup
   setupWakeup_();
 
-  // Link
+  // Link (key and channel plan must be in place before begin)
+  const ta::cfg::LinkShared linkCfg{};
+  link_.setPmk(linkCfg.pmk);
+  if (linkCfg.pmkIsPublicDefault) Serial.println("Pairing secret is the public default: link is obfuscated, not private.");
+  ta::link::RetuneConfig rc;
+  rc.lossThreshold = linkCfg.retuneLossThreshold;
+  rc.holdMs = linkCfg.retuneHoldMs;
+  rc.cooldownMs = linkCfg.retuneCooldownMs;
+  link_.setChannelConfig(linkCfg.homeChannel, linkCfg.maxChannel, linkCfg.sweepAfterPings, rc);
   if (!link_.begin(nullptr)) {
     Serial.println("ESP-NOW init failed");
   }
   // Configure link from shared config defaults
-  const ta::cfg::LinkShared linkCfg{};
   link_.setConnectionTimeoutMs(linkCfg.connectionTimeoutMs);
   link_.setPingBackoffStartMs(linkCfg.pingBackoffStartMs);
   link_.setPairReqIntervalMs(linkCfg.pairReqIntervalMs);
+  ta::link::LeaseConfig lease;
+  lease.leaseMs = linkCfg.manualLeaseMs;
+  lease.renewMs = linkCfg.manualRenewMs;
+  link_.setManualTiming(lease, linkCfg.manualRepeatMs);
+  if (linkCfg.adaptiveTiming) {
+    ta::link::LinkQualityConfig lq;
+    lq.initialTimeoutMs = linkCfg.connectionTimeoutMs;
+    lq.initialBackoffMs = linkCfg.pingBackoffStartMs;
+    lq.backoffMaxMs = linkCfg.pingBackoffMaxMs;
+    lq.statusIntervalMs = linkCfg.statusIntervalMs;
+    lq.timeoutMinMs = linkCfg.connectionTimeoutMinMs;
+    lq.timeoutMaxMs = linkCfg.connectionTimeoutMaxMs;
+    link_.setAdaptiveTiming(true, lq);
+    link_.setKeepalivePingMs(linkCfg.keepalivePingMs);
+  }
   link_.setStatusCallback(&RemoteApp::onStatusStatic_, this);
   link_.setPairCallback(&RemoteApp::onPairEventStatic_, this);
   Serial.println("ESP-NOW initialized");
@@ -56,15 +84,29 @@ void RemoteApp::begin() {
   }
 }
 
-void RemoteApp::onStatusStatic_(void* ctx, const ta::protocol::Response& msg) {
-  static_cast<RemoteApp*>(ctx)->onStatus_(msg);
+void RemoteApp::onStatusStatic_(void* ctx, uint8_t board, const ta::protocol::Response& msg) {
+  static_cast<RemoteApp*>(ctx)->onStatus_(board, msg);
 }
 void RemoteApp::onPairEventStatic_(void* ctx, ta::comms::PairEvent ev, const uint8_t mac[6]) {
   static_cast<RemoteApp*>(ctx)->onPairEvent_(ev, mac);
 }
 
-void RemoteApp::onStatus_(const ta::protocol::Response& msg) {
-  state_.onStatus(msg);
+void RemoteApp::onStatus_(uint8_t board, const ta::protocol::Response& msg) {
+  rec_.response(ta::time::getMillis(), board, msg);
+  state_.onStatus(board, msg);
+#if TA_RECORD_BYTES
+  // Keep the run-up to each board error on the console for replay
+  uint8_t bit = (uint8_t)(1u << board);
+  if (msg.status != ta::protocol::Status::Error) {
+    recErrorMask_ &= (uint8_t)~bit;
+  } else if (!(recErrorMask_ & bit)) {
+    recErrorMask_ |= bit;
+    if (!recDump_.active()) {   // streamed from loop()
+      rec_.hold(true);
+      recDump_.start("[REC]");
+    }
+  }
+#endif
 }
 void RemoteApp::onPairEvent_(ta::comms::PairEvent ev, const uint8_t mac[6]) {
   state_.onPairEvent(ev, mac);
@@ -79,6 +121,10 @@ void RemoteApp::setupWakeup_() {
 
 void RemoteApp::goToSleep_() {
   Serial.println("Entering light sleep...");
+  const ta::ui::PredictStats& ps = state_.predictionStats();
+  Serial.printf("UI predictions: %u confirmed, %u corrected, %u rolled back (%.0f%% missed)\n",
+                (unsigned)ps.confirmed, (unsigned)ps.corrected, (unsigned)ps.rolledBack, ps.missRate() * 100.0f);
+  link_.setTarget(ta::peers::kAllBoards); // stop every board, not just the selected one
   link_.sendCancel();
   if (ui_) {
     ui_->drawLogo(ta::display::Icons::logo_bmp, ta::display::Icons::LogoW, ta::display::Icons::LogoH);
@@ -166,6 +212,20 @@ void RemoteApp::loop() {
 
   // State update
   state_.update(ta::time::getMillis(), isConn, isConnIng);
+#if TA_RECORD_BYTES
+  if (recDump_.active() && !recDump_.step(Serial, rec_)) rec_.hold(false);
+#endif
+#if TA_LATENCY_PROBES
+  // The remote's hops; the board prints its own, as the clocks aren't shared
+  const ta::link::LatencyStats& sent = ta::probe::probes().segment(ta::probe::Hop::Send);
+  if (sent.count >= latReported_ + TA_LATENCY_REPORT_EVERY) {
+    latReported_ = sent.count;
+    ta::probe::report(Serial, ta::probe::probes(), "[LAT]");
+    for (uint8_t b = 0; b < ta::peers::kMaxPeers; ++b) {
+      if (link_.isBoardConnected(b)) Serial.printf("[LAT] board %u air ~ srtt/2 %.1f ms\n", b, link_.linkQuality(b).srttMs() * 0.5f);
+    }
+  }
+#endif
   if (state_.takeSleepRequest()) {
     goToSleep_();
   }
@@ -6,8 +6,14 @@
 #include <TA_Input.h>
 #include <TA_Display.h>
 #include <TA_Battery.h>
+#include <TA_Replay.h>
 #include <Adafruit_SSD1306.h>
 
+// Bytes of session recording kept in RAM (buttons and board status); 0 disables it
+#ifndef TA_RECORD_BYTES
+#define TA_RECORD_BYTES 4096
+#endif
+
 namespace ta { namespace app {
 
 class RemoteApp {
@@ -28,9 +34,9 @@ public:
 
 private:
   // Callbacks
-  static void onStatusStatic_(void* ctx, const ta::protocol::Response& msg);
+  static void onStatusStatic_(void* ctx, uint8_t board, const ta::protocol::Response& msg);
   static void onPairEventStatic_(void* ctx, ta::comms::PairEvent ev, const uint8_t mac[6]);
-  void onStatus_(const ta::protocol::Response& msg);
+  void onStatus_(uint8_t board, const ta::protocol::Response& msg);
   void onPairEvent_(ta::comms::PairEvent ev, const uint8_t mac[6]);
 
   void setupWakeup_();
@@ -46,6 +52,15 @@ private:
   ta::input::Buttons buttons_;
   ta::battery::TA_BatteryMonitor batteryMon_{};
 
+  // Session recording for replay (see TA_Replay.h)
+  ta::replay::Recorder rec_{};
+#if TA_RECORD_BYTES
+  uint8_t recBuf_[TA_RECORD_BYTES];
+  uint8_t recErrorMask_ = 0;  // boards whose current error was already dumped
+  ta::replay::HexDump recDump_{};   // a line per loop, recording held meanwhile
+#endif
+  uint32_t latReported_ = 0;    // probe traces at the last latency report
+
   // Display (optional)
   Adafruit_SSD1306* disp_ = nullptr;
   ta::display::TA_Display* ui_ = nullptr;
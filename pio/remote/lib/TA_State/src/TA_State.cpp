@@ -23,9 +23,12 @@ StateController::StateController(ta::comms::EspNowLink& link, const Config& cfg)
   uic.maxPsi = cfg_.ui->maxPsi;
   uic.defaultTargetPsi = cfg_.ui->defaultTargetPsi;
   uic.stepSmall = cfg_.ui->stepSmall;
+  uic.stepLarge = cfg_.ui->stepLarge;
+  uic.repeatLargeAfterMs = cfg_.ui->repeatLargeAfterMs;
   uic.doneHoldMs = cfg_.ui->doneHoldMs;
   uic.errorAutoClearMs = cfg_.ui->errorAutoClearMs;
   ui_.begin(uic);
+  predictor_.begin(cfg_.link->predictTimeoutMs);
 }
 
 void StateController::begin() {
@@ -39,6 +42,8 @@ void StateController::resetAfterWake() {
   leftLongHoldActive_ = false;   // clear latch after wake
   errorClearRequested_ = false;
   leftPressed_ = false;
+  predictor_.clear();
+  selectTarget(ta::peers::kAllBoards);
   enter_(RemoteState::DISCONNECTED, millis());
 }
 
@@ -52,32 +57,67 @@ void StateController::onBatteryPercent(int percent) {
   batteryPercent_ = constrain(percent, 0, 100);
 }
 
-void StateController::onStatus(const ta::protocol::Response& msg) {
-  using ta::protocol::Status;
-  if (msg.status != Status::Error) {
-    currentPsi_ = ta::protocol::byteToPsi05(msg.value);
-  } else {
-    lastErrorCode_ = msg.value;
-  }
+void StateController::onStatus(uint8_t board, const ta::protocol::Response& msg) {
+  boards_.onStatus(board, msg);
+  applyView_(millis());
+}
 
-  switch (msg.status) {
-    case Status::Idle:     cState_ = ControlState::IDLE;     break;
-    case Status::AirUp:    cState_ = ControlState::AIRUP;    break;
-    case Status::Venting:  cState_ = ControlState::VENTING;  break;
-    case Status::Checking: cState_ = ControlState::CHECKING; break;
-    case Status::Error:    cState_ = ControlState::ERROR;    break;
+// Fold the targeted boards' last status into the single view the UI runs on.
+// Boards that dropped off the link don't count, so a stale error can't stick.
+void StateController::applyView_(uint32_t now) {
+  using ta::protocol::Status;
+  uint8_t mask = ta::peers::targetMask(target_) & link_.connectedMask();
+  view_ = boards_.view(mask);
+  if (view_.valid) {
+    if (view_.hasPsi) currentPsi_ = view_.psi;
+    if (view_.status == Status::Error) lastErrorCode_ = view_.errorCode;
+
+    switch (view_.status) {
+      case Status::Idle:     reported_ = ControlState::IDLE;     break;
+      case Status::AirUp:    reported_ = ControlState::AIRUP;    break;
+      case Status::Venting:  reported_ = ControlState::VENTING;  break;
+      case Status::Checking: reported_ = ControlState::CHECKING; break;
+      case Status::Error:    reported_ = ControlState::ERROR;    break;
+    }
   }
+  // Also runs without a fresh status so an unconfirmed prediction times out
+  cState_ = fromUiCtrl(predictor_.reconcile(now, toUiCtrl(reported_)));
+  if (!view_.valid) return;
 
   // Leave ERROR view when board recovers
-  if (rState_ == RemoteState::ERROR && msg.status != Status::Error) {
+  if (rState_ == RemoteState::ERROR && view_.status != Status::Error) {
     errorClearRequested_ = false; // allow future auto-clears
-    enter_(RemoteState::IDLE, millis());
+    enter_(RemoteState::IDLE, now);
+  }
+}
+
+void StateController::selectTarget(uint8_t board) {
+  if (board != ta::peers::kAllBoards && !(link_.boardMask() & (1u << board))) board = ta::peers::kAllBoards;
+  target_ = board;
+  link_.setTarget(board);
+  predictor_.clear(); // the view now follows other boards
+  applyView_(millis());
+}
+
+// Show the state a command just sent should produce, until status confirms or
+// contradicts it
+void StateController::predict_(ControlState expected, uint8_t acceptMask) {
+  cState_ = fromUiCtrl(predictor_.predict(millis(), toUiCtrl(reported_), toUiCtrl(expected), acceptMask));
+}
+
+void StateController::selectNextBoard_() {
+  uint8_t used = link_.boardMask();
+  uint8_t from = target_ == ta::peers::kAllBoards ? 0 : (uint8_t)(target_ + 1);
+  for (uint8_t i = from; i < ta::peers::kMaxPeers; ++i) {
+    if (used & (1u << i)) { selectTarget(i); return; }
   }
+  selectTarget(ta::peers::kAllBoards);
 }
 
 void StateController::update(uint32_t now, bool isConnected, bool isConnecting) {
   isConnected_ = isConnected;
   isConnecting_ = isConnecting;
+  applyView_(now);
 
   // Pairing failure hold auto-exit
   if (rState_ == RemoteState::PAIRING && pairingFailed_) {
@@ -87,9 +127,11 @@ void StateController::update(uint32_t now, bool isConnected, bool isConnecting)
     }
   }
 
-  // Shared UI update (delegates error autoclear Cancel)
+  // Shared UI update (delegates error autoclear Cancel). It runs on what the boards
+  // reported: a prediction is only for display, so a Start that never arrived can't
+  // count as seek activity and end in Done when it rolls back.
   RemoteActions ra; ra.self = this;
-  ui_.update(now, ra, toUiCtrl(cState_));
+  ui_.update(now, ra, toUiCtrl(reported_));
 
   // Keep rState_ aligned with shared view
   switch (ui_.view()) {
@@ -101,19 +143,11 @@ void StateController::update(uint32_t now, bool isConnected, bool isConnecting)
     case ta::ui::View::Pairing:      rState_ = RemoteState::PAIRING; break;
   }
 
-  // Manual resend while truly in Manual
-  if (ui_.view() == ta::ui::View::Manual && manualSending_) {
-    if (now - lastManualSentMs_ >= cfg_.link->manualRepeatMs) {
-      link_.sendManual(manualCode_);
-      lastManualSentMs_ = now;
-    }
-  }
-
-  // If we left Manual due to error or other transitions, stop manual stream
+  // If we left Manual due to error or other transitions, end the manual hold
+  // (link_.service() keeps it up while it lasts)
   if (ui_.view() != ta::ui::View::Manual && manualSending_) {
-    link_.sendCancel();
+    link_.releaseManual();
     manualSending_ = false;
-    lastManualSentMs_ = 0;
     manualCode_ = 0x00;
   }
 }
@@ -125,10 +159,9 @@ void StateController::enter_(RemoteState s, uint32_t now) {
 
   if (rPrev_ == RemoteState::MANUAL && rState_ != RemoteState::MANUAL) {
     if (manualSending_) {
-      link_.sendCancel();
+      link_.releaseManual();
       manualSending_ = false;
     }
-    lastManualSentMs_ = 0;
     manualCode_ = 0x00;
   }
 
@@ -172,13 +205,25 @@ void StateController::onButton(const ta::input::Event& e) {
       return;
     }
     if (leftLongHoldActive_) return; // swallow all following left events until wake
-    if (e.action == ta::input::Action::Click && leftPressed_) return; // ignore repeat clicks while held
+    if (e.action == ta::input::Action::Repeat) return; // holding Left only matters for sleep
     if ((e.action == ta::input::Action::Click || e.action == ta::input::Action::Released) && now < suppressLeftClicksUntil_) return;
   }
 
-  // Disconnected & Pairing shortcuts remain remote-specific
+  // Disconnected & Pairing shortcuts remain remote-specific.
+  // Right click pairs the first board, or reconnects; Right double-click adds another board.
+  bool rightDouble = e.id == ta::input::ButtonId::Right && e.action == ta::input::Action::Click && e.clicks >= 2;
+  if (rightDouble && (rState_ == RemoteState::DISCONNECTED || rState_ == RemoteState::IDLE)) {
+    if (canStartPairing()) link_.startPairing(cfg_.link->pairGroupId, cfg_.link->pairTimeoutMs);
+    return;
+  }
   if (rState_ == RemoteState::DISCONNECTED && e.id == ta::input::ButtonId::Right && e.action == ta::input::Action::Click) {
-    if (canStartPairing()) link_.startPairing(cfg_.link->pairGroupId, cfg_.link->pairTimeoutMs); else link_.requestReconnect();
+    if (!link_.hasPeer()) link_.startPairing(cfg_.link->pairGroupId, cfg_.link->pairTimeoutMs); else link_.requestReconnect();
+    return;
+  }
+  // Left double-click picks which board(s) the next command goes to
+  if (rState_ == RemoteState::IDLE && e.id == ta::input::ButtonId::Left && e.action == ta::input::Action::Click &&
+      e.clicks >= 2 && link_.boardCount() > 1) {
+    selectNextBoard_();
     return;
   }
   if (rState_ == RemoteState::PAIRING) {
@@ -197,7 +242,9 @@ void StateController::onButton(const ta::input::Event& e) {
     e.id == ta::input::ButtonId::Up   ? ta::ui::Button::Up   : ta::ui::Button::Right,
     e.action == ta::input::Action::Pressed ? ta::ui::Action::Pressed :
     e.action == ta::input::Action::Released? ta::ui::Action::Released:
-    e.action == ta::input::Action::Click   ? ta::ui::Action::Click   : ta::ui::Action::LongHold
+    e.action == ta::input::Action::Click   ? ta::ui::Action::Click   :
+    e.action == ta::input::Action::Repeat  ? ta::ui::Action::Repeat  : ta::ui::Action::LongHold,
+    e.heldMs
   };
   ui_.onButton(be, ra);
 
@@ -221,6 +268,11 @@ void StateController::buildDisplayModel(ta::display::DisplayModel& dm) const {
   }
 
   dm.currentPSI = currentPsi_;
+  dm.boardCount = link_.boardCount();
+  dm.boardTarget = target_ == ta::peers::kAllBoards ? 0 : (uint8_t)(target_ + 1);
+  dm.boardsConnected = 0;
+  for (uint8_t i = 0; i < ta::peers::kMaxPeers; ++i) if (link_.connectedMask() & (1u << i)) dm.boardsConnected++;
+  dm.psiSpread = (view_.valid && view_.hasPsi) ? view_.psiMax - view_.psiMin : 0.0f;
   dm.targetPSI  = ui_.targetPsi();
   dm.lastErrorCode = lastErrorCode_;
   dm.seekingShowDoneHold = ui_.isDoneHoldActive(millis());
@@ -242,7 +294,7 @@ void StateController::buildDisplayModel(ta::display::DisplayModel& dm) const {
 }
 
 bool StateController::canStartPairing() const {
-  return !link_.hasPeer(); // only allow if no persisted peer yet
+  return link_.boardCount() < ta::peers::kMaxPeers; // a free board slot
 }
 
 void StateController::onPairEvent(ta::comms::PairEvent ev, const uint8_t* /*mac*/) {
@@ -282,22 +334,37 @@ void StateController::RemoteActions::cancel() {
     if (!self->errorClearRequested_) {
       self->link_.sendCancel();
       self->errorClearRequested_ = true;
+      self->predict_(ControlState::IDLE);
     }
   } else {
     self->link_.sendCancel();
+    self->predict_(ControlState::IDLE);
   }
 }
-void StateController::RemoteActions::startSeek(float targetPsi) { if (self) self->link_.sendStart(targetPsi); }
+void StateController::RemoteActions::startSeek(float targetPsi) {
+  if (!self) return;
+  self->link_.sendStart(targetPsi);
+  // Direction is a guess from the last reading; any active state shows the seek took
+  using ta::ui::Ctrl;
+  self->predict_(targetPsi >= self->currentPsi_ ? ControlState::AIRUP : ControlState::VENTING,
+                 ta::ui::ctrlBit(Ctrl::AirUp) | ta::ui::ctrlBit(Ctrl::Venting) | ta::ui::ctrlBit(Ctrl::Checking));
+}
+// The board re-plans the running seek; what it shows doesn't change, so nothing to predict
+void StateController::RemoteActions::retarget(float targetPsi) {
+  if (!self) return;
+  self->link_.sendStart(targetPsi);
+}
 void StateController::RemoteActions::manualVent(bool on) {
   if (!self) return;
   if (on && !self->manualSending_) {
     self->manualCode_ = 0x00;
     self->manualSending_ = true;
-    self->lastManualSentMs_ = millis();
-    self->link_.sendManual(self->manualCode_);
+    self->link_.holdManual(self->manualCode_);
+    self->predict_(ControlState::VENTING);
   } else if (!on && self->manualSending_ && self->manualCode_ == 0x00) {
     self->manualSending_ = false;
-    self->link_.sendCancel();
+    self->link_.releaseManual();
+    self->predict_(ControlState::IDLE);
   }
 }
 void StateController::RemoteActions::manualAirUp(bool on) {
@@ -305,11 +372,12 @@ void StateController::RemoteActions::manualAirUp(bool on) {
   if (on && !self->manualSending_) {
     self->manualCode_ = 0xFF;
     self->manualSending_ = true;
-    self->lastManualSentMs_ = millis();
-    self->link_.sendManual(self->manualCode_);
+    self->link_.holdManual(self->manualCode_);
+    self->predict_(ControlState::AIRUP);
   } else if (!on && self->manualSending_ && self->manualCode_ == 0xFF) {
     self->manualSending_ = false;
-    self->link_.sendCancel();
+    self->link_.releaseManual();
+    self->predict_(ControlState::IDLE);
   }
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 #include <stdint.h>
 #include <TA_UI.h>
+#include <TA_Predict.h>
 #include <TA_Protocol.h>
+#include <TA_BoardSet.h>
 
 // Forward declarations to avoid including Arduino and heavy headers here
 namespace ta { namespace display { struct DisplayModel; } }
@@ -30,12 +32,17 @@ public:
   void update(uint32_t now, bool isConnected, bool isConnecting);
 
   // Inputs
-  void onStatus(const ta::protocol::Response& msg);
+  void onStatus(uint8_t board, const ta::protocol::Response& msg);
   void onBatteryPercent(int percent);
   void onButton(const ta::input::Event& e);
   void onPairEvent(ta::comms::PairEvent ev, const uint8_t mac[6]);
   bool canStartPairing() const; 
 
+  // Board selection with several boards paired: ta::peers::kAllBoards or a slot.
+  // Left double-click in Idle steps All -> board 1 -> board 2 ... -> All.
+  uint8_t target() const { return target_; }
+  void selectTarget(uint8_t board);
+
   // UI
   void buildDisplayModel(ta::display::DisplayModel& dm) const;
 
@@ -47,14 +54,19 @@ public:
 
   // Accessors (if needed elsewhere)
   RemoteState remoteState() const { return rState_; }
-  ControlState controlState() const { return cState_; }
-  float currentPsi() const { return currentPsi_; }
+  ControlState controlState() const { return cState_; }  // optimistic: see predict_()
+  ControlState reportedState() const { return reported_; } // as the boards last said
+  float currentPsi() const { return currentPsi_; }  // lowest of the targeted boards
   float targetPsi() const { return ui_.targetPsi(); }
   uint8_t lastError() const { return lastErrorCode_; }
+  const ta::ui::PredictStats& predictionStats() const { return predictor_.stats(); }
 
 private:
   void enter_(RemoteState s, uint32_t now);
   void handleButtonsDisconnected_(const ta::input::Event& e, uint32_t now);
+  void applyView_(uint32_t now);
+  void selectNextBoard_();
+  void predict_(ControlState expected, uint8_t acceptMask = 0);
 
   // Device action bridge for UI layer
   struct RemoteActions : ta::ui::DeviceActions {
@@ -63,6 +75,7 @@ private:
     void cancel() override;
     void clearError() override { cancel(); }
     void startSeek(float targetPsi) override;
+    void retarget(float targetPsi) override;
     void manualVent(bool on) override;
     void manualAirUp(bool on) override;
   };
@@ -78,6 +91,17 @@ private:
     return ta::ui::Ctrl::Idle;
   }
 
+  static inline ControlState fromUiCtrl(ta::ui::Ctrl c) {
+    switch (c) {
+      case ta::ui::Ctrl::Idle: return ControlState::IDLE;
+      case ta::ui::Ctrl::AirUp: return ControlState::AIRUP;
+      case ta::ui::Ctrl::Venting: return ControlState::VENTING;
+      case ta::ui::Ctrl::Checking: return ControlState::CHECKING;
+      case ta::ui::Ctrl::Error: return ControlState::ERROR;
+    }
+    return ControlState::IDLE;
+  }
+
 private:
   ta::comms::EspNowLink& link_;
   Config cfg_;
@@ -88,14 +112,22 @@ private:
   // Domain state
   RemoteState rState_ = RemoteState::DISCONNECTED;
   RemoteState rPrev_  = RemoteState::DISCONNECTED;
-  ControlState cState_ = ControlState::IDLE;
+  ControlState cState_ = ControlState::IDLE;    // shown: the prediction while one is open
+  ControlState reported_ = ControlState::IDLE;  // boards' last status
+
+  // Optimistic state after a command, reconciled against status
+  ta::ui::CtrlPredictor predictor_{};
 
   float currentPsi_ = 0.0f;
 
-  // Manual
+  // Per-board status and the selection the view/commands apply to
+  ta::peers::BoardStatusSet boards_{};
+  uint8_t target_ = ta::peers::kAllBoards;
+  ta::peers::BoardView view_{};
+
+  // Manual (held by the link while manualSending_)
   bool manualSending_ = false;
   uint8_t manualCode_ = 0x00; // 0x00=vent, 0xFF=air
-  uint32_t lastManualSentMs_ = 0;
 
   // Errors and battery
   uint8_t lastErrorCode_ = 0;
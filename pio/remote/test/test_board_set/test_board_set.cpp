@@ -0,0 +1,234 @@
+/**
+ * Unit tests for TA_BoardSet
+ * Tests per-board connection/backoff on the remote and the aggregated status view
+ * across several boards (e.g. front and rear axle)
+ */
+
+#include <gtest/gtest.h>
+#include <TA_BoardSet.h>
+
+using namespace ta::peers;
+using ta::protocol::Response;
+using ta::protocol::Status;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class BoardConnTest : public ::testing::Test {
+protected:
+    BoardConnSet conns;
+    ConnConfig cfg;
+
+    void SetUp() override {
+        cfg.timeoutMs = 5000;
+        cfg.backoffStartMs = 200;
+        cfg.backoffMaxMs = 2000;
+        conns.begin(cfg);
+    }
+};
+
+class BoardStatusTest : public ::testing::Test {
+protected:
+    BoardStatusSet set;
+
+    static Response status(Status s, float psi) {
+        return ta::protocol::makeStatus(s, psi);
+    }
+    static Response error(uint8_t code, uint8_t detail = 0) {
+        return ta::protocol::makeError(code, detail);
+    }
+};
+
+// ============================================================================
+// Target Tests
+// ============================================================================
+TEST(BoardTarget, AllAndSingle) {
+    EXPECT_EQ(targetMask(kAllBoards), (1u << kMaxPeers) - 1);
+    EXPECT_EQ(targetMask(0), 0x01);
+    EXPECT_EQ(targetMask(2), 0x04);
+    EXPECT_EQ(targetMask(kMaxPeers), 0x00);
+}
+
+// ============================================================================
+// Connection / Backoff Tests
+// ============================================================================
+TEST_F(BoardConnTest, Initially_NothingConnectedNothingDue) {
+    EXPECT_EQ(conns.connectedMask(), 0);
+    EXPECT_EQ(conns.service(0, 0x03), 0);
+}
+
+TEST_F(BoardConnTest, Reconnect_FirstPingImmediately) {
+    conns.requestReconnect(0x03, 1000);
+    EXPECT_EQ(conns.connectingMask(), 0x03);
+    EXPECT_EQ(conns.service(1000, 0x03), 0x03);
+    EXPECT_EQ(conns.service(1001, 0x03), 0x00);
+}
+
+TEST_F(BoardConnTest, Backoff_DoublesUpToMax) {
+    conns.requestReconnect(0x01, 0);
+    uint32_t pings[8];
+    int n = 0;
+    for (uint32_t t = 0; t <= 12000 && n < 8; t += 10) {
+        if (conns.service(t, 0x01)) pings[n++] = t;
+    }
+    ASSERT_EQ(n, 8);
+    EXPECT_EQ(pings[1] - pings[0], 200u);
+    EXPECT_EQ(pings[2] - pings[1], 400u);
+    EXPECT_EQ(pings[3] - pings[2], 800u);
+    EXPECT_EQ(pings[4] - pings[3], 1600u);
+    EXPECT_EQ(pings[5] - pings[4], 2000u);
+    EXPECT_EQ(pings[7] - pings[6], 2000u);
+    EXPECT_EQ(conns.at(0).unanswered, 8);
+}
+
+TEST_F(BoardConnTest, Heard_ConnectsAndStopsPinging) {
+    conns.requestReconnect(0x01, 0);
+    conns.service(0, 0x01);
+    conns.heard(0, 50);
+    EXPECT_TRUE(conns.isConnected(0));
+    EXPECT_EQ(conns.at(0).unanswered, 0);
+    for (uint32_t t = 60; t < 4000; t += 10) EXPECT_EQ(conns.service(t, 0x01), 0);
+}
+
+TEST_F(BoardConnTest, Timeout_DisconnectsOnlyThatBoard) {
+    conns.heard(0, 1000);
+    conns.heard(1, 1000);
+    conns.heard(1, 4000);
+    conns.service(6500, 0x03);
+    EXPECT_FALSE(conns.isConnected(0));
+    EXPECT_TRUE(conns.isConnected(1));
+    EXPECT_EQ(conns.connectedMask(), 0x02);
+}
+
+TEST_F(BoardConnTest, Boards_BackOffIndependently) {
+    // Board 0 answers every ping, board 1 never does
+    conns.requestReconnect(0x03, 0);
+    int pings1 = 0;
+    for (uint32_t t = 0; t < 10000; t += 10) {
+        uint8_t due = conns.service(t, 0x03);
+        if (due & 0x01) conns.heard(0, t + 5);
+        if (due & 0x02) pings1++;
+        if (conns.isConnected(0) && t % 1000 == 0) conns.heard(0, t);
+    }
+    EXPECT_TRUE(conns.isConnected(0));
+    EXPECT_FALSE(conns.isConnected(1));
+    EXPECT_LE(pings1, 9); // 200,400,800,1600 then every 2 s
+    EXPECT_GE(pings1, 6);
+}
+
+TEST_F(BoardConnTest, UnusedSlots_Ignored) {
+    conns.requestReconnect(0x0F, 0);
+    EXPECT_EQ(conns.service(0, 0x05), 0x05);
+}
+
+TEST_F(BoardConnTest, MinUnanswered_AcrossSearchingBoards) {
+    EXPECT_EQ(conns.minUnanswered(0x03), 0xFF);
+    conns.requestReconnect(0x03, 0);
+    conns.service(0, 0x03);
+    conns.service(200, 0x03);
+    conns.heard(1, 250);
+    EXPECT_EQ(conns.minUnanswered(0x03), 2); // board 1 found, board 0 still searching
+}
+
+TEST_F(BoardConnTest, SetTiming_AppliesToNextLoss) {
+    conns.heard(0, 0);
+    conns.setTiming(1500, 100, 800);
+    conns.service(1600, 0x01);
+    EXPECT_FALSE(conns.isConnected(0));
+    conns.requestReconnect(0x01, 1600);
+    conns.service(1600, 0x01);
+    EXPECT_EQ(conns.at(0).nextPingAtMs, 1700u);
+}
+
+// ============================================================================
+// Aggregated View Tests
+// ============================================================================
+TEST_F(BoardStatusTest, NoStatus_Invalid) {
+    EXPECT_FALSE(set.view(targetMask(kAllBoards)).valid);
+}
+
+TEST_F(BoardStatusTest, SingleBoard_PassesThrough) {
+    set.onStatus(0, status(Status::AirUp, 31.5f));
+    BoardView v = set.view(targetMask(kAllBoards));
+    ASSERT_TRUE(v.valid);
+    EXPECT_EQ(v.status, Status::AirUp);
+    EXPECT_FLOAT_EQ(v.psi, 31.5f);
+    EXPECT_EQ(v.boards, 1);
+}
+
+TEST_F(BoardStatusTest, TwoBoards_LowestPsiAndSpread) {
+    set.onStatus(0, status(Status::Idle, 34.0f));
+    set.onStatus(1, status(Status::Idle, 30.0f));
+    BoardView v = set.view(targetMask(kAllBoards));
+    EXPECT_FLOAT_EQ(v.psi, 30.0f);
+    EXPECT_FLOAT_EQ(v.psiMin, 30.0f);
+    EXPECT_FLOAT_EQ(v.psiMax, 34.0f);
+    EXPECT_EQ(v.boards, 2);
+}
+
+TEST_F(BoardStatusTest, AnyError_Wins) {
+    set.onStatus(0, status(Status::AirUp, 30.0f));
+    set.onStatus(1, error(5));
+    BoardView v = set.view(targetMask(kAllBoards));
+    EXPECT_EQ(v.status, Status::Error);
+    EXPECT_EQ(v.errorCode, 5);
+    EXPECT_TRUE(v.hasPsi); // the healthy board still reports pressure
+    EXPECT_FLOAT_EQ(v.psi, 30.0f);
+}
+
+TEST_F(BoardStatusTest, ErrorDetail_PassedThrough) {
+    set.onStatus(0, error(9, 15)); // LEAK at 1.5 psi/min
+    BoardView v = set.view(targetMask(kAllBoards));
+    EXPECT_EQ(v.errorCode, 9);
+    EXPECT_EQ(v.errorDetail, 15);
+}
+
+TEST_F(BoardStatusTest, CompensatedTarget_HighestReported) {
+    set.onStatus(0, status(Status::AirUp, 30.0f));
+    EXPECT_FALSE(set.view(targetMask(kAllBoards)).hasTarget);
+    set.onStatus(1, ta::protocol::makeStatus(Status::AirUp, 31.0f, 38.5f));
+    set.onStatus(2, ta::protocol::makeStatus(Status::Checking, 33.0f, 37.0f));
+    BoardView v = set.view(targetMask(kAllBoards));
+    EXPECT_TRUE(v.hasTarget);
+    EXPECT_FLOAT_EQ(v.targetPsi, 38.5f);
+}
+
+TEST_F(BoardStatusTest, IdleOnlyWhenEveryBoardIsIdle) {
+    set.onStatus(0, status(Status::Idle, 32.0f));
+    set.onStatus(1, status(Status::Checking, 31.0f));
+    EXPECT_EQ(set.view(0x03).status, Status::Checking);
+    set.onStatus(1, status(Status::Venting, 33.0f));
+    EXPECT_EQ(set.view(0x03).status, Status::Venting);
+    set.onStatus(0, status(Status::AirUp, 28.0f));
+    EXPECT_EQ(set.view(0x03).status, Status::AirUp);
+    set.onStatus(0, status(Status::Idle, 32.0f));
+    set.onStatus(1, status(Status::Idle, 32.0f));
+    EXPECT_EQ(set.view(0x03).status, Status::Idle);
+}
+
+TEST_F(BoardStatusTest, SelectedBoard_OnlyItsState) {
+    set.onStatus(0, status(Status::AirUp, 28.0f));
+    set.onStatus(1, error(3));
+    BoardView v = set.view(targetMask(0));
+    EXPECT_EQ(v.status, Status::AirUp);
+    EXPECT_FLOAT_EQ(v.psi, 28.0f);
+    v = set.view(targetMask(1));
+    EXPECT_EQ(v.status, Status::Error);
+    EXPECT_FALSE(v.hasPsi);
+}
+
+TEST_F(BoardStatusTest, ClearedBoard_DropsOut) {
+    set.onStatus(0, status(Status::Idle, 32.0f));
+    set.onStatus(1, error(3));
+    set.clear(1);
+    EXPECT_EQ(set.view(0x03).status, Status::Idle);
+    EXPECT_FALSE(set.has(1));
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
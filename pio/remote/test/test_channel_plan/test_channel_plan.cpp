@@ -0,0 +1,232 @@
+/**
+ * Unit tests for TA_ChannelPlan
+ * Tests channel scoring, retune decisions, the peer search order, and a closed-loop
+ * run against a simulated per-channel loss model
+ */
+
+#include <gtest/gtest.h>
+#include <TA_ChannelPlan.h>
+#include <TA_LinkQuality.h>
+#include <set>
+
+using namespace ta::link;
+
+// ============================================================================
+// Simulated RF environment - per-channel loss plus the APs a scan would see
+// ============================================================================
+class SimChannels {
+public:
+    float loss[kMaxWifiChannel + 1] = {0};
+
+    struct Ap { uint8_t ch; int8_t rssi; };
+    Ap aps[16];
+    int apCount = 0;
+
+    void addAp(uint8_t ch, int8_t rssi) { aps[apCount++] = { ch, rssi }; }
+
+    void survey(ChannelPlanner& p) const {
+        p.clearSurvey();
+        for (int i = 0; i < apCount; ++i) p.addAp(aps[i].ch, aps[i].rssi);
+    }
+
+    // Deterministic LCG so runs are reproducible
+    bool delivered(uint8_t ch) {
+        seed_ = seed_ * 1664525u + 1013904223u;
+        float u = (seed_ >> 8) / 16777216.0f;
+        return u >= loss[ch];
+    }
+
+private:
+    uint32_t seed_ = 12345;
+};
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class ChannelPlanTest : public ::testing::Test {
+protected:
+    ChannelPlanner planner;
+    ChannelPlanConfig cfg;
+
+    void SetUp() override {
+        cfg.maxChannel = 11;
+        planner.begin(cfg);
+    }
+};
+
+// ============================================================================
+// Planner Tests
+// ============================================================================
+TEST_F(ChannelPlanTest, EmptySurvey_KeepsCurrent) {
+    EXPECT_EQ(planner.pick(6), 6);
+}
+
+TEST_F(ChannelPlanTest, StrongApOnChannel1_PicksNonOverlapping) {
+    planner.addAp(1, -40);
+    uint8_t c = planner.pick(1);
+    EXPECT_GE(c, 6);
+}
+
+TEST_F(ChannelPlanTest, BusyPrimaries_PicksWeakestNeighbourhood) {
+    planner.addAp(1, -40);
+    planner.addAp(6, -45);
+    planner.addAp(11, -80);
+    uint8_t c = planner.pick(1);
+    EXPECT_GE(c, 10);
+    EXPECT_LT(planner.score(c), planner.score(6));
+}
+
+TEST_F(ChannelPlanTest, Hysteresis_MarginalGainDoesNotSwitch) {
+    for (uint8_t c = 1; c <= 11; ++c) planner.addAp(c, -70);
+    planner.addAp(1, -80); // current channel slightly busier than its mirror, 11
+    EXPECT_EQ(planner.pick(1), 1);
+    planner.addAp(1, -65); // now clearly worse
+    EXPECT_EQ(planner.pick(1), 11);
+}
+
+TEST_F(ChannelPlanTest, NotedLoss_SteersAwayIncludingNeighbours) {
+    planner.noteLoss(3, 1.0f);
+    planner.noteLoss(3, 1.0f);
+    uint8_t c = planner.pick(3);
+    EXPECT_GE(c, 8);
+}
+
+TEST_F(ChannelPlanTest, MaxChannel_Respected) {
+    cfg.maxChannel = 6;
+    planner.begin(cfg);
+    planner.addAp(1, -30);
+    planner.addAp(2, -30);
+    EXPECT_LE(planner.pick(1), 6);
+}
+
+// ============================================================================
+// Retune Governor Tests
+// ============================================================================
+TEST(RetuneGovernor, BelowThreshold_NeverFires) {
+    RetuneGovernor g;
+    RetuneConfig rc;
+    g.begin(rc);
+    for (uint32_t t = 0; t < 100000; t += 500) EXPECT_FALSE(g.update(t, 0.1f, 100));
+}
+
+TEST(RetuneGovernor, SustainedLoss_FiresOnceThenCoolsDown) {
+    RetuneGovernor g;
+    RetuneConfig rc;
+    rc.holdMs = 3000;
+    rc.cooldownMs = 20000;
+    g.begin(rc);
+    int fired = 0;
+    uint32_t firstAt = 0;
+    for (uint32_t t = 0; t < 30000; t += 500) {
+        if (g.update(t, 0.5f, 100)) { if (!fired) firstAt = t; fired++; }
+    }
+    EXPECT_EQ(fired, 2);
+    EXPECT_GE(firstAt, 3000u);
+}
+
+TEST(RetuneGovernor, BriefSpike_Ignored) {
+    RetuneGovernor g;
+    RetuneConfig rc;
+    g.begin(rc);
+    EXPECT_FALSE(g.update(0, 0.9f, 100));
+    EXPECT_FALSE(g.update(1000, 0.9f, 100));
+    EXPECT_FALSE(g.update(2000, 0.0f, 100)); // recovered, resets hold
+    EXPECT_FALSE(g.update(6000, 0.9f, 100));
+}
+
+TEST(RetuneGovernor, TooFewPings_Ignored) {
+    RetuneGovernor g;
+    RetuneConfig rc;
+    g.begin(rc);
+    for (uint32_t t = 0; t < 20000; t += 500) EXPECT_FALSE(g.update(t, 1.0f, 2));
+}
+
+// ============================================================================
+// Sweep Order Tests
+// ============================================================================
+TEST(ChannelSweep, StartsOnPreferredThenCoversAll) {
+    std::set<uint8_t> seen;
+    EXPECT_EQ(sweepChannel(9, 0, 11), 9);
+    for (uint8_t s = 0; s <= 10; ++s) seen.insert(sweepChannel(9, s, 11));
+    EXPECT_EQ(seen.size(), 11u);
+    EXPECT_EQ(sweepChannel(9, 1, 11), 1);
+    EXPECT_EQ(sweepChannel(9, 2, 11), 6);
+}
+
+TEST(ChannelSweep, WrapsAndStaysInRange) {
+    for (uint8_t s = 0; s < 200; ++s) {
+        uint8_t c = sweepChannel(1, s, 11);
+        EXPECT_GE(c, 1);
+        EXPECT_LE(c, 11);
+    }
+}
+
+// ============================================================================
+// Closed-loop simulation - remote pings, governor, board survey + planner
+// ============================================================================
+TEST(ChannelSim, InvisibleInterferer_MovesToCleanChannelAndStays) {
+    SimChannels sim;
+    for (int c = 1; c <= 5; ++c) sim.loss[c] = 0.6f;   // wideband non-Wi-Fi noise
+    for (int c = 6; c <= 11; ++c) sim.loss[c] = 0.05f;
+    sim.addAp(6, -55);                                  // visible but tolerable AP
+
+    ChannelPlanner planner;
+    planner.begin(ChannelPlanConfig{});
+    LinkQuality lq;
+    lq.begin(LinkQualityConfig{});
+    RetuneGovernor gov;
+    RetuneConfig rc;
+    rc.holdMs = 5000;
+    rc.cooldownMs = 30000;
+    gov.begin(rc);
+
+    uint8_t ch = 1;
+    int retunes = 0;
+    for (uint32_t now = 0; now < 10UL * 60UL * 1000UL; now += 500) {
+        uint8_t s = lq.nextSeq();
+        lq.onPingSent(s, now);
+        if (sim.delivered(ch) && sim.delivered(ch)) lq.onPong(s, now + 10);
+        lq.expire(now + 10);
+
+        if (gov.update(now, lq.lossRatio(), lq.pingsSent())) {
+            planner.noteLoss(ch, lq.lossRatio());
+            sim.survey(planner);
+            uint8_t next = planner.pick(ch);
+            if (next != ch) {
+                ch = next;
+                retunes++;
+                lq.reset();
+                gov.reset();
+            }
+        }
+    }
+    EXPECT_LE(sim.loss[ch], 0.05f);
+    EXPECT_GE(retunes, 1);
+    EXPECT_LE(retunes, 3); // no flapping
+}
+
+TEST(ChannelSim, CleanLink_NeverRetunes) {
+    SimChannels sim;
+    for (int c = 1; c <= 11; ++c) sim.loss[c] = 0.03f;
+    LinkQuality lq;
+    lq.begin(LinkQualityConfig{});
+    RetuneGovernor gov;
+    gov.begin(RetuneConfig{});
+    int requests = 0;
+    for (uint32_t now = 0; now < 10UL * 60UL * 1000UL; now += 500) {
+        uint8_t s = lq.nextSeq();
+        lq.onPingSent(s, now);
+        if (sim.delivered(6) && sim.delivered(6)) lq.onPong(s, now + 10);
+        lq.expire(now + 10);
+        if (gov.update(now, lq.lossRatio(), lq.pingsSent())) requests++;
+    }
+    EXPECT_EQ(requests, 0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -21,6 +21,9 @@ TEST(Errors, ErrorCodes_ValidValues) {
     EXPECT_EQ(OVER_PSI, 4);
     EXPECT_EQ(UNDER_PSI, 5);
     EXPECT_EQ(CONFLICT, 6);
+    EXPECT_EQ(LOW_SUPPLY, 7);
+    EXPECT_EQ(NO_LOAD, 8);
+    EXPECT_EQ(LEAK, 9);
     EXPECT_EQ(UNKNOWN, 255);
 }
 
@@ -56,6 +59,18 @@ TEST(Errors, ShortText_Conflict) {
     EXPECT_STREQ(shortText(CONFLICT), "Conflict");
 }
 
+TEST(Errors, ShortText_LowSupply) {
+    EXPECT_STREQ(shortText(LOW_SUPPLY), "Low battery");
+}
+
+TEST(Errors, ShortText_NoLoad) {
+    EXPECT_STREQ(shortText(NO_LOAD), "No current");
+}
+
+TEST(Errors, ShortText_Leak) {
+    EXPECT_STREQ(shortText(LEAK), "Leak");
+}
+
 TEST(Errors, ShortText_Unknown) {
     EXPECT_STREQ(shortText(UNKNOWN), "Unknown");
 }
@@ -80,6 +95,9 @@ TEST(Errors, ShortText_ReasonableLength) {
     EXPECT_LE(strlen(shortText(OVER_PSI)), 12u);
     EXPECT_LE(strlen(shortText(UNDER_PSI)), 12u);
     EXPECT_LE(strlen(shortText(CONFLICT)), 12u);
+    EXPECT_LE(strlen(shortText(LOW_SUPPLY)), 12u);
+    EXPECT_LE(strlen(shortText(NO_LOAD)), 12u);
+    EXPECT_LE(strlen(shortText(LEAK)), 12u);
     EXPECT_LE(strlen(shortText(UNKNOWN)), 12u);
 }
 
@@ -0,0 +1,49 @@
+#pragma once
+// Native stand-in for the Arduino core (see FakeDevice.h)
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "FakeDevice.h"
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(m) (void)(m)
+#define portEXIT_CRITICAL(m) (void)(m)
+#define IRAM_ATTR
+#define INPUT_PULLUP 0x05
+#define OUTPUT 0x03
+#define HIGH 0x1
+#define LOW 0x0
+
+class String;
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t v) { fakeDevice().pinOut[pin] = v; }
+inline void analogWrite(uint8_t pin, int v) { fakeDevice().pinOut[pin] = v; }
+inline uint32_t analogReadMilliVolts(uint8_t pin) { return (uint32_t)fakeDevice().adcMv[pin]; }
+
+inline unsigned long millis() { return fakeDevice().nowMs; }
+inline unsigned long micros() { return fakeDevice().nowMs * 1000ul; }
+inline void delay(unsigned long ms) { fakeDevice().nowMs += (uint32_t)ms; }
+inline uint32_t esp_random() { static uint32_t s = 0x2545F491u; s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+struct FakeSerial {
+    void begin(int) {}
+    int available() { return (int)fakeDevice().serialIn.size(); }
+    int read() {
+        std::string& in = fakeDevice().serialIn;
+        if (in.empty()) return -1;
+        int c = (unsigned char)in[0];
+        in.erase(0, 1);
+        return c;
+    }
+    template <class... A> void printf(const char*, A...) {}
+    template <class T> void println(T) {}
+    void println() {}
+    template <class T> void print(T) {}
+};
+static FakeSerial Serial;
@@ -0,0 +1,51 @@
+#pragma once
+/**
+ * Host-side stand-in for one ESP32: clock, ESP-NOW radio, NVS, GPIO, ADC and the
+ * serial console's input.
+ * The stub headers in this folder (Arduino.h, esp_now.h, ...) route every call to
+ * the current device, so a board and a remote can live in one test binary.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef int esp_err_t;
+typedef enum { ESP_NOW_SEND_SUCCESS = 0, ESP_NOW_SEND_FAIL } esp_now_send_status_t;
+typedef void (*esp_now_recv_cb_t)(const uint8_t* mac, const uint8_t* data, int len);
+typedef void (*esp_now_send_cb_t)(const uint8_t* mac, esp_now_send_status_t status);
+
+struct SentFrame {
+    bool broadcast = false;      // esp_now_send(NULL, ...)
+    uint8_t mac[6] = {0};
+    size_t len = 0;
+    uint8_t data[32] = {0};
+};
+
+struct FakeDevice {
+    uint32_t nowMs = 1;
+    uint8_t mac[6] = {0};
+    uint8_t channel = 1;
+    uint32_t gpioIn = 0xFFFFFFFFu;             // input register: pulled-up pins read high
+    std::map<int, int> pinOut;                 // last digitalWrite/analogWrite per pin
+    std::map<int, int> adcMv;                  // analogReadMilliVolts per pin (unset: 0)
+    std::string serialIn;                      // console input not read yet
+    esp_now_recv_cb_t recv = nullptr;
+    esp_now_send_cb_t sent = nullptr;
+    std::vector<std::vector<uint8_t>> peers;   // registered ESP-NOW peer MACs
+    std::vector<SentFrame> tx;                 // everything sent, oldest first
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+
+    bool hasPeer(const uint8_t* m) const {
+        for (const auto& p : peers) if (memcmp(p.data(), m, 6) == 0) return true;
+        return false;
+    }
+    // Hand a frame to the firmware's receive callback, as the radio task would
+    void deliver(const uint8_t* from, const uint8_t* data, int len) { if (recv) recv(from, data, len); }
+};
+
+inline FakeDevice*& currentDevicePtr() { static FakeDevice* d = nullptr; return d; }
+inline FakeDevice& fakeDevice() { static FakeDevice fallback; FakeDevice* d = currentDevicePtr(); return d ? *d : fallback; }
+inline void selectDevice(FakeDevice& d) { currentDevicePtr() = &d; }
@@ -0,0 +1,38 @@
+#pragma once
+// NVS stub backed by the current FakeDevice
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) { ns_ = name; ro_ = readOnly; return true; }
+    void end() {}
+
+    size_t getBytesLength(const char* key) { const auto* v = find_(key); return v ? v->size() : 0; }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        const auto* v = find_(key);
+        if (!v || v->size() > len) return 0;
+        memcpy(buf, v->data(), v->size());
+        return v->size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (ro_) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(buf);
+        fakeDevice().nvs[ns_][key] = std::vector<uint8_t>(p, p + len);
+        return len;
+    }
+    uint8_t getUChar(const char* key, uint8_t def = 0) { const auto* v = find_(key); return v && v->size() == 1 ? (*v)[0] : def; }
+    size_t putUChar(const char* key, uint8_t v) { return putBytes(key, &v, 1); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { uint32_t v; return getBytes(key, &v, 4) == 4 ? v : def; }
+    size_t putUInt(const char* key, uint32_t v) { return putBytes(key, &v, 4); }
+    bool isKey(const char* key) { return find_(key) != nullptr; }
+    bool remove(const char* key) { return !ro_ && fakeDevice().nvs[ns_].erase(key) > 0; }
+
+private:
+    const std::vector<uint8_t>* find_(const char* key) {
+        auto& m = fakeDevice().nvs[ns_];
+        auto it = m.find(key);
+        return it == m.end() ? nullptr : &it->second;
+    }
+    std::string ns_;
+    bool ro_ = false;
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+#define WIFI_STA 1
+#define WIFI_OFF 0
+#define WIFI_SCAN_RUNNING -1
+#define WIFI_SCAN_FAILED -2
+
+// Channel surveys find no access points
+struct FakeWiFi {
+    void mode(int) {}
+    void disconnect() {}
+    int scanNetworks(bool = false, bool = false) { return 0; }
+    int scanComplete() { return 0; }
+    void scanDelete() {}
+    int32_t channel(int) { return 1; }
+    int32_t RSSI(int) { return -90; }
+};
+static FakeWiFi WiFi;
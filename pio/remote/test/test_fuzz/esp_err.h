@@ -0,0 +1,4 @@
+#pragma once
+#include "FakeDevice.h"
+#define ESP_OK 0
+#define ESP_FAIL -1
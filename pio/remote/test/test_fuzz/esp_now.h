@@ -0,0 +1,45 @@
+#pragma once
+// Transport stub: peers and sent frames are recorded on the current FakeDevice
+#include <esp_err.h>
+#define ESP_NOW_KEY_LEN 16
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_MAX_DATA_LEN 250
+
+typedef struct {
+    uint8_t peer_addr[6]; uint8_t lmk[16]; uint8_t channel; int ifidx; bool encrypt; void* priv;
+} esp_now_peer_info_t;
+
+inline esp_err_t esp_now_init() { return ESP_OK; }
+inline esp_err_t esp_now_deinit() { return ESP_OK; }
+inline esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) { fakeDevice().recv = cb; return ESP_OK; }
+inline esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) { fakeDevice().sent = cb; return ESP_OK; }
+inline esp_err_t esp_now_set_pmk(const uint8_t*) { return ESP_OK; }
+
+inline bool esp_now_is_peer_exist(const uint8_t* mac) { return fakeDevice().hasPeer(mac); }
+inline esp_err_t esp_now_add_peer(const esp_now_peer_info_t* p) {
+    FakeDevice& d = fakeDevice();
+    if (d.hasPeer(p->peer_addr)) return ESP_FAIL;
+    d.peers.emplace_back(p->peer_addr, p->peer_addr + 6);
+    return ESP_OK;
+}
+inline esp_err_t esp_now_mod_peer(const esp_now_peer_info_t* p) { return fakeDevice().hasPeer(p->peer_addr) ? ESP_OK : ESP_FAIL; }
+inline esp_err_t esp_now_del_peer(const uint8_t* mac) {
+    auto& peers = fakeDevice().peers;
+    for (size_t i = 0; i < peers.size(); ++i) {
+        if (memcmp(peers[i].data(), mac, 6) == 0) { peers.erase(peers.begin() + i); return ESP_OK; }
+    }
+    return ESP_FAIL;
+}
+
+inline esp_err_t esp_now_send(const uint8_t* mac, const uint8_t* data, size_t len) {
+    FakeDevice& d = fakeDevice();
+    if (len == 0 || len > ESP_NOW_MAX_DATA_LEN) return ESP_FAIL;
+    if (mac && !d.hasPeer(mac)) return ESP_FAIL;
+    SentFrame f;
+    f.broadcast = mac == nullptr;
+    if (mac) memcpy(f.mac, mac, 6);
+    f.len = len;
+    memcpy(f.data, data, len < sizeof(f.data) ? len : sizeof(f.data));
+    d.tx.push_back(f);
+    return ESP_OK;
+}
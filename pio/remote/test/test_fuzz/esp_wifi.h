@@ -0,0 +1,16 @@
+#pragma once
+#include <esp_err.h>
+typedef enum { WIFI_SECOND_CHAN_NONE = 0 } wifi_second_chan_t;
+typedef enum { WIFI_IF_STA = 0 } wifi_interface_t;
+
+inline esp_err_t esp_wifi_set_channel(uint8_t ch, wifi_second_chan_t) {
+    if (ch < 1 || ch > 14) return ESP_FAIL;
+    fakeDevice().channel = ch;
+    return ESP_OK;
+}
+inline esp_err_t esp_wifi_get_channel(uint8_t* ch, wifi_second_chan_t* second) {
+    *ch = fakeDevice().channel; if (second) *second = WIFI_SECOND_CHAN_NONE; return ESP_OK;
+}
+inline esp_err_t esp_wifi_set_promiscuous(bool) { return ESP_OK; }
+inline esp_err_t esp_wifi_stop() { return ESP_OK; }
+inline esp_err_t esp_wifi_get_mac(wifi_interface_t, uint8_t* mac) { memcpy(mac, fakeDevice().mac, 6); return ESP_OK; }
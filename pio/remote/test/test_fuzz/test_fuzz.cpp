@@ -0,0 +1,373 @@
+/**
+ * Fuzz tests for TA_Protocol and both receive paths
+ * Feeds random and opcode-seeded byte strings through the parsers, the opcode table
+ * and the real BoardLink / EspNowLink receive callbacks (over the stub transport in
+ * this folder), checking that decoded values stay inside their enums, that replies
+ * are well-formed frames, and that link state survives.
+ *
+ * Every input sits in an exact-size heap buffer, so a read past its end is caught by
+ * AddressSanitizer in the native_fuzz environment (pio test -e native_fuzz), which
+ * also runs far more iterations. Build with -DTA_LIBFUZZER and clang
+ * -fsanitize=fuzzer to drive the same checks from libFuzzer instead.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+
+#include "FakeDevice.h"
+#include <TA_Protocol.h>
+
+// The firmware under test, built against the stub headers in this folder
+#include "../../lib/TA_Comms/src/TA_Comms.cpp"
+#include "../../../control_board/lib/TA_CommsBoard/src/TA_CommsBoard.cpp"
+
+namespace ta { namespace time {
+    uint32_t (*_testMillis)() = []() -> uint32_t { return fakeDevice().nowMs; };
+} }
+
+using namespace ta::protocol;
+
+#ifndef TA_FUZZ_ITERATIONS
+#define TA_FUZZ_ITERATIONS 20000
+#endif
+#ifndef TA_FUZZ_SEED
+#define TA_FUZZ_SEED 0x5EED1234u
+#endif
+
+// ============================================================================
+// Input generation
+// ============================================================================
+struct Rng {
+    uint32_t s;
+    explicit Rng(uint32_t seed) : s(seed ? seed : 1) {}
+    uint32_t next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+static constexpr int kMaxFuzzLen = 16;
+
+// Mix of pure noise and frames that get past the first-byte lookup, so the
+// per-class parsers see plenty of hostile bodies
+static int makeInput(Rng& rng, uint8_t out[kMaxFuzzLen]) {
+    for (int i = 0; i < kMaxFuzzLen; ++i) out[i] = (uint8_t)rng.next();
+    switch (rng.below(4)) {
+        case 0:
+            return (int)rng.below(kMaxFuzzLen + 1);
+        case 1: {
+            const OpDef& d = kOpDefs[rng.below(kOpDefCount)];
+            out[0] = d.op;
+            int len = (d.lens & kLen12) ? kPairKeyLen : (d.lens & lenBit(4)) && rng.below(2) ? 4
+                      : (d.lens & lenBit(kLeaseLen)) && rng.below(2) ? kLeaseLen : 2;
+            if (len >= 4 && len <= kLeaseLen && rng.below(4)) out[1] = kProtoV2;
+            return len;
+        }
+        case 2:
+            out[1] = (uint8_t)(rng.below(3) == 0 ? rng.below(16) : out[1]); // small values hit channel/version checks
+            return 2;
+        default:
+            return rng.below(2) ? 2 : 4;
+    }
+}
+
+// ============================================================================
+// Checks
+// ============================================================================
+static std::string hex(const uint8_t* data, int len) {
+    std::string s;
+    char b[4];
+    for (int i = 0; i < len; ++i) { snprintf(b, sizeof(b), "%02X ", data[i]); s += b; }
+    return s;
+}
+
+struct Checker {
+    uint32_t failures = 0;
+    void fail(const char* what, const uint8_t* data, int len) {
+        failures++;
+#ifdef TA_LIBFUZZER
+        fprintf(stderr, "fuzz check failed: %s [%s]\n", what, hex(data, len).c_str());
+        abort();
+#else
+        if (failures <= 5) ADD_FAILURE() << what << " for input [" << hex(data, len) << "] len " << len;
+#endif
+    }
+};
+
+static bool validStatus(Status s) {
+    return s == Status::Idle || s == Status::AirUp || s == Status::Venting || s == Status::Checking || s == Status::Error;
+}
+
+static bool validRequest(const Request& r) {
+    switch (r.kind) {
+        case Request::Kind::Idle:
+        case Request::Kind::Ping:
+            return true;
+        case Request::Kind::Start:
+            return r.targetPsi >= 0.0f && r.targetPsi <= kMaxPsi01;
+        case Request::Kind::Manual:
+            return r.manual == ManualCode::Vent || r.manual == ManualCode::Air;
+    }
+    return false;
+}
+
+static bool validResponse(const Response& r) {
+    if (!validStatus(r.status)) return false;
+    if (r.status == Status::Error) return r.centiPsi == 0;
+    return r.value == psiToByte05(responsePsi(r)); // v1 and v2 views agree
+}
+
+static void checkParsers(Checker& c, const uint8_t* d, int len) {
+    Request req;
+    if (parseRequest(d, len, req) && !validRequest(req)) c.fail("parseRequest out of range", d, len);
+    Response resp;
+    if (parseResponse(d, len, resp) && !validResponse(resp)) c.fail("parseResponse out of range", d, len);
+    PairMsg pm;
+    if (parsePair(d, len, pm) && pm.op != PairOp::Req && pm.op != PairOp::Ack && pm.op != PairOp::Busy)
+        c.fail("parsePair bad op", d, len);
+    uint8_t v;
+    if (parseChan(d, len, v) && v > 13) c.fail("parseChan bad channel", d, len);
+    if (parseHello(d, len, v) && v == kProtoUnknown) c.fail("parseHello version 0", d, len);
+    PairKey pk;
+    parsePairKey(d, len, pk);
+    parsePong(d, len, v);
+
+    const Dir dirs[2] = { Dir::ToBoard, Dir::ToRemote };
+    for (Dir dir : dirs) {
+        Frame f;
+        bool ok = decodeFrame(d, len, dir, f);
+        if (f.cls != classify(d, len, dir)) c.fail("decodeFrame class differs from table", d, len);
+        if (!ok) continue;
+        if (f.cls == FrameClass::Cmd && (dir != Dir::ToBoard || !validRequest(f.req))) c.fail("bad Cmd frame", d, len);
+        if (f.cls == FrameClass::Status && (dir != Dir::ToRemote || !validResponse(f.resp))) c.fail("bad Status frame", d, len);
+        if (f.cls == FrameClass::Link && f.link == LinkOp::Pong && dir != Dir::ToRemote) c.fail("Pong to board", d, len);
+    }
+}
+
+// ============================================================================
+// Two devices, paired to each other, over the stub transport
+// ============================================================================
+class FuzzRig {
+public:
+    FakeDevice boardDev, remoteDev;
+    ta::comms::BoardLink board;
+    ta::comms::EspNowLink remote;
+    Checker checker;
+    uint32_t requests = 0, statuses = 0;
+
+    const uint8_t boardMac[6]    = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    const uint8_t remoteMac[6]   = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+    const uint8_t strangerMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x03};
+
+    void begin() {
+        ta::cfg::LinkShared cfg;
+        uint8_t lmk[ta::pairkey::kKeyLen];
+        ta::pairkey::deriveLmk(cfg.pmk, remoteMac, boardMac, 0x01, 0xC0FFEE, lmk);
+        memcpy(boardDev.mac, boardMac, 6);
+        memcpy(remoteDev.mac, remoteMac, 6);
+
+        selectDevice(boardDev);
+        Preferences p;
+        ta::pairkey::savePeer(p, 0, remoteMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        board.setRequestCallback(&FuzzRig::onRequest_, this);
+        board.begin();
+        boardDev.nowMs += cfg.boardPairWindowMs + 1; // extra remotes may no longer pair
+
+        selectDevice(remoteDev);
+        ta::pairkey::savePeer(p, 0, boardMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        remote.setPmk(cfg.pmk);
+        remote.setStatusCallback(&FuzzRig::onStatus_, this);
+        remote.begin(nullptr);
+        remote.requestReconnect();
+    }
+
+    // One input into both receive paths; mac 0 = paired peer, 1 = stranger
+    void runOne(const uint8_t* d, int len, uint8_t macSel) {
+        selectDevice(boardDev);
+        boardDev.tx.clear();
+        boardDev.nowMs += 7;
+        boardDev.deliver(macSel ? strangerMac : remoteMac, d, len);
+        board.service();
+        if (board.peerCount() != 1) checker.fail("board peer table changed", d, len);
+        if (board.channel() < 1 || board.channel() > 11) checker.fail("board channel out of range", d, len);
+        for (const SentFrame& f : boardDev.tx) {
+            Frame fr;
+            if (!decodeFrame(f.data, (int)f.len, Dir::ToRemote, fr)) checker.fail("board sent a frame remotes can't decode", d, len);
+        }
+
+        selectDevice(remoteDev);
+        remoteDev.tx.clear();
+        remoteDev.nowMs += 7;
+        remoteDev.deliver(macSel ? strangerMac : boardMac, d, len);
+        remote.service();
+        if (remote.boardCount() != 1) checker.fail("remote board table changed", d, len);
+        if (remote.isPairing()) checker.fail("remote started pairing", d, len);
+        if (remote.channel() < 1 || remote.channel() > 11) checker.fail("remote channel out of range", d, len);
+        for (const SentFrame& f : remoteDev.tx) {
+            Frame fr;
+            if (!decodeFrame(f.data, (int)f.len, Dir::ToBoard, fr)) checker.fail("remote sent a frame boards can't decode", d, len);
+        }
+    }
+
+    // Hand everything one device sent to the other (as if on the same channel)
+    static void pump(FakeDevice& from, FakeDevice& to, const uint8_t fromMac[6]) {
+        std::vector<SentFrame> tx;
+        tx.swap(from.tx);
+        selectDevice(to);
+        for (const SentFrame& f : tx) {
+            if (f.broadcast || memcmp(f.mac, to.mac, 6) == 0) to.deliver(fromMac, f.data, (int)f.len);
+        }
+    }
+
+    Request lastRequest;
+    Response lastStatus;
+
+private:
+    static bool onRequest_(void* ctx, uint8_t slot, const Request& r) {
+        FuzzRig* rig = static_cast<FuzzRig*>(ctx);
+        if (slot >= ta::peers::kMaxPeers) rig->checker.fail("board callback got a bad slot", nullptr, 0);
+        rig->requests++;
+        rig->lastRequest = r;
+        if (!validRequest(r)) rig->checker.fail("board callback got a bad request", nullptr, 0);
+        return true;
+    }
+    static void onStatus_(void* ctx, uint8_t board, const Response& r) {
+        FuzzRig* rig = static_cast<FuzzRig*>(ctx);
+        rig->statuses++;
+        rig->lastStatus = r;
+        if (board >= ta::peers::kMaxPeers || !validResponse(r)) rig->checker.fail("remote callback got a bad status", nullptr, 0);
+    }
+};
+
+// Exact-size copy so sanitizers see any overread
+static std::unique_ptr<uint8_t[]> exactCopy(const uint8_t* src, int len) {
+    std::unique_ptr<uint8_t[]> p(new uint8_t[len > 0 ? len : 1]);
+    if (len > 0) memcpy(p.get(), src, (size_t)len);
+    return p;
+}
+
+static void report(const char* what, uint32_t execs, std::chrono::steady_clock::time_point t0) {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    printf("[fuzz] %s: %u execs in %.0f ms (%.0f exec/s)\n", what, execs, ms, ms > 0 ? execs * 1000.0 / ms : 0.0);
+}
+
+#ifndef TA_LIBFUZZER
+// ============================================================================
+// Parser Fuzz Tests
+// ============================================================================
+TEST(Fuzz, Parsers_RandomInput_DecodedValuesInRange) {
+    Checker c;
+    Rng rng(TA_FUZZ_SEED);
+    uint8_t in[kMaxFuzzLen];
+    const uint32_t n = TA_FUZZ_ITERATIONS * 10u;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n && c.failures == 0; ++i) {
+        int len = makeInput(rng, in);
+        auto buf = exactCopy(in, len);
+        checkParsers(c, buf.get(), len);
+    }
+    report("parsers", n, t0);
+    EXPECT_EQ(c.failures, 0u);
+}
+
+TEST(Fuzz, Parsers_EveryTwoByteFrame) {
+    Checker c;
+    for (int a = 0; a < 256; ++a) {
+        for (int b = 0; b < 256; ++b) {
+            uint8_t in[2] = { (uint8_t)a, (uint8_t)b };
+            auto buf = exactCopy(in, 2);
+            checkParsers(c, buf.get(), 2);
+        }
+    }
+    EXPECT_EQ(c.failures, 0u);
+}
+
+TEST(Fuzz, ManualCode_OnlyDefinedValuesParse) {
+    for (int b = 0; b < 256; ++b) {
+        uint8_t in[2] = { (uint8_t)Cmd::Manual, (uint8_t)b };
+        Request r;
+        EXPECT_EQ(parseRequest(in, 2, r), b == 0x00 || b == 0xFF) << b;
+    }
+}
+
+// ============================================================================
+// Receive Path Fuzz Tests
+// ============================================================================
+TEST(Fuzz, RecvPaths_RandomInput_StateConsistent) {
+    FuzzRig rig;
+    rig.begin();
+    Rng rng(TA_FUZZ_SEED ^ 0xA5A5A5A5u);
+    uint8_t in[kMaxFuzzLen];
+    const uint32_t n = TA_FUZZ_ITERATIONS;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n && rig.checker.failures == 0; ++i) {
+        int len = makeInput(rng, in);
+        auto buf = exactCopy(in, len);
+        rig.runOne(buf.get(), len, rng.below(4) == 0 ? 1 : 0);
+    }
+    report("onRecv (board + remote)", n, t0);
+    EXPECT_EQ(rig.checker.failures, 0u);
+    EXPECT_GT(rig.requests, 0u);   // the generator does reach the app callbacks
+    EXPECT_GT(rig.statuses, 0u);
+}
+
+TEST(Fuzz, RecvPaths_AfterFuzz_LinkStillWorks) {
+    FuzzRig rig;
+    rig.begin();
+    Rng rng(TA_FUZZ_SEED);
+    uint8_t in[kMaxFuzzLen];
+    for (uint32_t i = 0; i < TA_FUZZ_ITERATIONS / 10u; ++i) {
+        int len = makeInput(rng, in);
+        rig.runOne(in, len, 0);
+    }
+
+    // Hello exchange, then a v2 Start and a v2 status both arrive intact
+    selectDevice(rig.boardDev);
+    rig.boardDev.tx.clear();
+    selectDevice(rig.remoteDev);
+    rig.remoteDev.tx.clear();
+    uint8_t hello[kPayloadLen];
+    packHello(hello);
+    selectDevice(rig.remoteDev);
+    rig.remoteDev.deliver(rig.boardMac, hello, kPayloadLen);
+    FuzzRig::pump(rig.remoteDev, rig.boardDev, rig.remoteMac);
+
+    selectDevice(rig.remoteDev);
+    ASSERT_TRUE(rig.remote.sendStart(32.17f));
+    FuzzRig::pump(rig.remoteDev, rig.boardDev, rig.remoteMac);
+    EXPECT_EQ(rig.lastRequest.kind, Request::Kind::Start);
+    EXPECT_EQ(psiToU16_01(rig.lastRequest.targetPsi), 3217);
+
+    selectDevice(rig.boardDev);
+    rig.boardDev.tx.clear();
+    ASSERT_TRUE(rig.board.sendStatus('U', 30.42f));
+    FuzzRig::pump(rig.boardDev, rig.remoteDev, rig.boardMac);
+    rig.remote.service();
+    EXPECT_EQ(rig.lastStatus.status, Status::AirUp);
+    EXPECT_EQ(rig.lastStatus.centiPsi, 3042);
+    EXPECT_EQ(rig.checker.failures, 0u);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+#else
+// libFuzzer entry: byte 0 picks the sender, the rest is the frame
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static FuzzRig* rig = [] { FuzzRig* r = new FuzzRig; r->begin(); return r; }();
+    if (size < 1 || size > 64) return 0;
+    int len = (int)size - 1;
+    auto buf = exactCopy(data + 1, len);
+    Checker c;
+    checkParsers(c, buf.get(), len);
+    rig->runOne(buf.get(), len, data[0] & 1);
+    return 0;
+}
+#endif
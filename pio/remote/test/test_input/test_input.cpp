@@ -0,0 +1,265 @@
+/**
+ * Unit tests for TA_Input's ButtonBank
+ * Tests bitmask debounce and the click/hold/long-hold gestures for all buttons at
+ * once: SmartButton's event sequence and cadence, independent buttons sharing a
+ * poll, and the idle fast path; and console lines parsed as button events
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Input.h>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace ta::input;
+
+static constexpr uint8_t kLeft = 1u << (int)ButtonId::Left;
+static constexpr uint8_t kDown = 1u << (int)ButtonId::Down;
+static constexpr uint8_t kUp = 1u << (int)ButtonId::Up;
+
+struct Seen {
+    uint32_t ms;
+    Event e;
+};
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+class ButtonBankTest : public ::testing::Test {
+protected:
+    ButtonBank bank;
+    std::vector<Seen> seen;
+    uint32_t now = 0;
+
+    void SetUp() override {
+        bank.begin();
+    }
+
+    // Poll every 5 ms (a busy loop's cadence) for ms with the given pins down
+    void hold(uint8_t raw, uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 5, now += 5) {
+            bank.poll(now, raw, [this](const Event& e) { seen.push_back(Seen{ now, e }); });
+        }
+    }
+
+    std::vector<Seen> of(ButtonId id, Action a) const {
+        std::vector<Seen> out;
+        for (const Seen& s : seen) if (s.e.id == id && s.e.action == a) out.push_back(s);
+        return out;
+    }
+};
+
+// ============================================================================
+// Debounce
+// ============================================================================
+TEST_F(ButtonBankTest, Idle_NoEvents) {
+    hold(0, 5000);
+    EXPECT_TRUE(seen.empty());
+    EXPECT_TRUE(bank.idle());
+}
+
+TEST_F(ButtonBankTest, ShortGlitch_Ignored) {
+    hold(0, 100);
+    hold(kUp, 15);
+    hold(0, 1000);
+    EXPECT_TRUE(seen.empty());
+}
+
+TEST_F(ButtonBankTest, Press_ReportedAfterDebounce) {
+    hold(0, 100);
+    hold(kUp, 100);
+    auto p = of(ButtonId::Up, Action::Pressed);
+    ASSERT_EQ(p.size(), 1u);
+    EXPECT_EQ(p[0].ms, 120u);
+    EXPECT_EQ(bank.pressed(), kUp);
+}
+
+TEST_F(ButtonBankTest, ChatteringRelease_OneRelease) {
+    hold(kDown, 200);
+    for (int i = 0; i < 5; ++i) { hold(0, 10); hold(kDown, 5); }
+    hold(0, 100);
+    EXPECT_EQ(of(ButtonId::Down, Action::Pressed).size(), 1u);
+    EXPECT_EQ(of(ButtonId::Down, Action::Released).size(), 1u);
+}
+
+// ============================================================================
+// Clicks
+// ============================================================================
+TEST_F(ButtonBankTest, Click_AfterQuietPeriod) {
+    hold(kLeft, 150);
+    hold(0, 1000);
+    ASSERT_EQ(seen.size(), 3u);
+    EXPECT_EQ(seen[0].e.action, Action::Pressed);
+    EXPECT_EQ(seen[1].e.action, Action::Released);
+    EXPECT_EQ(seen[2].e.action, Action::Click);
+    EXPECT_EQ(seen[2].e.clicks, 1);
+    EXPECT_EQ(seen[2].e.heldMs, 0u);
+    // clickMs counts from the press, as SmartButton's did
+    EXPECT_GT(seen[2].ms - seen[0].ms, 500u);
+    EXPECT_LE(seen[2].ms - seen[0].ms, 510u);
+    EXPECT_TRUE(bank.idle());
+}
+
+TEST_F(ButtonBankTest, DoubleClick_CountsTwo) {
+    hold(kLeft, 100);
+    hold(0, 150);
+    hold(kLeft, 100);
+    hold(0, 1000);
+    auto c = of(ButtonId::Left, Action::Click);
+    ASSERT_EQ(c.size(), 1u);
+    EXPECT_EQ(c[0].e.clicks, 2);
+}
+
+// ============================================================================
+// Hold
+// ============================================================================
+TEST_F(ButtonBankTest, Hold_SmartButtonCadence) {
+    hold(kUp, 4000);
+    auto r = of(ButtonId::Up, Action::Repeat);
+    auto l = of(ButtonId::Up, Action::LongHold);
+    ASSERT_FALSE(r.empty());
+    ASSERT_EQ(l.size(), 1u);
+    EXPECT_EQ(r[0].e.heldMs, 1000u);
+    EXPECT_EQ(l[0].e.heldMs, 3000u);
+    for (size_t i = 1; i < r.size(); ++i) {
+        uint32_t gap = r[i].ms - r[i - 1].ms;
+        if (r[i].ms < l[0].ms) {
+            EXPECT_EQ(gap, 200u);
+        } else if (r[i - 1].ms > l[0].ms) {
+            EXPECT_EQ(gap, 50u);
+        }
+    }
+    // 1 at hold, 9 hold repeats, then one every 50 ms for the last second
+    EXPECT_EQ(r.size(), 10u + 19u);
+}
+
+TEST_F(ButtonBankTest, ReleaseAfterHold_NoClick_NoStrayRepeat) {
+    hold(kUp, 3500);
+    size_t before = of(ButtonId::Up, Action::Repeat).size();
+    hold(0, 1000);
+    EXPECT_EQ(of(ButtonId::Up, Action::Repeat).size(), before);
+    EXPECT_TRUE(of(ButtonId::Up, Action::Click).empty());
+    EXPECT_EQ(of(ButtonId::Up, Action::Released).size(), 1u);
+    EXPECT_TRUE(bank.idle());
+}
+
+TEST_F(ButtonBankTest, ClicksBeforeHold_Discarded) {
+    hold(kDown, 100);
+    hold(0, 100);
+    hold(kDown, 1500);
+    hold(0, 1000);
+    EXPECT_TRUE(of(ButtonId::Down, Action::Click).empty());
+    hold(kDown, 100);
+    hold(0, 1000);
+    auto c = of(ButtonId::Down, Action::Click);
+    ASSERT_EQ(c.size(), 1u);
+    EXPECT_EQ(c[0].e.clicks, 1);
+}
+
+// ============================================================================
+// Several buttons in one poll
+// ============================================================================
+TEST_F(ButtonBankTest, TwoButtons_Independent) {
+    hold(kUp, 300);
+    hold(kUp | kLeft, 400);        // Left clicked while Up is held
+    hold(kUp, 1000);
+    hold(0, 1000);
+    EXPECT_EQ(of(ButtonId::Up, Action::Repeat).front().e.heldMs, 1000u);
+    EXPECT_TRUE(of(ButtonId::Up, Action::Click).empty());
+    EXPECT_TRUE(of(ButtonId::Left, Action::Repeat).empty());
+    auto c = of(ButtonId::Left, Action::Click);
+    ASSERT_EQ(c.size(), 1u);
+    EXPECT_EQ(c[0].e.clicks, 1);
+}
+
+TEST_F(ButtonBankTest, SimultaneousPress_ButtonOrder) {
+    hold(kUp | kLeft | kDown, 50);
+    ASSERT_EQ(seen.size(), 3u);
+    EXPECT_EQ(seen[0].e.id, ButtonId::Left);
+    EXPECT_EQ(seen[1].e.id, ButtonId::Down);
+    EXPECT_EQ(seen[2].e.id, ButtonId::Up);
+    EXPECT_EQ(seen[0].ms, seen[2].ms);
+}
+
+TEST_F(ButtonBankTest, TimeWrap_HoldStillTimed) {
+    now = 0xFFFFFF00u;
+    hold(kUp, 1200);
+    auto r = of(ButtonId::Up, Action::Repeat);
+    ASSERT_FALSE(r.empty());
+    EXPECT_EQ(r[0].e.heldMs, 1000u);
+}
+
+TEST_F(ButtonBankTest, CustomTiming_Applied) {
+    Timing t;
+    t.debounceMs = 5;
+    t.holdMs = 400;
+    bank.begin(t);
+    hold(kLeft, 600);
+    EXPECT_EQ(of(ButtonId::Left, Action::Pressed)[0].ms, 5u);
+    EXPECT_EQ(of(ButtonId::Left, Action::Repeat)[0].e.heldMs, 400u);
+}
+
+// ============================================================================
+// Cost
+// ============================================================================
+TEST_F(ButtonBankTest, PollCost_Printed) {
+    const int kPolls = 1000000;
+    int events = 0;
+    auto count = [&](const Event&) { events++; };
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPolls; ++i) bank.poll((uint32_t)i, 0, count);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPolls; ++i) bank.poll((uint32_t)i, 0x0F, count);
+    auto t2 = std::chrono::steady_clock::now();
+    double idleNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / kPolls;
+    double heldNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / kPolls;
+    printf("[INPUT] poll: %.1f ns idle, %.1f ns with all four held\n", idleNs, heldNs);
+    EXPECT_GT(events, 0);
+}
+
+// ============================================================================
+// Console buttons
+// ============================================================================
+TEST(ConsoleButtonTest, Name_Clicks) {
+    Event e{};
+    ASSERT_TRUE(parseConsoleButton("up", e));
+    EXPECT_EQ(e.id, ButtonId::Up);
+    EXPECT_EQ(e.action, Action::Click);
+    EXPECT_EQ(e.clicks, 1);
+    ASSERT_TRUE(parseConsoleButton("  right\r\n", e));
+    EXPECT_EQ(e.id, ButtonId::Right);
+}
+
+TEST(ConsoleButtonTest, Hold_LongHoldsPastTheLongHoldTime) {
+    Event e{};
+    ASSERT_TRUE(parseConsoleButton("down hold", e));
+    EXPECT_EQ(e.id, ButtonId::Down);
+    EXPECT_EQ(e.action, Action::LongHold);
+    EXPECT_EQ(e.heldMs, 3000u);
+}
+
+TEST(ConsoleButtonTest, PairAndCal_AreLeftAndRightHolds) {
+    Event e{};
+    ASSERT_TRUE(parseConsoleButton("pair", e));
+    EXPECT_EQ(e.id, ButtonId::Left);
+    EXPECT_EQ(e.action, Action::LongHold);
+    ASSERT_TRUE(parseConsoleButton("cal", e));
+    EXPECT_EQ(e.id, ButtonId::Right);
+    EXPECT_EQ(e.action, Action::LongHold);
+}
+
+TEST(ConsoleButtonTest, Unknown_Rejected) {
+    Event e{};
+    EXPECT_FALSE(parseConsoleButton("", e));
+    EXPECT_FALSE(parseConsoleButton("lefty", e));
+    EXPECT_FALSE(parseConsoleButton("up holdx", e));
+    EXPECT_FALSE(parseConsoleButton("paired", e));
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
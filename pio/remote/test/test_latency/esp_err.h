@@ -0,0 +1,3 @@
+#pragma once
+// Shared with test_fuzz
+#include "../test_fuzz/esp_err.h"
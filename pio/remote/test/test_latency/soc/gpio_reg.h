@@ -0,0 +1,2 @@
+#pragma once
+#define GPIO_IN_REG 0x6000403Cu
@@ -0,0 +1,4 @@
+#pragma once
+// Register reads come from the current FakeDevice
+#include "../../test_fuzz/FakeDevice.h"
+#define REG_READ(r) ((r) == GPIO_IN_REG ? fakeDevice().gpioIn : 0u)
@@ -0,0 +1,453 @@
+/**
+ * Latency tests for the button -> relay path
+ * Tests the TA_Probe trace rules, then runs the real Buttons, EspNowLink, BoardLink
+ * and Controller in one host loopback (both devices on one clock, a fixed air time
+ * between them) through bouncy, jittered presses, and checks each hop's p99 and the
+ * end-to-end p99 against the budget the loop periods allow. Also checks that the
+ * remote times each paired board's round trip on its own.
+ */
+
+#define TA_LATENCY_PROBES 1
+
+#include <gtest/gtest.h>
+#include <deque>
+#include <memory>
+#include <stdio.h>
+
+#include "../test_fuzz/FakeDevice.h"
+#include <TA_Protocol.h>
+#include <TA_Controller.h>
+
+// The firmware under test, built against the stub headers in this folder
+#include "../../lib/TA_Comms/src/TA_Comms.cpp"
+#include "../../../control_board/lib/TA_CommsBoard/src/TA_CommsBoard.cpp"
+#include "../../../../pioLib/TA_Input/src/TA_Input.cpp"
+
+namespace ta { namespace time {
+    uint32_t (*_testMillis)() = []() -> uint32_t { return fakeDevice().nowMs; };
+} }
+
+using namespace ta::probe;
+using ta::protocol::Request;
+
+struct StdOut {
+    void println(const char* s) { printf("%s\n", s); }
+};
+
+// ============================================================================
+// Trace rules
+// ============================================================================
+TEST(ProbesTest, FullTrace_SegmentsAndEndToEnd) {
+    Probes p;
+    p.mark(Hop::Edge, 1000);
+    p.mark(Hop::Dispatch, 21000);
+    p.mark(Hop::Send, 21050);
+    p.mark(Hop::Recv, 24000);
+    p.mark(Hop::Actuate, 30000);
+    EXPECT_EQ(p.segment(Hop::Dispatch).maxUs, 20000u);
+    EXPECT_EQ(p.segment(Hop::Send).maxUs, 50u);
+    EXPECT_EQ(p.segment(Hop::Recv).maxUs, 2950u);
+    EXPECT_EQ(p.segment(Hop::Actuate).maxUs, 6000u);
+    ASSERT_EQ(p.endToEnd().count, 1u);
+    EXPECT_EQ(p.endToEnd().maxUs, 29000u);
+}
+
+TEST(ProbesTest, OutOfOrderAndRepeats_Ignored) {
+    Probes p;
+    p.mark(Hop::Edge, 0);
+    p.mark(Hop::Send, 100);          // skipped Dispatch
+    EXPECT_EQ(p.segment(Hop::Send).count, 0u);
+    p.mark(Hop::Dispatch, 200);
+    p.mark(Hop::Send, 300);
+    p.mark(Hop::Send, 900);          // a manual resend
+    EXPECT_EQ(p.segment(Hop::Send).count, 1u);
+    EXPECT_EQ(p.at(Hop::Send), 300u);
+}
+
+TEST(ProbesTest, RecvWithoutSend_StartsBoardTrace) {
+    Probes p;
+    p.mark(Hop::Recv, 5000);
+    p.mark(Hop::Actuate, 7000);
+    p.mark(Hop::Actuate, 9000);      // relay already on
+    EXPECT_EQ(p.segment(Hop::Actuate).count, 1u);
+    EXPECT_EQ(p.segment(Hop::Actuate).maxUs, 2000u);
+    EXPECT_EQ(p.endToEnd().count, 0u);
+}
+
+TEST(ProbesTest, NewEdge_AbandonsOpenTrace) {
+    Probes p;
+    p.mark(Hop::Edge, 0);
+    p.mark(Hop::Dispatch, 100);
+    p.mark(Hop::Edge, 5000);         // press never got sent (not in Manual)
+    p.mark(Hop::Dispatch, 5100);
+    p.mark(Hop::Send, 5100);
+    p.mark(Hop::Recv, 6000);
+    p.mark(Hop::Actuate, 7000);
+    EXPECT_EQ(p.segment(Hop::Dispatch).count, 2u);
+    ASSERT_EQ(p.endToEnd().count, 1u);
+    EXPECT_EQ(p.endToEnd().maxUs, 2000u);
+}
+
+// ============================================================================
+// Remote and board in one loopback
+// ============================================================================
+static constexpr uint32_t kRemoteLoopMs = 5;
+static constexpr uint32_t kBoardLoopMs = 10;
+static constexpr uint32_t kAirMs = 3;
+static constexpr uint32_t kMaxBounceMs = 8;
+static constexpr uint16_t kDebounceMs = 20;   // Timing's default
+
+// p99 budgets per hop: what the loop periods and the debounce allow
+static constexpr uint32_t kEdgeToDispatchUs = (kDebounceMs + kMaxBounceMs + kRemoteLoopMs) * 1000u;
+static constexpr uint32_t kDispatchToSendUs = 1000u;
+static constexpr uint32_t kSendToRecvUs = (kAirMs + 1) * 1000u;
+static constexpr uint32_t kRecvToActuateUs = kBoardLoopMs * 1000u;
+static constexpr uint32_t kEndToEndUs = 50000u;
+
+class LoopbackRig {
+public:
+    FakeDevice boardDev, remoteDev;
+    ta::comms::BoardLink board;
+    std::unique_ptr<ta::comms::EspNowLink> link;
+    ta::input::Buttons buttons{ ta::input::Pins{ 10, 9, 8, 20 } };
+    ta::ctl::Controller ctl;
+    uint32_t now = 1;
+
+    const uint8_t boardMac[6]  = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    const uint8_t remoteMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+
+    void begin() {
+        ta::cfg::LinkShared cfg;
+        uint8_t lmk[ta::pairkey::kKeyLen];
+        ta::pairkey::deriveLmk(cfg.pmk, remoteMac, boardMac, 0x01, 0xC0FFEE, lmk);
+        memcpy(boardDev.mac, boardMac, 6);
+        memcpy(remoteDev.mac, remoteMac, 6);
+
+        selectDevice(boardDev);
+        Preferences p;
+        ta::pairkey::savePeer(p, 0, remoteMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        board.setRequestCallback(&LoopbackRig::onRequest_, this);
+        board.begin();
+        ctl.begin(&relay_, ta::ctl::Config());
+
+        selectDevice(remoteDev);
+        ta::pairkey::savePeer(p, 0, boardMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+        startRemote_();
+        buttons.begin();
+        buttons.subscribe(&LoopbackRig::onButton_, this);
+
+        run(2000);
+        ta::probe::probes().reset();
+    }
+
+    // The remote restarts (its lease seq with it) and pairs again; the board forgot it
+    // first. Returns once the new pairing is acked and connected, false past limitMs.
+    bool rebootRemoteAndRepair(uint32_t limitMs) {
+        selectDevice(boardDev);
+        board.forget();
+        selectDevice(remoteDev);
+        startRemote_();
+        link->startPairing(0x01, limitMs);
+        for (uint32_t ms = 0; ms < limitMs; ms += kRemoteLoopMs) {
+            run(kRemoteLoopMs);
+            if (!link->isPairing() && link->isConnected()) return true;
+        }
+        return false;
+    }
+
+    void setUp(bool down) {
+        uint32_t bit = 1u << 8;
+        remoteDev.gpioIn = down ? (remoteDev.gpioIn & ~bit) : (remoteDev.gpioIn | bit);
+    }
+
+    // 1 ms steps: air, then each device's loop when it is due
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; ++i) {
+            now++;
+            boardDev.nowMs = remoteDev.nowMs = now;
+            deliverDue_();
+            if (now % kRemoteLoopMs == 0) {
+                selectDevice(remoteDev);
+                buttons.service();
+                link->service();
+                launch_(remoteDev, boardDev, remoteMac);
+            }
+            if (now % kBoardLoopMs == 0) {
+                selectDevice(boardDev);
+                ta::peers::QueuedRequest q;
+                while (queue_.pop(q)) {
+                    if (q.req.kind == Request::Kind::Manual && !ta::protocol::isManualStop(q.req)) {
+                        probes().mark(Hop::Recv, q.us);
+                    }
+                    ctl.apply(q.req);
+                }
+                ctl.update(now, 20.0f);
+                board.service();
+                launch_(boardDev, remoteDev, boardMac);
+            }
+        }
+    }
+
+    uint32_t relayOnCount() const { return relay_.onCount; }
+    bool relayOn() const { return relay_.on; }
+    uint32_t framesSent() const { return framesSent_; }
+
+    // Drop one frame in every lossEvery (either direction); 0 = lossless
+    void setLoss(uint32_t lossEvery, uint32_t seed) { lossEvery_ = lossEvery; lossRng_ = seed ? seed : 1; }
+
+private:
+    // Mirrors Actuators::write_: the stamp is where the relay pin goes on
+    struct Relay : ta::ctl::IOutputs {
+        bool on = false;
+        uint32_t onCount = 0;
+        void setCompressor(bool c) override {
+            if (c && !on) { probes().mark(Hop::Actuate, micros()); onCount++; }
+            on = c;
+        }
+        void setVent(bool) override {}
+        void stopAll() override { on = false; }
+        bool compressorRunning() const override { return on; }
+    };
+    struct InFlight { uint32_t at; FakeDevice* to; const uint8_t* fromMac; SentFrame f; };
+
+    void launch_(FakeDevice& from, FakeDevice& to, const uint8_t* fromMac) {
+        for (const SentFrame& f : from.tx) {
+            static const uint8_t kBcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+            bool bcast = f.broadcast || memcmp(f.mac, kBcast, 6) == 0;
+            if (!bcast && memcmp(f.mac, to.mac, 6) != 0) continue;
+            framesSent_++;
+            if (lossEvery_ && nextLoss_() % lossEvery_ == 0) continue;
+            air_.push_back(InFlight{ now + kAirMs, &to, fromMac, f });
+        }
+        from.tx.clear();
+    }
+    void deliverDue_() {
+        while (!air_.empty() && air_.front().at <= now) {
+            InFlight m = air_.front();
+            air_.pop_front();
+            selectDevice(*m.to);
+            m.to->deliver(m.fromMac, m.f.data, (int)m.f.len);
+        }
+    }
+
+    void startRemote_() {
+        link.reset();                       // one radio instance at a time
+        remoteDev.peers.clear();            // a reboot forgets the radio's peer list
+        remoteDev.tx.clear();
+        link.reset(new ta::comms::EspNowLink());
+        link->setPmk(ta::cfg::LinkShared().pmk);
+        link->begin(nullptr);
+        link->requestReconnect();
+    }
+
+    uint32_t nextLoss_() { lossRng_ ^= lossRng_ << 13; lossRng_ ^= lossRng_ >> 17; lossRng_ ^= lossRng_ << 5; return lossRng_; }
+
+    // Radio callback: timed here, stamped from the board loop (as App does)
+    static bool onRequest_(void* ctx, uint8_t slot, const Request& r) {
+        ta::peers::QueuedRequest q;
+        q.req = r;
+        q.slot = slot;
+        q.us = (uint32_t)micros();
+        return static_cast<LoopbackRig*>(ctx)->queue_.push(q);
+    }
+    // The manual screen: air while Up is down (as TA_State drives the link)
+    static void onButton_(void* ctx, const ta::input::Event& e) {
+        LoopbackRig* rig = static_cast<LoopbackRig*>(ctx);
+        if (e.id != ta::input::ButtonId::Up) return;
+        if (e.action == ta::input::Action::Pressed) rig->link->holdManual((uint8_t)ta::protocol::ManualCode::Air);
+        else if (e.action == ta::input::Action::Released) rig->link->releaseManual();
+    }
+
+    Relay relay_;
+    ta::peers::RequestQueue queue_;
+    std::deque<InFlight> air_;
+    uint32_t framesSent_ = 0;
+    uint32_t lossEvery_ = 0;
+    uint32_t lossRng_ = 1;
+};
+
+struct Rng {
+    uint32_t s;
+    explicit Rng(uint32_t seed) : s(seed ? seed : 1) {}
+    uint32_t next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+TEST(LatencyLoopback, BouncyPresses_EachHopWithinBudget) {
+    LoopbackRig rig;
+    rig.begin();
+    Rng rng(0x1A7E5CEDu);
+    const int kPresses = 200;
+
+    for (int i = 0; i < kPresses; ++i) {
+        rig.run(600 + rng.below(kBoardLoopMs * kRemoteLoopMs));   // release long done; phase jitter
+        uint32_t bounce = rng.below(kMaxBounceMs + 1);
+        for (uint32_t b = 0; b < bounce; ++b) {
+            rig.setUp(rng.below(2) != 0);
+            rig.run(1);
+        }
+        rig.setUp(true);
+        rig.run(200 + rng.below(200));
+        rig.setUp(false);
+    }
+    rig.run(1000);
+
+    const Probes& p = probes();
+    StdOut out;
+    report(out, p, "[LAT]");
+
+    EXPECT_EQ(rig.relayOnCount(), (uint32_t)kPresses);
+    EXPECT_EQ(p.endToEnd().count, (uint32_t)kPresses);
+    EXPECT_LE(p.segment(Hop::Dispatch).p99Us(), kEdgeToDispatchUs);
+    EXPECT_GE(p.segment(Hop::Dispatch).minUs, kDebounceMs * 1000u);
+    EXPECT_LE(p.segment(Hop::Send).p99Us(), kDispatchToSendUs);
+    EXPECT_LE(p.segment(Hop::Recv).p99Us(), kSendToRecvUs);
+    EXPECT_LE(p.segment(Hop::Actuate).p99Us(), kRecvToActuateUs);
+    EXPECT_LE(p.endToEnd().p99Us(), kEndToEndUs);
+    EXPECT_LE(p.endToEnd().p99Us(), p.endToEnd().maxUs);
+}
+
+// Release -> relay off, pressing and releasing Up cleanly; -1 if still on after limitMs
+static int32_t holdAndRelease(LoopbackRig& rig, uint32_t holdMs, uint32_t limitMs) {
+    rig.setUp(true);
+    rig.run(holdMs);
+    rig.setUp(false);
+    for (uint32_t ms = 0; ms < limitMs; ++ms) {
+        if (!rig.relayOn()) return (int32_t)ms;
+        rig.run(1);
+    }
+    return -1;
+}
+
+TEST(LatencyLoopback, Release_StopsWithinLoopPeriods) {
+    LoopbackRig rig;
+    rig.begin();
+    for (int i = 0; i < 20; ++i) {
+        rig.run(500);
+        int32_t ms = holdAndRelease(rig, 2500, 5000);
+        ASSERT_GE(ms, 0);
+        EXPECT_LE((uint32_t)ms, kDebounceMs + kRemoteLoopMs + kAirMs + kBoardLoopMs + 1);
+    }
+}
+
+TEST(LatencyLoopback, LossyAir_StopBoundedByLease) {
+    const ta::link::LeaseConfig lease;
+    LoopbackRig rig;
+    rig.begin();
+    rig.setLoss(3, 0x5EEDu);
+    uint32_t worst = 0;
+    for (int i = 0; i < 50; ++i) {
+        rig.run(500);
+        int32_t ms = holdAndRelease(rig, 3000, 10000);
+        ASSERT_GE(ms, 0);
+        if ((uint32_t)ms > worst) worst = (uint32_t)ms;
+    }
+    printf("[LAT] 1-in-3 loss: worst release -> relay off %u ms\n", (unsigned)worst);
+    EXPECT_LE(worst, kDebounceMs + kRemoteLoopMs + lease.leaseMs + kBoardLoopMs);
+}
+
+TEST(LatencyLoopback, SteadyHold_FewerFramesThanResendStream) {
+    const uint32_t kHoldMs = 10000;
+    const uint32_t kRepeatMs = ta::cfg::LinkShared().manualRepeatMs;
+    LoopbackRig rig;
+    rig.begin();
+    uint32_t before = rig.framesSent();
+    rig.run(kHoldMs);
+    uint32_t idleFrames = rig.framesSent() - before;    // the link's own pings and status
+    rig.setUp(true);
+    rig.run(1000);
+    before = rig.framesSent();
+    rig.run(kHoldMs);
+    uint32_t holdFrames = rig.framesSent() - before - idleFrames;
+    rig.setUp(false);
+    rig.run(1000);
+    printf("[LAT] %u ms hold: %u manual frames (grants + acks) vs %u resends\n",
+           (unsigned)kHoldMs, (unsigned)holdFrames, (unsigned)(kHoldMs / kRepeatMs));
+    EXPECT_LT(holdFrames, kHoldMs / kRepeatMs);
+    EXPECT_FALSE(rig.relayOn());
+}
+
+TEST(LatencyLoopback, RepairedRemote_FirstHoldNotDroppedAsStale) {
+    LoopbackRig rig;
+    rig.begin();
+    rig.setUp(true);
+    rig.run(10000);                         // plenty of renewals: the board's seq is well past 1
+    rig.setUp(false);
+    rig.run(100);
+    ASSERT_FALSE(rig.relayOn());
+
+    ASSERT_TRUE(rig.rebootRemoteAndRepair(3000));
+    int32_t ms = holdAndRelease(rig, 1000, 2000);   // still inside the board's stale-seq window
+    ASSERT_GE(ms, 0);
+    EXPECT_EQ(rig.relayOnCount(), 2u);
+}
+
+// ============================================================================
+// RTT per board
+// ============================================================================
+// Answers the remote's pending Pings as board `mac` would; returns how many it answered
+static int answerPings(FakeDevice& dev, const uint8_t* boardMac) {
+    int n = 0;
+    std::vector<SentFrame> tx;
+    tx.swap(dev.tx);
+    for (const SentFrame& f : tx) {
+        Request r;
+        if (memcmp(f.mac, boardMac, 6) != 0 || !ta::protocol::parseRequest(f.data, (int)f.len, r)) continue;
+        if (r.kind != Request::Kind::Ping) continue;
+        uint8_t pong[ta::protocol::kPayloadLen];
+        ta::protocol::packPong(pong, r.seq);
+        dev.deliver(boardMac, pong, ta::protocol::kPayloadLen);
+        n++;
+    }
+    for (const SentFrame& f : tx) if (memcmp(f.mac, boardMac, 6) != 0) dev.tx.push_back(f);
+    return n;
+}
+
+TEST(LinkRtt, TwoBoards_EachTimedOnItsOwnPath) {
+    const uint8_t nearMac[6]   = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    const uint8_t farMac[6]    = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x04};
+    const uint8_t remoteMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+    FakeDevice dev;
+    memcpy(dev.mac, remoteMac, 6);
+    selectDevice(dev);
+    dev.nowMs = 1;
+    ta::cfg::LinkShared cfg;
+    uint8_t lmk[ta::pairkey::kKeyLen];
+    Preferences p;
+    ta::pairkey::deriveLmk(cfg.pmk, remoteMac, nearMac, 0x01, 0xC0FFEE, lmk);
+    ta::pairkey::savePeer(p, 0, nearMac, lmk);
+    ta::pairkey::deriveLmk(cfg.pmk, remoteMac, farMac, 0x01, 0xC0FFEE, lmk);
+    ta::pairkey::savePeer(p, 1, farMac, lmk);
+    p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+
+    ta::comms::EspNowLink link;
+    link.setPmk(cfg.pmk);
+    link.begin(nullptr);
+    link.setAdaptiveTiming(true, ta::link::LinkQualityConfig());
+
+    // The near board answers in 8 ms, the far one in 60 ms, every round
+    for (int round = 0; round < 8; ++round) {
+        dev.tx.clear();
+        ASSERT_TRUE(link.sendPing());
+        dev.nowMs += 8;
+        EXPECT_EQ(answerPings(dev, nearMac), 1);
+        link.service();
+        dev.nowMs += 52;
+        EXPECT_EQ(answerPings(dev, farMac), 1);
+        link.service();
+        dev.nowMs += 200;
+    }
+    EXPECT_NEAR(link.linkQuality(0).srttMs(), 8.0f, 1.0f);
+    EXPECT_NEAR(link.linkQuality(1).srttMs(), 60.0f, 1.0f);
+    EXPECT_GT(link.linkQuality(1).rtoMs(), link.linkQuality(0).rtoMs());
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
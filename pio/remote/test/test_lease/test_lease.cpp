@@ -0,0 +1,209 @@
+/**
+ * Unit tests for TA_Lease
+ * Tests the remote's manual lease: grants, RTO resends with backoff, renewal after
+ * the acknowledged grant, acknowledged and expired stops, and the frame count of a
+ * steady hold against the v1 resend stream
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Lease.h>
+#include <vector>
+
+using namespace ta::link;
+
+using Send = ManualLease::Send;
+
+static constexpr uint32_t kRto = 50;
+
+struct Sent {
+    uint32_t ms;
+    Send what;
+    uint8_t seq;
+    uint16_t leaseMs;
+};
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+class LeaseTest : public ::testing::Test {
+protected:
+    ManualLease lease;
+    LeaseConfig cfg;
+    std::vector<Sent> sent;
+    uint32_t now = 1000;
+
+    void SetUp() override {
+        lease.begin(cfg);
+    }
+
+    // Poll every ms; the board acks after ackMs (never when ackMs == 0)
+    void run(uint32_t ms, uint32_t ackMs) {
+        std::vector<Sent> inFlight;
+        for (uint32_t i = 0; i < ms; ++i, ++now) {
+            for (size_t k = 0; k < inFlight.size();) {
+                if (now - inFlight[k].ms >= ackMs) {
+                    lease.onAck(inFlight[k].seq, now);
+                    inFlight.erase(inFlight.begin() + k);
+                } else {
+                    ++k;
+                }
+            }
+            Send s = lease.poll(now, kRto);
+            if (s == Send::None) continue;
+            Sent f{ now, s, lease.seq(), lease.leaseMs() };
+            sent.push_back(f);
+            if (ackMs) inFlight.push_back(f);
+        }
+    }
+
+    size_t count(Send what) const {
+        size_t n = 0;
+        for (const Sent& s : sent) if (s.what == what) n++;
+        return n;
+    }
+};
+
+// ============================================================================
+// Grant
+// ============================================================================
+TEST_F(LeaseTest, Idle_SendsNothing) {
+    run(5000, 5);
+    EXPECT_TRUE(sent.empty());
+    EXPECT_FALSE(lease.active());
+}
+
+TEST_F(LeaseTest, Hold_GrantsAtOnceWithLease) {
+    lease.hold(0xFF, now);
+    run(1, 5);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_EQ(sent[0].what, Send::Grant);
+    EXPECT_EQ(sent[0].leaseMs, cfg.leaseMs);
+    EXPECT_EQ(lease.code(), 0xFF);
+}
+
+TEST_F(LeaseTest, LostGrant_ResentAfterRtoWithBackoff) {
+    lease.hold(0xFF, now);
+    run(1000, 0);
+    ASSERT_GE(sent.size(), 5u);
+    for (const Sent& s : sent) {
+        EXPECT_EQ(s.seq, sent[0].seq);           // same frame until acked
+    }
+    EXPECT_EQ(sent[1].ms - sent[0].ms, kRto);
+    EXPECT_EQ(sent[2].ms - sent[1].ms, 2 * kRto);
+    EXPECT_EQ(sent[3].ms - sent[2].ms, 4 * kRto);
+    EXPECT_EQ(sent[4].ms - sent[3].ms, 8 * kRto);
+    EXPECT_EQ(sent.back().ms - sent[sent.size() - 2].ms, 8 * kRto);
+}
+
+TEST_F(LeaseTest, StaleAck_Ignored) {
+    lease.hold(0xFF, now);
+    run(1, 0);
+    EXPECT_FALSE(lease.onAck((uint8_t)(lease.seq() - 1), now));
+    EXPECT_TRUE(lease.onAck(lease.seq(), now));
+    EXPECT_FALSE(lease.onAck(lease.seq(), now)); // duplicate
+}
+
+// ============================================================================
+// Renewal
+// ============================================================================
+TEST_F(LeaseTest, SteadyHold_RenewsEveryRenewMs) {
+    lease.hold(0xFF, now);
+    run(10000, 5);
+    ASSERT_GT(sent.size(), 2u);
+    for (size_t i = 1; i < sent.size(); ++i) {
+        EXPECT_EQ(sent[i].ms - sent[i - 1].ms, cfg.renewMs);
+        EXPECT_EQ(sent[i].seq, (uint8_t)(sent[i - 1].seq + 1));
+    }
+    EXPECT_LT(cfg.renewMs, cfg.leaseMs); // renewed before the board's lease runs out
+}
+
+TEST_F(LeaseTest, SteadyHold_FewerFramesThanResendStream) {
+    const uint32_t kHoldMs = 10000;
+    const uint32_t kRepeatMs = 300;              // LinkShared::manualRepeatMs
+    lease.hold(0xFF, now);
+    run(kHoldMs, 5);
+    size_t leaseFrames = sent.size() * 2;        // each grant is acknowledged
+    size_t streamFrames = kHoldMs / kRepeatMs + 1;
+    printf("[LEASE] %u ms hold: %u frames (grants + acks) vs %u resends\n",
+           (unsigned)kHoldMs, (unsigned)leaseFrames, (unsigned)streamFrames);
+    EXPECT_LT(leaseFrames, streamFrames);
+}
+
+TEST_F(LeaseTest, LostRenewal_ResentWellInsideLease) {
+    lease.hold(0xFF, now);
+    run(cfg.renewMs + 1, 5);                     // grant acked, first renewal out
+    size_t before = sent.size();
+    run(3 * kRto + 1, 0);                        // renewal and two resends lost
+    EXPECT_EQ(sent.size(), before + 2);
+    EXPECT_LT(sent.back().ms - sent[0].ms, (uint32_t)cfg.leaseMs);
+}
+
+TEST_F(LeaseTest, CodeChange_NewGrant) {
+    lease.hold(0xFF, now);
+    run(10, 5);
+    lease.hold(0xFF, now);                       // same hold: nothing new
+    run(10, 5);
+    EXPECT_EQ(sent.size(), 1u);
+    lease.hold(0x00, now);
+    run(10, 5);
+    ASSERT_EQ(sent.size(), 2u);
+    EXPECT_NE(sent[1].seq, sent[0].seq);
+    EXPECT_EQ(lease.code(), 0x00);
+}
+
+// ============================================================================
+// Stop
+// ============================================================================
+TEST_F(LeaseTest, Release_StopAckedAndTimed) {
+    lease.hold(0xFF, now);
+    run(300, 4);
+    lease.release(now);
+    run(100, 4);
+    ASSERT_EQ(count(Send::Stop), 1u);
+    EXPECT_EQ(sent.back().leaseMs, 0);
+    EXPECT_FALSE(lease.active());
+    ASSERT_EQ(lease.stopLatency().count, 1u);
+    EXPECT_EQ(lease.stopLatency().maxUs, 4000u);
+    EXPECT_EQ(lease.stopsExpired(), 0u);
+}
+
+TEST_F(LeaseTest, Release_LostStopGivenUpWhenLeaseRunsOut) {
+    lease.hold(0xFF, now);
+    run(700, 5);
+    uint32_t lastGrant = sent.back().ms;
+    lease.release(now);
+    run(5000, 0);
+    EXPECT_FALSE(lease.active());
+    EXPECT_EQ(lease.stopsExpired(), 1u);
+    EXPECT_EQ(lease.stopLatency().count, 0u);
+    for (const Sent& s : sent) {
+        if (s.what == Send::Stop) {
+            EXPECT_LT(s.ms - lastGrant, (uint32_t)cfg.leaseMs);
+        }
+    }
+    EXPECT_GE(count(Send::Stop), 3u);
+}
+
+TEST_F(LeaseTest, Release_WhenIdle_NoStop) {
+    lease.release(now);
+    run(100, 5);
+    EXPECT_TRUE(sent.empty());
+}
+
+TEST_F(LeaseTest, HoldAgainWhileStopping_GrantsAgain) {
+    lease.hold(0xFF, now);
+    run(100, 0);
+    lease.release(now);
+    lease.hold(0xFF, now);
+    run(1, 0);
+    EXPECT_EQ(sent.back().what, Send::Grant);
+    EXPECT_TRUE(lease.holding());
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,208 @@
+/**
+ * Unit tests for TA_LinkQuality
+ * Tests RTT smoothing, ping-loss estimation, the adaptive timeout/backoff derivation
+ * and the latency histogram behind p99
+ */
+
+#include <gtest/gtest.h>
+#include <TA_LinkQuality.h>
+
+using namespace ta::link;
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class LinkQualityTest : public ::testing::Test {
+protected:
+    LinkQuality lq;
+    LinkQualityConfig cfg;
+
+    void SetUp() override {
+        cfg.initialTimeoutMs = 5000;
+        cfg.initialBackoffMs = 200;
+        cfg.backoffMaxMs = 2000;
+        cfg.statusIntervalMs = 1000;
+        cfg.timeoutMinMs = 1500;
+        cfg.timeoutMaxMs = 10000;
+        lq.begin(cfg);
+    }
+
+    // Ping at `now`, pong after `rtt` ms
+    void exchange(uint32_t& now, uint32_t rtt) {
+        uint8_t s = lq.nextSeq();
+        lq.onPingSent(s, now);
+        now += rtt;
+        lq.onPong(s, now);
+    }
+
+    // Ping that never gets an answer
+    void drop(uint32_t& now) {
+        uint8_t s = lq.nextSeq();
+        lq.onPingSent(s, now);
+        now += lq.lossTimeoutMs();
+        lq.expire(now);
+    }
+};
+
+// ============================================================================
+// Initialization Tests
+// ============================================================================
+TEST_F(LinkQualityTest, InitialState_UsesFallbacks) {
+    EXPECT_FALSE(lq.hasRtt());
+    EXPECT_EQ(lq.connectionTimeoutMs(), 5000u);
+    EXPECT_EQ(lq.pingBackoffStartMs(), 200u);
+    EXPECT_EQ(lq.pingBackoffMaxMs(), 2000u);
+    EXPECT_FLOAT_EQ(lq.lossRatio(), 0.0f);
+}
+
+// ============================================================================
+// RTT Tests
+// ============================================================================
+TEST_F(LinkQualityTest, FirstSample_SeedsSrtt) {
+    uint32_t now = 1000;
+    exchange(now, 20);
+    EXPECT_TRUE(lq.hasRtt());
+    EXPECT_FLOAT_EQ(lq.srttMs(), 20.0f);
+    EXPECT_FLOAT_EQ(lq.rttVarMs(), 10.0f);
+}
+
+TEST_F(LinkQualityTest, Srtt_ConvergesToSteadyRtt) {
+    uint32_t now = 0;
+    exchange(now, 100);
+    for (int i = 0; i < 50; ++i) { now += 500; exchange(now, 20); }
+    EXPECT_NEAR(lq.srttMs(), 20.0f, 1.0f);
+    EXPECT_LT(lq.rttVarMs(), 2.0f);
+}
+
+TEST_F(LinkQualityTest, Pong_UnknownSeq_Ignored) {
+    uint32_t now = 0;
+    uint8_t s = lq.nextSeq();
+    lq.onPingSent(s, now);
+    EXPECT_FALSE(lq.onPong(s + 1, 10));
+    EXPECT_TRUE(lq.onPong(s, 10));
+    EXPECT_FALSE(lq.onPong(s, 12)); // duplicate
+    EXPECT_FLOAT_EQ(lq.srttMs(), 10.0f);
+}
+
+TEST_F(LinkQualityTest, Rto_IsClampedToFloor) {
+    uint32_t now = 0;
+    for (int i = 0; i < 30; ++i) { now += 500; exchange(now, 2); }
+    EXPECT_EQ(lq.rtoMs(), cfg.rtoMinMs);
+}
+
+// ============================================================================
+// Loss Tests
+// ============================================================================
+TEST_F(LinkQualityTest, Loss_ExpiredPingsCounted) {
+    uint32_t now = 0;
+    exchange(now, 20);
+    drop(now);
+    EXPECT_EQ(lq.pingsLost(), 1u);
+    EXPECT_GT(lq.lossRatio(), 0.0f);
+}
+
+TEST_F(LinkQualityTest, Loss_DecaysAfterRecovery) {
+    uint32_t now = 0;
+    exchange(now, 20);
+    for (int i = 0; i < 5; ++i) drop(now);
+    float peak = lq.lossRatio();
+    for (int i = 0; i < 30; ++i) exchange(now, 20);
+    EXPECT_LT(lq.lossRatio(), peak * 0.1f);
+}
+
+TEST_F(LinkQualityTest, Loss_SlotReuseCountsLoss) {
+    uint32_t now = 0;
+    for (int i = 0; i < LinkQuality::kSlots + 2; ++i) {
+        lq.onPingSent(lq.nextSeq(), now); // never answered, never expired
+    }
+    EXPECT_EQ(lq.pingsLost(), 2u);
+}
+
+// ============================================================================
+// Adaptive Timing Tests
+// ============================================================================
+TEST_F(LinkQualityTest, CleanLink_TimeoutShorterThanFixedDefault) {
+    uint32_t now = 0;
+    for (int i = 0; i < 20; ++i) { now += 2000; exchange(now, 15); }
+    uint32_t t = lq.connectionTimeoutMs();
+    EXPECT_LT(t, 5000u);
+    EXPECT_GE(t, cfg.minMisses * cfg.statusIntervalMs);
+}
+
+TEST_F(LinkQualityTest, LossyLink_TimeoutLongerThanCleanLink) {
+    uint32_t now = 0;
+    for (int i = 0; i < 20; ++i) { now += 2000; exchange(now, 15); }
+    uint32_t clean = lq.connectionTimeoutMs();
+    // ~40% loss
+    for (int i = 0; i < 40; ++i) {
+        if (i % 5 < 2) drop(now); else exchange(now, 15);
+    }
+    EXPECT_GT(lq.allowedMisses(), cfg.minMisses);
+    EXPECT_GT(lq.connectionTimeoutMs(), clean);
+    EXPECT_LE(lq.connectionTimeoutMs(), cfg.timeoutMaxMs);
+}
+
+TEST_F(LinkQualityTest, AllowedMisses_CappedOnDeadLink) {
+    uint32_t now = 0;
+    exchange(now, 15);
+    for (int i = 0; i < 100; ++i) drop(now);
+    EXPECT_EQ(lq.allowedMisses(), cfg.maxMisses);
+}
+
+TEST_F(LinkQualityTest, Backoff_TracksRttAndStaysOrdered) {
+    uint32_t now = 0;
+    for (int i = 0; i < 20; ++i) { now += 2000; exchange(now, 80); }
+    EXPECT_NEAR((float)lq.pingBackoffStartMs(), 80.0f, 10.0f);
+    EXPECT_GE(lq.pingBackoffMaxMs(), lq.pingBackoffStartMs());
+    EXPECT_LE(lq.pingBackoffMaxMs(), cfg.backoffMaxMs);
+}
+
+// ============================================================================
+// Latency statistics
+// ============================================================================
+TEST(LatencyStatsTest, Empty_AllZero) {
+    LatencyStats s;
+    EXPECT_EQ(s.meanUs(), 0u);
+    EXPECT_EQ(s.p99Us(), 0u);
+}
+
+TEST(LatencyStatsTest, SmallValues_Exact) {
+    LatencyStats s;
+    for (uint32_t us = 1; us <= 10; ++us) s.add(us);
+    EXPECT_EQ(s.minUs, 1u);
+    EXPECT_EQ(s.maxUs, 10u);
+    EXPECT_EQ(s.meanUs(), 5u);
+    EXPECT_EQ(s.percentileUs(0.5f), 5u);
+    EXPECT_EQ(s.p99Us(), 10u);
+}
+
+TEST(LatencyStatsTest, P99_CatchesTailWithinBucket) {
+    LatencyStats s;
+    for (int i = 0; i < 980; ++i) s.add(2000 + i);        // 2.0..3.0 ms
+    for (int i = 0; i < 20; ++i) s.add(40000 + 100 * i);  // 2% tail at ~40 ms
+    uint32_t p99 = s.p99Us();
+    EXPECT_GE(p99, 40000u);
+    EXPECT_LE(p99, 42000u * 9 / 8);
+    EXPECT_LE(s.percentileUs(0.9f), 3000u * 9 / 8);
+    EXPECT_LE(p99, s.maxUs);
+}
+
+TEST(LatencyStatsTest, Buckets_CoverRangeInOrder) {
+    using S = LatencyStats;
+    uint32_t prevTop = 0;
+    for (int i = 1; i < S::kBuckets - 1; ++i) {
+        EXPECT_EQ(S::bucket_(S::bucketTop_(i)), i);
+        EXPECT_EQ(S::bucket_(S::bucketTop_(i - 1) + 1), i);
+        EXPECT_GT(S::bucketTop_(i), prevTop);
+        prevTop = S::bucketTop_(i);
+    }
+    EXPECT_EQ(S::bucket_(0xFFFFFFFFu), S::kBuckets - 1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
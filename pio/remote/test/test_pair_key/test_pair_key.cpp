@@ -0,0 +1,280 @@
+/**
+ * Unit tests for TA_PairKey
+ * Tests SHA-256/HMAC against published vectors, per-pair LMK derivation, the NVS
+ * storage paths (against a fake Preferences), and the one-off derivation cost
+ */
+
+#include <gtest/gtest.h>
+#include <TA_PairKey.h>
+#include <TA_Protocol.h>
+#include <TA_Config.h>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ta::pairkey;
+
+// ============================================================================
+// Fake Preferences - same surface as Arduino's Preferences, backed by a map
+// ============================================================================
+class FakePrefs {
+public:
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+    std::string ns;
+    bool open = false;
+    bool readOnly = false;
+    bool failBegin = false;
+    int writes = 0;
+
+    bool begin(const char* name, bool ro = false) {
+        if (failBegin) return false;
+        ns = name; open = true; readOnly = ro;
+        return true;
+    }
+    void end() { open = false; }
+
+    size_t getBytesLength(const char* key) {
+        auto& m = nvs[ns];
+        auto it = m.find(key);
+        return it == m.end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t len) {
+        auto& m = nvs[ns];
+        auto it = m.find(key);
+        if (it == m.end() || it->second.size() > len) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* buf, size_t len) {
+        if (readOnly) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(buf);
+        nvs[ns][key] = std::vector<uint8_t>(p, p + len);
+        writes++;
+        return len;
+    }
+    bool remove(const char* key) {
+        if (readOnly) return false;
+        return nvs[ns].erase(key) > 0;
+    }
+
+    void reset() { nvs.clear(); open = false; failBegin = false; writes = 0; }
+};
+
+static std::string hex(const uint8_t* p, size_t n) {
+    static const char* d = "0123456789abcdef";
+    std::string s;
+    for (size_t i = 0; i < n; ++i) { s += d[p[i] >> 4]; s += d[p[i] & 0xF]; }
+    return s;
+}
+
+static std::string sha256Hex(const std::string& msg) {
+    uint8_t out[Sha256::kDigestLen];
+    Sha256 s;
+    s.update(reinterpret_cast<const uint8_t*>(msg.data()), msg.size());
+    s.finish(out);
+    return hex(out, sizeof(out));
+}
+
+// ============================================================================
+// Test Fixture - Provides common setup
+// ============================================================================
+class PairKeyTest : public ::testing::Test {
+protected:
+    FakePrefs prefs;
+    uint8_t pmk[kKeyLen];
+    const uint8_t remoteMac[6] = {0x34, 0x85, 0x18, 0x01, 0x02, 0x03};
+    const uint8_t boardMac[6]  = {0x34, 0x85, 0x18, 0xAA, 0xBB, 0xCC};
+
+    void SetUp() override {
+        prefs.reset();
+        const ta::cfg::LinkShared link{};
+        memcpy(pmk, link.pmk, kKeyLen);
+    }
+};
+
+// ============================================================================
+// Hash Tests (FIPS 180-4 / RFC 4231 vectors)
+// ============================================================================
+TEST(Sha256, KnownVectors) {
+    EXPECT_EQ(sha256Hex(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(sha256Hex("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(sha256Hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(Sha256, IncrementalMatchesOneShot) {
+    std::string msg(200, 'x');
+    Sha256 s;
+    for (size_t i = 0; i < msg.size(); i += 7) {
+        size_t n = std::min<size_t>(7, msg.size() - i);
+        s.update(reinterpret_cast<const uint8_t*>(msg.data()) + i, n);
+    }
+    uint8_t out[Sha256::kDigestLen];
+    s.finish(out);
+    EXPECT_EQ(hex(out, sizeof(out)), sha256Hex(msg));
+}
+
+TEST(Hmac, Rfc4231Vectors) {
+    uint8_t out[Sha256::kDigestLen];
+
+    uint8_t key1[20];
+    memset(key1, 0x0b, sizeof(key1));
+    hmacSha256(key1, sizeof(key1), reinterpret_cast<const uint8_t*>("Hi There"), 8, out);
+    EXPECT_EQ(hex(out, sizeof(out)), "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+    const char* data2 = "what do ya want for nothing?";
+    hmacSha256(reinterpret_cast<const uint8_t*>("Jefe"), 4,
+               reinterpret_cast<const uint8_t*>(data2), strlen(data2), out);
+    EXPECT_EQ(hex(out, sizeof(out)), "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    // Key longer than the block size is hashed first
+    uint8_t key6[131];
+    memset(key6, 0xaa, sizeof(key6));
+    const char* data6 = "Test Using Larger Than Block-Size Key - Hash Key First";
+    hmacSha256(key6, sizeof(key6), reinterpret_cast<const uint8_t*>(data6), strlen(data6), out);
+    EXPECT_EQ(hex(out, sizeof(out)), "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+// ============================================================================
+// Derivation Tests
+// ============================================================================
+TEST_F(PairKeyTest, Derive_Deterministic) {
+    uint8_t a[kKeyLen], b[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 0x12345678, a);
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 0x12345678, b);
+    EXPECT_EQ(hex(a, kKeyLen), hex(b, kKeyLen));
+}
+
+TEST_F(PairKeyTest, Derive_EveryInputChangesKey) {
+    uint8_t base[kKeyLen], k[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 0x12345678, base);
+
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 0x12345679, k);
+    EXPECT_NE(hex(base, kKeyLen), hex(k, kKeyLen)) << "nonce";
+    deriveLmk(pmk, remoteMac, boardMac, 0x02, 0x12345678, k);
+    EXPECT_NE(hex(base, kKeyLen), hex(k, kKeyLen)) << "group";
+    deriveLmk(pmk, boardMac, remoteMac, 0x01, 0x12345678, k);
+    EXPECT_NE(hex(base, kKeyLen), hex(k, kKeyLen)) << "roles swapped";
+
+    uint8_t otherPmk[kKeyLen];
+    memcpy(otherPmk, pmk, kKeyLen);
+    otherPmk[0] ^= 1;
+    deriveLmk(otherPmk, remoteMac, boardMac, 0x01, 0x12345678, k);
+    EXPECT_NE(hex(base, kKeyLen), hex(k, kKeyLen)) << "pmk";
+}
+
+TEST_F(PairKeyTest, Derive_BothSidesAgreeThroughKeyFrame) {
+    using namespace ta::protocol;
+    // Board: draw nonce, derive, send the Key frame
+    PairKey sent;
+    sent.groupId = 0x01;
+    sent.nonce = 0xCAFEF00D;
+    memcpy(sent.target, remoteMac, 6);
+    uint8_t frame[kPairKeyLen];
+    packPairKey(frame, sent);
+    uint8_t boardLmk[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, sent.groupId, sent.nonce, boardLmk);
+
+    // Remote: parse, check it is addressed to us, derive
+    PairKey got;
+    ASSERT_TRUE(parsePairKey(frame, kPairKeyLen, got));
+    EXPECT_EQ(memcmp(got.target, remoteMac, 6), 0);
+    uint8_t remoteLmk[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, got.groupId, got.nonce, remoteLmk);
+
+    EXPECT_EQ(hex(boardLmk, kKeyLen), hex(remoteLmk, kKeyLen));
+}
+
+// ============================================================================
+// Storage Tests
+// ============================================================================
+TEST_F(PairKeyTest, Storage_RoundTrip) {
+    uint8_t lmk[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 42, lmk);
+    ASSERT_TRUE(savePeer(prefs, remoteMac, lmk));
+    EXPECT_FALSE(prefs.open);
+
+    uint8_t mac[6] = {0}, got[kKeyLen] = {0};
+    ASSERT_TRUE(loadPeer(prefs, mac, got));
+    EXPECT_EQ(memcmp(mac, remoteMac, 6), 0);
+    EXPECT_EQ(hex(got, kKeyLen), hex(lmk, kKeyLen));
+    EXPECT_EQ(prefs.nvs[kNvsNamespace].size(), 2u); // "peer" + "lmk"
+}
+
+TEST_F(PairKeyTest, Storage_LegacyMacWithoutKey_ReadsUnpaired) {
+    prefs.nvs[kNvsNamespace][kNvsPeer] = std::vector<uint8_t>(remoteMac, remoteMac + 6);
+    uint8_t mac[6], lmk[kKeyLen];
+    EXPECT_FALSE(loadPeer(prefs, mac, lmk));
+}
+
+TEST_F(PairKeyTest, Storage_WrongLengthRejected) {
+    prefs.nvs[kNvsNamespace][kNvsPeer] = std::vector<uint8_t>(remoteMac, remoteMac + 6);
+    prefs.nvs[kNvsNamespace][kNvsLmk] = std::vector<uint8_t>(8, 0x55);
+    uint8_t mac[6], lmk[kKeyLen];
+    EXPECT_FALSE(loadPeer(prefs, mac, lmk));
+}
+
+TEST_F(PairKeyTest, Storage_ClearRemovesBoth) {
+    uint8_t lmk[kKeyLen] = {1};
+    ASSERT_TRUE(savePeer(prefs, remoteMac, lmk));
+    EXPECT_TRUE(clearPeer(prefs));
+    EXPECT_TRUE(prefs.nvs[kNvsNamespace].empty());
+    uint8_t mac[6];
+    EXPECT_FALSE(loadPeer(prefs, mac, lmk));
+}
+
+TEST_F(PairKeyTest, Storage_LeavesOtherKeysAlone) {
+    prefs.nvs[kNvsNamespace]["chan"] = {6};
+    uint8_t lmk[kKeyLen] = {1};
+    savePeer(prefs, remoteMac, lmk);
+    clearPeer(prefs);
+    EXPECT_EQ(prefs.nvs[kNvsNamespace].count("chan"), 1u);
+}
+
+TEST_F(PairKeyTest, Storage_RepairOverwritesKey) {
+    uint8_t k1[kKeyLen], k2[kKeyLen];
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 1, k1);
+    deriveLmk(pmk, remoteMac, boardMac, 0x01, 2, k2);
+    savePeer(prefs, remoteMac, k1);
+    savePeer(prefs, remoteMac, k2);
+    uint8_t mac[6], got[kKeyLen];
+    ASSERT_TRUE(loadPeer(prefs, mac, got));
+    EXPECT_EQ(hex(got, kKeyLen), hex(k2, kKeyLen));
+}
+
+TEST_F(PairKeyTest, Storage_NvsUnavailable_Fails) {
+    prefs.failBegin = true;
+    uint8_t mac[6], lmk[kKeyLen] = {0};
+    EXPECT_FALSE(savePeer(prefs, remoteMac, lmk));
+    EXPECT_FALSE(loadPeer(prefs, mac, lmk));
+    EXPECT_FALSE(clearPeer(prefs));
+}
+
+// ============================================================================
+// Benchmark - key derivation runs once per pairing, never per frame. Per-frame
+// CCMP is done by the radio; see TA_COMMS_BENCH in TA_Comms for the on-device figure.
+// ============================================================================
+TEST_F(PairKeyTest, Benchmark_DerivationCost) {
+    const int kRuns = 2000;
+    uint8_t lmk[kKeyLen];
+    uint8_t acc = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRuns; ++i) {
+        deriveLmk(pmk, remoteMac, boardMac, 0x01, (uint32_t)i, lmk);
+        acc ^= lmk[0];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / kRuns;
+    std::printf("[BENCH] deriveLmk: %.2f us/call (host), checksum %02x\n", us, acc);
+    EXPECT_LT(us, 1000.0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
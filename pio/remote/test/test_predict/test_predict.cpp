@@ -0,0 +1,153 @@
+/**
+ * Unit tests for TA_Predict
+ * Tests the remote's optimistic controller state: confirmation, correction and
+ * rollback against board status, and the misprediction counts
+ */
+
+#include <gtest/gtest.h>
+#include <TA_Predict.h>
+
+using namespace ta::ui;
+
+static const uint8_t kSeekAccept = ctrlBit(Ctrl::AirUp) | ctrlBit(Ctrl::Venting) | ctrlBit(Ctrl::Checking);
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+class PredictTest : public ::testing::Test {
+protected:
+    CtrlPredictor p;
+
+    void SetUp() override {
+        p.begin(2500);
+    }
+};
+
+// ============================================================================
+// Showing the prediction
+// ============================================================================
+TEST_F(PredictTest, NoPrediction_PassesReportThrough) {
+    EXPECT_EQ(p.reconcile(0, Ctrl::Checking), Ctrl::Checking);
+    EXPECT_FALSE(p.pending());
+    EXPECT_EQ(p.stats().resolved(), 0u);
+}
+
+TEST_F(PredictTest, Predict_ShowsExpectedAtOnce) {
+    EXPECT_EQ(p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept), Ctrl::AirUp);
+    EXPECT_TRUE(p.pending());
+}
+
+TEST_F(PredictTest, StaleReport_IgnoredBeforeTimeout) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(600, Ctrl::Idle), Ctrl::AirUp);
+    EXPECT_EQ(p.reconcile(2500, Ctrl::Idle), Ctrl::AirUp);
+    EXPECT_TRUE(p.pending());
+}
+
+// ============================================================================
+// Resolution
+// ============================================================================
+TEST_F(PredictTest, MatchingReport_Confirms) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(900, Ctrl::AirUp), Ctrl::AirUp);
+    EXPECT_FALSE(p.pending());
+    EXPECT_EQ(p.stats().confirmed, 1u);
+    EXPECT_EQ(p.stats().missed(), 0u);
+}
+
+TEST_F(PredictTest, AcceptedOtherState_Corrects) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(900, Ctrl::Venting), Ctrl::Venting);
+    EXPECT_FALSE(p.pending());
+    EXPECT_EQ(p.stats().corrected, 1u);
+}
+
+TEST_F(PredictTest, AcceptedStateSameAsPrior_DoesNotConfirm) {
+    // Seek while the board was checking: a Checking report may predate the command
+    p.predict(100, Ctrl::Checking, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(900, Ctrl::Checking), Ctrl::AirUp);
+    EXPECT_TRUE(p.pending());
+}
+
+TEST_F(PredictTest, Timeout_RollsBackToReport) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(2600, Ctrl::Idle), Ctrl::Idle);
+    EXPECT_FALSE(p.pending());
+    EXPECT_EQ(p.stats().rolledBack, 1u);
+}
+
+TEST_F(PredictTest, Error_RollsBackAtOnce) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    EXPECT_EQ(p.reconcile(300, Ctrl::Error), Ctrl::Error);
+    EXPECT_FALSE(p.pending());
+    EXPECT_EQ(p.stats().rolledBack, 1u);
+}
+
+TEST_F(PredictTest, ClearingError_StaleErrorIgnored) {
+    p.predict(100, Ctrl::Error, Ctrl::Idle);
+    EXPECT_EQ(p.reconcile(500, Ctrl::Error), Ctrl::Idle);
+    EXPECT_EQ(p.reconcile(1200, Ctrl::Idle), Ctrl::Idle);
+    EXPECT_EQ(p.stats().confirmed, 1u);
+}
+
+TEST_F(PredictTest, ClearingError_PersistentErrorRollsBack) {
+    p.predict(100, Ctrl::Error, Ctrl::Idle);
+    EXPECT_EQ(p.reconcile(2600, Ctrl::Error), Ctrl::Error);
+    EXPECT_EQ(p.stats().rolledBack, 1u);
+}
+
+TEST_F(PredictTest, CancelAfterSeek_StaleActiveIgnored) {
+    p.predict(100, Ctrl::AirUp, Ctrl::Idle);
+    EXPECT_EQ(p.reconcile(400, Ctrl::AirUp), Ctrl::Idle);
+    EXPECT_EQ(p.reconcile(1100, Ctrl::Idle), Ctrl::Idle);
+    EXPECT_EQ(p.stats().confirmed, 1u);
+}
+
+TEST_F(PredictTest, TimeoutAcrossWrap_Handled) {
+    p.predict(0xFFFFFF00u, Ctrl::Idle, Ctrl::Venting);
+    EXPECT_EQ(p.reconcile(0x100u, Ctrl::Idle), Ctrl::Venting);
+    EXPECT_EQ(p.reconcile(0x100u + 2500, Ctrl::Idle), Ctrl::Idle);
+}
+
+// ============================================================================
+// Stats
+// ============================================================================
+TEST_F(PredictTest, Supersede_NotScored_KeepsOriginalPrior) {
+    p.predict(100, Ctrl::Idle, Ctrl::Venting);            // manual vent press
+    p.predict(200, Ctrl::Idle, Ctrl::Idle);               // release before any status
+    EXPECT_EQ(p.stats().superseded, 1u);
+    EXPECT_EQ(p.reconcile(900, Ctrl::Idle), Ctrl::Idle);
+    EXPECT_EQ(p.stats().resolved(), 1u);
+    EXPECT_EQ(p.stats().confirmed, 1u);
+}
+
+TEST_F(PredictTest, Clear_DropsWithoutScoring) {
+    p.predict(100, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    p.clear();
+    EXPECT_EQ(p.reconcile(5000, Ctrl::Idle), Ctrl::Idle);
+    EXPECT_EQ(p.stats().resolved(), 0u);
+}
+
+TEST_F(PredictTest, MissRate_CountsCorrectionsAndRollbacks) {
+    p.predict(0, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    p.reconcile(500, Ctrl::AirUp);                        // confirmed
+    p.predict(1000, Ctrl::AirUp, Ctrl::Idle);
+    p.reconcile(1500, Ctrl::Idle);                        // confirmed
+    p.predict(2000, Ctrl::Idle, Ctrl::AirUp, kSeekAccept);
+    p.reconcile(2500, Ctrl::Venting);                     // corrected
+    p.predict(3000, Ctrl::Venting, Ctrl::AirUp);
+    p.reconcile(6000, Ctrl::Venting);                     // rolled back
+    EXPECT_EQ(p.stats().resolved(), 4u);
+    EXPECT_EQ(p.stats().missed(), 2u);
+    EXPECT_FLOAT_EQ(p.stats().missRate(), 0.5f);
+    p.resetStats();
+    EXPECT_FLOAT_EQ(p.stats().missRate(), 0.0f);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
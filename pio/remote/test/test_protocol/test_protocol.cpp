@@ -49,6 +49,12 @@ TEST(Protocol, PsiRoundTrip) {
     EXPECT_FLOAT_EQ(unpacked, original);
 }
 
+TEST(Protocol, CentiToByte_MatchesFloatPathEverywhere) {
+    for (uint32_t v = 0; v <= 0xFFFF; ++v) {
+        ASSERT_EQ(centiToByte05((uint16_t)v), psiToByte05(u16ToPsi01((uint16_t)v))) << "v=" << v;
+    }
+}
+
 // ============================================================================
 // Request Packing/Parsing Tests
 // ============================================================================
@@ -111,6 +117,92 @@ TEST(Protocol, PackRequest_Ping) {
     EXPECT_EQ(buf[1], 0);
 }
 
+TEST(Protocol, PingSeq_RoundTrip) {
+    Request req;
+    req.kind = Request::Kind::Ping;
+    req.seq = 0xA5;
+
+    uint8_t buf[kPayloadLen];
+    packRequest(buf, req);
+    EXPECT_EQ(buf[1], 0xA5);
+
+    Request parsed;
+    ASSERT_TRUE(parseRequest(buf, kPayloadLen, parsed));
+    EXPECT_EQ(parsed.kind, Request::Kind::Ping);
+    EXPECT_EQ(parsed.seq, 0xA5);
+}
+
+TEST(Protocol, Pong_RoundTrip) {
+    uint8_t buf[kPayloadLen];
+    packPong(buf, 17);
+    EXPECT_EQ(buf[0], static_cast<uint8_t>(LinkOp::Pong));
+
+    uint8_t seq = 0;
+    ASSERT_TRUE(parsePong(buf, kPayloadLen, seq));
+    EXPECT_EQ(seq, 17);
+}
+
+TEST(Protocol, Pong_NotAStatusOrPairFrame) {
+    uint8_t buf[kPayloadLen];
+    packPong(buf, 1);
+    Response resp;
+    EXPECT_FALSE(parseResponse(buf, kPayloadLen, resp));
+    EXPECT_FALSE(isPairingFrame(buf, kPayloadLen));
+
+    uint8_t seq;
+    uint8_t status[] = {'I', 1};
+    EXPECT_FALSE(parsePong(status, kPayloadLen, seq));
+    EXPECT_FALSE(parsePong(buf, 1, seq));
+}
+
+TEST(Protocol, Chan_RoundTrip) {
+    uint8_t buf[kPayloadLen];
+    uint8_t ch = 0xFF;
+    packChan(buf, 11);
+    EXPECT_TRUE(parseChan(buf, kPayloadLen, ch));
+    EXPECT_EQ(ch, 11);
+
+    packChan(buf, kChanRetuneRequest);
+    EXPECT_TRUE(parseChan(buf, kPayloadLen, ch));
+    EXPECT_EQ(ch, kChanRetuneRequest);
+
+    Response resp;
+    EXPECT_FALSE(parseResponse(buf, kPayloadLen, resp));
+    EXPECT_FALSE(isPairingFrame(buf, kPayloadLen));
+}
+
+TEST(Protocol, Chan_RejectsOutOfRange) {
+    uint8_t buf[] = {'H', 14};
+    uint8_t ch;
+    EXPECT_FALSE(parseChan(buf, kPayloadLen, ch));
+    EXPECT_FALSE(parseChan(buf, 1, ch));
+}
+
+TEST(Protocol, PairKey_RoundTrip) {
+    PairKey k;
+    k.groupId = 0x07;
+    k.nonce = 0xDEADBEEF;
+    const uint8_t mac[6] = {1, 2, 3, 4, 5, 6};
+    memcpy(k.target, mac, 6);
+    uint8_t buf[kPairKeyLen];
+    packPairKey(buf, k);
+
+    PairKey out;
+    ASSERT_TRUE(parsePairKey(buf, kPairKeyLen, out));
+    EXPECT_EQ(out.groupId, 0x07);
+    EXPECT_EQ(out.nonce, 0xDEADBEEFu);
+    EXPECT_EQ(memcmp(out.target, mac, 6), 0);
+}
+
+TEST(Protocol, PairKey_WrongLengthOrOpRejected) {
+    uint8_t buf[kPairKeyLen] = {'K'};
+    PairKey out;
+    EXPECT_FALSE(parsePairKey(buf, kPayloadLen, out));
+    EXPECT_FALSE(isPairingFrame(buf, kPairKeyLen));
+    buf[0] = 'A';
+    EXPECT_FALSE(parsePairKey(buf, kPairKeyLen, out));
+}
+
 TEST(Protocol, ParseRequest_Idle) {
     uint8_t data[] = {'I', 0x00};
     Request req;
@@ -361,6 +453,304 @@ TEST(Protocol, ZeroPsi) {
     EXPECT_FLOAT_EQ(parsed.targetPsi, 0.0f);
 }
 
+// ============================================================================
+// v2 Wire Format Tests (0.01 PSI)
+// ============================================================================
+
+// Conversions are usable at compile time
+static_assert(psiToU16_01(0.0f) == 0, "zero");
+static_assert(psiToU16_01(32.17f) == 3217, "centi-psi");
+static_assert(psiToU16_01(1000.0f) == 0xFFFF, "clamps high");
+static_assert(psiToU16_01(-3.0f) == 0, "clamps low");
+static_assert(psiToByte05(31.5f) == 63, "v1 helper stays constexpr");
+static_assert(negotiate(kProtoV1) == kProtoV1 && negotiate(9) == kProtoVersion, "lower wins");
+
+TEST(ProtocolV2, U16RoundTrip_FullRange) {
+    for (uint32_t v = 0; v <= 0xFFFF; ++v) {
+        ASSERT_EQ(psiToU16_01(u16ToPsi01((uint16_t)v)), v) << "v=" << v;
+    }
+}
+
+TEST(ProtocolV2, PsiRoundTrip_WithinHalfStep) {
+    for (float psi = 0.0f; psi < kMaxPsi01; psi += 0.137f) {
+        ASSERT_NEAR(u16ToPsi01(psiToU16_01(psi)), psi, 0.005f + psi * 1e-6f) << "psi=" << psi;
+    }
+}
+
+TEST(ProtocolV2, Clamp_NaNAndOutOfRange) {
+    EXPECT_EQ(psiToU16_01(NAN), 0);
+    EXPECT_EQ(psiToU16_01(-0.01f), 0);
+    EXPECT_EQ(psiToU16_01(kMaxPsi01), 0xFFFF);
+    EXPECT_EQ(psiToU16_01(INFINITY), 0xFFFF);
+    EXPECT_EQ(psiToByte05(NAN), 0);
+}
+
+TEST(ProtocolV2, StartRoundTrip_FullRange) {
+    for (uint32_t v = 0; v <= 0xFFFF; ++v) {
+        Request req; req.kind = Request::Kind::Start; req.targetPsi = u16ToPsi01((uint16_t)v);
+        uint8_t buf[kMaxPayloadLen];
+        ASSERT_EQ(packRequest(buf, req, kProtoV2), kWidePayloadLen);
+        Request parsed;
+        ASSERT_TRUE(parseRequest(buf, kWidePayloadLen, parsed));
+        ASSERT_EQ(parsed.kind, Request::Kind::Start);
+        ASSERT_EQ(psiToU16_01(parsed.targetPsi), v) << "v=" << v;
+    }
+}
+
+TEST(ProtocolV2, StatusRoundTrip_FullRange) {
+    for (uint32_t v = 0; v <= 0xFFFF; ++v) {
+        Response r = makeStatus(Status::AirUp, u16ToPsi01((uint16_t)v));
+        uint8_t buf[kMaxPayloadLen];
+        ASSERT_EQ(packResponse(buf, r, kProtoV2), kWidePayloadLen);
+        Response parsed;
+        ASSERT_TRUE(parseResponse(buf, kWidePayloadLen, parsed));
+        ASSERT_EQ(parsed.status, Status::AirUp);
+        ASSERT_EQ(parsed.centiPsi, v);
+        ASSERT_EQ(parsed.value, psiToByte05(u16ToPsi01((uint16_t)v))); // v1 view kept in step
+    }
+}
+
+TEST(ProtocolV2, V1Peer_GetsTwoByteFrames) {
+    Request req; req.kind = Request::Kind::Start; req.targetPsi = 32.25f;
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packRequest(buf, req, kProtoV1), kPayloadLen);
+    EXPECT_EQ(buf[1], psiToByte05(32.25f));
+
+    Response r = makeStatus(Status::Idle, 32.25f);
+    ASSERT_EQ(packResponse(buf, r, kProtoV1), kPayloadLen);
+    Response parsed;
+    ASSERT_TRUE(parseResponse(buf, kPayloadLen, parsed));
+    EXPECT_EQ(parsed.centiPsi, parsed.value * 50u); // v1 frames still fill centiPsi
+    EXPECT_FLOAT_EQ(responsePsi(parsed), 32.5f);
+}
+
+TEST(ProtocolV2, NonPressureFrames_StayV1) {
+    Request req; req.kind = Request::Kind::Manual; req.manual = ManualCode::Air;
+    uint8_t buf[kMaxPayloadLen];
+    EXPECT_EQ(packRequest(buf, req, kProtoV2), kPayloadLen);
+
+    ASSERT_EQ(packResponse(buf, makeError(7), kProtoV2), kPayloadLen);
+    Response parsed;
+    ASSERT_TRUE(parseResponse(buf, kPayloadLen, parsed));
+    EXPECT_EQ(parsed.status, Status::Error);
+    EXPECT_EQ(parsed.value, 7);
+    EXPECT_EQ(parsed.centiPsi, 0);
+}
+
+TEST(ProtocolV2, WideFrames_Rejected) {
+    uint8_t badVer[] = {'U', 3, 0x0C, 0x80};
+    uint8_t badErrVer[] = {'E', 3, 9, 12};
+    uint8_t wideIdle[] = {'I', kProtoV2, 0, 0};
+    Response resp;
+    Request req;
+    EXPECT_FALSE(parseResponse(badVer, kWidePayloadLen, resp));
+    EXPECT_FALSE(parseResponse(badErrVer, kWidePayloadLen, resp));
+    EXPECT_FALSE(parseRequest(wideIdle, kWidePayloadLen, req));
+    EXPECT_FALSE(parseResponse(badVer, 3, resp));
+}
+
+TEST(ProtocolV2, ErrorDetail_WideRoundTrip) {
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packResponse(buf, makeError(9, 23), kProtoV2), kWidePayloadLen);
+    EXPECT_EQ(buf[0], 'E');
+    EXPECT_EQ(buf[1], kProtoV2);
+    Response parsed;
+    ASSERT_TRUE(parseResponse(buf, kWidePayloadLen, parsed));
+    EXPECT_EQ(parsed.status, Status::Error);
+    EXPECT_EQ(parsed.value, 9);
+    EXPECT_EQ(parsed.detail, 23);
+    EXPECT_EQ(parsed.centiPsi, 0);
+}
+
+TEST(ProtocolV2, ExtendedStatus_CarriesTarget) {
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packResponse(buf, makeStatus(Status::AirUp, 31.5f, 40.09f), kProtoV2), kExtStatusLen);
+    Response parsed;
+    ASSERT_TRUE(parseResponse(buf, kExtStatusLen, parsed));
+    EXPECT_EQ(parsed.status, Status::AirUp);
+    EXPECT_FLOAT_EQ(responsePsi(parsed), 31.5f);
+    EXPECT_TRUE(hasTarget(parsed));
+    EXPECT_NEAR(responseTargetPsi(parsed), 40.09f, 0.005f);
+}
+
+TEST(ProtocolV2, ExtendedStatus_OnlyWhenTargetSet) {
+    uint8_t buf[kMaxPayloadLen];
+    EXPECT_EQ(packResponse(buf, makeStatus(Status::AirUp, 31.5f), kProtoV2), kWidePayloadLen);
+    ASSERT_EQ(packResponse(buf, makeStatus(Status::AirUp, 31.5f, 40.0f), kProtoV1), kPayloadLen);
+    Response parsed;
+    parsed.targetCentiPsi = 1234;
+    ASSERT_TRUE(parseResponse(buf, kPayloadLen, parsed));
+    EXPECT_FALSE(hasTarget(parsed)); // a v1 peer never sees it
+}
+
+TEST(ProtocolV2, ExtendedStatus_Rejected) {
+    uint8_t badVer[] = {'U', 3, 0x0C, 0x80, 0x0F, 0xA0};
+    uint8_t extErr[] = {'E', kProtoV2, 9, 12, 0, 0};
+    Response resp;
+    EXPECT_FALSE(parseResponse(badVer, kExtStatusLen, resp));
+    EXPECT_FALSE(parseResponse(extErr, kExtStatusLen, resp));
+}
+
+TEST(ProtocolV2, ErrorDetail_DroppedForV1Peer) {
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packResponse(buf, makeError(9, 23), kProtoV1), kPayloadLen);
+    Response parsed;
+    parsed.detail = 99;
+    ASSERT_TRUE(parseResponse(buf, kPayloadLen, parsed));
+    EXPECT_EQ(parsed.value, 9);
+    EXPECT_EQ(parsed.detail, 0);
+}
+
+TEST(ProtocolV2, Hello_RoundTripAndNegotiate) {
+    uint8_t buf[kPayloadLen];
+    packHello(buf);
+    uint8_t ver = 0;
+    ASSERT_TRUE(parseHello(buf, kPayloadLen, ver));
+    EXPECT_EQ(ver, kProtoVersion);
+    EXPECT_EQ(negotiate(ver), kProtoVersion);
+    EXPECT_EQ(negotiate(kProtoV1), kProtoV1);
+
+    packHello(buf, kProtoUnknown);
+    EXPECT_FALSE(parseHello(buf, kPayloadLen, ver));
+    Request req;
+    packHello(buf);
+    EXPECT_FALSE(parseRequest(buf, kPayloadLen, req)); // old boards ignore it
+}
+
+TEST(ProtocolV2, ManualLease_RoundTrip) {
+    Request req; req.kind = Request::Kind::Manual; req.manual = ManualCode::Air;
+    req.leased = true; req.seq = 0xA7; req.leaseMs = 1500;
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packRequest(buf, req, kProtoV2), kLeaseLen);
+    EXPECT_EQ(buf[0], static_cast<uint8_t>(Cmd::Manual));
+    EXPECT_EQ(buf[1], kProtoV2);
+    Request parsed;
+    ASSERT_TRUE(parseRequest(buf, kLeaseLen, parsed));
+    EXPECT_EQ(parsed.kind, Request::Kind::Manual);
+    EXPECT_EQ(parsed.manual, ManualCode::Air);
+    EXPECT_TRUE(parsed.leased);
+    EXPECT_EQ(parsed.seq, 0xA7);
+    EXPECT_EQ(parsed.leaseMs, 1500);
+    EXPECT_FALSE(isManualStop(parsed));
+
+    req.leaseMs = 0;
+    packRequest(buf, req, kProtoV2);
+    ASSERT_TRUE(parseRequest(buf, kLeaseLen, parsed));
+    EXPECT_TRUE(isManualStop(parsed));
+}
+
+TEST(ProtocolV2, ManualLease_V1PeerGetsPlainManual) {
+    Request req; req.kind = Request::Kind::Manual; req.manual = ManualCode::Vent;
+    req.leased = true; req.seq = 3; req.leaseMs = 1500;
+    uint8_t buf[kMaxPayloadLen];
+    ASSERT_EQ(packRequest(buf, req, kProtoV1), kPayloadLen);
+    Request parsed;
+    parsed.leased = true;
+    ASSERT_TRUE(parseRequest(buf, kPayloadLen, parsed));
+    EXPECT_EQ(parsed.manual, ManualCode::Vent);
+    EXPECT_FALSE(parsed.leased);
+    EXPECT_FALSE(isManualStop(parsed));
+}
+
+TEST(ProtocolV2, ManualLease_Rejected) {
+    uint8_t badVer[] = {'M', 3, 0xFF, 1, 0x05, 0xDC};
+    uint8_t badCode[] = {'M', kProtoV2, 0x01, 1, 0x05, 0xDC};
+    uint8_t wideStart[] = {'S', kProtoV2, 0x0C, 0x80, 0, 0};
+    uint8_t wideManual[] = {'M', kProtoV2, 0xFF, 1};
+    Request req;
+    EXPECT_FALSE(parseRequest(badVer, kLeaseLen, req));
+    EXPECT_FALSE(parseRequest(badCode, kLeaseLen, req));
+    EXPECT_FALSE(parseRequest(wideStart, kLeaseLen, req));
+    EXPECT_FALSE(parseRequest(wideManual, kWidePayloadLen, req));
+}
+
+TEST(ProtocolV2, LeaseAck_RoundTrip) {
+    uint8_t buf[kPayloadLen];
+    packLeaseAck(buf, 0x42);
+    Frame f;
+    ASSERT_TRUE(decodeFrame(buf, kPayloadLen, Dir::ToRemote, f));
+    EXPECT_EQ(f.cls, FrameClass::Link);
+    EXPECT_EQ(f.link, LinkOp::Lease);
+    EXPECT_EQ(f.linkValue, 0x42);
+    EXPECT_FALSE(decodeFrame(buf, kPayloadLen, Dir::ToBoard, f)); // boards never get one
+    Response resp;
+    EXPECT_FALSE(parseResponse(buf, kPayloadLen, resp));
+}
+
+// ============================================================================
+// Opcode Table / Dispatch Tests
+// ============================================================================
+
+TEST(ProtocolTable, EveryDefinedOpcode_ClassifiedPerDirection) {
+    for (int i = 0; i < kOpDefCount; ++i) {
+        const OpDef& d = kOpDefs[i];
+        uint8_t frame[kPairKeyLen] = { d.op };
+        int len = d.lens & kLen12 ? kPairKeyLen : kPayloadLen;
+        if (d.dirs & kDirToBoard) {
+            EXPECT_EQ(classify(frame, len, Dir::ToBoard), d.cls) << (char)d.op;
+        }
+        if (d.dirs & kDirToRemote) {
+            EXPECT_EQ(classify(frame, len, Dir::ToRemote), d.cls) << (char)d.op;
+        }
+    }
+}
+
+TEST(ProtocolTable, SharedLetter_MeansOneThingPerReceiver) {
+    uint8_t idle[] = {'I', 0};
+    EXPECT_EQ(classify(idle, 2, Dir::ToBoard), FrameClass::Cmd);
+    EXPECT_EQ(classify(idle, 2, Dir::ToRemote), FrameClass::Status);
+    uint8_t start[] = {'S', 60};
+    EXPECT_EQ(classify(start, 2, Dir::ToRemote), FrameClass::None); // only boards take commands
+    uint8_t pong[] = {'O', 1};
+    EXPECT_EQ(classify(pong, 2, Dir::ToBoard), FrameClass::None);
+}
+
+TEST(ProtocolTable, UnknownBytesAndLengths_Rejected) {
+    int known = 0;
+    for (int b = 0; b < 256; ++b) {
+        uint8_t f[kPairKeyLen] = { (uint8_t)b };
+        for (int len = 0; len <= kPairKeyLen; ++len) {
+            if (classify(f, len, Dir::ToBoard) != FrameClass::None) known++;
+            if (classify(f, len, Dir::ToRemote) != FrameClass::None) known++;
+        }
+    }
+    // Per receiver: board 4 Cmd + 1 wide Start + 1 lease + 4 Pair + 2 Link;
+    // remote 5 Status + 5 wide + 4 extended + 4 Pair + 4 Link
+    EXPECT_EQ(known, 12 + 22);
+}
+
+TEST(ProtocolTable, DecodeFrame_OneCallPerClass) {
+    Frame f;
+    uint8_t manual[] = {'M', 0xFF};
+    ASSERT_TRUE(decodeFrame(manual, 2, Dir::ToBoard, f));
+    EXPECT_EQ(f.cls, FrameClass::Cmd);
+    EXPECT_EQ(f.req.kind, Request::Kind::Manual);
+    EXPECT_EQ(f.req.manual, ManualCode::Air);
+
+    uint8_t status[kMaxPayloadLen];
+    packResponse(status, makeStatus(Status::Venting, 29.37f), kProtoV2);
+    ASSERT_TRUE(decodeFrame(status, kWidePayloadLen, Dir::ToRemote, f));
+    EXPECT_EQ(f.cls, FrameClass::Status);
+    EXPECT_EQ(f.resp.centiPsi, 2937);
+
+    uint8_t hello[kPayloadLen];
+    packHello(hello);
+    ASSERT_TRUE(decodeFrame(hello, kPayloadLen, Dir::ToBoard, f));
+    EXPECT_EQ(f.cls, FrameClass::Link);
+    EXPECT_EQ(f.link, LinkOp::Hello);
+    EXPECT_EQ(f.linkValue, kProtoVersion);
+
+    PairKey k; k.groupId = 3; k.nonce = 0xA1B2C3D4; k.target[5] = 9;
+    uint8_t key[kPairKeyLen];
+    packPairKey(key, k);
+    ASSERT_TRUE(decodeFrame(key, kPairKeyLen, Dir::ToRemote, f));
+    EXPECT_EQ(f.pair.op, PairOp::Key);
+    EXPECT_EQ(f.key.nonce, 0xA1B2C3D4u);
+
+    uint8_t badChan[] = {'H', 14};
+    EXPECT_FALSE(decodeFrame(badChan, 2, Dir::ToRemote, f));
+}
+
 // ============================================================================
 // Main function
 // ============================================================================
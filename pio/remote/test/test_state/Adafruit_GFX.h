@@ -0,0 +1,3 @@
+#pragma once
+// Headless: the state controller only fills a DisplayModel
+class Adafruit_GFX {};
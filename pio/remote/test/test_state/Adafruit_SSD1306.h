@@ -0,0 +1,4 @@
+#pragma once
+// Headless: the state controller only fills a DisplayModel
+#include "Adafruit_GFX.h"
+class Adafruit_SSD1306 : public Adafruit_GFX {};
@@ -0,0 +1,3 @@
+#pragma once
+// The remote's own libraries (lib_ignore'd in native_test)
+#include "../../lib/TA_Comms/src/TA_Comms.h"
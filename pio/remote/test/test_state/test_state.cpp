@@ -0,0 +1,149 @@
+/**
+ * Unit tests for TA_State
+ * Runs the remote's StateController on a real EspNowLink (over the stub transport in
+ * test_fuzz) with one paired board whose status frames are fed in by hand, for what
+ * depends on the controller and the link together: the optimistic state shown after
+ * a command, and what the screens do when the board never got that command.
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "../test_fuzz/FakeDevice.h"
+#include <TA_Protocol.h>
+#include <TA_Display.h>
+
+// The firmware under test, built against the stub headers in this folder
+#include "../../lib/TA_Comms/src/TA_Comms.cpp"
+#include "../../lib/TA_State/src/TA_State.cpp"
+#include "../../../../pioLib/TA_UI/src/TA_UI.cpp"
+
+namespace ta { namespace time {
+    uint32_t (*_testMillis)() = []() -> uint32_t { return fakeDevice().nowMs; };
+} }
+
+using ta::protocol::Status;
+using ta::state::ControlState;
+using ta::state::RemoteState;
+
+static constexpr uint32_t kLoopMs = 5;
+static constexpr uint32_t kStatusMs = 1000;   // the board's status period
+
+// ============================================================================
+// Remote with one paired board
+// ============================================================================
+class StateRig {
+public:
+    FakeDevice dev;
+    ta::comms::EspNowLink link;
+    ta::state::StateController state{link};
+    Status boardStatus = Status::Idle;   // what the board keeps reporting
+    float boardPsi = 30.0f;
+    uint32_t startsSent = 0;
+    bool sawDone = false;
+
+    const uint8_t boardMac[6]  = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    const uint8_t remoteMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+
+    void begin() {
+        ta::cfg::LinkShared cfg;
+        uint8_t lmk[ta::pairkey::kKeyLen];
+        ta::pairkey::deriveLmk(cfg.pmk, remoteMac, boardMac, 0x01, 0xC0FFEE, lmk);
+        memcpy(dev.mac, remoteMac, 6);
+        dev.nowMs = 1;
+        selectDevice(dev);
+        Preferences p;
+        ta::pairkey::savePeer(p, 0, boardMac, lmk);
+        p.begin(ta::pairkey::kNvsNamespace); p.putUChar("chan", 6); p.end();
+
+        link.setPmk(cfg.pmk);
+        link.begin(nullptr);
+        link.setStatusCallback(&StateRig::onStatus_, this);
+        state.begin();
+        run(2 * kStatusMs);
+    }
+
+    void click(ta::input::ButtonId id) {
+        selectDevice(dev);
+        state.onButton(ta::input::Event{ id, ta::input::Action::Click, 1, 0 });
+    }
+
+    // The remote's loop every kLoopMs and a board status every kStatusMs. Frames the
+    // remote sends go nowhere, so every command is lost; Starts are counted.
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; ++i) {
+            dev.nowMs++;
+            if (dev.nowMs % kStatusMs == 0) {
+                uint8_t f[ta::protocol::kMaxPayloadLen];
+                int len = ta::protocol::packResponse(f, ta::protocol::makeStatus(boardStatus, boardPsi),
+                                                     ta::protocol::kProtoV1);
+                dev.deliver(boardMac, f, len);
+            }
+            if (dev.nowMs % kLoopMs == 0) {
+                link.service();
+                state.update(dev.nowMs, link.isConnected(), link.isConnecting());
+                ta::display::DisplayModel dm;
+                state.buildDisplayModel(dm);
+                sawDone |= dm.seekingShowDoneHold;
+                countStarts_();
+            }
+        }
+    }
+
+private:
+    void countStarts_() {
+        for (const SentFrame& f : dev.tx) {
+            ta::protocol::Request r;
+            if (ta::protocol::parseRequest(f.data, (int)f.len, r) && r.kind == ta::protocol::Request::Kind::Start) startsSent++;
+        }
+        dev.tx.clear();
+    }
+    static void onStatus_(void* ctx, uint8_t board, const ta::protocol::Response& msg) {
+        static_cast<StateRig*>(ctx)->state.onStatus(board, msg);
+    }
+};
+
+// ============================================================================
+// Predicted state vs the screens
+// ============================================================================
+TEST(StatePredict, DroppedStart_NoDoneScreen) {
+    StateRig rig;
+    rig.begin();
+    ASSERT_EQ(rig.state.remoteState(), RemoteState::IDLE);
+
+    rig.click(ta::input::ButtonId::Right);   // Start; the board never hears it
+    rig.run(kLoopMs);
+    EXPECT_EQ(rig.startsSent, 1u);
+    EXPECT_EQ(rig.state.controlState(), ControlState::AIRUP);   // shown at once
+    EXPECT_EQ(rig.state.remoteState(), RemoteState::SEEKING);
+
+    // The board keeps saying Idle; the prediction times out and rolls back
+    rig.run(ta::cfg::LinkShared().predictTimeoutMs + 2 * kStatusMs);
+    EXPECT_EQ(rig.state.controlState(), ControlState::IDLE);
+    EXPECT_EQ(rig.state.predictionStats().rolledBack, 1u);
+    EXPECT_FALSE(rig.sawDone);
+    EXPECT_EQ(rig.state.remoteState(), RemoteState::SEEKING);
+}
+
+TEST(StatePredict, ReportedSeek_EndsInDone) {
+    StateRig rig;
+    rig.begin();
+    rig.click(ta::input::ButtonId::Right);
+    rig.boardStatus = Status::AirUp;          // as if the Start had arrived
+    rig.run(2 * kStatusMs);
+    EXPECT_EQ(rig.state.predictionStats().confirmed, 1u);
+    EXPECT_FALSE(rig.sawDone);
+
+    rig.boardStatus = Status::Idle;
+    rig.run(2 * kStatusMs);
+    EXPECT_TRUE(rig.sawDone);
+    EXPECT_EQ(rig.state.remoteState(), RemoteState::IDLE);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
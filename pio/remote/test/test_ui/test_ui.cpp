@@ -17,6 +17,8 @@ public:
     int clearErrorCalls = 0;
     int startSeekCalls = 0;
     float lastSeekTarget = 0.0f;
+    int retargetCalls = 0;
+    float lastRetarget = 0.0f;
     int manualVentCalls = 0;
     bool lastVentState = false;
     int manualAirCalls = 0;
@@ -36,6 +38,11 @@ public:
         lastSeekTarget = targetPsi;
     }
 
+    void retarget(float targetPsi) override {
+        retargetCalls++;
+        lastRetarget = targetPsi;
+    }
+
     void manualVent(bool on) override {
         manualVentCalls++;
         lastVentState = on;
@@ -51,7 +58,7 @@ public:
     }
 
     void reset() {
-        cancelCalls = clearErrorCalls = startSeekCalls = 0;
+        cancelCalls = clearErrorCalls = startSeekCalls = retargetCalls = 0;
         manualVentCalls = manualAirCalls = 0;
         lastSeekTarget = 0.0f;
         lastVentState = lastAirState = false;
@@ -81,8 +88,8 @@ protected:
     }
 
     // Helper to create button events
-    ButtonEvent makeEvent(Button btn, Action act) {
-        return ButtonEvent{btn, act};
+    ButtonEvent makeEvent(Button btn, Action act, uint32_t heldMs = 0) {
+        return ButtonEvent{btn, act, heldMs};
     }
 };
 
@@ -136,6 +143,72 @@ TEST_F(UiTest, Idle_MultipleClicks_AccumulateSteps) {
     EXPECT_FLOAT_EQ(ui.targetPsi(), initial + 3.0f * cfg.stepSmall);
 }
 
+// ============================================================================
+// Idle View - Hold-Repeat Acceleration
+// ============================================================================
+TEST_F(UiTest, Repeat_ShortHold_StepsSmall) {
+    float initial = ui.targetPsi();
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, 1000}, device);
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, 1200}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), initial + 2.0f * cfg.stepSmall);
+}
+
+TEST_F(UiTest, Repeat_LongHold_StepsLargeOnGrid) {
+    ui.setTargetPsi(32.0f);
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, cfg.repeatLargeAfterMs}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), 35.0f);
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, cfg.repeatLargeAfterMs + 50}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), 40.0f);
+    ui.onButton(ButtonEvent{Button::Down, Action::Repeat, cfg.repeatLargeAfterMs}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), 35.0f);
+}
+
+TEST_F(UiTest, Repeat_DownFromOffGrid_SnapsBelow) {
+    ui.setTargetPsi(33.0f);
+    ui.onButton(ButtonEvent{Button::Down, Action::Repeat, cfg.repeatLargeAfterMs}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), 30.0f);
+}
+
+TEST_F(UiTest, Repeat_ClampsAtLimits) {
+    ui.setTargetPsi(cfg.maxPsi - 2.0f);
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, 5000}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), cfg.maxPsi);
+    ui.setTargetPsi(cfg.minPsi + 1.0f);
+    ui.onButton(ButtonEvent{Button::Down, Action::Repeat, 5000}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), cfg.minPsi);
+}
+
+TEST_F(UiTest, Repeat_OtherButtons_Ignored) {
+    ui.onButton(ButtonEvent{Button::Right, Action::Repeat, 1200}, device);
+    ui.onButton(ButtonEvent{Button::Left, Action::Repeat, 1200}, device);
+    EXPECT_EQ(ui.view(), View::Idle);
+    EXPECT_EQ(device.startSeekCalls, 0);
+    EXPECT_EQ(device.cancelCalls, 0);
+}
+
+TEST_F(UiTest, Repeat_NoLargeStepConfigured_StaysSmall) {
+    cfg.stepLarge = cfg.stepSmall;
+    ui.begin(cfg);
+    float initial = ui.targetPsi();
+    ui.onButton(ButtonEvent{Button::Up, Action::Repeat, 5000}, device);
+    EXPECT_FLOAT_EQ(ui.targetPsi(), initial + cfg.stepSmall);
+}
+
+// Held Up from 20 to 80 with SmartButton's cadence: hold repeats every 200 ms from
+// 1 s, long-hold repeats every 50 ms from 3 s
+TEST_F(UiTest, Repeat_HeldAcrossRange_UnderFourSeconds) {
+    cfg.maxPsi = 100.0f;
+    ui.begin(cfg);
+    ui.setTargetPsi(20.0f);
+    uint32_t t = 1000;
+    while (ui.targetPsi() < 80.0f && t < 20000) {
+        ui.onButton(ButtonEvent{Button::Up, Action::Repeat, t}, device);
+        t += t < 3000 ? 200 : 50;
+    }
+    EXPECT_FLOAT_EQ(ui.targetPsi(), 80.0f);
+    EXPECT_LT(t, 4000u);
+}
+
 // ============================================================================
 // Idle View - View Transitions
 // ============================================================================
@@ -250,12 +323,64 @@ TEST_F(UiTest, Seeking_IgnoresOtherButtons) {
     float target = ui.targetPsi();
     device.reset();
 
-    ui.onButton(makeEvent(Button::Up, Action::Click), device);
-    ui.onButton(makeEvent(Button::Down, Action::Click), device);
     ui.onButton(makeEvent(Button::Left, Action::Click), device);
-    
+    ui.onButton(makeEvent(Button::Left, Action::LongHold), device);
+    ui.update(5000, device, Ctrl::AirUp);
+
+    EXPECT_EQ(ui.view(), View::Seeking);
     EXPECT_FLOAT_EQ(ui.targetPsi(), target); // Unchanged
     EXPECT_EQ(device.startSeekCalls, 0); // No new seeks
+    EXPECT_EQ(device.retargetCalls, 0);
+}
+
+TEST_F(UiTest, Seeking_TargetStep_RetargetsAfterDebounce) {
+    ui.onButton(makeEvent(Button::Right, Action::Click), device);
+    ui.update(0, device, Ctrl::AirUp);
+    device.reset();
+
+    ui.onButton(makeEvent(Button::Up, Action::Click), device);
+    ui.update(100, device, Ctrl::AirUp);
+    ui.update(100 + cfg.retargetDebounceMs - 10, device, Ctrl::AirUp);
+    EXPECT_EQ(device.retargetCalls, 0);
+    ui.update(100 + cfg.retargetDebounceMs, device, Ctrl::AirUp);
+    EXPECT_EQ(device.retargetCalls, 1);
+    EXPECT_FLOAT_EQ(device.lastRetarget, cfg.defaultTargetPsi + cfg.stepSmall);
+    EXPECT_EQ(device.startSeekCalls, 0);
+    EXPECT_EQ(ui.view(), View::Seeking);
+}
+
+TEST_F(UiTest, Seeking_HeldRepeat_OneRetargetAtTheEnd) {
+    ui.onButton(makeEvent(Button::Right, Action::Click), device);
+    device.reset();
+
+    uint32_t now = 0;
+    for (int i = 0; i < 10; ++i) {
+        ui.onButton(ButtonEvent{ Button::Down, Action::Repeat, 500u + 100u * i }, device);
+        now += 100;
+        ui.update(now, device, Ctrl::Checking);
+    }
+    EXPECT_EQ(device.retargetCalls, 0);
+    ui.update(now + cfg.retargetDebounceMs, device, Ctrl::Checking);
+    EXPECT_EQ(device.retargetCalls, 1);
+    EXPECT_FLOAT_EQ(device.lastRetarget, ui.targetPsi());
+    EXPECT_FLOAT_EQ(ui.targetPsi(), cfg.defaultTargetPsi - 10 * cfg.stepSmall);
+}
+
+TEST_F(UiTest, Seeking_CancelDropsPendingRetarget) {
+    ui.onButton(makeEvent(Button::Right, Action::Click), device);
+    ui.onButton(makeEvent(Button::Up, Action::Click), device);
+    ui.update(0, device, Ctrl::AirUp);
+    ui.onButton(makeEvent(Button::Right, Action::Click), device); // Cancel
+    ui.update(cfg.retargetDebounceMs + 10, device, Ctrl::Idle);
+    EXPECT_EQ(device.retargetCalls, 0);
+}
+
+TEST_F(UiTest, Idle_TargetStep_NoRetarget) {
+    ui.onButton(makeEvent(Button::Up, Action::Click), device);
+    ui.update(0, device, Ctrl::Idle);
+    ui.update(cfg.retargetDebounceMs + 10, device, Ctrl::Idle);
+    EXPECT_EQ(device.retargetCalls, 0);
+    EXPECT_EQ(device.startSeekCalls, 0);
 }
 
 // ============================================================================
@@ -465,6 +590,44 @@ TEST_F(UiTest, AccessorsReturnCorrectValues) {
     EXPECT_FLOAT_EQ(ui.maxPsi(), cfg.maxPsi);
 }
 
+// ============================================================================
+// Transition Table
+// ============================================================================
+TEST_F(UiTest, Table_EveryRuleLandsInTable) {
+    // Each listed rule owns its cell of the dense table
+    for (int i = 0; i < kUiRuleCount; ++i) {
+        const UiRule& r = kUiRules[i];
+        const UiCell& c = kUiTable.cell[(int)r.view][uiEventIndex(r.button, r.action)];
+        EXPECT_EQ(c.op, r.op) << "rule " << i;
+        EXPECT_EQ(c.next, r.next) << "rule " << i;
+    }
+}
+
+TEST_F(UiTest, Table_UnlistedEventsIgnoredInEveryView) {
+    int listed = 0;
+    for (int v = 0; v < kViewCount; ++v) {
+        for (int e = 0; e < kUiEventCount; ++e) {
+            const UiCell& c = kUiTable.cell[v][e];
+            if (c.op == UiOp::None) EXPECT_EQ((int)c.next, v);
+            else listed++;
+        }
+    }
+    EXPECT_EQ(listed, kUiRuleCount);
+}
+
+TEST_F(UiTest, Table_DisconnectedTakesNoInput) {
+    device.connected = false;
+    ui.update(0, device, Ctrl::Idle);
+    ASSERT_EQ(ui.view(), View::Disconnected);
+    for (int b = 0; b < kButtonCount; ++b) {
+        for (int a = 0; a < kActionCount; ++a) {
+            ui.onButton(ButtonEvent{(Button)b, (Action)a, 0}, device);
+        }
+    }
+    EXPECT_EQ(ui.view(), View::Disconnected);
+    EXPECT_EQ(device.startSeekCalls + device.cancelCalls + device.manualVentCalls + device.manualAirCalls, 0);
+}
+
 // ============================================================================
 // Main function
 // ============================================================================
@@ -0,0 +1,242 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+namespace ta {
+namespace calib {
+
+// ---------------------------------------------------------------------------
+// Pressure transducer calibration: millivolts at the ADC -> gauge PSI.
+//
+// A record is either offset + gain (the transducer's straight line, trimmed for
+// this part) or, with two or more points, a piecewise-linear table through
+// measured (mV, PSI) pairs for a sensor that isn't straight. Readings past the
+// table's ends follow its first/last segment.
+//
+// The hot path never evaluates the record: Linearizer bakes it into a fixed-point
+// table of centi-PSI every kLutStepMv, and a read is one lookup, an integer
+// interpolation and a clamp.
+// ---------------------------------------------------------------------------
+static constexpr int kMaxPoints = 8;
+
+struct CalPoint {
+  uint16_t mv = 0;
+  float psi = 0;
+};
+
+struct Calibration {
+  float offsetMv = 500.0f;            // reading at 0 PSI gauge
+  float psiPerMv = 150.0f / 4000.0f;  // gain
+  float fullScalePsi = 150.0f;        // readings are clamped to 0..fullScale
+  uint8_t points = 0;                 // >= 2: table replaces offset/gain
+  CalPoint table[kMaxPoints];         // ascending mv
+};
+
+// Nominal record for a 0.5-4.5 V transducer of the given range (100, 150, 200 PSI)
+inline Calibration forSensor(float fullScalePsi) {
+  Calibration c;
+  c.offsetMv = 500.0f;
+  c.psiPerMv = fullScalePsi / 4000.0f;
+  c.fullScalePsi = fullScalePsi;
+  return c;
+}
+
+// Highest PSI a record can hold (stored as u16 centi-PSI)
+static constexpr float kMaxRecordPsi = 655.35f;
+
+inline bool isValid(const Calibration& c) {
+  if (!(c.fullScalePsi > 0) || c.fullScalePsi > kMaxRecordPsi) return false;
+  if (c.points == 1 || c.points > kMaxPoints) return false;
+  if (c.points == 0) return c.psiPerMv > 0 && c.offsetMv >= 0 && c.offsetMv < 5000.0f;
+  for (int i = 0; i < c.points; ++i) {
+    if (!(c.table[i].psi >= 0) || c.table[i].psi > kMaxRecordPsi) return false;
+    if (i > 0 && (c.table[i].mv <= c.table[i - 1].mv || !(c.table[i].psi > c.table[i - 1].psi))) return false;
+  }
+  return true;
+}
+
+// Reference evaluation in float, unclamped (builds the lookup table; tests)
+inline float psiAt(const Calibration& c, float mv) {
+  if (c.points < 2) return (mv - c.offsetMv) * c.psiPerMv;
+  int i = 1;
+  while (i < c.points - 1 && mv > c.table[i].mv) ++i;
+  const CalPoint& a = c.table[i - 1];
+  const CalPoint& b = c.table[i];
+  return a.psi + (mv - a.mv) * (b.psi - a.psi) / (float)(b.mv - a.mv);
+}
+
+// ---------------------------------------------------------------------------
+// Fixed-point lookup. Input is millivolts in 1/16 mV (the filter's average keeps
+// sub-mV resolution), output centi-PSI as on the wire.
+// ---------------------------------------------------------------------------
+static constexpr int kMvFracBits = 4;
+static constexpr int kLutShift = 4;                   // 16 mV per entry
+static constexpr int kLutStepMv = 1 << kLutShift;
+static constexpr int kLutMaxMv = 5120;                // 5 V sensors straight to a divider-less input
+static constexpr int kLutSize = kLutMaxMv / kLutStepMv + 1;
+
+class Linearizer {
+public:
+  Linearizer() { build(Calibration()); }
+
+  // Entries are unclamped so the knees at 0 and full scale, which rarely fall on the
+  // grid, don't get rounded off; the clamp is applied after interpolating
+  void build(const Calibration& c) {
+    cal_ = c;
+    maxCenti_ = (int32_t)(c.fullScalePsi * 100.0f + 0.5f);
+    for (int i = 0; i < kLutSize; ++i) {
+      lut_[i] = (int32_t)lroundf(psiAt(c, (float)(i * kLutStepMv)) * 100.0f);
+    }
+  }
+
+  uint16_t centiPsi16(int32_t mv16) const {
+    int32_t v;
+    if (mv16 <= 0) {
+      v = lut_[0];
+    } else {
+      int32_t idx = mv16 >> (kLutShift + kMvFracBits);
+      if (idx >= kLutSize - 1) {
+        v = lut_[kLutSize - 1];
+      } else {
+        int32_t frac = mv16 & ((1 << (kLutShift + kMvFracBits)) - 1);
+        v = lut_[idx] + (((lut_[idx + 1] - lut_[idx]) * frac) >> (kLutShift + kMvFracBits));
+      }
+    }
+    return (uint16_t)(v < 0 ? 0 : (v > maxCenti_ ? maxCenti_ : v));
+  }
+
+  uint16_t centiPsi(int mv) const { return centiPsi16((int32_t)mv << kMvFracBits); }
+  float psi(float mv) const { return centiPsi16((int32_t)(mv * (1 << kMvFracBits) + 0.5f)) / 100.0f; }
+
+  const Calibration& calibration() const { return cal_; }
+
+private:
+  Calibration cal_{};
+  int32_t maxCenti_ = 0;
+  int32_t lut_[kLutSize];
+};
+
+// ---------------------------------------------------------------------------
+// Two-point field calibration: the reading with the sensor open to air (0 PSI),
+// then at a reference pressure read off a trusted gauge. Replaces offset and gain
+// (and drops any table) while keeping the part's full scale.
+// ---------------------------------------------------------------------------
+class TwoPointCal {
+public:
+  static constexpr float kMinSpanMv = 200.0f;
+  static constexpr float kMinSpanPsi = 5.0f;
+
+  void begin(const Calibration& current) { base_ = current; haveLow_ = haveHigh_ = false; }
+
+  void setLow(float mv, float psi = 0.0f) { lowMv_ = mv; lowPsi_ = psi; haveLow_ = true; }
+  void setHigh(float mv, float psi) { highMv_ = mv; highPsi_ = psi; haveHigh_ = true; }
+  bool haveLow() const { return haveLow_; }
+  bool haveHigh() const { return haveHigh_; }
+
+  // False when a point is missing or the two are too close to trust
+  bool solve(Calibration& out) const {
+    if (!haveLow_ || !haveHigh_) return false;
+    float dMv = highMv_ - lowMv_;
+    float dPsi = highPsi_ - lowPsi_;
+    if (dMv < kMinSpanMv || dPsi < kMinSpanPsi) return false;
+    out = base_;
+    out.points = 0;
+    out.psiPerMv = dPsi / dMv;
+    out.offsetMv = lowMv_ - lowPsi_ / out.psiPerMv;
+    return isValid(out);
+  }
+
+private:
+  Calibration base_{};
+  bool haveLow_ = false, haveHigh_ = false;
+  float lowMv_ = 0, lowPsi_ = 0, highMv_ = 0, highPsi_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// NVS persistence, templated on the store like ta::act's cycle counts. One record
+// per board: [version, points, offsetMv f32, psiPerMv f32, fullScale centi-PSI u16,
+// points x (mv u16, centi-PSI u16), checksum], little-endian, under its own key in
+// the shared "trailair" namespace.
+// ---------------------------------------------------------------------------
+static constexpr const char* kNvsNamespace = "trailair";
+static constexpr const char* kNvsRecord = "pressure_cal";
+static constexpr uint8_t kRecordVersion = 1;
+static constexpr size_t kRecordHeaderLen = 12;
+static constexpr size_t kRecordMaxLen = kRecordHeaderLen + 4 * kMaxPoints + 1;
+
+inline void putU16_(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+inline uint16_t getU16_(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+inline void putF32_(uint8_t* p, float f) {
+  uint32_t v; memcpy(&v, &f, 4);
+  for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+inline float getF32_(const uint8_t* p) {
+  uint32_t v = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  float f; memcpy(&f, &v, 4);
+  return f;
+}
+inline uint8_t checksum_(const uint8_t* p, size_t len) {
+  uint8_t s = 0xA5;
+  for (size_t i = 0; i < len; ++i) s = (uint8_t)((s << 1 | s >> 7) ^ p[i]);
+  return s;
+}
+
+// Serialized length; 0 if the record isn't valid
+inline size_t packRecord(uint8_t out[kRecordMaxLen], const Calibration& c) {
+  if (!isValid(c)) return 0;
+  out[0] = kRecordVersion;
+  out[1] = c.points;
+  putF32_(out + 2, c.offsetMv);
+  putF32_(out + 6, c.psiPerMv);
+  putU16_(out + 10, (uint16_t)(c.fullScalePsi * 100.0f + 0.5f));
+  size_t n = kRecordHeaderLen;
+  for (int i = 0; i < c.points; ++i, n += 4) {
+    putU16_(out + n, c.table[i].mv);
+    putU16_(out + n + 2, (uint16_t)(c.table[i].psi * 100.0f + 0.5f));
+  }
+  out[n] = checksum_(out, n);
+  return n + 1;
+}
+
+inline bool parseRecord(const uint8_t* data, size_t len, Calibration& out) {
+  if (len < kRecordHeaderLen + 1 || data[0] != kRecordVersion || data[1] > kMaxPoints) return false;
+  size_t n = kRecordHeaderLen + 4 * (size_t)data[1];
+  if (len != n + 1 || data[n] != checksum_(data, n)) return false;
+  Calibration c;
+  c.points = data[1];
+  c.offsetMv = getF32_(data + 2);
+  c.psiPerMv = getF32_(data + 6);
+  c.fullScalePsi = getU16_(data + 10) / 100.0f;
+  for (int i = 0; i < c.points; ++i) {
+    c.table[i].mv = getU16_(data + kRecordHeaderLen + 4 * i);
+    c.table[i].psi = getU16_(data + kRecordHeaderLen + 4 * i + 2) / 100.0f;
+  }
+  if (!isValid(c)) return false;
+  out = c;
+  return true;
+}
+
+template <typename Prefs>
+bool loadCalibration(Prefs& prefs, Calibration& out) {
+  if (!prefs.begin(kNvsNamespace, true)) return false;
+  uint8_t b[kRecordMaxLen];
+  size_t len = prefs.getBytesLength(kNvsRecord);
+  bool ok = len > 0 && len <= sizeof(b) && prefs.getBytes(kNvsRecord, b, sizeof(b)) == len;
+  prefs.end();
+  return ok && parseRecord(b, len, out);
+}
+
+template <typename Prefs>
+bool saveCalibration(Prefs& prefs, const Calibration& c) {
+  uint8_t b[kRecordMaxLen];
+  size_t len = packRecord(b, c);
+  if (len == 0 || !prefs.begin(kNvsNamespace, false)) return false;
+  bool ok = prefs.putBytes(kNvsRecord, b, len) == len;
+  prefs.end();
+  return ok;
+}
+
+} // namespace calib
+} // namespace ta
@@ -1,6 +1,17 @@
 #pragma once
 #include <stdint.h>
 
+// Pairing secret: 16 comma-separated bytes, provisioned into both firmwares at build
+// time (e.g. -DTA_PAIR_SECRET="0x3a,0x91,...") and never sent over the air. The default
+// below is public (it is in this source tree), so a build that keeps it only obfuscates
+// the link: anyone who captures a pairing can derive the key. See ta::pairkey::deriveLmk.
+#ifndef TA_PAIR_SECRET
+#define TA_PAIR_SECRET 'T','r','a','i','l','A','i','r','-','P','M','K','-','v','0','1'
+#define TA_PAIR_SECRET_IS_DEFAULT 1
+#else
+#define TA_PAIR_SECRET_IS_DEFAULT 0
+#endif
+
 namespace ta { namespace cfg {
 
 // Shared UI configuration used by both control board and remote
@@ -9,6 +20,8 @@ struct UiShared {
   float maxPsi = 50.0f;
   float defaultTargetPsi = 32.0f;
   float stepSmall = 1.0f;          // PSI increment/decrement per click
+  float stepLarge = 5.0f;          // per repeat once a button has been held repeatLargeAfterMs
+  uint32_t repeatLargeAfterMs = 1500;
   uint32_t doneHoldMs = 1500;      // "Done" hold duration after seeking
   uint32_t errorAutoClearMs = 4000;// auto-exit Error after this window (0=disabled)
 };
@@ -17,15 +30,43 @@ struct UiShared {
 struct LinkShared {
   uint32_t remoteActiveTimeoutMs = 3000; // board: consider remote active if seen within this
   uint32_t connectionTimeoutMs = 5000;   // remote: lose connection after this
-  // Manual resend cadence (remote manual streaming)
+  // Manual resend cadence (remote manual streaming to v1 boards)
   uint32_t manualRepeatMs = 300;
+  // Manual lease (v2 boards): a grant runs this long on the board, renewed this long
+  // after the board acknowledged it
+  uint16_t manualLeaseMs = 1500;
+  uint16_t manualRenewMs = 1000;
   // Reconnect/ping backoff (remote)
   uint32_t pingBackoffStartMs = 200;
   uint32_t pingBackoffMaxMs = 2000;
+  // Adaptive link timing (remote): the values above are used until RTT/loss samples exist,
+  // after which the timeout and ping backoff are derived from the measured link.
+  bool adaptiveTiming = true;
+  uint32_t statusIntervalMs = 1000;       // board status cadence the remote expects
+  uint32_t keepalivePingMs = 2000;        // ping cadence while connected (RTT sampling), 0=off
+  uint32_t connectionTimeoutMinMs = 1500; // adaptive timeout bounds
+  uint32_t connectionTimeoutMaxMs = 10000;
+  uint32_t predictTimeoutMs = 2500;       // remote: optimistic state held this long without a confirming status
+  // Channel management (ESP-NOW shares the 2.4 GHz channel with nearby Wi-Fi)
+  uint8_t homeChannel = 1;              // used until a channel is surveyed/advertised
+  uint8_t maxChannel = 11;              // highest channel allowed in the region
+  float retuneLossThreshold = 0.3f;     // remote: sustained ping loss that triggers a retune
+  uint32_t retuneHoldMs = 5000;
+  uint32_t retuneCooldownMs = 60000;
+  uint8_t sweepAfterPings = 4;          // remote: unanswered pings before searching other channels
   // Pairing
   uint8_t pairGroupId = 0x01;     // default group id
   uint32_t pairReqIntervalMs = 500;
   uint32_t pairTimeoutMs = 30000;
+  // Multiple remotes (board)
+  uint32_t boardPairWindowMs = 120000;  // after a board-side confirm, extra remotes may pair into free slots
+  uint32_t statusFanoutMs = 30000;      // keep sending status to a remote this long after it was heard
+  uint32_t conflictHoldMs = 1500;       // a remote's Start/Manual holds off others' different commands
+  // ESP-NOW primary master key and the secret each per-pair LMK is derived from. The
+  // nonce that goes into the LMK crosses the air in the clear, so confidentiality rests
+  // entirely on this value staying off the air and out of public source (TA_PAIR_SECRET).
+  uint8_t pmk[16] = { TA_PAIR_SECRET };
+  static constexpr bool pmkIsPublicDefault = TA_PAIR_SECRET_IS_DEFAULT != 0;
 };
 
 }} // namespace ta::cfg
@@ -19,11 +19,15 @@ using namespace ta::ctl;
 void Controller::ActuatorAdapter::setCompressor(bool on) { if (hw) hw->setCompressor(on); }
 void Controller::ActuatorAdapter::setVent(bool open) { if (hw) hw->setVent(open); }
 void Controller::ActuatorAdapter::stopAll() { if (hw) hw->stopAll(); }
+void Controller::ActuatorAdapter::emergencyStop() { if (hw) hw->emergencyStop(); }
+bool Controller::ActuatorAdapter::compressorRunning() const { return hw && hw->compressor().isOn(); }
 #else
 // Stub implementations for unit tests (vtable needs these)
 void Controller::ActuatorAdapter::setCompressor(bool) {}
 void Controller::ActuatorAdapter::setVent(bool) {}
 void Controller::ActuatorAdapter::stopAll() {}
+void Controller::ActuatorAdapter::emergencyStop() {}
+bool Controller::ActuatorAdapter::compressorRunning() const { return false; }
 #endif
 
 #ifndef UNIT_TEST
@@ -43,21 +47,85 @@ void Controller::begin(IOutputs* outputs, const Config& cfg) {
 }
 
 void Controller::reset_() {
+  psiTol_ = ta::fx::toReal(cfg_.psiTol);
+  aimMargin_ = ta::fx::toReal(cfg_.aimMarginPsi);
+  dPsiNoiseEps_ = ta::fx::toReal(cfg_.dPsiNoiseEps);
+  rateMinEps_ = ta::fx::toReal(cfg_.rateMinEps);
+  checkDtMin_ = ta::fx::toReal(cfg_.checkDtMinSec);
+  noChangeEps_ = ta::fx::toReal(cfg_.noChangeEps);
+  nominalCentiVolts_ = lroundf(cfg_.nominalVolts * 100.0f);
+  lowSupplyCentiVolts_ = lroundf(cfg_.lowSupplyVolts * 100.0f);
+  noLoadCentiAmps_ = lroundf(cfg_.noLoadAmps * 100.0f);
   state_ = State::IDLE;
   prev_ = State::IDLE;
-  targetPsi_ = 0;
+  targetPsi_ = Real();
+  requestedPsi_ = 0;
   manualActive_ = false;
   inContinuous_ = false;
-  upRate_ = downRate_ = 0;
-  upSamples_ = downSamples_ = 0;
+  resetRates_();
   noChangeBurstCount_ = 0;
   errorCode_ = ErrorCode::NONE;
+  errorDetail_ = 0;
+  duty_.begin(cfg_.duty);
+  hold_.begin(cfg_.hold);
+  resting_ = false;
+  loadedFactor_ = ta::fx::ratioToReal(1, 1);
+  loadedIdleCentiVolts_ = 0;
+  supplyValid_ = false;   // unknown until the board passes a reading
+  supplyCentiVolts_ = 0;
+  supplyCentiAmps_ = -1;
+  beginBurst_();
 }
 
+void Controller::beginBurst_() {
+  burstCentiVoltsSum_ = burstCentiAmpsSum_ = 0;
+  burstSamples_ = 0;
+  burstIdleCentiVolts_ = supplyCentiVolts_;
+}
+
+void Controller::setSupplyCenti(uint16_t centiVolts, int16_t centiAmps) {
+  supplyValid_ = true;
+  supplyCentiVolts_ = centiVolts;
+  supplyCentiAmps_ = centiAmps < 0 ? -1 : centiAmps;
+}
+
+void Controller::setSupply(float volts, float amps) {
+  setSupplyCenti(volts <= 0 ? 0 : volts >= 655.0f ? 65500 : (uint16_t)lroundf(volts * 100.0f),
+                 amps < 0 ? -1 : amps >= 327.0f ? 32700 : (int16_t)lroundf(amps * 100.0f));
+}
+
+void Controller::setTemperatures(float ambientC, float tireC) {
+  ambientC_ = ambientC;
+  tireC_ = tireC;
+}
+
+// Supply over nominal, clamped to 0.3..1.3; 1 while nothing is known
+ta::fx::Real Controller::powerFactor_(int32_t centiVolts) const {
+  if (!supplyValid_ || nominalCentiVolts_ <= 0) return ta::fx::ratioToReal(1, 1);
+  int32_t lo = nominalCentiVolts_ * 3 / 10, hi = nominalCentiVolts_ * 13 / 10;
+  if (centiVolts < lo) centiVolts = lo;
+  if (centiVolts > hi) centiVolts = hi;
+  return ta::fx::ratioToReal(centiVolts, nominalCentiVolts_);
+}
+
+// Seek cycling: the outputs' relay guard may hold a switch for its minimum time
 void Controller::stopOutputs_() {
   if (out_) out_->stopAll();
 }
 
+// Faults, cancels and manual watchdogs: off now, guard or not
+void Controller::emergencyStop_() {
+  if (out_) out_->emergencyStop();
+}
+
+void Controller::setCompressor_(bool on) {
+  if (out_) out_->setCompressor(on);
+}
+
+void Controller::setVent_(bool open) {
+  if (out_) out_->setVent(open);
+}
+
 char Controller::statusChar() const {
   switch (state_) {
     case State::IDLE:     return 'I';
@@ -78,94 +146,212 @@ void Controller::enter_(State s, uint32_t now) {
 }
 
 void Controller::manualAirUp(bool active) {
+  hold_.stop();
   manualActive_ = active;
-  lastManualRefreshMs_ = millis();
+  lastManualRefreshMs_ = lastUpdateMs_;
+  manualLeaseMs_ = 0;
+  manualSlot_ = kLocalSlot;
   if (!out_) return;
+  if (active && duty_.mustRest()) {
+    // Too hot to run; the remote keeps refreshing, so this holds until it has cooled
+    active = false;
+    manualActive_ = false;
+  }
   if (active) {
-    out_->setCompressor(true);
+    setCompressor_(true);
     state_ = State::AIRUP;
   } else {
-    stopOutputs_();
+    emergencyStop_();
     state_ = State::IDLE;
   }
 }
 
 void Controller::manualVent(bool active) {
+  hold_.stop();
   manualActive_ = active;
-  lastManualRefreshMs_ = millis();
+  lastManualRefreshMs_ = lastUpdateMs_;
+  manualLeaseMs_ = 0;
+  manualSlot_ = kLocalSlot;
   if (!out_) return;
   if (active) {
-    out_->setVent(true);
+    setVent_(true);
     state_ = State::VENTING;
   } else {
-    stopOutputs_();
+    emergencyStop_();
     state_ = State::IDLE;
   }
 }
 
 void Controller::cancel() {
+  hold_.stop();
   manualActive_ = false;
   inContinuous_ = false;
-  stopOutputs_();
-  targetPsi_ = 0;
+  resting_ = false;
+  duty_.clearCarry();
+  emergencyStop_();
+  targetPsi_ = Real();
+  requestedPsi_ = 0;
   if (state_ != State::ERROR) state_ = State::IDLE;
 }
 
 void Controller::clearError() {
   if (state_ == State::ERROR) {
     errorCode_ = ErrorCode::NONE;
+    errorDetail_ = 0;
     state_ = State::IDLE;
   }
 }
 
-void Controller::startSeek(float t) {
+void Controller::apply(const ta::protocol::Request& req, uint8_t slot) {
+  using RK = ta::protocol::Request::Kind;
+  switch (req.kind) {
+    case RK::Idle:
+      cancel();
+      clearError();
+      break;
+    case RK::Start:
+      // A new target while seeking (the remote adjusting it) re-plans the seek
+      retarget(req.targetPsi);
+      break;
+    case RK::Manual:
+      // A lease stop ends its sender's manual control only; a seek, or another
+      // remote's manual, keeps running
+      if (ta::protocol::isManualStop(req)) {
+        if (manualActive_ && manualSlot_ == slot) cancel();
+        break;
+      }
+      if (req.manual == ta::protocol::ManualCode::Vent) manualVent(true);
+      else if (req.manual == ta::protocol::ManualCode::Air) manualAirUp(true);
+      if (manualActive_) manualSlot_ = slot;
+      if (req.leased && manualActive_) {
+        manualLeaseMs_ = req.leaseMs < cfg_.manualLeaseMaxMs ? req.leaseMs : (uint32_t)cfg_.manualLeaseMaxMs;
+      }
+      break;
+    case RK::Ping:
+      // no-op (the link layer already answered)
+      break;
+  }
+}
+
+void Controller::setTarget_(float t) {
+  if (t < cfg_.minPsi) t = cfg_.minPsi;
+  if (t > cfg_.maxPsi) t = cfg_.maxPsi;
+  requestedPsi_ = t;
+  t += ta::ctl::tempOffsetPsi(t, ambientC_, tireC_, cfg_.temp);
   if (t < cfg_.minPsi) t = cfg_.minPsi;
   if (t > cfg_.maxPsi) t = cfg_.maxPsi;
-  targetPsi_ = t;
+  targetPsi_ = ta::fx::toReal(t);
+}
+
+bool Controller::isSeeking() const {
+  return !manualActive_ && (state_ == State::AIRUP || state_ == State::VENTING || state_ == State::CHECKING);
+}
+
+void Controller::startSeek(float t) {
+  setTarget_(t);
+  hold_.stop();
   manualActive_ = false;
   inContinuous_ = false;
-  upRate_ = downRate_ = 0;
-  upSamples_ = downSamples_ = 0;
+  resetRates_();
   noChangeBurstCount_ = 0;
+  reachedCount_ = 0;
+  resting_ = false;
+  duty_.clearCarry();
 
   stopOutputs_();
-  float diff = targetPsi_ - currentPsi_;
-  if (fabsf(diff) <= cfg_.psiTol) {
-    state_ = State::IDLE;
+  Real diff = targetPsi_ - currentPsi_;
+  if (ta::fx::abs(diff) <= psiTol_) {
+    // Already there: a seek to the current pressure doubles as a leak check
+    seekDone_(lastUpdateMs_);
+    return;
+  }
+  scheduleBurst_(diff > Real() ? State::AIRUP : State::VENTING, cfg_.burstMsInit, lastUpdateMs_);
+}
+
+void Controller::retarget(float t) {
+  if (!isSeeking()) {
+    startSeek(t);
+    return;
+  }
+  setTarget_(t);
+  reachedCount_ = 0;
+  // Settling or resting: planNext_ plans from the new target when the phase ends
+  if (state_ != State::AIRUP && state_ != State::VENTING) return;
+
+  uint32_t now = lastUpdateMs_;
+  bool up = state_ == State::AIRUP;
+  Real remaining = targetPsi_ - currentPsi_;
+  if (ta::fx::abs(remaining) <= psiTol_ || (remaining > Real()) != up) {
+    // At or past the new target: end the run here and let the settle measure it
+    stopOutputs_();
+    enter_(State::CHECKING, now);
+    lastBurstEndMs_ = now;
     return;
   }
-  scheduleBurst_(diff > 0 ? State::AIRUP : State::VENTING, cfg_.burstMsInit, millis());
+  // A blind burst runs its course (it still stops at the target); a planned run is
+  // stretched or cut to reach the new one, within the same caps as a fresh plan
+  if (!inContinuous_) return;
+  unsigned long ranMs = now - phaseStartMs_;
+  unsigned long moreMs = seek::aimMs(up ? upCurve_ : downCurve_, currentPsi_, targetPsi_, aimMargin_,
+                                     plannedScale_(up));
+  unsigned long capMs = runCapMs_(up, ranMs + moreMs);
+  moreMs = capMs > ranMs ? (moreMs < capMs - ranMs ? moreMs : capMs - ranMs) : 0;
+  if (up && moreMs > duty_.allowedRunMs(currentPsi_)) moreMs = duty_.allowedRunMs(currentPsi_);
+  phaseEndMs_ = now + moreMs;
 }
 
 void Controller::scheduleBurst_(State dir, unsigned long durMs, uint32_t now) {
+  if (dir == State::AIRUP && (durMs = permitRun_(durMs, now)) == 0) return;
   phaseStartPsi_ = currentPsi_;
   phaseStartMs_ = now;
   phaseEndMs_ = now + durMs;
   inContinuous_ = false;
+  beginBurst_();
   if (!out_) return;
   if (dir == State::AIRUP) {
-    out_->setCompressor(true);
+    setCompressor_(true);
     state_ = State::AIRUP;
   } else {
-    out_->setVent(true);
+    setVent_(true);
     state_ = State::VENTING;
   }
 }
 
+unsigned long Controller::permitRun_(unsigned long wantMs, uint32_t now) {
+  unsigned long ms = duty_.permit(currentPsi_, wantMs, cfg_.runMinMs, cfg_.runMaxMs);
+  if (ms == 0) startRest_(now);
+  return ms;
+}
+
+// Pause the seek (reported as CHECKING) until the compressor has cooled
+void Controller::startRest_(uint32_t now) {
+  stopOutputs_();
+  inContinuous_ = false;
+  resting_ = true;
+  prev_ = state_;
+  state_ = State::CHECKING;
+  uint32_t rest = duty_.restMs();
+  phaseEndMs_ = now + (rest ? rest : cfg_.settleMs);
+}
+
 void Controller::enterError_(ErrorCode ec, const char* /*why*/) {
   errorCode_ = ec;
-  stopOutputs_();
+  errorDetail_ = 0;
+  hold_.stop();
+  emergencyStop_();
   manualActive_ = false;
   inContinuous_ = false;
   state_ = State::ERROR;
 }
 
 void Controller::handleRunPhase_(State runState, uint32_t now) {
-  float remaining = targetPsi_ - currentPsi_;
-  if (fabsf(remaining) <= cfg_.psiTol) {
+  Real remaining = targetPsi_ - currentPsi_;
+  if (ta::fx::abs(remaining) <= psiTol_) {
     stopOutputs_();
     enter_(State::CHECKING, now);
     lastBurstEndMs_ = now;
+    reachedPsi_ = currentPsi_;
+    reachedCount_++;
     return;
   }
   // End burst / continuous phases
@@ -175,30 +361,58 @@ void Controller::handleRunPhase_(State runState, uint32_t now) {
     lastBurstEndMs_ = now;
     return;
   }
-  (void)runState; // placeholder for per-mode nuances
+  // Budget ran out mid-burst (e.g. a stall heats faster than planned): end it early
+  if (runState == State::AIRUP && duty_.mustRest()) {
+    stopOutputs_();
+    enter_(State::CHECKING, now);
+    lastBurstEndMs_ = now;
+    return;
+  }
 }
 
 void Controller::handleChecking_(uint32_t now) {
   if (now < phaseEndMs_) return;
+  if (resting_) {
+    // Nothing ran during a rest, so there is no rate sample to take
+    resting_ = false;
+    planNext_(now);
+    return;
+  }
+
+  Real dt = ta::fx::msToSec(lastBurstEndMs_ > phaseStartMs_ ? lastBurstEndMs_ - phaseStartMs_
+                                                             : now - phaseStartMs_);
+  Real dPsi = currentPsi_ - phaseStartPsi_;
 
-  float dt = (lastBurstEndMs_ > phaseStartMs_)
-             ? (lastBurstEndMs_ - phaseStartMs_) / 1000.0f
-             : (now - phaseStartMs_) / 1000.0f;
-  float dPsi = currentPsi_ - phaseStartPsi_;
-
-  if (dt > cfg_.checkDtMinSec) {
-    if (dPsi > cfg_.dPsiNoiseEps) {
-      upRate_ = (upRate_ * upSamples_ + (fabsf(dPsi) / dt)) / (upSamples_ + 1);
-      upSamples_++;
-    } else if (dPsi < -cfg_.dPsiNoiseEps) {
-      downRate_ = (downRate_ * downSamples_ + (fabsf(dPsi) / dt)) / (downSamples_ + 1);
-      downSamples_++;
+  // Supply while the compressor ran this burst (factor 1 = nominal, or nothing known)
+  bool ran = burstSamples_ > 0;
+  Real one = ta::fx::ratioToReal(1, 1);
+  Real factor = ran ? powerFactor_((int32_t)(burstCentiVoltsSum_ / burstSamples_)) : one;
+  if (ran) {
+    loadedFactor_ = factor;
+    loadedIdleCentiVolts_ = burstIdleCentiVolts_;
+  }
+
+  if (dt > checkDtMin_) {
+    if (dPsi > dPsiNoiseEps_) {
+      // Learned per unit of power so a sagging or recovering supply rescales it
+      upCurve_.add(phaseStartPsi_, currentPsi_, seek::rateSample(dPsi, dt) / factor);
+    } else if (dPsi < -dPsiNoiseEps_) {
+      downCurve_.add(phaseStartPsi_, currentPsi_, seek::rateSample(dPsi, dt));
+    }
+    // A weak supply slows the fill; only a clear lack of change counts
+    Real noChangeEps = noChangeEps_ * ta::fx::min(factor, one);
+    if (ran && supplyValid_ && ta::fx::abs(dPsi) < noChangeEps) {
+      if (supplyCentiAmps_ >= 0 && burstCentiAmpsSum_ / burstSamples_ < noLoadCentiAmps_) {
+        enterError_(ErrorCode::NO_LOAD, "No current");
+        return;
+      }
     }
     if (!inContinuous_) {
-      if (fabsf(dPsi) < cfg_.noChangeEps) {
+      if (ta::fx::abs(dPsi) < noChangeEps) {
         noChangeBurstCount_++;
         if (noChangeBurstCount_ >= cfg_.maxNoChangeBursts) {
-          enterError_(ErrorCode::NO_CHANGE, "No change");
+          bool lowSupply = ran && supplyValid_ && burstCentiVoltsSum_ / burstSamples_ < lowSupplyCentiVolts_;
+          enterError_(lowSupply ? ErrorCode::LOW_SUPPLY : ErrorCode::NO_CHANGE, "No change");
           return;
         }
       } else {
@@ -209,51 +423,135 @@ void Controller::handleChecking_(uint32_t now) {
     }
   }
 
-  float remaining = targetPsi_ - currentPsi_;
-  if (fabsf(remaining) <= cfg_.psiTol) {
-    state_ = State::IDLE;
-    stopOutputs_();
+  planNext_(now);
+}
+
+void Controller::planNext_(uint32_t now) {
+  Real remaining = targetPsi_ - currentPsi_;
+  if (ta::fx::abs(remaining) <= psiTol_) {
+    seekDone_(now);
+    return;
+  }
+  // Reached but not held, again and again (a leak): stop chasing it. The hold check
+  // reports the leak-down when it is on; without it, going idle would leave the tire
+  // short of target unreported, so call the leak from the fall since the last reach.
+  if (reachedCount_ >= cfg_.maxNoChangeBursts) {
+    if (cfg_.hold.windowMs > 0) {
+      seekDone_(now);
+      return;
+    }
+    uint32_t dtMs = now - lastBurstEndMs_;
+    float tenths = dtMs ? ta::fx::toFloat(reachedPsi_ - currentPsi_) * 600000.0f / dtMs + 0.5f : 0.0f;
+    enterError_(ErrorCode::LEAK, "Leak");
+    errorDetail_ = tenths <= 0.0f ? 0 : (tenths >= 255.0f ? 255 : (uint8_t)tenths);
     return;
   }
 
-  bool needUp = remaining > 0;
-  bool haveRate = needUp ? (upSamples_ >= 2 && upRate_ > cfg_.rateMinEps)
-                         : (downSamples_ >= 2 && downRate_ > cfg_.rateMinEps);
+  bool needUp = remaining > Real();
+  const seek::RateCurve<Real>& curve = needUp ? upCurve_ : downCurve_;
+  bool haveRate = curve.samples() >= 2 && curve.mean() > rateMinEps_;
   if (haveRate) {
-    float rate = needUp ? upRate_ : downRate_;
-    unsigned long predictedFullMs = (unsigned long)(1000.0f * (fabsf(remaining) / rate));
+    // Judged at nominal power: a flat battery makes the fill slow, not the tire faulty
+    unsigned long predictedFullMs = seek::fullMs(curve, currentPsi_, targetPsi_);
     if (predictedFullMs > cfg_.maxContinuousMs) {
       enterError_(ErrorCode::EXCESSIVE_TIME, "Too long");
       return;
     }
-    float aim = fmaxf(0.0f, fabsf(remaining) - cfg_.aimMarginPsi);
-    unsigned long runMs = (unsigned long)(1000.0f * (aim / rate));
+    unsigned long runMs = seek::aimMs(curve, currentPsi_, targetPsi_, aimMargin_, plannedScale_(needUp));
+    unsigned long runMaxMs = runCapMs_(needUp, runMs);
     if (runMs < cfg_.runMinMs) runMs = cfg_.runMinMs;
-    if (runMs > cfg_.runMaxMs) runMs = cfg_.runMaxMs;
+    if (runMs > runMaxMs) runMs = runMaxMs;
+    if (needUp && (runMs = permitRun_(runMs, now)) == 0) return;
     // schedule continuous
     inContinuous_ = true;
+    beginBurst_();
     phaseStartPsi_ = currentPsi_;
     phaseStartMs_ = now;
     phaseEndMs_ = now + runMs;
-    if (needUp) { state_ = State::AIRUP; if (out_) out_->setCompressor(true); }
-    else        { state_ = State::VENTING;  if (out_) out_->setVent(true); }
+    if (needUp) { state_ = State::AIRUP; setCompressor_(true); }
+    else        { state_ = State::VENTING; setVent_(true); }
   } else {
     scheduleBurst_(needUp ? State::AIRUP : State::VENTING, cfg_.burstMsInit, now);
   }
 }
 
-void Controller::handleIdle_(uint32_t /*now*/) {
+// Scale on the learned rates for the next run. Air-up expects the last burst's loaded
+// supply, moved by however much the idle supply has since (engine started or stopped).
+ta::fx::Real Controller::plannedScale_(bool up) const {
+  if (!up) return ta::fx::ratioToReal(1, 1);
+  if (!supplyValid_ || loadedIdleCentiVolts_ == 0) return loadedFactor_;
+  return loadedFactor_ * ta::fx::ratioToReal(supplyCentiVolts_, loadedIdleCentiVolts_);
+}
+
+void Controller::resetRates_() {
+  upCurve_.reset(false, ta::fx::toReal(cfg_.rateCurveMinSpreadPsi));
+  downCurve_.reset(true, ta::fx::toReal(cfg_.rateCurveMinSpreadPsi));
+}
+
+// Longest planned run. Trades a little overshoot risk for a relay cycle: a run of
+// runMs that would leave a tail worth less than a cycle may finish in one burst.
+unsigned long Controller::runCapMs_(bool up, unsigned long runMs) const {
+  unsigned long runMaxMs = cfg_.runMaxMs;
+  if (up) runMaxMs += duty_.carryMs();
+  if (runMs > runMaxMs && runMs <= runMaxMs + cfg_.relayCycleCostMs) runMaxMs = runMs;
+  return runMaxMs;
+}
+
+// At target after a settle: go idle and, if configured, start watching for leak-down
+void Controller::seekDone_(uint32_t now) {
+  state_ = State::IDLE;
+  stopOutputs_();
+  hold_.start(now, currentPsi_);
+}
+
+void Controller::handleIdle_(uint32_t now) {
   stopOutputs_();
+  if (hold_.update(now, currentPsi_) == HoldMonitor::Verdict::LEAK) {
+    float tenths = hold_.leakPsiPerMin() * 10.0f + 0.5f;
+    enterError_(ErrorCode::LEAK, "Leak");
+    errorDetail_ = tenths >= 255.0f ? 255 : (uint8_t)tenths;
+  }
 }
 
 void Controller::update(uint32_t now, float currentPsi) {
+#if TA_FIXED_POINT
+  // At the sensor's resolution, so a replay of the recorded centi-PSI matches (the
+  // board itself calls updateCentiPsi)
+  updateCentiPsi(now, ta::protocol::psiToU16_01(currentPsi));
+#else
   currentPsi_ = currentPsi;
+  update_(now);
+#endif
+}
+
+void Controller::updateCentiPsi(uint32_t now, uint16_t centiPsi) {
+  currentPsi_ = ta::fx::centiToReal(centiPsi);
+  update_(now);
+}
+
+void Controller::update_(uint32_t now) {
+  lastUpdateMs_ = now;
+  bool running = compressorOn_();
+  duty_.update(now, running, currentPsi_);
+  if (running && supplyValid_) {
+    burstCentiVoltsSum_ += supplyCentiVolts_;
+    burstCentiAmpsSum_ += supplyCentiAmps_;
+    burstSamples_++;
+  }
+
+  // Held manual air-up is cut when the thermal budget runs out
+  if (manualActive_ && compressorOn_() && duty_.mustRest()) {
+    manualActive_ = false;
+    emergencyStop_();
+    state_ = State::IDLE;
+  }
 
-  // Manual watchdog
+  // Manual watchdog: the lease, or the refresh timeout for a v1 remote
   if (manualActive_) {
-    if (now - lastManualRefreshMs_ > cfg_.manualRefreshTimeoutMs) {
+    uint32_t limit = manualLeaseMs_ ? manualLeaseMs_ : (uint32_t)cfg_.manualRefreshTimeoutMs;
+    if (now - lastManualRefreshMs_ > limit) {
       manualActive_ = false;
-      stopOutputs_();
+      emergencyStop_();
       state_ = State::IDLE;
     }
   }
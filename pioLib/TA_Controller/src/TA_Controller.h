@@ -1,7 +1,12 @@
 #pragma once
 #include <stdint.h>
+#include <math.h>
 #include "TA_Protocol.h"
 #include <TA_Errors.h>
+#include "TA_DutyCycle.h"
+#include "TA_HoldMonitor.h"
+#include "TA_TempComp.h"
+#include "TA_SeekMath.h"
 
 namespace ta {
 namespace act { class Actuators; }
@@ -14,6 +19,9 @@ enum class ErrorCode : uint8_t {
   NONE = ta::errors::NONE,
   NO_CHANGE = ta::errors::NO_CHANGE,
   EXCESSIVE_TIME = ta::errors::EXCESSIVE_TIME,
+  LOW_SUPPLY = ta::errors::LOW_SUPPLY,
+  NO_LOAD = ta::errors::NO_LOAD,
+  LEAK = ta::errors::LEAK,
   // Additional internal codes can be added; default mapping uses raw byte
   UNKNOWN = ta::errors::UNKNOWN
 };
@@ -24,6 +32,11 @@ struct IOutputs {
   virtual void setCompressor(bool on) = 0;
   virtual void setVent(bool open) = 0;
   virtual void stopAll() = 0;
+  // Off now, past any relay minimum on time: faults, cancels and manual watchdogs
+  virtual void emergencyStop() { stopAll(); }
+  // Whether the compressor is actually running. A relay guard may hold a requested
+  // off for its minimum on time, so this is the guard's output, not the last request.
+  virtual bool compressorRunning() const = 0;
 };
 
 struct Config {
@@ -34,7 +47,8 @@ struct Config {
   unsigned long burstMsInit = 5000;
   unsigned long runMinMs = 1000;
   unsigned long runMaxMs = 4000;
-  unsigned long manualRefreshTimeoutMs = 1000;
+  unsigned long manualRefreshTimeoutMs = 1000;  // v1 manual: stop without a resend this long
+  unsigned long manualLeaseMaxMs = 3000;        // v2 manual: longest lease honoured
   unsigned long maxContinuousMs = 30UL * 60UL * 1000UL; // 30 minutes
   float noChangeEps = 0.02f;
   int maxNoChangeBursts = 3;
@@ -43,6 +57,24 @@ struct Config {
   float dPsiNoiseEps = 0.01f;     // noise threshold when computing rates
   float rateMinEps = 0.001f;      // minimal rate to consider valid
   float checkDtMinSec = 0.02f;    // minimal time window to consider (seconds)
+  // Pressure-dependent rates: fitted once the phases seen span this much (PSI)
+  float rateCurveMinSpreadPsi = 2.0f;
+  // Relay wear: a burst may run up to this much past runMaxMs when that finishes the
+  // seek and saves a short tail burst (one relay cycle). 0 = never stretch.
+  unsigned long relayCycleCostMs = 0;
+  // Supply-aware rate model (only once setSupply() has been called). Fill rates are
+  // learned per unit of power factor = loaded volts / nominalVolts, so planned bursts
+  // and the EXCESSIVE_TIME check follow the supply instead of blaming the tire.
+  float nominalVolts = 13.5f;     // engine running
+  float lowSupplyVolts = 10.5f;   // loaded supply below this: no-change means LOW_SUPPLY
+  float noLoadAmps = 1.0f;        // a running compressor draws far more than this
+  // Compressor thermal budget: bursts are shortened to fit it and rests inserted when
+  // it runs out; time cut from a burst is added to the next one
+  DutyConfig duty{};
+  // Leak-down check after a completed seek (off by default: windowMs = 0)
+  HoldConfig hold{};
+  // Hot-tire compensation of seek targets (only once setTemperatures() has been called)
+  TempCompConfig temp{};
 };
 
 class Controller {
@@ -53,23 +85,62 @@ public:
   // New: directly inject an outputs implementation
   void begin(IOutputs* outputs, const Config& cfg);
 
+  // Float entry for tests and replays; with TA_FIXED_POINT it is rounded to centi-PSI
   void update(uint32_t nowMs, float currentPsi);
+  // Same, from the sensor's centi-PSI: what the board calls. With TA_FIXED_POINT the
+  // update runs without float; the float left is configuration (begin()), the float
+  // setters and accessors, the temperature offset when a seek starts and the leak
+  // figure of a LEAK error.
+  void updateCentiPsi(uint32_t nowMs, uint16_t centiPsi);
 
   // Commands
   void startSeek(float targetPsi);
+  // Move the target of a running seek, keeping the learned rates and the phase in
+  // progress (a run is re-planned to the new target); not seeking: startSeek
+  void retarget(float targetPsi);
+  bool isSeeking() const;
   void manualAirUp(bool active);
   void manualVent(bool active);
   void cancel();
   void clearError();
+  // A remote's request as decoded off the link (what the board app forwards) and the
+  // sender's peer slot; a lease stop only ends a manual that slot started
+  void apply(const ta::protocol::Request& req, uint8_t slot = 0);
+  static constexpr uint8_t kLocalSlot = 0xFF;   // manual from the board's own buttons
 
   // Accessors
   State state() const { return state_; }
   ErrorCode error() const { return errorCode_; }
-  float targetPsi() const { return targetPsi_; }
-  float currentPsi() const { return currentPsi_; }
+  float targetPsi() const { return ta::fx::toFloat(targetPsi_); } // effective (temperature-compensated)
+  float requestedPsi() const { return requestedPsi_; } // as asked for (cold)
+  float tempOffsetPsi() const { return targetPsi() - requestedPsi_; }
+  float currentPsi() const { return ta::fx::toFloat(currentPsi_); }
 
   char statusChar() const; // Map state to protocol char
   uint8_t errorByte() const { return (uint8_t)errorCode_; }
+  // Extra byte sent with the error: LEAK carries the loss in 0.1 psi/min, others 0
+  uint8_t errorDetail() const { return errorDetail_; }
+
+  // Supply: loaded/idle volts and compressor amps from the board's power sensor, in
+  // 0.01 V / 0.01 A; pass amps < 0 when there is no current channel
+  void setSupplyCenti(uint16_t centiVolts, int16_t centiAmps = -1);
+  // Same in volts and amps (tests and replays), rounded to 0.01
+  void setSupply(float volts, float amps = -1.0f);
+  float powerFactor() const { return ta::fx::toFloat(powerFactor_(supplyCentiVolts_)); }
+  // Fill rate as learned against pressure, per unit of power factor
+  const seek::RateCurve<ta::fx::Real>& fillCurve() const { return upCurve_; }
+
+  // Ambient and tire (carcass or valve-stem) temperature; NAN for a missing sensor.
+  // Applied when a seek starts: the target is raised for a tire hotter than ambient.
+  void setTemperatures(float ambientC, float tireC);
+
+  // Compressor duty cycle: resting = a seek is paused (reported as CHECKING) to cool down
+  const DutyCycle& duty() const { return duty_; }
+  bool isResting() const { return resting_; }
+
+  // Leak-down check: holding = watching the pressure after a seek (state stays IDLE)
+  bool isHolding() const { return hold_.active(); }
+  float leakPsiPerMin() const { return hold_.leakPsiPerMin(); }
 
 private:
   // Per-state handlers
@@ -79,10 +150,27 @@ private:
   
   void enter_(State s, uint32_t now);
   void stopOutputs_();
+  void emergencyStop_();
+  bool compressorOn_() const { return out_ && out_->compressorRunning(); }
   void scheduleBurst_(State dir, unsigned long durMs, uint32_t now);
+  void planNext_(uint32_t now);
+  void setTarget_(float t);
+  ta::fx::Real plannedScale_(bool up) const;
+  ta::fx::Real powerFactor_(int32_t centiVolts) const;
+  unsigned long runCapMs_(bool up, unsigned long runMs) const;
   void enterError_(ErrorCode ec, const char* why);
+  void seekDone_(uint32_t now);
+
+  // Run-permit gate: how much of wantMs the compressor may run now (0 = a rest was started)
+  unsigned long permitRun_(unsigned long wantMs, uint32_t now);
+  void startRest_(uint32_t now);
+  void setCompressor_(bool on);
+  void setVent_(bool open);
 
   void reset_();
+  void beginBurst_();
+  void resetRates_();
+  void update_(uint32_t now);
 
   // Outputs
   struct ActuatorAdapter : IOutputs {
@@ -90,6 +178,8 @@ private:
     void setCompressor(bool on) override;
     void setVent(bool open) override;
     void stopAll() override;
+    void emergencyStop() override;
+    bool compressorRunning() const override;
   } actAdapter_;
 
   IOutputs* out_ = nullptr;
@@ -99,28 +189,60 @@ private:
   State state_ = State::IDLE;
   State prev_ = State::IDLE;
 
+  // Seek math runs in ta::fx::Real: float, or Q16.16 with TA_FIXED_POINT. The
+  // tolerances it compares against are converted once, in begin().
+  using Real = ta::fx::Real;
+  Real psiTol_{}, aimMargin_{}, dPsiNoiseEps_{}, rateMinEps_{}, checkDtMin_{}, noChangeEps_{};
+
   // Runtime
-  float targetPsi_ = 0;
-  float currentPsi_ = 0;
+  Real targetPsi_{};
+  float requestedPsi_ = 0;
+  float ambientC_ = NAN;
+  float tireC_ = NAN;
+  Real currentPsi_{};
   bool manualActive_ = false;
   uint32_t lastManualRefreshMs_ = 0;
+  uint32_t manualLeaseMs_ = 0;  // lease of the running manual, 0 = refresh timeout
+  uint8_t manualSlot_ = kLocalSlot;  // who started the running manual
 
   // Phases
   bool inContinuous_ = false;
   uint32_t phaseStartMs_ = 0;
   uint32_t phaseEndMs_ = 0;
   uint32_t lastBurstEndMs_ = 0;
-  float phaseStartPsi_ = 0;
+  Real phaseStartPsi_{};
 
-  // Learned rates
-  float upRate_ = 0;
-  float downRate_ = 0;
-  int upSamples_ = 0;
-  int downSamples_ = 0;
+  // Learned rates against pressure (PSI/s; air-up per unit of power factor)
+  seek::RateCurve<Real> upCurve_;
+  seek::RateCurve<Real> downCurve_;
 
   // Errors
   ErrorCode errorCode_ = ErrorCode::NONE;
+  uint8_t errorDetail_ = 0;
   int noChangeBurstCount_ = 0;
+  int reachedCount_ = 0;          // bursts that hit the target, only to drift off in the settle
+  Real reachedPsi_{};             // where the last of them stopped
+
+  // Supply, in 0.01 V / 0.01 A: summed as integers over the updates with the compressor
+  // on and turned into a power factor once per phase. Limits converted in begin().
+  bool supplyValid_ = false;
+  uint16_t supplyCentiVolts_ = 0;
+  int16_t supplyCentiAmps_ = -1;
+  int64_t burstCentiVoltsSum_ = 0;
+  int64_t burstCentiAmpsSum_ = 0;
+  int burstSamples_ = 0;
+  uint16_t burstIdleCentiVolts_ = 0;   // supply just before this burst started
+  Real loadedFactor_{};                // power factor during the last air-up burst
+  uint16_t loadedIdleCentiVolts_ = 0;  // idle supply before that burst
+  int32_t nominalCentiVolts_ = 0, lowSupplyCentiVolts_ = 0, noLoadCentiAmps_ = 0;
+
+  // Duty cycle
+  DutyCycle duty_{};
+  bool resting_ = false;
+  uint32_t lastUpdateMs_ = 0;
+
+  // Leak-down check
+  HoldMonitor hold_{};
 };
 
 } // namespace ctl
@@ -0,0 +1,187 @@
+#pragma once
+#include <stdint.h>
+#include <TA_Fixed.h>
+
+namespace ta {
+namespace ctl {
+
+// ---------------------------------------------------------------------------
+// Compressor duty-cycle / thermal budget.
+//
+// Heat is measured in full-load running time: every ms the compressor runs adds
+// 1 + loadGain * (psi / ratedPsi), doubled again (stallFactor) while pressure isn't
+// rising, i.e. the motor is pushing against a closed or full tire. Every ms it rests
+// removes ratedDuty / (1 - ratedDuty), so running at exactly the rated duty cycle
+// holds the estimate steady. Reaching budgetMs forces a rest until the heat is back
+// down to resumeFraction of the budget.
+//
+// Pure bookkeeping: the controller reports on/off and pressure each update and asks
+// for a run permit before starting a burst. The arithmetic is written once for float
+// and ta::fx::Fixed (heat is held in seconds, so a budget up to 9 hours fits Q16.16);
+// DutyCycle is the ta::fx::Real one, so with TA_FIXED_POINT update() and the run permit
+// are integer arithmetic. The configuration is converted once in begin(), through
+// float, and heatFraction() reports through float.
+// ---------------------------------------------------------------------------
+struct DutyConfig {
+  bool enabled = true;
+  unsigned long budgetMs = 10UL * 60UL * 1000UL; // full-load run time from cold
+  float ratedDuty = 0.33f;          // sustainable on fraction (typical 12 V compressor at load)
+  float resumeFraction = 0.5f;      // after a forced rest, resume at this share of the budget
+  float ratedPsi = 100.0f;          // pressure at which load heating reaches loadGain
+  float loadGain = 1.0f;            // extra heat per ms at ratedPsi
+  float stallFactor = 2.0f;         // heat multiplier while pressure isn't rising
+  float stallEpsPsi = 0.05f;        // rise below this over stallWindowMs counts as a stall
+  unsigned long stallWindowMs = 2000;
+};
+
+template <class R>
+class BasicDutyCycle {
+public:
+  void begin(const DutyConfig& cfg) {
+    cfg_ = cfg;
+    budget_ = ta::fx::secFromMs<R>(cfg.budgetMs);
+    resume_ = budget_ * ta::fx::fromFloat<R>(cfg.resumeFraction);
+    cool_ = ta::fx::fromFloat<R>(cfg.ratedDuty / (1.0f - cfg.ratedDuty));
+    ratedPsi_ = ta::fx::fromFloat<R>(cfg.ratedPsi);
+    loadGain_ = ta::fx::fromFloat<R>(cfg.loadGain);
+    stallFactor_ = ta::fx::fromFloat<R>(cfg.stallFactor);
+    stallEps_ = ta::fx::fromFloat<R>(cfg.stallEpsPsi);
+    one_ = ta::fx::fromFloat<R>(1.0f);
+    secMs_ = ta::fx::fromFloat<R>(1000.0f);
+    maxLoad_ = ta::fx::fromFloat<R>(1.5f);
+    reset();
+  }
+
+  void reset() {
+    heatSec_ = pendMs_ = R();
+    started_ = false;
+    wasOn_ = false;
+    stalled_ = false;
+    resting_ = false;
+    runMs_ = 0;
+    totalOnMs_ = 0;
+    starts_ = 0;
+    rests_ = 0;
+    carryMs_ = 0;
+    cut_ = false;
+  }
+
+  // Call every controller update with the compressor state the outputs were left in
+  void update(uint32_t now, bool on, R psi) {
+    if (!started_) { started_ = true; lastMs_ = now; }
+    uint32_t dt = now - lastMs_;
+    lastMs_ = now;
+
+    // Account the interval that just ended in the state it was in
+    if (wasOn_) {
+      add_(dt, heatRate_(psi));
+      runMs_ += dt;
+      totalOnMs_ += dt;
+    } else {
+      add_(dt, -cool_);
+    }
+    R heat = heat_();
+    if (heat < R()) { heatSec_ = pendMs_ = heat = R(); }
+    if (heat >= budget_ && !resting_) { resting_ = true; rests_++; }
+    if (heat <= resume_) { resting_ = false; cut_ = false; }
+
+    if (on && !wasOn_) {
+      starts_++;
+      runMs_ = 0;
+      stalled_ = false;
+      windowStartMs_ = now;
+      windowPsi_ = psi;
+    } else if (on && now - windowStartMs_ >= cfg_.stallWindowMs) {
+      stalled_ = (psi - windowPsi_) < stallEps_;
+      windowStartMs_ = now;
+      windowPsi_ = psi;
+    }
+    if (!on) stalled_ = false;
+    wasOn_ = on;
+  }
+
+  // Over budget: the compressor must stay off until restMs() has passed
+  bool mustRest() const { return cfg_.enabled && resting_; }
+
+  // Longest run that fits the remaining budget at this pressure (no stall assumed)
+  uint32_t allowedRunMs(R psi) const {
+    if (!cfg_.enabled) return UINT32_MAX;
+    if (resting_) return 0;
+    R left = budget_ - heat_();
+    return left > R() ? (uint32_t)ta::fx::secToMs(left / heatRate_(psi, false)) : 0;
+  }
+
+  // Run permit for a planned air-up burst: wantMs, or less when the budget can't cover
+  // it, or 0 when the compressor should rest first. Time cut from a burst is owed to a
+  // later one (carryMs, capped at maxCarryMs). A second cut before the heat is back at
+  // the resume level returns 0 rather than trickling out bursts as fast as the pauses
+  // between them cool it.
+  uint32_t permit(R psi, uint32_t wantMs, uint32_t minMs, uint32_t maxCarryMs) {
+    uint32_t allowed = allowedRunMs(psi);
+    if (mustRest() || allowed < minMs || (cut_ && allowed < wantMs)) return 0;
+    if (allowed >= wantMs) { carryMs_ = 0; return wantMs; }
+    cut_ = true;
+    carryMs_ = wantMs - allowed;
+    if (carryMs_ > maxCarryMs) carryMs_ = maxCarryMs;
+    return allowed;
+  }
+  uint32_t carryMs() const { return carryMs_; }
+  void clearCarry() { carryMs_ = 0; cut_ = false; }
+
+  // Rest that brings the heat back to the resume level
+  uint32_t restMs() const {
+    R excess = heat_() - resume_;
+    return excess > R() ? (uint32_t)ta::fx::secToMs(excess / cool_) + 1 : 0;
+  }
+
+  // Statistics
+  float heatFraction() const { return budget_ > R() ? ta::fx::toFloat(heat_() / budget_) : 0.0f; }
+  bool stalled() const { return stalled_; }
+  uint32_t currentRunMs() const { return wasOn_ ? runMs_ : 0; }
+  uint32_t totalOnMs() const { return totalOnMs_; }
+  uint32_t starts() const { return starts_; }
+  uint32_t forcedRests() const { return rests_; }
+  const DutyConfig& config() const { return cfg_; }
+
+private:
+  // Heat per ms of running, in ms of full-load running
+  R heatRate_(R psi, bool withStall = true) const {
+    R load = psi > R() ? psi / ratedPsi_ : R();
+    if (load > maxLoad_) load = maxLoad_;
+    R r = one_ + loadGain_ * load;
+    return (withStall && stalled_) ? r * stallFactor_ : r;
+  }
+  // dtMs at perMs. Loop-sized steps are summed exactly in ms and moved into the
+  // seconds a second at a time, so Q16.16 rounds once per second of heat rather than
+  // once per loop (which would drift by a fraction of a percent of everything run);
+  // a longer gap goes straight to seconds so it can't saturate.
+  void add_(uint32_t dtMs, R perMs) {
+    if (dtMs > 1000) { heatSec_ += perMs * ta::fx::secFromMs<R>(dtMs); return; }
+    pendMs_ += perMs * (int32_t)dtMs;
+    if (ta::fx::abs(pendMs_) >= secMs_) { heatSec_ += pendMs_ / 1000; pendMs_ = R(); }
+  }
+  R heat_() const { return heatSec_ + pendMs_ / 1000; }
+
+  DutyConfig cfg_{};
+  R budget_{}, resume_{}, cool_{};    // seconds of heat, and heat shed per ms of rest
+  R ratedPsi_{}, loadGain_{}, stallFactor_{}, stallEps_{}, one_{}, maxLoad_{}, secMs_{};
+  R heatSec_{}, pendMs_{};            // full-load running: seconds, plus ms not yet moved
+  bool started_ = false;
+  uint32_t lastMs_ = 0;
+  bool wasOn_ = false;
+  bool stalled_ = false;
+  bool resting_ = false;
+  uint32_t windowStartMs_ = 0;
+  R windowPsi_{};
+  uint32_t runMs_ = 0;
+  uint32_t totalOnMs_ = 0;
+  uint32_t starts_ = 0;
+  uint32_t rests_ = 0;
+  uint32_t carryMs_ = 0;
+  bool cut_ = false;
+};
+
+using DutyCycle = BasicDutyCycle<ta::fx::Real>;
+
+} // namespace ctl
+} // namespace ta
@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+#include <TA_Fixed.h>
+
+namespace ta {
+namespace ctl {
+
+// ---------------------------------------------------------------------------
+// Post-seek leak-down check.
+//
+// After a seek settles at its target the outputs stay off and the pressure is
+// watched for a while. A least-squares line through (time, psi) samples gives the
+// leak rate; the fit is kept as running means, so each sample costs a handful of
+// adds and the window never needs storing. The line is refitted and the verdict
+// checked only when a sample is taken; updates in between cost a compare. A clear
+// leak is reported as soon as minMs of samples show it; otherwise the verdict
+// comes at the end of the window.
+//
+// Like the seek math it is written once for float and ta::fx::Fixed, and HoldMonitor
+// is the ta::fx::Real one. Time is taken in tens of seconds from the first sample, so
+// the squared term stays inside Q16.16 for windows up to 30 minutes.
+//
+// Expect a little apparent leak-down right after an air-up as the pumped air cools;
+// leakPsiPerMin sits well above that.
+// ---------------------------------------------------------------------------
+struct HoldConfig {
+  unsigned long windowMs = 0;         // how long to watch after a seek; 0 = off
+  unsigned long minMs = 10000;        // earliest a leak can be called
+  unsigned long sampleMs = 250;       // fit one reading per this interval
+  float leakPsiPerMin = 1.0f;         // loss rate that counts as a leak
+  float minDropPsi = 0.2f;            // an early call also needs this much fitted loss
+};
+
+template <class R>
+class BasicHoldMonitor {
+public:
+  enum class Verdict { NONE, HOLDING, LEAK };
+
+  void begin(const HoldConfig& cfg) {
+    cfg_ = cfg;
+    leakPerMin_ = ta::fx::fromFloat<R>(cfg.leakPsiPerMin);
+    minDrop_ = ta::fx::fromFloat<R>(cfg.minDropPsi);
+    stop();
+  }
+
+  void start(uint32_t now, R psi) {
+    if (cfg_.windowMs == 0) return;
+    active_ = true;
+    startMs_ = now;
+    nextSampleMs_ = now;
+    psi0_ = psi;
+    n_ = 0;
+    mt_ = mp_ = mtt_ = mtp_ = R();
+    rate_ = R();
+  }
+
+  void stop() { active_ = false; }
+  bool active() const { return active_; }
+
+  // Feed every update; returns HOLDING when the window ends without a leak (the monitor
+  // stops), LEAK when one is found (also stops) and NONE otherwise
+  Verdict update(uint32_t now, R psi) {
+    if (!active_ || (int32_t)(now - nextSampleMs_) < 0) return Verdict::NONE;
+    nextSampleMs_ += cfg_.sampleMs ? cfg_.sampleMs : 1;
+    // Relative to the first reading so the means keep their precision
+    uint32_t span = now - startMs_;
+    R t = ta::fx::secFromMs<R>(span) / 10;
+    R p = psi - psi0_;
+    n_++;
+    mt_ += (t - mt_) / n_;
+    mp_ += (p - mp_) / n_;
+    mtt_ += (t * t - mtt_) / n_;
+    mtp_ += (t * p - mtp_) / n_;
+
+    if (span < cfg_.minMs || n_ < 3) return Verdict::NONE;
+    R slope = slope_();
+    rate_ = slope < R() ? -slope * 6 : R();
+    bool leaking = rate_ >= leakPerMin_;
+    if (leaking && rate_ * ta::fx::secFromMs<R>(span) / 60 >= minDrop_) {
+      active_ = false;
+      return Verdict::LEAK;
+    }
+    if (span >= cfg_.windowMs) {
+      active_ = false;
+      return leaking ? Verdict::LEAK : Verdict::HOLDING;
+    }
+    return Verdict::NONE;
+  }
+
+  // Fitted loss in psi per minute as of the last sample's fit (0 if rising)
+  float leakPsiPerMin() const { return ta::fx::toFloat(rate_); }
+  int samples() const { return n_; }
+  const HoldConfig& config() const { return cfg_; }
+
+private:
+  // psi per ten seconds
+  R slope_() const {
+    R var = mtt_ - mt_ * mt_;
+    return var > R() ? (mtp_ - mt_ * mp_) / var : R();
+  }
+
+  HoldConfig cfg_{};
+  R leakPerMin_{}, minDrop_{};
+  bool active_ = false;
+  uint32_t startMs_ = 0;
+  uint32_t nextSampleMs_ = 0;
+  R psi0_{};
+  int32_t n_ = 0;
+  R mt_{}, mp_{}, mtt_{}, mtp_{};
+  R rate_{};                          // psi per minute
+};
+
+using HoldMonitor = BasicHoldMonitor<ta::fx::Real>;
+
+} // namespace ctl
+} // namespace ta
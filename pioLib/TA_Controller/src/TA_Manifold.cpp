@@ -0,0 +1,266 @@
+#include "TA_Manifold.h"
+#include <TA_Time.h>
+#include <math.h>
+
+using namespace ta::ctl;
+
+void ManifoldScheduler::begin(IManifoldOutputs* out, const Config& cfg) {
+  out_ = out;
+  cfg_ = cfg;
+  count_ = out ? out->tireCount() : 0;
+  if (count_ > kMaxTires) count_ = kMaxTires;
+  for (uint8_t i = 0; i < kMaxTires; ++i) tires_[i] = TireSeek{};
+  duty_.begin(cfg_.duty);
+  resting_ = false;
+  valvesOpen_ = 0;
+  compressorOn_ = false;
+  ventOpen_ = false;
+  if (out_) out_->stopAll();
+}
+
+void ManifoldScheduler::startSeek(const float* targets, uint8_t mask) {
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (!(mask & (1u << i))) continue;
+    float t = targets[i];
+    if (t < cfg_.minPsi) t = cfg_.minPsi;
+    if (t > cfg_.maxPsi) t = cfg_.maxPsi;
+    float psi = tires_[i].psi;
+    tires_[i] = TireSeek{};
+    tires_[i].psi = psi;
+    tires_[i].target = t;
+    tires_[i].state = fabsf(t - psi) <= cfg_.psiTol ? TireState::IDLE : TireState::READY;
+  }
+  duty_.clearCarry();
+  schedule_(lastUpdateMs_);
+  apply_();
+}
+
+void ManifoldScheduler::startSeek(float target, uint8_t mask) {
+  float targets[kMaxTires];
+  for (uint8_t i = 0; i < kMaxTires; ++i) targets[i] = target;
+  startSeek(targets, mask);
+}
+
+// Every output off, as Controller::cancel does, whatever apply_ last set them to
+void ManifoldScheduler::cancel() {
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (tires_[i].state != TireState::ERROR) tires_[i].state = TireState::IDLE;
+  }
+  resting_ = false;
+  duty_.clearCarry();
+  if (out_) out_->emergencyStop();
+  valvesOpen_ = 0;
+  compressorOn_ = false;
+  ventOpen_ = false;
+}
+
+State ManifoldScheduler::state() const {
+  if (any_(TireState::AIRUP)) return State::AIRUP;
+  if (any_(TireState::VENTING)) return State::VENTING;
+  if (any_(TireState::READY) || any_(TireState::SETTLING)) return State::CHECKING;
+  if (any_(TireState::ERROR)) return State::ERROR;
+  return State::IDLE;
+}
+
+ErrorCode ManifoldScheduler::error() const {
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (tires_[i].state == TireState::ERROR) return tires_[i].error;
+  }
+  return ErrorCode::NONE;
+}
+
+char ManifoldScheduler::statusChar() const {
+  switch (state()) {
+    case State::IDLE:     return 'I';
+    case State::AIRUP:    return 'U';
+    case State::VENTING:  return 'V';
+    case State::CHECKING: return 'C';
+    case State::ERROR:    return 'E';
+  }
+  return 'I';
+}
+
+uint8_t ManifoldScheduler::activeMask() const {
+  uint8_t m = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    TireState s = tires_[i].state;
+    if (s != TireState::IDLE && s != TireState::ERROR) m |= (uint8_t)(1u << i);
+  }
+  return m;
+}
+
+bool ManifoldScheduler::any_(TireState s) const {
+  for (uint8_t i = 0; i < count_; ++i) if (tires_[i].state == s) return true;
+  return false;
+}
+
+void ManifoldScheduler::update(uint32_t now, const float* psi) {
+  lastUpdateMs_ = now;
+  float linePsi = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    tires_[i].psi = psi[i];
+    if (tires_[i].state == TireState::AIRUP) linePsi = psi[i];
+  }
+  duty_.update(now, compressorOn_, ta::fx::toReal(linePsi));
+
+  // End bursts: at target (live reading), planned time up, or budget gone mid-fill
+  for (uint8_t i = 0; i < count_; ++i) {
+    TireSeek& t = tires_[i];
+    if (t.state != TireState::AIRUP && t.state != TireState::VENTING) continue;
+    if (fabsf(t.target - t.psi) <= cfg_.psiTol || ta::time::isTimeFor(now, t.phaseEndMs) ||
+        (t.state == TireState::AIRUP && duty_.mustRest())) {
+      endBurst_(i, now);
+    }
+  }
+
+  // Settled tires: learn from the burst and decide whether they're done
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (tires_[i].state == TireState::SETTLING && ta::time::isTimeFor(now, tires_[i].phaseEndMs)) sample_(i, now);
+  }
+
+  if (resting_ && ta::time::isTimeFor(now, restEndMs_)) resting_ = false;
+
+  schedule_(now);
+  apply_();
+}
+
+void ManifoldScheduler::endBurst_(uint8_t i, uint32_t now) {
+  TireSeek& t = tires_[i];
+  t.state = TireState::SETTLING;
+  t.lastBurstEndMs = now;
+  t.phaseEndMs = now + cfg_.settleMs;
+}
+
+// Controller::handleChecking_'s seek:: rate samples and no-change detection, with a
+// single learned rate per direction (no curve against pressure, no supply scaling)
+void ManifoldScheduler::sample_(uint8_t i, uint32_t now) {
+  TireSeek& t = tires_[i];
+  // The burst's own length, unless its end stamp is from an earlier one
+  uint32_t ranMs = t.lastBurstEndMs - t.phaseStartMs;
+  uint32_t sinceMs = now - t.phaseStartMs;
+  float dt = ta::fx::secFromMs<float>(ranMs > 0 && ranMs <= sinceMs ? ranMs : sinceMs);
+  float dPsi = t.psi - t.phaseStartPsi;
+
+  if (dt > cfg_.checkDtMinSec) {
+    if (dPsi > cfg_.dPsiNoiseEps) {
+      t.upRate = seek::learn(t.upRate, t.upSamples++, seek::rateSample(dPsi, dt));
+    } else if (dPsi < -cfg_.dPsiNoiseEps) {
+      t.downRate = seek::learn(t.downRate, t.downSamples++, seek::rateSample(dPsi, dt));
+    }
+    if (!t.continuous && fabsf(dPsi) < cfg_.noChangeEps) {
+      if (++t.noChangeBursts >= cfg_.maxNoChangeBursts) {
+        fail_(i, ErrorCode::NO_CHANGE);
+        return;
+      }
+    } else {
+      t.noChangeBursts = 0;
+    }
+  }
+
+  t.state = fabsf(t.target - t.psi) <= cfg_.psiTol ? TireState::IDLE : TireState::READY;
+}
+
+void ManifoldScheduler::schedule_(uint32_t now) {
+  bool filling = any_(TireState::AIRUP);
+
+  // Vents share the gallery with each other but not with the compressor
+  if (!filling) {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (tires_[i].state == TireState::READY && tires_[i].psi > tires_[i].target) startBurst_(i, now);
+    }
+  }
+  if (filling || any_(TireState::VENTING) || resting_) return;
+
+  // Compressor goes to the tire furthest below target
+  int best = -1;
+  float bestDeficit = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    const TireSeek& t = tires_[i];
+    float deficit = t.target - t.psi;
+    if (t.state == TireState::READY && deficit > bestDeficit) {
+      best = i;
+      bestDeficit = deficit;
+    }
+  }
+  if (best >= 0) startBurst_((uint8_t)best, now);
+}
+
+bool ManifoldScheduler::startBurst_(uint8_t i, uint32_t now) {
+  TireSeek& t = tires_[i];
+  bool up = t.target > t.psi;
+  unsigned long ms = planMs_(i, up);
+  if (ms == 0) return false;
+  if (up) {
+    ms = duty_.permit(ta::fx::toReal(t.psi), ms, cfg_.runMinMs, cfg_.runMaxMs);
+    if (ms == 0) {
+      // Every fill waits out the rest; vents keep going meanwhile
+      uint32_t rest = duty_.restMs();
+      resting_ = true;
+      restEndMs_ = now + (rest ? rest : cfg_.settleMs);
+      return false;
+    }
+  }
+  t.state = up ? TireState::AIRUP : TireState::VENTING;
+  t.phaseStartPsi = t.psi;
+  t.phaseStartMs = now;
+  t.phaseEndMs = now + ms;
+  return true;
+}
+
+// Burst length for tire i, planned with the seek:: helpers as Controller::planNext_
+// plans on a flat rate curve; 0 if the tire failed
+unsigned long ManifoldScheduler::planMs_(uint8_t i, bool up) {
+  TireSeek& t = tires_[i];
+  float remaining = t.target - t.psi;
+  bool haveRate = up ? (t.upSamples >= 2 && t.upRate > cfg_.rateMinEps)
+                     : (t.downSamples >= 2 && t.downRate > cfg_.rateMinEps);
+  if (!haveRate) {
+    t.continuous = false;
+    return cfg_.burstMsInit;
+  }
+  float rate = up ? t.upRate : t.downRate;
+  if (seek::fullMs(remaining, rate) > cfg_.maxContinuousMs) {
+    fail_(i, ErrorCode::EXCESSIVE_TIME);
+    return 0;
+  }
+  unsigned long runMs = seek::aimMs(remaining, cfg_.aimMarginPsi, rate);
+  unsigned long runMaxMs = cfg_.runMaxMs + (up ? duty_.carryMs() : 0);
+  if (runMs > runMaxMs && runMs <= runMaxMs + cfg_.relayCycleCostMs) runMaxMs = runMs;
+  if (runMs < cfg_.runMinMs) runMs = cfg_.runMinMs;
+  if (runMs > runMaxMs) runMs = runMaxMs;
+  t.continuous = true;
+  return runMs;
+}
+
+void ManifoldScheduler::fail_(uint8_t i, ErrorCode ec) {
+  tires_[i].state = TireState::ERROR;
+  tires_[i].error = ec;
+}
+
+// Drive the outputs from the tire states, switching only what changed. Valves close
+// before any open so a tire leaving the gallery never shares it with one joining.
+void ManifoldScheduler::apply_() {
+  uint8_t valves = 0;
+  bool comp = false;
+  bool vent = false;
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (tires_[i].state == TireState::AIRUP) { valves |= (uint8_t)(1u << i); comp = true; }
+    if (tires_[i].state == TireState::VENTING) { valves |= (uint8_t)(1u << i); vent = true; }
+  }
+  if (!out_) return;
+  for (uint8_t i = 0; i < count_; ++i) {
+    uint8_t bit = (uint8_t)(1u << i);
+    if ((valvesOpen_ & bit) && !(valves & bit)) out_->setValve(i, false);
+  }
+  if (compressorOn_ && !comp) out_->setCompressor(false);
+  if (ventOpen_ && !vent) out_->setVent(false);
+  for (uint8_t i = 0; i < count_; ++i) {
+    uint8_t bit = (uint8_t)(1u << i);
+    if (!(valvesOpen_ & bit) && (valves & bit)) out_->setValve(i, true);
+  }
+  if (comp && !compressorOn_) out_->setCompressor(true);
+  if (vent && !ventOpen_) out_->setVent(true);
+  valvesOpen_ = valves;
+  compressorOn_ = comp;
+  ventOpen_ = vent;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+#include "TA_Controller.h"
+
+namespace ta {
+namespace ctl {
+
+static constexpr uint8_t kMaxTires = 8;
+
+// Outputs for a valve manifold: one compressor and one vent on a common gallery, and a
+// valve per tire between the gallery and that tire. setCompressor/setVent keep the same
+// interlock as the single-tire board and act on whichever tire valves are open;
+// stopAll() also closes every tire valve.
+struct IManifoldOutputs : IOutputs {
+  virtual uint8_t tireCount() const = 0;
+  virtual void setValve(uint8_t tire, bool open) = 0;
+};
+
+enum class TireState : uint8_t {
+  IDLE,      // not part of the job, or at target
+  READY,     // settled reading is off target; waiting for the gallery
+  AIRUP,
+  VENTING,
+  SETTLING,  // valve closed, waiting for a trustworthy reading
+  ERROR
+};
+
+struct TireSeek {
+  TireState state = TireState::IDLE;
+  float target = 0;
+  float psi = 0;
+  ErrorCode error = ErrorCode::NONE;
+  // Current phase
+  bool continuous = false;
+  uint32_t phaseStartMs = 0;
+  uint32_t phaseEndMs = 0;
+  uint32_t lastBurstEndMs = 0;
+  float phaseStartPsi = 0;
+  // Learned rates (this tire alone on the gallery)
+  float upRate = 0;
+  float downRate = 0;
+  int upSamples = 0;
+  int downSamples = 0;
+  int noChangeBursts = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Seeks several tires at once through a manifold, using the same burst/settle/learn
+// steps (and Config) as Controller does for one tire.
+//
+// The gallery is either filling one tire, venting any number of tires, or free:
+//  - tires above target vent together; a tire joins a running vent batch as soon as
+//    it is ready and leaves it when its own burst ends
+//  - the compressor is time-shared: when the gallery is free the tire with the largest
+//    deficit gets the next burst, so while one tire settles the next one fills and the
+//    compressor doesn't sit idle through every settle
+//  - vents go first when both are waiting; a fill burst is at most runMaxMs so
+//    waiting vents get the gallery at the next burst end
+//  - every burst asks the shared DutyCycle for a run permit; while it rests, vents
+//    carry on and fills wait
+// A tire that fails (NO_CHANGE, EXCESSIVE_TIME) drops out and the others continue;
+// the job reports ERROR once the rest are done.
+// ---------------------------------------------------------------------------
+class ManifoldScheduler {
+public:
+  void begin(IManifoldOutputs* out, const Config& cfg);
+
+  // One reading per tire (tireCount() entries)
+  void update(uint32_t nowMs, const float* psi);
+
+  // Seek every tire in mask (bit per tire) to its own target / a common one
+  void startSeek(const float* targets, uint8_t mask);
+  void startSeek(float target, uint8_t mask = 0xFF);
+  void cancel();
+
+  State state() const;
+  ErrorCode error() const;
+  char statusChar() const;
+
+  uint8_t tireCount() const { return count_; }
+  const TireSeek& tire(uint8_t i) const { return tires_[i < kMaxTires ? i : 0]; }
+  uint8_t activeMask() const;   // tires still working toward target
+
+  const DutyCycle& duty() const { return duty_; }
+  bool isResting() const { return resting_; }
+
+private:
+  void endBurst_(uint8_t i, uint32_t now);
+  void sample_(uint8_t i, uint32_t now);
+  void schedule_(uint32_t now);
+  bool startBurst_(uint8_t i, uint32_t now);
+  unsigned long planMs_(uint8_t i, bool up);
+  void fail_(uint8_t i, ErrorCode ec);
+  void apply_();
+  bool any_(TireState s) const;
+
+  IManifoldOutputs* out_ = nullptr;
+  Config cfg_{};
+  uint8_t count_ = 0;
+  TireSeek tires_[kMaxTires];
+
+  DutyCycle duty_{};
+  bool resting_ = false;
+  uint32_t restEndMs_ = 0;
+  uint32_t lastUpdateMs_ = 0;
+
+  // What the outputs were last set to
+  uint8_t valvesOpen_ = 0;
+  bool compressorOn_ = false;
+  bool ventOpen_ = false;
+};
+
+} // namespace ctl
+} // namespace ta
@@ -0,0 +1,118 @@
+#pragma once
+#include <TA_Fixed.h>
+
+namespace ta {
+namespace ctl {
+namespace seek {
+
+// ---------------------------------------------------------------------------
+// Rate learning and run planning, written once for float and ta::fx::Fixed. The
+// controller uses them with ta::fx::Real; tests run both types on the same inputs
+// to hold the fixed-point build to the float one.
+// ---------------------------------------------------------------------------
+
+// PSI/s seen over a phase
+template <class R>
+R rateSample(R dPsi, R dtSec) { return ta::fx::abs(dPsi) / dtSec; }
+
+// Running mean of `samples` rates, with one more
+template <class R>
+R learn(R mean, int samples, R sample) { return (mean * samples + sample) / (samples + 1); }
+
+// Time to cover all of `remaining` at `rate` (the EXCESSIVE_TIME prediction)
+template <class R>
+unsigned long fullMs(R remaining, R rate) { return ta::fx::secToMs(ta::fx::abs(remaining) / rate); }
+
+// Time to cover `remaining` short of `marginPsi` at `rate` (a planned run)
+template <class R>
+unsigned long aimMs(R remaining, R marginPsi, R rate) {
+  return ta::fx::secToMs(ta::fx::max(R(), ta::fx::abs(remaining) - marginPsi) / rate);
+}
+
+// ---------------------------------------------------------------------------
+// Rate against pressure. Vent flow rises with tire pressure (orifice flow) and the
+// pump's falls with back-pressure, so one learned rate plans runs short at one end
+// of the range and long at the other. Each phase adds its mean rate at its middle
+// pressure; the curve is the least-squares line through them, kept as running means
+// so it costs the same whatever the count. It stays flat at the mean rate (what a
+// constant-rate learner would use) until the phases spread over minSpreadPsi, and
+// a fit with the wrong sign for the direction (noise) is flattened too. Evaluated
+// rates are held within 1/16..16x the mean so a short fit can't extrapolate wildly.
+// ---------------------------------------------------------------------------
+template <class R>
+class RateCurve {
+public:
+  // rises: the rate grows with pressure (venting) rather than falling (filling)
+  void reset(bool rises, R minSpreadPsi) {
+    *this = RateCurve();
+    rises_ = rises;
+    R half = minSpreadPsi / 20;           // in x: two equal groups minSpreadPsi apart
+    minVar_ = half * half;
+  }
+
+  // A phase from psi0 to psi1 at a mean rate of `rate`
+  void add(R psi0, R psi1, R rate) {
+    R x = (psi0 + psi1) / 20;
+    x_ = learn(x_, n_, x);
+    xx_ = learn(xx_, n_, x * x);
+    xr_ = learn(xr_, n_, x * rate);
+    rate_ = learn(rate_, n_, rate);
+    n_++;
+    R var = xx_ - x_ * x_;
+    R slope = var >= minVar_ && var > R() ? (xr_ - x_ * rate_) / var : R();
+    slope_ = (slope > R()) == rises_ ? slope : R();
+  }
+
+  int samples() const { return n_; }
+  R mean() const { return rate_; }
+  bool flat() const { return slope_ == R(); }
+  R slope() const { return slope_ / 10; }    // PSI/s per PSI
+
+  R at(R psi) const {
+    R r = rate_ + slope_ * (psi / 10 - x_);
+    R lo = rate_ / 16;
+    R hi = rate_ * 16;
+    return r < lo ? lo : r > hi ? hi : r;
+  }
+
+  // Seconds to go from one pressure to another along the curve: Simpson's rule on
+  // 1/rate over 8 steps, within a percent of the exact time unless the span runs
+  // right up to where the rate collapses (a pump near stall), where it errs long
+  R seconds(R from, R to) const {
+    R span = ta::fx::abs(to - from);
+    if (flat()) return span / rate_;
+    R h = (to - from) / 8;
+    R step = span / 8;
+    R sum = step / at(from) + step / at(to);
+    for (int i = 1; i < 8; ++i) sum += step / at(from + h * i) * (i % 2 ? 4 : 2);
+    return sum / 3;
+  }
+
+private:
+  R x_{}, xx_{}, xr_{}, rate_{};  // running means; x = mid-pressure / 10 keeps x*x small
+  R slope_{};                      // PSI/s per x
+  R minVar_{};
+  int n_ = 0;
+  bool rises_ = false;
+};
+
+// fullMs from `from` to `to` along the curve
+template <class R>
+unsigned long fullMs(const RateCurve<R>& c, R from, R to) {
+  if (c.flat()) return fullMs(to - from, c.mean());
+  return ta::fx::secToMs(c.seconds(from, to));
+}
+
+// aimMs along the curve, with its rates scaled by `scale` (the supply)
+template <class R>
+unsigned long aimMs(const RateCurve<R>& c, R from, R to, R marginPsi, R scale) {
+  if (c.flat()) return aimMs(to - from, marginPsi, c.mean() * scale);
+  R span = ta::fx::abs(to - from) - marginPsi;
+  if (!(span > R())) return 0;
+  R end = to > from ? from + span : from - span;
+  return ta::fx::secToMs(c.seconds(from, end) / scale);
+}
+
+} // namespace seek
+} // namespace ctl
+} // namespace ta
@@ -0,0 +1,49 @@
+#pragma once
+#include <math.h>
+
+namespace ta {
+namespace ctl {
+
+// ---------------------------------------------------------------------------
+// Temperature-compensated target pressure.
+//
+// Targets are cold pressures (what the placard means): the pressure the tire will
+// settle at once it is back at ambient. Filling a tire that is hotter than that,
+// e.g. right after highway driving, has to aim higher by the ideal-gas ratio of
+// absolute temperatures applied to absolute pressure:
+//
+//   P_hot + atm = (P_cold + atm) * (T_tire + 273.15) / (T_ambient + 273.15)
+//
+// The tire's volume is taken as fixed. Readings outside a plausible range, or a
+// correction larger than maxPsi, are treated as a sensor fault and ignored.
+// ---------------------------------------------------------------------------
+struct TempCompConfig {
+  float atmPsi = 14.696f;       // sea level; the error at altitude is a few percent of the correction
+  float minC = -40.0f;          // plausible readings
+  float maxC = 120.0f;
+  float maxPsi = 10.0f;         // larger corrections are taken as a bad reading
+};
+
+static constexpr float kZeroCelsiusK = 273.15f;
+
+// Gauge pressure at tireC of a tire holding coldPsi at ambientC
+inline float hotPsi(float coldPsi, float ambientC, float tireC, float atmPsi = 14.696f) {
+  return (coldPsi + atmPsi) * (tireC + kZeroCelsiusK) / (ambientC + kZeroCelsiusK) - atmPsi;
+}
+
+// Gauge pressure a tire at tireC reading hotPsi will settle to at ambientC
+inline float coldPsi(float hotPsi, float ambientC, float tireC, float atmPsi = 14.696f) {
+  return (hotPsi + atmPsi) * (ambientC + kZeroCelsiusK) / (tireC + kZeroCelsiusK) - atmPsi;
+}
+
+// Correction to add to a cold target for the current temperatures; 0 when either
+// reading is missing (NaN) or implausible
+inline float tempOffsetPsi(float coldTargetPsi, float ambientC, float tireC, const TempCompConfig& cfg) {
+  if (!(ambientC >= cfg.minC && ambientC <= cfg.maxC)) return 0.0f;
+  if (!(tireC >= cfg.minC && tireC <= cfg.maxC)) return 0.0f;
+  float d = hotPsi(coldTargetPsi, ambientC, tireC, cfg.atmPsi) - coldTargetPsi;
+  return fabsf(d) > cfg.maxPsi ? 0.0f : d;
+}
+
+} // namespace ctl
+} // namespace ta
@@ -178,6 +178,19 @@ namespace ta {
             }
         }
 
+        // "All" or "B<n>" left of the link icon, with a '*' when a board is missing
+        // or the targeted tires differ by a PSI or more
+        void TA_Display::drawBoardTag_(const DisplayModel& m) {
+            if (m.boardCount < 2) return;
+            String tag = m.boardTarget == 0 ? String("All") : String("B") + String((int)m.boardTarget);
+            if (m.boardsConnected < m.boardCount || m.psiSpread >= 1.0f) tag += "*";
+            int16_t w, h; measure_(tag, 1, w, h);
+            d_.setTextSize(1);
+            d_.setTextColor(SSD1306_WHITE);
+            d_.setCursor(d_.width() - 8 - 3 - w, 0);
+            d_.print(tag);
+        }
+
         void TA_Display::drawButtonHints_(const uint8_t* left, const uint8_t* down, const uint8_t* up, const uint8_t* right) {
             const int iconSize = style_.btnIcon;
             const int cellW = 32;
@@ -271,6 +284,7 @@ namespace ta {
         void TA_Display::drawIdle(const DisplayModel& m) {
             drawBatteryIcon_(m.batteryPercent);
             drawConnectionIcon_(m.link);
+            drawBoardTag_(m);
             drawButtonHints_(Icons::icon_manual_control_6x6, Icons::icon_dash_6x6, Icons::icon_plus_6x6, Icons::icon_arrow_right_6x6);
             String currentStr = String((int)m.currentPSI);
             String targetStr  = String((int)m.targetPSI);
@@ -280,6 +294,7 @@ namespace ta {
         void TA_Display::drawSeeking(const DisplayModel& m) {
             drawBatteryIcon_(m.batteryPercent);
             drawConnectionIcon_(m.link);
+            drawBoardTag_(m);
 
             // Right=Cancel
             drawButtonHints_(nullptr, nullptr, nullptr, Icons::icon_cancel_6x6);
@@ -305,6 +320,7 @@ namespace ta {
         void TA_Display::drawManual(const DisplayModel& m) {
             drawBatteryIcon_(m.batteryPercent);
             drawConnectionIcon_(m.link);
+            drawBoardTag_(m);
 
             // Left=cancel, Down=vent, Up=airup
             drawButtonHints_(Icons::icon_cancel_6x6, Icons::icon_arrow_down_6x6, Icons::icon_arrow_up_6x6, nullptr);
@@ -323,6 +339,7 @@ namespace ta {
         void TA_Display::drawError(const DisplayModel& m) {
             drawBatteryIcon_(m.batteryPercent);
             drawConnectionIcon_(m.link);
+            drawBoardTag_(m);
 
             // Right = acknowledge
             drawButtonHints_(nullptr, nullptr, nullptr, Icons::icon_arrow_right_6x6);
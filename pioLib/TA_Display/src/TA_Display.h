@@ -38,6 +38,12 @@ namespace ta {
             uint8_t lastErrorCode = 0;        // for Error screen
             bool showReconnectHint = false;   // show right-arrow on Disconnected
 
+            // Several boards (remote only): shown when boardCount > 1
+            uint8_t boardCount = 0;
+            uint8_t boardTarget = 0;        // 0 = all boards, n = board n
+            uint8_t boardsConnected = 0;
+            float psiSpread = 0.0f;         // max - min across the targeted boards
+
             // Pairing flags (remote only)
             bool pairingActive = false;
             bool pairingFailed = false;   // timeout / canceled / busy
@@ -89,6 +95,7 @@ namespace ta {
                 // Widgets
                 void drawBatteryIcon_(int percent);
                 void drawConnectionIcon_(Link link);
+                void drawBoardTag_(const DisplayModel& m);
                 void drawButtonHints_(const uint8_t* left, const uint8_t* down, const uint8_t* up, const uint8_t* right);
 
                 // Helpers
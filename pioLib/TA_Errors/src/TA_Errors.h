@@ -15,6 +15,9 @@ enum : uint8_t {
   OVER_PSI = 4,
   UNDER_PSI = 5,
   CONFLICT = 6,
+  LOW_SUPPLY = 7,   // compressor too weak to make progress on this supply voltage
+  NO_LOAD = 8,      // relay on but the compressor draws no current (fuse, wiring)
+  LEAK = 9,         // pressure falling after a seek (detail: loss in 0.1 psi/min)
   UNKNOWN = 255
 };
 
@@ -27,6 +30,9 @@ inline const char* shortText(uint8_t code) {
     case OVER_PSI:       return "Over PSI";
     case UNDER_PSI:      return "Under PSI";
     case CONFLICT:       return "Conflict";
+    case LOW_SUPPLY:     return "Low battery";
+    case NO_LOAD:        return "No current";
+    case LEAK:           return "Leak";
     case UNKNOWN:        return "Unknown";
     default:             return "Error";
   }
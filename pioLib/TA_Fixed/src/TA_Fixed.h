@@ -0,0 +1,149 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Run the seek math and the sensor/battery conversions in Q16.16 integers instead of
+// float (for FPU-less parts such as the ESP32-C3's RV32IMC, where every float op is a
+// soft-float library call)
+#ifndef TA_FIXED_POINT
+#define TA_FIXED_POINT 0
+#endif
+
+namespace ta {
+namespace fx {
+
+// ---------------------------------------------------------------------------
+// Q16.16 fixed point: 16 integer bits (+-32767) and a resolution of 1/65536.
+// PSI, PSI/s, seconds and supply factors all fit with room to spare. Products
+// and quotients are computed in 64 bits, rounded to nearest and saturated, so an
+// out-of-range result (a near-zero rate) pins at the limit rather than wrapping.
+//
+// Tolerance against float, for the values the controller works with (0..200 PSI,
+// rates 0.05..20 PSI/s, times up to 32767 s): each operation is within one LSB
+// (1.5e-5) of the exact result, a learned rate within 4 LSB + 0.01%, and a planned
+// run or EXCESSIVE_TIME prediction within 1 ms + 0.1% of the float one.
+// ---------------------------------------------------------------------------
+class Fixed {
+public:
+  static constexpr int kFracBits = 16;
+  static constexpr int32_t kOne = (int32_t)1 << kFracBits;
+
+  constexpr Fixed() : raw_(0) {}
+
+  static constexpr Fixed fromRaw(int32_t raw) { return Fixed(raw, Raw{}); }
+  static constexpr Fixed fromInt(int32_t i) { return fromRaw(sat_((int64_t)i * kOne)); }
+  // num / den, rounded to nearest (den > 0)
+  static constexpr Fixed ratio(int32_t num, int32_t den) {
+    return fromRaw(sat_(divRound_((int64_t)num * kOne, den)));
+  }
+  // Conversions through float: configuration and reporting, not the loop
+  static Fixed fromFloat(float f) {
+    float r = f * (float)kOne;
+    return fromRaw(r >= 2147483520.0f ? INT32_MAX : r <= -2147483520.0f ? INT32_MIN : (int32_t)lroundf(r));
+  }
+  float toFloat() const { return (float)raw_ / (float)kOne; }
+
+  constexpr int32_t raw() const { return raw_; }
+  // Nearest integer (halves away from zero, as lroundf)
+  constexpr int32_t roundToInt() const {
+    return raw_ >= 0 ? (int32_t)(((int64_t)raw_ + kOne / 2) >> kFracBits)
+                     : -(int32_t)((-(int64_t)raw_ + kOne / 2) >> kFracBits);
+  }
+
+  constexpr Fixed operator-() const { return fromRaw(sat_(-(int64_t)raw_)); }
+  constexpr Fixed operator+(Fixed o) const { return fromRaw(sat_((int64_t)raw_ + o.raw_)); }
+  constexpr Fixed operator-(Fixed o) const { return fromRaw(sat_((int64_t)raw_ - o.raw_)); }
+  constexpr Fixed operator*(Fixed o) const {
+    return fromRaw(sat_(divRound_((int64_t)raw_ * o.raw_, kOne)));
+  }
+  constexpr Fixed operator/(Fixed o) const {
+    return o.raw_ == 0 ? fromRaw(raw_ >= 0 ? INT32_MAX : INT32_MIN)
+         : o.raw_ > 0 ? fromRaw(sat_(divRound_((int64_t)raw_ * kOne, o.raw_)))
+                      : fromRaw(sat_(divRound_(-(int64_t)raw_ * kOne, -(int64_t)o.raw_)));
+  }
+  // By a count (running means)
+  constexpr Fixed operator*(int32_t n) const { return fromRaw(sat_((int64_t)raw_ * n)); }
+  constexpr Fixed operator/(int32_t n) const {
+    return n > 0 ? fromRaw(sat_(divRound_(raw_, n)))
+         : n < 0 ? fromRaw(sat_(divRound_(-(int64_t)raw_, -(int64_t)n)))
+                 : fromRaw(raw_ >= 0 ? INT32_MAX : INT32_MIN);
+  }
+
+  Fixed& operator+=(Fixed o) { return *this = *this + o; }
+  Fixed& operator-=(Fixed o) { return *this = *this - o; }
+  Fixed& operator*=(Fixed o) { return *this = *this * o; }
+  Fixed& operator/=(Fixed o) { return *this = *this / o; }
+
+  constexpr bool operator==(Fixed o) const { return raw_ == o.raw_; }
+  constexpr bool operator!=(Fixed o) const { return raw_ != o.raw_; }
+  constexpr bool operator<(Fixed o) const { return raw_ < o.raw_; }
+  constexpr bool operator<=(Fixed o) const { return raw_ <= o.raw_; }
+  constexpr bool operator>(Fixed o) const { return raw_ > o.raw_; }
+  constexpr bool operator>=(Fixed o) const { return raw_ >= o.raw_; }
+
+private:
+  struct Raw {};
+  constexpr Fixed(int32_t raw, Raw) : raw_(raw) {}
+
+  static constexpr int32_t sat_(int64_t v) {
+    return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : (int32_t)v;
+  }
+  // n / d rounded to nearest, halves away from zero (d > 0)
+  static constexpr int64_t divRound_(int64_t n, int64_t d) {
+    return n >= 0 ? (n + d / 2) / d : -((-n + d / 2) / d);
+  }
+
+  int32_t raw_;
+};
+
+// ---------------------------------------------------------------------------
+// The helpers the controller's seek math is written with, for both number types.
+// The float overloads are the expressions the float build always used, so that
+// build is unchanged bit for bit.
+// ---------------------------------------------------------------------------
+inline float abs(float v) { return fabsf(v); }
+inline float max(float a, float b) { return fmaxf(a, b); }
+inline float min(float a, float b) { return fminf(a, b); }
+inline unsigned long secToMs(float s) { return (unsigned long)(1000.0f * s); }
+inline float toFloat(float v) { return v; }
+
+constexpr Fixed abs(Fixed v) { return v.raw() < 0 ? -v : v; }
+constexpr Fixed max(Fixed a, Fixed b) { return a < b ? b : a; }
+constexpr Fixed min(Fixed a, Fixed b) { return b < a ? b : a; }
+// Truncated like the float cast; negative and NaN-like results give 0
+constexpr unsigned long secToMs(Fixed s) {
+  return s.raw() <= 0 ? 0 : (unsigned long)(((int64_t)s.raw() * 1000) >> Fixed::kFracBits);
+}
+// Saturates past the Q16.16 range (about 9 hours)
+constexpr Fixed msToSecFixed(uint32_t ms) {
+  return ms > 32767000u ? Fixed::fromRaw(INT32_MAX) : Fixed::ratio((int32_t)ms, 1000);
+}
+inline float toFloat(Fixed v) { return v.toFloat(); }
+
+// Configuration into either type, for code templated on it (setup, not the loop)
+template <class R> R fromFloat(float v);
+template <> inline float fromFloat<float>(float v) { return v; }
+template <> inline Fixed fromFloat<Fixed>(float v) { return Fixed::fromFloat(v); }
+// Milliseconds as seconds, for code templated on the type
+template <class R> R secFromMs(uint32_t ms);
+template <> inline float secFromMs<float>(uint32_t ms) { return ms / 1000.0f; }
+template <> inline Fixed secFromMs<Fixed>(uint32_t ms) { return msToSecFixed(ms); }
+
+// The controller's number type. ratioToReal is num / den (den > 0), e.g. a ratio of two
+// integer readings, without a float on the way with TA_FIXED_POINT.
+#if TA_FIXED_POINT
+using Real = Fixed;
+inline Real toReal(float v) { return Fixed::fromFloat(v); }
+inline Real centiToReal(int32_t centi) { return Fixed::ratio(centi, 100); }
+inline Real ratioToReal(int32_t num, int32_t den) { return Fixed::ratio(num, den); }
+inline Real msToSec(uint32_t ms) { return msToSecFixed(ms); }
+#else
+using Real = float;
+inline Real toReal(float v) { return v; }
+inline Real centiToReal(int32_t centi) { return centi / 100.0f; }
+inline Real ratioToReal(int32_t num, int32_t den) { return (float)num / den; }
+inline Real msToSec(uint32_t ms) { return ms / 1000.0f; }
+#endif
+
+} // namespace fx
+} // namespace ta
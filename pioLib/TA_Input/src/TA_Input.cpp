@@ -1,24 +1,12 @@
 #include <Arduino.h>
 #include "TA_Input.h"
-#include <SmartButton.h>
-using namespace smartbutton;
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include <TA_Probe.h>
 
 namespace ta {
 namespace input {
 
-namespace {
-  // mapping table for SmartButton::Event -> Action
-  static inline Action mapEv(SmartButton::Event ev) {
-    switch (ev) {
-      case SmartButton::Event::PRESSED:    return Action::Pressed;
-      case SmartButton::Event::RELEASED:   return Action::Released;
-      case SmartButton::Event::CLICK:      return Action::Click;
-      case SmartButton::Event::LONG_HOLD:  return Action::LongHold;
-      default:                             return Action::Click;
-    }
-  }
-}
-
 void Buttons::begin() {
   // Configure pins
   pinMode(pins_.left,  INPUT_PULLUP);
@@ -26,29 +14,14 @@ void Buttons::begin() {
   pinMode(pins_.up,    INPUT_PULLUP);
   pinMode(pins_.right, INPUT_PULLUP);
 
-  // Allocate SmartButtons and bind instance-aware callbacks via context
-  bLeft_  = new SmartButton(pins_.left);
-  bDown_  = new SmartButton(pins_.down);
-  bUp_    = new SmartButton(pins_.up);
-  bRight_ = new SmartButton(pins_.right);
+  gpio_[(int)ButtonId::Left]  = pins_.left;
+  gpio_[(int)ButtonId::Down]  = pins_.down;
+  gpio_[(int)ButtonId::Up]    = pins_.up;
+  gpio_[(int)ButtonId::Right] = pins_.right;
+  highBank_ = false;
+  for (uint8_t g : gpio_) highBank_ = highBank_ || g >= 32;
 
-  // Use the SmartButton context to pass our BtnCtx pointer
-  bLeft_->begin([](SmartButton* b, SmartButton::Event ev, int clicks){
-    auto* ctx = static_cast<BtnCtx*>(b->getContext());
-    ctx->self->onRawEvent_(ctx->id, mapEv(ev), clicks);
-  }, &ctxLeft_);
-  bDown_->begin([](SmartButton* b, SmartButton::Event ev, int clicks){
-    auto* ctx = static_cast<BtnCtx*>(b->getContext());
-    ctx->self->onRawEvent_(ctx->id, mapEv(ev), clicks);
-  }, &ctxDown_);
-  bUp_->begin([](SmartButton* b, SmartButton::Event ev, int clicks){
-    auto* ctx = static_cast<BtnCtx*>(b->getContext());
-    ctx->self->onRawEvent_(ctx->id, mapEv(ev), clicks);
-  }, &ctxUp_);
-  bRight_->begin([](SmartButton* b, SmartButton::Event ev, int clicks){
-    auto* ctx = static_cast<BtnCtx*>(b->getContext());
-    ctx->self->onRawEvent_(ctx->id, mapEv(ev), clicks);
-  }, &ctxRight_);
+  bank_.begin();
 }
 
 void Buttons::subscribe(ButtonCallback cb, void* ctx) {
@@ -73,16 +46,38 @@ void Buttons::clearSubscribers() {
 }
 
 void Buttons::service() {
-  SmartButton::service();
+  uint64_t in = REG_READ(GPIO_IN_REG);
+#ifdef GPIO_IN1_REG
+  if (highBank_) in |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+#endif
+  // Active low (pull-ups)
+  uint8_t raw = 0;
+  for (int i = 0; i < 4; ++i) raw |= (uint8_t)((~in >> gpio_[i]) & 1u) << i;
+#if TA_LATENCY_PROBES
+  // First sample of a new press (bounces before its Pressed don't restart the trace)
+  if ((raw & ~prevRaw_ & ~bank_.pressed()) && !edgeStamped_) {
+    ta::probe::probes().mark(ta::probe::Hop::Edge, micros());
+    edgeStamped_ = true;
+  }
+  prevRaw_ = raw;
+#endif
+  bank_.poll(millis(), raw, [this](const Event& e) { dispatch_(e); });
+#if TA_LATENCY_PROBES
+  if (bank_.idle()) edgeStamped_ = false;
+#endif
 }
 
-void Buttons::onRawEvent_(ButtonId id, Action a, int clicks) {
-  if (subCount_ == 0) return;
-  Event e{ id, a, clicks };
+void Buttons::dispatch_(const Event& e) {
+#if TA_LATENCY_PROBES
+  if (e.action == Action::Pressed) {
+    ta::probe::probes().mark(ta::probe::Hop::Dispatch, micros());
+    edgeStamped_ = false;
+  }
+#endif
   for (int i = 0; i < subCount_; ++i) {
     if (subs_[i].cb) subs_[i].cb(subs_[i].ctx, e);
   }
 }
 
 } // namespace input
-} // namespace ta
\ No newline at end of file
+} // namespace ta
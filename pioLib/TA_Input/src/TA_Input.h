@@ -1,22 +1,167 @@
 #pragma once
 #include <stdint.h>
-
-namespace smartbutton { class SmartButton; }
+#include <string.h>
 
 namespace ta {
 namespace input {
 
 enum class ButtonId { Left, Down, Up, Right };
-enum class Action   { Pressed, Released, Click, LongHold };
+// Repeat fires while a button is held (SmartButton's hold and long-hold repeats);
+// LongHold fires once when the hold turns into a long hold
+enum class Action   { Pressed, Released, Click, LongHold, Repeat };
 
 struct Event {
   ButtonId id;
   Action action;
-  int clicks; // valid for Click
+  int clicks;          // valid for Click
+  uint32_t heldMs;     // valid for Repeat and LongHold: time since the press
 };
 
 using ButtonCallback = void(*)(void* ctx, const Event& e);
 
+// Press/hold timing (SmartButton's defaults)
+struct Timing {
+  uint16_t debounceMs = 20;
+  uint16_t clickMs = 500;         // quiet this long after the last press: Click
+  uint16_t holdMs = 1000;         // down this long: first Repeat
+  uint16_t longHoldMs = 2000;     // this long after the first Repeat: LongHold
+  uint16_t repeatMs = 200;        // Repeat period while held
+  uint16_t longRepeatMs = 50;     // Repeat period in a long hold
+};
+
+// ---------------------------------------------------------------------------
+// Debounce and gestures for up to 8 buttons sampled together as one bitmask (bit i
+// set = ButtonId i pressed). Bitmask state says which buttons need any work: a
+// bank with nothing pressed, settling or waiting out a click returns after one
+// compare, and per-button timers are only read for buttons that are.
+//
+// Events and cadence are SmartButton's, except that a long hold no longer fires a
+// stray Repeat on the poll that sees its release.
+// ---------------------------------------------------------------------------
+class ButtonBank {
+public:
+  static constexpr int kMaxButtons = 8;
+
+  void begin(const Timing& t = Timing()) {
+    t_ = t;
+    stable_ = pending_ = clickWait_ = held_ = longHeld_ = 0;
+  }
+
+  // Sample at `now`; emit(const Event&) is called for each event, in button order
+  template <typename Emit>
+  void poll(uint32_t now, uint8_t raw, Emit&& emit) {
+    uint8_t diff = raw ^ stable_;
+    if ((diff | stable_ | pending_ | clickWait_) == 0) return;
+
+    // A bit flips once it has disagreed with the stable state for debounceMs
+    for (uint8_t m = diff & ~pending_; m; m &= m - 1) since_[ctz_(m)] = now;
+    pending_ = diff;
+    uint8_t flip = 0;
+    for (uint8_t m = pending_; m; m &= m - 1) {
+      int i = ctz_(m);
+      if (now - since_[i] >= t_.debounceMs) flip |= (uint8_t)(1u << i);
+    }
+    pending_ &= (uint8_t)~flip;
+    stable_ ^= flip;
+
+    for (uint8_t m = flip | stable_ | clickWait_; m; m &= m - 1) {
+      int i = ctz_(m);
+      uint8_t b = (uint8_t)(1u << i);
+      if (flip & stable_ & b) {
+        downMs_[i] = tick_[i] = now;
+        clickWait_ &= (uint8_t)~b;              // a multi-click keeps counting
+        emit(event_(i, Action::Pressed, 0));
+      } else if (flip & b) {
+        if ((held_ | longHeld_) & b) {
+          clicks_[i] = 0;                       // a hold is not a click
+          held_ &= (uint8_t)~b;
+          longHeld_ &= (uint8_t)~b;
+        } else {
+          if (clicks_[i] < 255) clicks_[i]++;
+          clickWait_ |= b;
+        }
+        emit(event_(i, Action::Released, 0));
+      } else if (clickWait_ & b) {
+        if (now - tick_[i] > t_.clickMs) {
+          clickWait_ &= (uint8_t)~b;
+          emit(event_(i, Action::Click, 0));
+          clicks_[i] = 0;
+        }
+      } else if (longHeld_ & b) {
+        if (now - repeat_[i] >= t_.longRepeatMs) {
+          repeat_[i] = now;
+          emit(event_(i, Action::Repeat, now - downMs_[i]));
+        }
+      } else if (held_ & b) {
+        if (now - tick_[i] >= t_.longHoldMs) {
+          tick_[i] = repeat_[i] = now;
+          held_ &= (uint8_t)~b;
+          longHeld_ |= b;
+          emit(event_(i, Action::LongHold, now - downMs_[i]));
+        } else if (now - repeat_[i] >= t_.repeatMs) {
+          repeat_[i] = now;
+          emit(event_(i, Action::Repeat, now - downMs_[i]));
+        }
+      } else if (now - tick_[i] >= t_.holdMs) {
+        tick_[i] = repeat_[i] = now;
+        held_ |= b;
+        emit(event_(i, Action::Repeat, now - downMs_[i]));
+      }
+    }
+  }
+
+  uint8_t pressed() const { return stable_; }   // debounced
+  bool idle() const { return (stable_ | pending_ | clickWait_) == 0; }
+
+private:
+  static int ctz_(uint8_t m) { return __builtin_ctz(m); }
+  Event event_(int i, Action a, uint32_t heldMs) const {
+    return Event{ (ButtonId)i, a, clicks_[i], heldMs };
+  }
+
+  Timing t_{};
+  uint8_t stable_ = 0;      // debounced pressed
+  uint8_t pending_ = 0;     // raw disagrees with stable_, settling
+  uint8_t clickWait_ = 0;   // released with clicks to report
+  uint8_t held_ = 0;        // past holdMs, repeating
+  uint8_t longHeld_ = 0;    // past the long hold, repeating fast
+  uint32_t since_[kMaxButtons]{};
+  uint32_t downMs_[kMaxButtons]{};
+  uint32_t tick_[kMaxButtons]{};     // press, then hold-phase start
+  uint32_t repeat_[kMaxButtons]{};
+  uint8_t clicks_[kMaxButtons]{};
+};
+
+// ---------------------------------------------------------------------------
+// Console buttons: one line of serial text as a button event, for a device with no
+// buttons of its own (the control board). "left", "down", "up" or "right" clicks
+// that button and "<button> hold" long-holds it; "pair" and "cal" are shorthand for
+// "left hold" and "right hold". Unknown lines return false.
+// ---------------------------------------------------------------------------
+inline bool parseConsoleButton(const char* line, Event& out, const Timing& t = Timing()) {
+  while (*line == ' ' || *line == '\t') line++;
+  size_t n = strlen(line);
+  while (n && (line[n - 1] == ' ' || line[n - 1] == '\t' || line[n - 1] == '\r' || line[n - 1] == '\n')) n--;
+  auto is = [&](const char* w) { return strlen(w) == n && strncmp(line, w, n) == 0; };
+  static const char* const kNames[] = { "left", "down", "up", "right" };
+  bool hold = false;
+  int id = -1;
+  if (is("pair")) { id = (int)ButtonId::Left; hold = true; }
+  else if (is("cal")) { id = (int)ButtonId::Right; hold = true; }
+  else {
+    for (int i = 0; i < 4 && id < 0; i++) {
+      size_t k = strlen(kNames[i]);
+      if (k > n || strncmp(line, kNames[i], k) != 0) continue;
+      if (k == n) id = i;
+      else if (n == k + 5 && strncmp(line + k, " hold", 5) == 0) { id = i; hold = true; }
+    }
+  }
+  if (id < 0) return false;
+  out = hold ? Event{ (ButtonId)id, Action::LongHold, 0, (uint32_t)t.holdMs + t.longHoldMs }
+             : Event{ (ButtonId)id, Action::Click, 1, 0 };
+  return true;
+}
+
 struct Pins {
   uint8_t left, down, up, right;
 };
@@ -34,13 +179,12 @@ public:
   // Remove all subscribers
   void clearSubscribers();
 
+  // One read of the GPIO input register, then the bank; cost doesn't depend on how
+  // many buttons there are
   void service();
 
 private:
-  // Per-button SmartButton callback context
-  struct BtnCtx { Buttons* self; ButtonId id; };
-  // Raw event hook from SmartButton callbacks (defined in .cpp)
-  void onRawEvent_(ButtonId id, Action a, int clicks);
+  void dispatch_(const Event& e);
 
 private:
   Pins pins_;
@@ -51,15 +195,15 @@ private:
   Sub subs_[kMaxSubs_]{};
   int subCount_ = 0;
 
-  // SmartButton instances (allocated in begin to avoid header dependency)
-  smartbutton::SmartButton* bLeft_  = nullptr;
-  smartbutton::SmartButton* bDown_  = nullptr;
-  smartbutton::SmartButton* bUp_    = nullptr;
-  smartbutton::SmartButton* bRight_ = nullptr;
-  BtnCtx ctxLeft_{this, ButtonId::Left};
-  BtnCtx ctxDown_{this, ButtonId::Down};
-  BtnCtx ctxUp_{this, ButtonId::Up};
-  BtnCtx ctxRight_{this, ButtonId::Right};
+  ButtonBank bank_{};
+  // GPIO number per button (ButtonId order), and whether any is past the first
+  // input register (GPIO 32+ on the original ESP32)
+  uint8_t gpio_[4]{};
+  bool highBank_ = false;
+
+  // Latency probe (TA_LATENCY_PROBES): last raw sample, press edge already stamped
+  uint8_t prevRaw_ = 0;
+  bool edgeStamped_ = false;
 };
 
 } // namespace input
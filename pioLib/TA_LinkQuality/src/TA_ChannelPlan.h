@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+namespace ta {
+namespace link {
+
+// 2.4 GHz channel numbers used by ESP-NOW (1..13); 0 is "unset"
+static constexpr uint8_t kMaxWifiChannel = 13;
+
+struct ChannelPlanConfig {
+  uint8_t maxChannel = 11;      // highest channel allowed (11 = FCC)
+  float lossPenalty = 4.0f;     // weight of remembered link loss vs. AP interference
+  float switchMargin = 0.25f;   // new channel must score this fraction better than current
+};
+
+// Scores channels from a Wi-Fi scan (co/adjacent-channel energy) plus loss we
+// remember having seen on them, and picks the quietest.
+class ChannelPlanner {
+public:
+  void begin(const ChannelPlanConfig& cfg) {
+    cfg_ = cfg;
+    if (cfg_.maxChannel < 1) cfg_.maxChannel = 1;
+    if (cfg_.maxChannel > kMaxWifiChannel) cfg_.maxChannel = kMaxWifiChannel;
+    clearSurvey();
+    for (uint8_t c = 0; c <= kMaxWifiChannel; ++c) loss_[c] = 0;
+  }
+
+  void clearSurvey() {
+    for (uint8_t c = 0; c <= kMaxWifiChannel; ++c) energy_[c] = 0;
+  }
+
+  // One access point from a scan; its energy leaks into channels within +/-4
+  void addAp(uint8_t channel, int8_t rssiDbm) {
+    if (channel < 1 || channel > kMaxWifiChannel) return;
+    float p = powf(10.0f, (rssiDbm + 90) / 10.0f); // relative to the -90 dBm noise floor
+    energy_[channel] += p;
+  }
+
+  // Remember link loss observed on a channel (EWMA so old data fades). Interference
+  // that is invisible to a scan (non-Wi-Fi, hidden APs) is usually wideband, so the
+  // overlapping channels inherit part of it.
+  void noteLoss(uint8_t channel, float loss) {
+    if (channel < 1 || channel > kMaxWifiChannel) return;
+    for (int k = 1; k <= kMaxWifiChannel; ++k) {
+      float w = overlap_(k, channel);
+      if (w > 0) loss_[k] += (loss - loss_[k]) * 0.5f * w;
+    }
+  }
+
+  float score(uint8_t channel) const {
+    if (channel < 1 || channel > kMaxWifiChannel) return 1e30f;
+    float s = 0;
+    for (int k = 1; k <= kMaxWifiChannel; ++k) s += energy_[k] * overlap_(k, channel);
+    return s + loss_[channel] * cfg_.lossPenalty * (1.0f + s);
+  }
+
+  // Quietest allowed channel; stays on `current` unless a clearly better one exists
+  uint8_t pick(uint8_t current) const {
+    uint8_t best = 1;
+    float bestScore = score(1);
+    for (uint8_t c = 2; c <= cfg_.maxChannel; ++c) {
+      float s = score(c);
+      if (s < bestScore) { best = c; bestScore = s; }
+    }
+    if (current >= 1 && current <= cfg_.maxChannel && best != current) {
+      float cur = score(current);
+      if (bestScore >= cur * (1.0f - cfg_.switchMargin)) return current;
+    }
+    return best;
+  }
+
+private:
+  // 20 MHz channel overlap by channel distance
+  static float overlap_(int a, int b) {
+    static const float kOverlap[5] = { 1.0f, 0.7f, 0.35f, 0.1f, 0.02f };
+    int d = a > b ? a - b : b - a;
+    return d < 5 ? kOverlap[d] : 0.0f;
+  }
+
+  ChannelPlanConfig cfg_{};
+  float energy_[kMaxWifiChannel + 1]{};
+  float loss_[kMaxWifiChannel + 1]{};
+};
+
+struct RetuneConfig {
+  float lossThreshold = 0.3f;     // sustained ping loss that triggers a retune
+  uint32_t holdMs = 5000;         // loss must stay above threshold this long
+  uint32_t cooldownMs = 60000;    // minimum spacing between retunes
+  uint32_t minPings = 4;          // samples before the loss figure is trusted
+};
+
+// Decides when the remote should ask the board to move channels
+class RetuneGovernor {
+public:
+  void begin(const RetuneConfig& cfg) { cfg_ = cfg; reset(); }
+  void reset() { aboveSinceMs_ = 0; above_ = false; }
+
+  // Returns true once per qualifying episode; caller then sends the request
+  bool update(uint32_t now, float loss, uint32_t pingsSent) {
+    if (pingsSent < cfg_.minPings || loss < cfg_.lossThreshold) {
+      above_ = false;
+      return false;
+    }
+    if (!above_) { above_ = true; aboveSinceMs_ = now; }
+    if ((now - aboveSinceMs_) < cfg_.holdMs) return false;
+    if (haveRetuned_ && (now - lastRetuneMs_) < cfg_.cooldownMs) return false;
+    haveRetuned_ = true;
+    lastRetuneMs_ = now;
+    above_ = false;
+    return true;
+  }
+
+private:
+  RetuneConfig cfg_{};
+  bool above_ = false;
+  uint32_t aboveSinceMs_ = 0;
+  bool haveRetuned_ = false;
+  uint32_t lastRetuneMs_ = 0;
+};
+
+// Channel order used when searching for a peer: preferred channel first, then the
+// non-overlapping 1/6/11, then the rest
+inline uint8_t sweepChannel(uint8_t preferred, uint8_t step, uint8_t maxChannel) {
+  static const uint8_t kOrder[kMaxWifiChannel] = { 1, 6, 11, 3, 8, 2, 7, 4, 9, 5, 10, 12, 13 };
+  if (step == 0 && preferred >= 1 && preferred <= maxChannel) return preferred;
+  uint8_t n = 0;
+  for (;;) {
+    for (uint8_t i = 0; i < kMaxWifiChannel; ++i) {
+      uint8_t c = kOrder[i];
+      if (c > maxChannel || c == preferred) continue;
+      if (++n >= step) return c;
+    }
+    if (n == 0) return preferred ? preferred : 1;
+  }
+}
+
+} // namespace link
+} // namespace ta
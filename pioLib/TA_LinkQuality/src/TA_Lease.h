@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+#include "TA_LinkQuality.h"
+
+namespace ta {
+namespace link {
+
+// Manual lease timing (remote side)
+struct LeaseConfig {
+  uint16_t leaseMs = 1500;   // a grant runs the board's output this long
+  uint16_t renewMs = 1000;   // renew this long after the grant the board acknowledged
+};
+
+// ---------------------------------------------------------------------------
+// One board's manual lease, as the remote holds it. hold() grants, release()
+// stops. Each new grant, renewal or stop gets a fresh sequence and is resent
+// after an RTO (doubling up to 8x while unanswered) until the board acknowledges
+// that sequence, so a lost frame costs one RTO rather than a refresh period, and
+// a steady hold costs one frame each way per renewMs.
+//
+// A stop that never gets through is given up once the last grant sent has run
+// out: by then the board has stopped on its own, so release-to-stop is bounded
+// by leaseMs whatever the link does. Acknowledged stops are timed.
+//
+// Loop only: the radio callback hands acks over and the loop feeds them here.
+// ---------------------------------------------------------------------------
+class ManualLease {
+public:
+  enum class Send : uint8_t { None, Grant, Stop };
+
+  void begin(const LeaseConfig& cfg) { cfg_ = cfg; state_ = State::Off; }
+
+  void hold(uint8_t code, uint32_t now) {
+    if (state_ == State::Holding && code == code_) return;
+    code_ = code;
+    state_ = State::Holding;
+    next_(now);
+  }
+
+  void release(uint32_t now) {
+    if (state_ != State::Holding) return;
+    state_ = State::Stopping;
+    releasedMs_ = now;
+    next_(now);
+  }
+
+  // What to put on the air now, if anything (with seq() and leaseMs()); rtoMs paces resends
+  Send poll(uint32_t now, uint32_t rtoMs) {
+    switch (state_) {
+      case State::Off:
+        return Send::None;
+      case State::Holding:
+        if (acked_ && now - firstSentMs_ >= cfg_.renewMs) next_(now);
+        if (!due_(now, rtoMs)) return Send::None;
+        lastGrantMs_ = now;
+        return Send::Grant;
+      case State::Stopping:
+        if (now - lastGrantMs_ >= cfg_.leaseMs) {
+          state_ = State::Off;   // the board's lease has run out by now
+          stopsExpired_++;
+          return Send::None;
+        }
+        return due_(now, rtoMs) ? Send::Stop : Send::None;
+    }
+    return Send::None;
+  }
+
+  // Board acknowledged seq; false if it isn't the frame outstanding
+  bool onAck(uint8_t seq, uint32_t now) {
+    if (state_ == State::Off || acked_ || seq != seq_) return false;
+    acked_ = true;
+    if (state_ == State::Stopping) {
+      stopLatency_.add((now - releasedMs_) * 1000u);
+      state_ = State::Off;
+    }
+    return true;
+  }
+
+  bool active() const { return state_ != State::Off; }
+  bool holding() const { return state_ == State::Holding; }
+  uint8_t code() const { return code_; }
+  uint8_t seq() const { return seq_; }
+  uint16_t leaseMs() const { return state_ == State::Holding ? cfg_.leaseMs : 0; }
+
+  // Release -> acknowledged stop, and stops that timed out on the lease instead
+  const LatencyStats& stopLatency() const { return stopLatency_; }
+  uint32_t stopsExpired() const { return stopsExpired_; }
+
+private:
+  enum class State : uint8_t { Off, Holding, Stopping };
+
+  void next_(uint32_t now) {
+    seq_++;
+    acked_ = false;
+    unsent_ = true;
+    tries_ = 0;
+    firstSentMs_ = now;
+  }
+
+  bool due_(uint32_t now, uint32_t rtoMs) {
+    if (!unsent_ && (acked_ || now - sentMs_ < (rtoMs << tries_))) return false;
+    if (unsent_) firstSentMs_ = now;
+    else if (tries_ < 3) tries_++;
+    unsent_ = false;
+    sentMs_ = now;
+    return true;
+  }
+
+  LeaseConfig cfg_{};
+  State state_ = State::Off;
+  uint8_t code_ = 0;
+  uint8_t seq_ = 0;
+  bool acked_ = false;
+  bool unsent_ = false;
+  uint8_t tries_ = 0;          // resends of seq_ so far (backoff shift)
+  uint32_t firstSentMs_ = 0;   // first send of seq_ (the board's lease starts no earlier)
+  uint32_t sentMs_ = 0;        // latest send of seq_
+  uint32_t lastGrantMs_ = 0;
+  uint32_t releasedMs_ = 0;
+  LatencyStats stopLatency_;
+  uint32_t stopsExpired_ = 0;
+};
+
+} // namespace link
+} // namespace ta
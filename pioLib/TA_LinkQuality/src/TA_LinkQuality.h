@@ -0,0 +1,209 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+namespace ta {
+namespace link {
+
+// Bounds and fallbacks for the adaptive link timing
+struct LinkQualityConfig {
+  uint32_t initialTimeoutMs = 5000;   // used until the first RTT sample
+  uint32_t initialBackoffMs = 200;
+  uint32_t backoffMaxMs = 2000;
+  uint32_t statusIntervalMs = 1000;   // expected gap between board status frames
+  uint32_t timeoutMinMs = 1500;
+  uint32_t timeoutMaxMs = 10000;
+  uint32_t rtoMinMs = 50;             // floor for the retransmit/ping timeout
+  uint32_t rtoMaxMs = 2000;
+  uint8_t  minMisses = 2;             // status frames that may be missed on a clean link
+  uint8_t  maxMisses = 8;             // cap on a lossy link
+  float    falseDropProb = 0.001f;    // accepted chance of declaring a live link lost
+};
+
+// Smoothed RTT (RFC 6298 style) and ping-loss estimate for one peer.
+// Not thread-safe: feed it from the loop, not from the radio callback.
+class LinkQuality {
+public:
+  static constexpr uint8_t kSlots = 8; // outstanding pings tracked
+
+  void begin(const LinkQualityConfig& cfg) { cfg_ = cfg; reset(); }
+
+  void reset() {
+    for (uint8_t i = 0; i < kSlots; ++i) slots_[i].pending = false;
+    srttMs_ = 0; rttVarMs_ = 0; samples_ = 0;
+    loss_ = 0; sent_ = lost_ = 0;
+  }
+
+  // Sequence for the next ping (wraps at 255)
+  uint8_t nextSeq() { return ++seq_; }
+
+  void onPingSent(uint8_t seq, uint32_t now) {
+    Slot& s = slots_[seq % kSlots];
+    if (s.pending) countLoss_(); // slot reused before its pong arrived
+    s.seq = seq; s.sentMs = now; s.pending = true;
+    sent_++;
+  }
+
+  // Returns false for an unknown/stale sequence (duplicate or late pong)
+  bool onPong(uint8_t seq, uint32_t now) {
+    Slot& s = slots_[seq % kSlots];
+    if (!s.pending || s.seq != seq) return false;
+    s.pending = false;
+    addRttSample_((float)(now - s.sentMs));
+    loss_ += (0.0f - loss_) * kLossGain;
+    return true;
+  }
+
+  // Age out pings whose pong never came back
+  void expire(uint32_t now) {
+    uint32_t limit = lossTimeoutMs();
+    for (uint8_t i = 0; i < kSlots; ++i) {
+      Slot& s = slots_[i];
+      if (s.pending && (now - s.sentMs) >= limit) {
+        s.pending = false;
+        countLoss_();
+      }
+    }
+  }
+
+  bool hasRtt() const { return samples_ > 0; }
+  float srttMs() const { return srttMs_; }
+  float rttVarMs() const { return rttVarMs_; }
+  float lossRatio() const { return loss_; }
+  uint32_t pingsSent() const { return sent_; }
+  uint32_t pingsLost() const { return lost_; }
+
+  // Retransmission timeout: srtt + 4*rttvar, clamped
+  uint32_t rtoMs() const {
+    if (!hasRtt()) return cfg_.initialBackoffMs;
+    return clamp_((uint32_t)(srttMs_ + 4.0f * rttVarMs_ + 0.5f), cfg_.rtoMinMs, cfg_.rtoMaxMs);
+  }
+
+  // A ping older than this is counted as lost
+  uint32_t lossTimeoutMs() const { return clamp_(2 * rtoMs(), cfg_.rtoMinMs, cfg_.rtoMaxMs); }
+
+  // Status frames we tolerate missing so that P(all lost) stays below falseDropProb
+  uint8_t allowedMisses() const {
+    uint8_t k = cfg_.minMisses;
+    if (loss_ > 0.001f) {
+      float p = loss_ < 0.95f ? loss_ : 0.95f;
+      float need = ceilf(logf(cfg_.falseDropProb) / logf(p));
+      if (need > (float)cfg_.maxMisses) need = (float)cfg_.maxMisses;
+      if (need > (float)k) k = (uint8_t)need;
+    }
+    return k;
+  }
+
+  uint32_t connectionTimeoutMs() const {
+    if (!hasRtt()) return cfg_.initialTimeoutMs;
+    uint32_t t = allowedMisses() * cfg_.statusIntervalMs + rtoMs();
+    return clamp_(t, cfg_.timeoutMinMs, cfg_.timeoutMaxMs);
+  }
+
+  // Reconnect pings: never faster than a reply could come back, cap scales with the timeout
+  uint32_t pingBackoffStartMs() const {
+    if (!hasRtt()) return cfg_.initialBackoffMs;
+    return rtoMs();
+  }
+  uint32_t pingBackoffMaxMs() const {
+    if (!hasRtt()) return cfg_.backoffMaxMs;
+    uint32_t cap = connectionTimeoutMs() / 2;
+    if (cap > cfg_.backoffMaxMs) cap = cfg_.backoffMaxMs;
+    uint32_t start = pingBackoffStartMs();
+    return cap < start ? start : cap;
+  }
+
+private:
+  struct Slot { uint8_t seq = 0; uint32_t sentMs = 0; bool pending = false; };
+
+  static constexpr float kLossGain = 0.125f;
+
+  static uint32_t clamp_(uint32_t v, uint32_t lo, uint32_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+  void addRttSample_(float r) {
+    if (samples_ == 0) {
+      srttMs_ = r;
+      rttVarMs_ = r * 0.5f;
+    } else {
+      rttVarMs_ += (fabsf(srttMs_ - r) - rttVarMs_) * 0.25f;
+      srttMs_ += (r - srttMs_) * 0.125f;
+    }
+    if (samples_ < 0xFFFF) samples_++;
+  }
+
+  void countLoss_() {
+    lost_++;
+    loss_ += (1.0f - loss_) * kLossGain;
+  }
+
+  LinkQualityConfig cfg_{};
+  Slot slots_[kSlots]{};
+  uint8_t seq_ = 0;
+  float srttMs_ = 0;
+  float rttVarMs_ = 0;
+  uint16_t samples_ = 0;
+  float loss_ = 0;
+  uint32_t sent_ = 0;
+  uint32_t lost_ = 0;
+};
+
+// Running min/mean/max of a latency in microseconds, and a log-scale histogram
+// (8 buckets per doubling, so within 12.5%) for percentiles
+struct LatencyStats {
+  static constexpr int kBuckets = 168;   // exact below 16 us; everything past ~8 s shares the last
+
+  uint32_t count = 0;
+  uint32_t minUs = 0;
+  uint32_t maxUs = 0;
+  uint64_t sumUs = 0;
+  uint16_t hist[kBuckets] = {};          // saturates; percentiles drift past 65535 samples per bucket
+
+  void add(uint32_t us) {
+    if (count == 0 || us < minUs) minUs = us;
+    if (us > maxUs) maxUs = us;
+    sumUs += us;
+    count++;
+    uint16_t& h = hist[bucket_(us)];
+    if (h < 0xFFFF) h++;
+  }
+  uint32_t meanUs() const { return count ? (uint32_t)(sumUs / count) : 0; }
+
+  // Latency that a fraction q of the samples don't exceed (the top of its bucket,
+  // kept inside min..max)
+  uint32_t percentileUs(float q) const {
+    if (count == 0) return 0;
+    uint32_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) seen += hist[i];
+    uint32_t want = (uint32_t)ceilf(q * (float)seen);
+    if (want == 0) want = 1;
+    uint32_t cum = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      cum += hist[i];
+      if (cum >= want) {
+        uint32_t top = bucketTop_(i);
+        return top < minUs ? minUs : (top > maxUs ? maxUs : top);
+      }
+    }
+    return maxUs;
+  }
+  uint32_t p99Us() const { return percentileUs(0.99f); }
+
+  void reset() { *this = LatencyStats{}; }
+
+  static int bucket_(uint32_t us) {
+    if (us < 16) return (int)us;
+    int e = 31 - __builtin_clz(us);
+    int i = 16 + (e - 4) * 8 + (int)((us >> (e - 3)) & 7);
+    return i < kBuckets ? i : kBuckets - 1;
+  }
+  static uint32_t bucketTop_(int i) {
+    if (i < 16) return (uint32_t)i;
+    if (i == kBuckets - 1) return 0xFFFFFFFFu;
+    int e = (i - 16) / 8 + 4;
+    uint32_t sub = (uint32_t)((i - 16) % 8);
+    return ((9 + sub) << (e - 3)) - 1;
+  }
+};
+
+} // namespace link
+} // namespace ta
@@ -0,0 +1,216 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace ta {
+namespace pairkey {
+
+// ESP-NOW key sizes (PMK and LMK are both 16 bytes)
+static constexpr size_t kKeyLen = 16;
+static constexpr size_t kMacLen = 6;
+
+// NVS layout: the LMK sits next to the peer MAC in the "trailair" namespace
+static constexpr const char* kNvsNamespace = "trailair";
+static constexpr const char* kNvsPeer = "peer";
+static constexpr const char* kNvsLmk  = "lmk";
+
+// ---------------------------------------------------------------------------
+// SHA-256 / HMAC-SHA256 (FIPS 180-4, RFC 2104). Only run at pairing time, so a
+// small portable implementation is enough and keeps this testable on the host.
+// ---------------------------------------------------------------------------
+class Sha256 {
+public:
+  static constexpr size_t kDigestLen = 32;
+  static constexpr size_t kBlockLen = 64;
+
+  Sha256() { reset(); }
+
+  void reset() {
+    static const uint32_t kInit[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    memcpy(h_, kInit, sizeof(h_));
+    bufLen_ = 0;
+    total_ = 0;
+  }
+
+  void update(const uint8_t* data, size_t len) {
+    total_ += len;
+    while (len > 0) {
+      size_t n = kBlockLen - bufLen_;
+      if (n > len) n = len;
+      memcpy(buf_ + bufLen_, data, n);
+      bufLen_ += n; data += n; len -= n;
+      if (bufLen_ == kBlockLen) { block_(buf_); bufLen_ = 0; }
+    }
+  }
+
+  void finish(uint8_t out[kDigestLen]) {
+    uint64_t bits = total_ * 8;
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    pad = 0;
+    while (bufLen_ != 56) update(&pad, 1);
+    uint8_t len[8];
+    for (int i = 0; i < 8; ++i) len[i] = (uint8_t)(bits >> (56 - 8 * i));
+    update(len, 8);
+    for (int i = 0; i < 8; ++i) {
+      out[4 * i]     = (uint8_t)(h_[i] >> 24);
+      out[4 * i + 1] = (uint8_t)(h_[i] >> 16);
+      out[4 * i + 2] = (uint8_t)(h_[i] >> 8);
+      out[4 * i + 3] = (uint8_t)(h_[i]);
+    }
+  }
+
+private:
+  static uint32_t rotr_(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void block_(const uint8_t* p) {
+    static const uint32_t k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+             ((uint32_t)p[4 * i + 2] << 8) | (uint32_t)p[4 * i + 3];
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = rotr_(w[i - 15], 7) ^ rotr_(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotr_(w[i - 2], 17) ^ rotr_(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4], f = h_[5], g = h_[6], h = h_[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t t1 = h + (rotr_(e, 6) ^ rotr_(e, 11) ^ rotr_(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+      uint32_t t2 = (rotr_(a, 2) ^ rotr_(a, 13) ^ rotr_(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+    }
+    h_[0] += a; h_[1] += b; h_[2] += c; h_[3] += d;
+    h_[4] += e; h_[5] += f; h_[6] += g; h_[7] += h;
+  }
+
+  uint32_t h_[8];
+  uint8_t buf_[kBlockLen];
+  size_t bufLen_ = 0;
+  uint64_t total_ = 0;
+};
+
+inline void hmacSha256(const uint8_t* key, size_t keyLen, const uint8_t* msg, size_t msgLen,
+                       uint8_t out[Sha256::kDigestLen]) {
+  uint8_t k[Sha256::kBlockLen] = {0};
+  if (keyLen > Sha256::kBlockLen) {
+    Sha256 s; s.update(key, keyLen); s.finish(k);
+  } else {
+    memcpy(k, key, keyLen);
+  }
+  uint8_t pad[Sha256::kBlockLen];
+  for (size_t i = 0; i < Sha256::kBlockLen; ++i) pad[i] = k[i] ^ 0x36;
+  uint8_t inner[Sha256::kDigestLen];
+  Sha256 s;
+  s.update(pad, sizeof(pad)); s.update(msg, msgLen); s.finish(inner);
+  for (size_t i = 0; i < Sha256::kBlockLen; ++i) pad[i] = k[i] ^ 0x5c;
+  s.reset();
+  s.update(pad, sizeof(pad)); s.update(inner, sizeof(inner)); s.finish(out);
+}
+
+// ---------------------------------------------------------------------------
+// Per-pair LMK: HMAC-SHA256(PMK, label | remote MAC | board MAC | group | nonce),
+// truncated to 16 bytes. The board draws a fresh nonce for every pairing, so
+// re-pairing the same remote rotates the key. Everything but the PMK is public
+// (the nonce goes out in the Key frame), so the key is only as secret as the
+// PMK: a provisioned one keeps captured pairings useless to an eavesdropper;
+// the built-in default (see TA_PAIR_SECRET) is obfuscation, not encryption.
+// ---------------------------------------------------------------------------
+inline void deriveLmk(const uint8_t pmk[kKeyLen], const uint8_t remoteMac[kMacLen],
+                      const uint8_t boardMac[kMacLen], uint8_t groupId, uint32_t nonce,
+                      uint8_t lmk[kKeyLen]) {
+  static const char kLabel[] = "TrailAir LMK v1";
+  uint8_t msg[sizeof(kLabel) - 1 + 2 * kMacLen + 1 + 4];
+  size_t n = 0;
+  memcpy(msg + n, kLabel, sizeof(kLabel) - 1); n += sizeof(kLabel) - 1;
+  memcpy(msg + n, remoteMac, kMacLen); n += kMacLen;
+  memcpy(msg + n, boardMac, kMacLen); n += kMacLen;
+  msg[n++] = groupId;
+  msg[n++] = (uint8_t)(nonce >> 24);
+  msg[n++] = (uint8_t)(nonce >> 16);
+  msg[n++] = (uint8_t)(nonce >> 8);
+  msg[n++] = (uint8_t)nonce;
+  uint8_t digest[Sha256::kDigestLen];
+  hmacSha256(pmk, kKeyLen, msg, n, digest);
+  memcpy(lmk, digest, kKeyLen);
+}
+
+// ---------------------------------------------------------------------------
+// NVS persistence. Templated on the store so the same code runs against
+// Arduino's Preferences on the device and a fake in native tests.
+// ---------------------------------------------------------------------------
+
+// NVS key for a peer slot. Slot 0 keeps the plain names ("peer"/"lmk") so a
+// single-peer pairing carries over; slot n uses "peer<n>"/"lmk<n>".
+inline void slotKey(char out[8], const char* base, uint8_t slot) {
+  size_t n = strlen(base);
+  memcpy(out, base, n);
+  if (slot > 0) out[n++] = (char)('0' + slot % 10);
+  out[n] = '\0';
+}
+
+// Returns false unless both the MAC and its LMK are present. A peer saved by older
+// firmware (MAC only) therefore reads as unpaired and must pair again.
+template <typename Prefs>
+bool loadPeer(Prefs& prefs, uint8_t slot, uint8_t mac[kMacLen], uint8_t lmk[kKeyLen]) {
+  char kPeer[8], kLmk[8];
+  slotKey(kPeer, kNvsPeer, slot);
+  slotKey(kLmk, kNvsLmk, slot);
+  if (!prefs.begin(kNvsNamespace, true)) return false;
+  bool ok = prefs.getBytesLength(kPeer) == kMacLen && prefs.getBytesLength(kLmk) == kKeyLen;
+  if (ok) {
+    ok = prefs.getBytes(kPeer, mac, kMacLen) == kMacLen &&
+         prefs.getBytes(kLmk, lmk, kKeyLen) == kKeyLen;
+  }
+  prefs.end();
+  return ok;
+}
+
+template <typename Prefs>
+bool savePeer(Prefs& prefs, uint8_t slot, const uint8_t mac[kMacLen], const uint8_t lmk[kKeyLen]) {
+  char kPeer[8], kLmk[8];
+  slotKey(kPeer, kNvsPeer, slot);
+  slotKey(kLmk, kNvsLmk, slot);
+  if (!prefs.begin(kNvsNamespace, false)) return false;
+  // Key first: a power cut in between leaves no MAC, i.e. cleanly unpaired
+  prefs.remove(kPeer);
+  bool ok = prefs.putBytes(kLmk, lmk, kKeyLen) == kKeyLen &&
+            prefs.putBytes(kPeer, mac, kMacLen) == kMacLen;
+  prefs.end();
+  return ok;
+}
+
+template <typename Prefs>
+bool clearPeer(Prefs& prefs, uint8_t slot) {
+  char kPeer[8], kLmk[8];
+  slotKey(kPeer, kNvsPeer, slot);
+  slotKey(kLmk, kNvsLmk, slot);
+  if (!prefs.begin(kNvsNamespace, false)) return false;
+  bool ok = prefs.remove(kPeer);
+  prefs.remove(kLmk);
+  prefs.end();
+  return ok;
+}
+
+// Single-peer forms (slot 0)
+template <typename Prefs>
+bool loadPeer(Prefs& prefs, uint8_t mac[kMacLen], uint8_t lmk[kKeyLen]) { return loadPeer(prefs, 0, mac, lmk); }
+template <typename Prefs>
+bool savePeer(Prefs& prefs, const uint8_t mac[kMacLen], const uint8_t lmk[kKeyLen]) { return savePeer(prefs, 0, mac, lmk); }
+template <typename Prefs>
+bool clearPeer(Prefs& prefs) { return clearPeer(prefs, 0); }
+
+} // namespace pairkey
+} // namespace ta
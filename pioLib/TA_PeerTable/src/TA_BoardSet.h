@@ -0,0 +1,217 @@
+#pragma once
+#include <stdint.h>
+#include <TA_Protocol.h>
+#include "TA_PeerTable.h"
+
+namespace ta {
+namespace peers {
+
+// Remote side of a multi-board trailer (e.g. front and rear axle boards). Boards live
+// in a PeerTable on the remote; the state below is indexed by the same slot.
+
+// Command target meaning "every paired board"
+static constexpr uint8_t kAllBoards = 0xFF;
+
+inline uint8_t targetMask(uint8_t target) {
+  return target == kAllBoards ? (uint8_t)((1u << kMaxPeers) - 1) : (uint8_t)(target < kMaxPeers ? (1u << target) : 0);
+}
+
+// ---------------------------------------------------------------------------
+// Per-board connection and reconnect backoff. Everything advances from the app
+// loop: the radio callback only records when a board was heard, service() turns
+// that into state and says which boards are due a ping, and nothing waits.
+// ---------------------------------------------------------------------------
+struct ConnConfig {
+  uint32_t timeoutMs = 5000;      // not heard for this long -> disconnected
+  uint32_t backoffStartMs = 200;  // first reconnect ping interval
+  uint32_t backoffMaxMs = 2000;
+};
+
+struct BoardConn {
+  bool connected = false;
+  bool connecting = false;
+  uint32_t lastSeenMs = 0;
+  uint32_t nextPingAtMs = 0;
+  uint32_t backoffMs = 0;
+  uint8_t unanswered = 0;     // reconnect pings since the board was last heard
+};
+
+class BoardConnSet {
+public:
+  void begin(const ConnConfig& cfg) {
+    cfg_ = cfg;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) clear(i);
+  }
+
+  // Adaptive timing updates these as RTT/loss samples arrive
+  void setTiming(uint32_t timeoutMs, uint32_t backoffStartMs, uint32_t backoffMaxMs) {
+    cfg_.timeoutMs = timeoutMs;
+    cfg_.backoffStartMs = backoffStartMs;
+    cfg_.backoffMaxMs = backoffMaxMs;
+  }
+  const ConnConfig& config() const { return cfg_; }
+
+  void clear(uint8_t slot) {
+    if (slot >= kMaxPeers) return;
+    conns_[slot] = BoardConn{};
+    conns_[slot].backoffMs = cfg_.backoffStartMs;
+  }
+
+  void heard(uint8_t slot, uint32_t now) {
+    if (slot >= kMaxPeers) return;
+    BoardConn& c = conns_[slot];
+    c.connected = true;
+    c.connecting = false;
+    c.lastSeenMs = now;
+    c.unanswered = 0;
+    c.backoffMs = cfg_.backoffStartMs;
+  }
+
+  // Start pinging every board in mask that isn't connected; the first ping goes out
+  // on the next service()
+  void requestReconnect(uint8_t mask, uint32_t now) {
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+      BoardConn& c = conns_[i];
+      if (!(mask & (1u << i)) || c.connected) continue;
+      c.connecting = true;
+      c.nextPingAtMs = now;
+    }
+  }
+
+  // Times out quiet boards and returns the boards (bit per slot, limited to usedMask)
+  // whose reconnect ping is due now. Each returned board is counted as pinged.
+  uint8_t service(uint32_t now, uint8_t usedMask) {
+    uint8_t due = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+      if (!(usedMask & (1u << i))) continue;
+      BoardConn& c = conns_[i];
+      if (c.connected && (now - c.lastSeenMs) >= cfg_.timeoutMs) {
+        c.connected = false;
+        c.backoffMs = cfg_.backoffStartMs;
+      }
+      if (!c.connecting || c.connected) continue;
+      if ((int32_t)(now - c.nextPingAtMs) < 0) continue;
+      due |= (uint8_t)(1u << i);
+      if (c.unanswered < 0xFF) c.unanswered++;
+      c.nextPingAtMs = now + c.backoffMs;
+      c.backoffMs = c.backoffMs * 2 < cfg_.backoffMaxMs ? c.backoffMs * 2 : cfg_.backoffMaxMs;
+    }
+    return due;
+  }
+
+  bool isConnected(uint8_t slot) const { return slot < kMaxPeers && conns_[slot].connected; }
+  bool isConnecting(uint8_t slot) const { return slot < kMaxPeers && conns_[slot].connecting; }
+
+  uint8_t connectedMask() const {
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (conns_[i].connected) m |= (uint8_t)(1u << i);
+    return m;
+  }
+  uint8_t connectingMask() const {
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (conns_[i].connecting && !conns_[i].connected) m |= (uint8_t)(1u << i);
+    return m;
+  }
+
+  // Fewest unanswered pings among the boards in mask still being searched for
+  // (0xFF when none are); drives the channel sweep
+  uint8_t minUnanswered(uint8_t mask) const {
+    uint8_t n = 0xFF;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+      if (!(mask & (1u << i)) || !conns_[i].connecting || conns_[i].connected) continue;
+      if (conns_[i].unanswered < n) n = conns_[i].unanswered;
+    }
+    return n;
+  }
+
+  const BoardConn& at(uint8_t slot) const { return conns_[slot < kMaxPeers ? slot : 0]; }
+
+private:
+  ConnConfig cfg_{};
+  BoardConn conns_[kMaxPeers];
+};
+
+// ---------------------------------------------------------------------------
+// Last status from each board and the combined view the remote renders.
+// For several boards the view is the one that needs attention:
+//  - any board in error -> Error (first such board's code)
+//  - else the busiest activity: AirUp, then Venting, then Checking; Idle only when all are
+//  - pressure is the lowest reported (the tire most likely to need air), min/max kept
+// ---------------------------------------------------------------------------
+struct BoardView {
+  bool valid = false;             // at least one board in the mask has reported
+  ta::protocol::Status status = ta::protocol::Status::Idle;
+  bool hasPsi = false;            // false when every reporting board is in error
+  float psi = 0.0f;
+  float psiMin = 0.0f;
+  float psiMax = 0.0f;
+  uint8_t errorCode = 0;
+  uint8_t errorDetail = 0;        // with errorCode (e.g. LEAK: 0.1 psi/min)
+  bool hasTarget = false;         // a board reported a temperature-compensated target
+  float targetPsi = 0.0f;         // the highest such target
+  uint8_t boards = 0;             // boards contributing
+};
+
+class BoardStatusSet {
+public:
+  void onStatus(uint8_t slot, const ta::protocol::Response& r) {
+    if (slot >= kMaxPeers) return;
+    last_[slot] = r;
+    validMask_ |= (uint8_t)(1u << slot);
+  }
+
+  void clear(uint8_t slot) { if (slot < kMaxPeers) validMask_ &= (uint8_t)~(1u << slot); }
+  void clearAll() { validMask_ = 0; }
+
+  bool has(uint8_t slot) const { return slot < kMaxPeers && (validMask_ & (1u << slot)); }
+  const ta::protocol::Response& at(uint8_t slot) const { return last_[slot < kMaxPeers ? slot : 0]; }
+
+  BoardView view(uint8_t mask) const {
+    using ta::protocol::Status;
+    BoardView v;
+    uint8_t bestRank = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+      if (!(mask & validMask_ & (1u << i))) continue;
+      const ta::protocol::Response& r = last_[i];
+      v.valid = true;
+      v.boards++;
+      uint8_t rank = rank_(r.status);
+      if (rank > bestRank || v.boards == 1) {
+        bestRank = rank;
+        v.status = r.status;
+        if (r.status == Status::Error) { v.errorCode = r.value; v.errorDetail = r.detail; }
+      }
+      if (r.status == Status::Error) continue;
+      if (ta::protocol::hasTarget(r)) {
+        float t = ta::protocol::responseTargetPsi(r);
+        if (!v.hasTarget || t > v.targetPsi) v.targetPsi = t;
+        v.hasTarget = true;
+      }
+      float psi = ta::protocol::responsePsi(r);
+      if (!v.hasPsi || psi < v.psiMin) v.psiMin = psi;
+      if (!v.hasPsi || psi > v.psiMax) v.psiMax = psi;
+      v.hasPsi = true;
+    }
+    v.psi = v.psiMin;
+    return v;
+  }
+
+private:
+  static uint8_t rank_(ta::protocol::Status s) {
+    using ta::protocol::Status;
+    switch (s) {
+      case Status::Error:    return 4;
+      case Status::AirUp:    return 3;
+      case Status::Venting:  return 2;
+      case Status::Checking: return 1;
+      case Status::Idle:     return 0;
+    }
+    return 0;
+  }
+
+  ta::protocol::Response last_[kMaxPeers];
+  uint8_t validMask_ = 0;
+};
+
+} // namespace peers
+} // namespace ta
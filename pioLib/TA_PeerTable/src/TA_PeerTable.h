@@ -0,0 +1,220 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <TA_Protocol.h>
+#include <TA_PairKey.h>
+
+namespace ta {
+namespace peers {
+
+// Remotes one board can hold. Every entry is an encrypted ESP-NOW peer and the
+// radio caps those at 6-7, so leave headroom.
+static constexpr uint8_t kMaxPeers = 4;
+
+struct Peer {
+  bool used = false;
+  uint8_t mac[ta::pairkey::kMacLen] = {0};
+  uint8_t lmk[ta::pairkey::kKeyLen] = {0};
+  uint32_t lastRxMs = 0;   // 0 = not heard since boot
+  uint8_t proto = ta::protocol::kProtoUnknown; // negotiated wire version, relearned every boot
+};
+
+// Fixed-capacity table; slot i is persisted in NVS slot i (see ta::pairkey::slotKey).
+// Not thread-safe: BoardLink guards it against its radio callback.
+class PeerTable {
+public:
+  int8_t find(const uint8_t mac[6]) const {
+    for (uint8_t i = 0; i < kMaxPeers; ++i) {
+      if (peers_[i].used && memcmp(peers_[i].mac, mac, 6) == 0) return (int8_t)i;
+    }
+    return -1;
+  }
+
+  int8_t freeSlot() const {
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (!peers_[i].used) return (int8_t)i;
+    return -1;
+  }
+
+  void set(uint8_t slot, const uint8_t mac[6], const uint8_t lmk[ta::pairkey::kKeyLen]) {
+    if (slot >= kMaxPeers) return;
+    Peer& p = peers_[slot];
+    if (!p.used || memcmp(p.mac, mac, 6) != 0) { p.lastRxMs = 0; p.proto = ta::protocol::kProtoUnknown; }
+    p.used = true;
+    memcpy(p.mac, mac, 6);
+    memcpy(p.lmk, lmk, sizeof(p.lmk));
+  }
+
+  void clear(uint8_t slot) { if (slot < kMaxPeers) peers_[slot] = Peer{}; }
+  void clearAll() { for (uint8_t i = 0; i < kMaxPeers; ++i) peers_[i] = Peer{}; }
+
+  void touch(uint8_t slot, uint32_t now) { if (slot < kMaxPeers) peers_[slot].lastRxMs = now ? now : 1; }
+
+  void setProto(uint8_t slot, uint8_t v) { if (slot < kMaxPeers) peers_[slot].proto = v; }
+  // Version to send in: v1 until the peer has told us otherwise
+  uint8_t sendProto(uint8_t slot) const {
+    uint8_t v = slot < kMaxPeers ? peers_[slot].proto : ta::protocol::kProtoUnknown;
+    return v == ta::protocol::kProtoUnknown ? ta::protocol::kProtoV1 : v;
+  }
+
+  bool isActive(uint8_t slot, uint32_t now, uint32_t timeoutMs) const {
+    if (slot >= kMaxPeers) return false;
+    const Peer& p = peers_[slot];
+    return p.used && p.lastRxMs != 0 && (now - p.lastRxMs) < timeoutMs;
+  }
+
+  // Bit i set when slot i is active
+  uint8_t activeMask(uint32_t now, uint32_t timeoutMs) const {
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (isActive(i, now, timeoutMs)) m |= (uint8_t)(1u << i);
+    return m;
+  }
+
+  uint8_t usedMask() const {
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (peers_[i].used) m |= (uint8_t)(1u << i);
+    return m;
+  }
+
+  uint8_t count() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < kMaxPeers; ++i) if (peers_[i].used) n++;
+    return n;
+  }
+
+  const Peer& at(uint8_t slot) const { return peers_[slot < kMaxPeers ? slot : 0]; }
+
+private:
+  Peer peers_[kMaxPeers];
+};
+
+// Fill the table from NVS; returns the number of peers loaded
+template <typename Prefs>
+uint8_t loadPeers(Prefs& prefs, PeerTable& table) {
+  table.clearAll();
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < kMaxPeers; ++i) {
+    uint8_t mac[ta::pairkey::kMacLen];
+    uint8_t lmk[ta::pairkey::kKeyLen];
+    if (ta::pairkey::loadPeer(prefs, i, mac, lmk)) { table.set(i, mac, lmk); n++; }
+  }
+  return n;
+}
+
+// ---------------------------------------------------------------------------
+// Conflict policy for commands from several remotes.
+//  - Idle is always accepted and releases ownership: any remote can stop.
+//  - A manual lease stop ends only the lease its sender holds. From the lease owner
+//    (or with no lease running) it is accepted and releases ownership; from anyone
+//    else it is ignored: acknowledged so the sender stops resending, never applied.
+//  - A Start/Manual makes its sender the owner for holdMs (renewed by each command,
+//    so a held manual button keeps it); a leased Manual also makes it the lease owner
+//    until a stop, an Idle or another accepted command.
+//  - While owned, another remote's Start/Manual is accepted only if it asks for the
+//    same thing (same kind and target/code); otherwise it is rejected as a conflict.
+//  - Pings are not commands and never conflict.
+// ---------------------------------------------------------------------------
+struct ArbiterConfig {
+  uint32_t holdMs = 1500;  // must exceed the remote's manual resend / lease renew period
+};
+
+class CommandArbiter {
+public:
+  enum class Verdict : uint8_t { Accept, Conflict, Ignore };
+
+  void begin(const ArbiterConfig& cfg) { cfg_ = cfg; release(); }
+  void release() { owner_ = -1; leaseOwner_ = -1; }
+
+  int8_t owner(uint32_t now) const { return owned_(now) ? owner_ : (int8_t)-1; }
+  int8_t leaseOwner() const { return leaseOwner_; }
+
+  Verdict admit(int8_t slot, const ta::protocol::Request& r, uint32_t now) {
+    using RK = ta::protocol::Request::Kind;
+    if (r.kind == RK::Ping) return Verdict::Accept;
+    if (ta::protocol::isManualStop(r) && leaseOwner_ >= 0 && leaseOwner_ != slot) return Verdict::Ignore;
+    if (r.kind == RK::Idle || ta::protocol::isManualStop(r)) { release(); return Verdict::Accept; }
+    if (owned_(now) && owner_ != slot && !same_(r, last_)) return Verdict::Conflict;
+    owner_ = slot;
+    leaseOwner_ = (r.kind == RK::Manual && r.leased) ? slot : (int8_t)-1;
+    last_ = r;
+    sinceMs_ = now;
+    return Verdict::Accept;
+  }
+
+private:
+  bool owned_(uint32_t now) const { return owner_ >= 0 && (now - sinceMs_) < cfg_.holdMs; }
+
+  static bool same_(const ta::protocol::Request& a, const ta::protocol::Request& b) {
+    using RK = ta::protocol::Request::Kind;
+    if (a.kind != b.kind) return false;
+    if (a.kind == RK::Start) return ta::protocol::psiToU16_01(a.targetPsi) == ta::protocol::psiToU16_01(b.targetPsi);
+    if (a.kind == RK::Manual) return a.manual == b.manual;
+    return true;
+  }
+
+  ArbiterConfig cfg_{};
+  int8_t owner_ = -1;
+  int8_t leaseOwner_ = -1;   // slot whose manual lease is running
+  ta::protocol::Request last_{};
+  uint32_t sinceMs_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Requests handed from the radio callback to the loop, oldest first. When full,
+// a new request evicts the oldest one that is not a stop (Idle or a manual lease
+// stop); a stop that finds only stops queued evicts the oldest of those, anything
+// else is refused. A stop is never lost to a burst of other traffic; evictions
+// and refusals are counted. Not thread-safe: the board app guards it.
+// ---------------------------------------------------------------------------
+struct QueuedRequest {
+  ta::protocol::Request req{};
+  uint8_t slot = 0;         // sender's peer slot
+  uint32_t us = 0;          // arrival (latency probes)
+};
+
+class RequestQueue {
+public:
+  static constexpr uint8_t kCapacity = 4;
+
+  // false = refused (the caller must not acknowledge it)
+  bool push(const QueuedRequest& q) {
+    if (count_ == kCapacity) {
+      int8_t victim = -1;
+      for (uint8_t i = 0; i < count_ && victim < 0; ++i) {
+        if (!isStop(at_(i).req)) victim = (int8_t)i;
+      }
+      if (victim < 0 && isStop(q.req)) victim = 0;
+      dropped_++;
+      if (victim < 0) return false;
+      for (uint8_t i = (uint8_t)victim; i + 1 < count_; ++i) at_(i) = at_(i + 1);
+      count_--;
+    }
+    at_(count_++) = q;
+    return true;
+  }
+
+  bool pop(QueuedRequest& out) {
+    if (count_ == 0) return false;
+    out = items_[head_];
+    head_ = (uint8_t)((head_ + 1) % kCapacity);
+    count_--;
+    return true;
+  }
+
+  uint8_t size() const { return count_; }
+  uint32_t dropped() const { return dropped_; }   // evicted or refused since boot
+
+  static bool isStop(const ta::protocol::Request& r) {
+    return r.kind == ta::protocol::Request::Kind::Idle || ta::protocol::isManualStop(r);
+  }
+
+private:
+  QueuedRequest& at_(uint8_t i) { return items_[(head_ + i) % kCapacity]; }
+
+  QueuedRequest items_[kCapacity];
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+  uint32_t dropped_ = 0;
+};
+
+} // namespace peers
+} // namespace ta
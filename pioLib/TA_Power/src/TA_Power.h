@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+
+namespace ta {
+namespace sensors {
+
+// ADC source behind the sensor channels: analogReadMilliVolts on the board, a fake
+// in native tests
+struct IAdc {
+  virtual ~IAdc() = default;
+  virtual int readMilliVolts(int pin) = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Compressor current and vehicle supply voltage.
+//
+// Current comes from a hall sensor (e.g. ACS758-050B: 40 mV/A around a mid-rail zero)
+// or a shunt amplifier (zeroMv = 0); voltage from a resistor divider off the supply.
+// Both are smoothed with an EMA since the motor's commutation ripple is large. The
+// readings are held in integer 0.01 V / 0.01 A (what the controller and the recorder
+// take), with the configuration converted once in begin(), so a sample costs no
+// float on a part without an FPU. A pin of -1 disables that channel.
+// ---------------------------------------------------------------------------
+struct PowerConfig {
+  int currentPin = -1;
+  int voltagePin = -1;
+  float currentZeroMv = 1650.0f;
+  float currentMvPerAmp = 40.0f;
+  float voltageDivider = 5.7f;     // 47k over 10k
+  float alpha = 0.2f;              // EMA weight of a new sample
+};
+
+class PowerSensor {
+public:
+  void begin(IAdc* adc, const PowerConfig& cfg) {
+    adc_ = adc;
+    cfg_ = cfg;
+    primed_ = false;
+    volts256_ = amps256_ = 0;
+    dividerMilli_ = (int32_t)(cfg.voltageDivider * 1000.0f + 0.5f);
+    zeroMv16_ = (int32_t)(cfg.currentZeroMv * 16.0f + 0.5f);
+    mvPerAmp16_ = (int32_t)(cfg.currentMvPerAmp * 16.0f + 0.5f);
+    int32_t a = (int32_t)(cfg.alpha * 256.0f + 0.5f);
+    alpha256_ = a < 1 ? 1 : (a > 256 ? 256 : a);
+  }
+
+  // Take one reading of each enabled channel
+  void sample() {
+    if (!adc_) return;
+    int32_t v = cfg_.voltagePin >= 0 ? (adc_->readMilliVolts(cfg_.voltagePin) * dividerMilli_ + 5000) / 10000 : 0;
+    int32_t a = 0;
+    if (cfg_.currentPin >= 0 && mvPerAmp16_ > 0) {
+      a = ((adc_->readMilliVolts(cfg_.currentPin) * 16 - zeroMv16_) * 100 + mvPerAmp16_ / 2) / mvPerAmp16_;
+      if (a < 0) a = 0; // the compressor only draws
+    }
+    v = v > 65500 ? 65500 : (v < 0 ? 0 : v);
+    a = a > 32700 ? 32700 : a;
+    if (!primed_) {
+      volts256_ = v * 256;
+      amps256_ = a * 256;
+      primed_ = true;
+    } else {
+      volts256_ += (int32_t)((int64_t)alpha256_ * (v * 256 - volts256_) / 256);
+      amps256_ += (int32_t)((int64_t)alpha256_ * (a * 256 - amps256_) / 256);
+    }
+  }
+
+  bool hasVoltage() const { return primed_ && cfg_.voltagePin >= 0; }
+  bool hasCurrent() const { return primed_ && cfg_.currentPin >= 0; }
+  uint16_t centiVolts() const { return (uint16_t)((volts256_ + 128) / 256); }
+  int16_t centiAmps() const { return (int16_t)((amps256_ + 128) / 256); }
+  float volts() const { return volts256_ / 25600.0f; }
+  float amps() const { return amps256_ / 25600.0f; }
+  float watts() const { return volts() * amps(); }
+  const PowerConfig& config() const { return cfg_; }
+
+private:
+  IAdc* adc_ = nullptr;
+  PowerConfig cfg_{};
+  bool primed_ = false;
+  int32_t volts256_ = 0;      // EMA in 1/256 of 0.01 V
+  int32_t amps256_ = 0;       // and of 0.01 A
+  int32_t dividerMilli_ = 0;
+  int32_t zeroMv16_ = 0;      // current zero in 1/16 mV
+  int32_t mvPerAmp16_ = 0;
+  int32_t alpha256_ = 256;
+};
+
+} // namespace sensors
+} // namespace ta
@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <TA_LinkQuality.h>
+
+// Stamp the button -> relay path and print per-hop latency (min/mean/p99/max)
+#ifndef TA_LATENCY_PROBES
+#define TA_LATENCY_PROBES 0
+#endif
+
+// Completed traces between reports
+#ifndef TA_LATENCY_REPORT_EVERY
+#define TA_LATENCY_REPORT_EVERY 10
+#endif
+
+namespace ta {
+namespace probe {
+
+// ---------------------------------------------------------------------------
+// Latency from a finger on a button to the board's compressor relay closing,
+// stamped in microseconds at each hop on the way:
+//
+//   Edge      remote: first input-register sample showing the press
+//   Dispatch  remote: debounced Pressed handed to subscribers
+//   Send      remote: manual command queued to the radio
+//   Recv      board:  command out of the radio callback
+//   Actuate   board:  compressor relay driven on
+//
+// Each stamp closes the segment from the hop before it in the same trace.
+// Edge starts a trace; Recv starts one too unless the open trace is waiting for it
+// (host runs with both links on one clock), so on hardware the remote records
+// Edge..Send and the board Recv..Actuate. Out-of-order stamps and repeats of a hop
+// already stamped (the remote's manual resends, relay already on) are ignored.
+// Only a trace that runs Edge..Actuate on one clock gives an end-to-end sample.
+//
+// Loop-side only: a hop seen in an interrupt or radio callback is timed there and
+// stamped from the loop with that time.
+// ---------------------------------------------------------------------------
+enum class Hop : uint8_t { Edge, Dispatch, Send, Recv, Actuate };
+static constexpr int kHops = 5;
+
+inline const char* hopName(Hop h) {
+  switch (h) {
+    case Hop::Edge:     return "edge";
+    case Hop::Dispatch: return "dispatch";
+    case Hop::Send:     return "send";
+    case Hop::Recv:     return "recv";
+    case Hop::Actuate:  return "actuate";
+  }
+  return "?";
+}
+
+class Probes {
+public:
+  void mark(Hop h, uint32_t us) {
+    int i = (int)h;
+    bool fresh = h == Hop::Edge || (h == Hop::Recv && !(open_ && last_ == (int)Hop::Send));
+    if (fresh) {
+      open_ = true;
+      origin_ = last_ = i;
+      at_[i] = us;
+      return;
+    }
+    if (!open_ || i != last_ + 1) return;
+    at_[i] = us;
+    segment_[i].add(us - at_[last_]);
+    last_ = i;
+    if (h == Hop::Actuate) {
+      if (origin_ == (int)Hop::Edge) endToEnd_.add(us - at_[origin_]);
+      open_ = false;
+    }
+  }
+
+  // From the hop before h (nothing for Edge)
+  const ta::link::LatencyStats& segment(Hop h) const { return segment_[(int)h]; }
+  const ta::link::LatencyStats& endToEnd() const { return endToEnd_; }
+  // Stamp of h in the latest trace that reached it
+  uint32_t at(Hop h) const { return at_[(int)h]; }
+
+  void reset() { *this = Probes(); }
+
+private:
+  bool open_ = false;
+  int origin_ = 0;
+  int last_ = 0;
+  uint32_t at_[kHops] = {};
+  ta::link::LatencyStats segment_[kHops];
+  ta::link::LatencyStats endToEnd_;
+};
+
+// The device's probes (one per firmware image)
+inline Probes& probes() {
+  static Probes p;
+  return p;
+}
+
+// One console line per segment with samples, then end-to-end if there is any:
+//   "<tag> edge->dispatch us: n 12 min 20110 mean 20480 p99 21503 max 21870"
+template <typename Out>
+void report(Out& out, const Probes& p, const char* tag) {
+  char line[112];
+  auto print = [&](const char* from, const char* to, const ta::link::LatencyStats& s) {
+    snprintf(line, sizeof(line), "%s %s->%s us: n %u min %u mean %u p99 %u max %u", tag, from, to,
+             (unsigned)s.count, (unsigned)s.minUs, (unsigned)s.meanUs(), (unsigned)s.p99Us(), (unsigned)s.maxUs);
+    out.println(line);
+  };
+  for (int i = 1; i < kHops; ++i) {
+    if (p.segment((Hop)i).count) print(hopName((Hop)(i - 1)), hopName((Hop)i), p.segment((Hop)i));
+  }
+  if (p.endToEnd().count) print(hopName(Hop::Edge), hopName(Hop::Actuate), p.endToEnd());
+}
+
+} // namespace probe
+} // namespace ta
@@ -5,9 +5,31 @@
 namespace ta {
     namespace protocol {
 
-        // Two-byte payload size (all messages are 2 bytes)
+        // Two-byte payload size (all v1 messages are 2 bytes)
         static constexpr int kPayloadLen = 2;
 
+        // Wire format versions. v1 is the 2-byte frame set below (pressure in 0.5 PSI,
+        // 0..127.5). v2 adds 4-byte pressure frames [op, kProtoV2, psi hi, psi lo] with
+        // pressure in 0.01 PSI (0..655.35) for Status (non-error) and Start; every other
+        // frame stays v1. Each side learns a peer's version from its Hello and only
+        // sends v2 frames to peers that announced it. Parsers accept both.
+        // v2 also has a 4-byte Error frame [E, kProtoV2, code, detail] for codes that carry
+        // a value (LEAK: loss rate); errors without one stay 2 bytes.
+        // The extended v2 Status frame [op, kProtoV2, psi hi, psi lo, target hi, target lo]
+        // adds the board's effective seek target (temperature-compensated) in 0.01 PSI;
+        // it is sent only when that differs from what was asked for.
+        // v2 manual control is a lease instead of a resend stream: [M, kProtoV2, code, seq,
+        // ms hi, ms lo] runs the output for that many ms unless renewed, ms = 0 stops it, and
+        // the board acknowledges each one with a Lease link frame [L, seq].
+        static constexpr uint8_t kProtoUnknown = 0;
+        static constexpr uint8_t kProtoV1 = 1;
+        static constexpr uint8_t kProtoV2 = 2;
+        static constexpr uint8_t kProtoVersion = kProtoV2; // what this firmware speaks
+        static constexpr int kWidePayloadLen = 4;
+        static constexpr int kExtStatusLen = 6;
+        static constexpr int kLeaseLen = 6;
+        static constexpr int kMaxPayloadLen = kExtStatusLen;
+
         // Status codes sent from Control Board -> Remote (first byte)
         enum class Status : uint8_t {
             Idle     = 'I',
@@ -30,33 +52,170 @@ namespace ta {
             Req  = 'R',  // Remote -> broadcast
             Ack  = 'A',  // Board  -> Remote (unicast)
             // Cfm  = 'C',  // Remote -> Board (optional)
-            Busy = 'B'   // Board  -> Remote (board already paired)
+            Busy = 'B',  // Board  -> Remote (board already paired)
+            Key  = 'K'   // Board  -> broadcast: key-derivation nonce for one remote (kPairKeyLen bytes)
+        };
+
+        // Link-maintenance opcodes (distinct from Status/Cmd/Pair letters)
+        enum class LinkOp : uint8_t {
+            Pong = 'O',  // Board  -> Remote: echo of a Ping's sequence byte (RTT / loss sampling)
+            Chan = 'H',  // Board  -> Remote: operating channel (pairing advert / retune)
+                         // Remote -> Board : value 0 = request a retune, else join that
+                         //                   channel (multi-board remotes keep boards together)
+            Hello = 'N', // Either way: highest protocol version the sender speaks
+            Lease = 'L'  // Board  -> Remote: manual lease frame with this sequence received
         };
 
+        static constexpr uint8_t kChanRetuneRequest = 0;
+
         // Manual codes
         enum class ManualCode : uint8_t { Vent = 0x00, Air = 0xFF };
 
-        // 0.5 PSI resolution helpers
-        inline uint8_t psiToByte05(float psi) {
-            if (psi < 0) psi = 0;
-            if (psi > 127.5f) psi = 127.5f;
-            return static_cast<uint8_t>(lroundf(psi * 2.0f));
+        // ---------------------------------------------------------------------------
+        // Opcode table. Every frame is classified by its first byte with one lookup,
+        // per receiving side: the same letter may mean different things in each
+        // direction ('I' is Status::Idle to a remote and Cmd::Idle to a board), but
+        // never two things to the same receiver. New opcodes go in kOpDefs; the
+        // static_assert below rejects any clash at compile time.
+        // ---------------------------------------------------------------------------
+        enum class FrameClass : uint8_t { None, Status, Cmd, Pair, Link };
+
+        // Receiving side, also the index into OpEntry
+        enum class Dir : uint8_t { ToBoard = 0, ToRemote = 1 };
+        static constexpr uint8_t kDirToBoard = 1u << 0;
+        static constexpr uint8_t kDirToRemote = 1u << 1;
+        static constexpr uint8_t kDirBoth = kDirToBoard | kDirToRemote;
+
+        // Allowed frame lengths as a bit set: bit n accepts length 2n (all frames are even, < 16)
+        constexpr uint8_t lenBit(int len) { return (uint8_t)(1u << (len >> 1)); }
+        static constexpr uint8_t kLen2 = 1u << 1;
+        static constexpr uint8_t kLen2or4 = (1u << 1) | (1u << 2);
+        static constexpr uint8_t kLen2to6 = (1u << 1) | (1u << 2) | (1u << 3);
+        static constexpr uint8_t kLen2or6 = (1u << 1) | (1u << 3);
+        static constexpr uint8_t kLen12 = 1u << 6;
+
+        struct OpDef {
+            uint8_t op;
+            FrameClass cls;
+            uint8_t dirs;   // kDirToBoard / kDirToRemote
+            uint8_t lens;   // lenBit() set
+        };
+
+        static constexpr OpDef kOpDefs[] = {
+            { (uint8_t)Status::Idle,     FrameClass::Status, kDirToRemote, kLen2to6 },
+            { (uint8_t)Status::AirUp,    FrameClass::Status, kDirToRemote, kLen2to6 },
+            { (uint8_t)Status::Venting,  FrameClass::Status, kDirToRemote, kLen2to6 },
+            { (uint8_t)Status::Checking, FrameClass::Status, kDirToRemote, kLen2to6 },
+            { (uint8_t)Status::Error,    FrameClass::Status, kDirToRemote, kLen2or4 },
+            { (uint8_t)Cmd::Start,       FrameClass::Cmd,    kDirToBoard,  kLen2or4 },
+            { (uint8_t)Cmd::Idle,        FrameClass::Cmd,    kDirToBoard,  kLen2 },
+            { (uint8_t)Cmd::Manual,      FrameClass::Cmd,    kDirToBoard,  kLen2or6 },
+            { (uint8_t)Cmd::Ping,        FrameClass::Cmd,    kDirToBoard,  kLen2 },
+            // Pairing is broadcast, so both kinds of device hear every pairing opcode
+            { (uint8_t)PairOp::Req,      FrameClass::Pair,   kDirBoth,     kLen2 },
+            { (uint8_t)PairOp::Ack,      FrameClass::Pair,   kDirBoth,     kLen2 },
+            { (uint8_t)PairOp::Busy,     FrameClass::Pair,   kDirBoth,     kLen2 },
+            { (uint8_t)PairOp::Key,      FrameClass::Pair,   kDirBoth,     kLen12 },
+            { (uint8_t)LinkOp::Pong,     FrameClass::Link,   kDirToRemote, kLen2 },
+            { (uint8_t)LinkOp::Chan,     FrameClass::Link,   kDirBoth,     kLen2 },
+            { (uint8_t)LinkOp::Hello,    FrameClass::Link,   kDirBoth,     kLen2 },
+            { (uint8_t)LinkOp::Lease,    FrameClass::Link,   kDirToRemote, kLen2 },
+        };
+        static constexpr int kOpDefCount = sizeof(kOpDefs) / sizeof(kOpDefs[0]);
+
+        constexpr bool opsDisjoint() {
+            for (int i = 0; i < kOpDefCount; ++i) {
+                for (int j = i + 1; j < kOpDefCount; ++j) {
+                    if (kOpDefs[i].op == kOpDefs[j].op && (kOpDefs[i].dirs & kOpDefs[j].dirs)) return false;
+                }
+            }
+            return true;
+        }
+        static_assert(opsDisjoint(), "two opcodes share a first byte for the same receiver");
+
+        struct OpEntry {
+            FrameClass cls[2] = { FrameClass::None, FrameClass::None }; // indexed by Dir
+            uint8_t lens[2] = { 0, 0 };
+        };
+        struct OpTable { OpEntry op[256]; };
+
+        constexpr OpTable buildOpTable() {
+            OpTable t{};
+            for (int i = 0; i < kOpDefCount; ++i) {
+                for (int d = 0; d < 2; ++d) {
+                    if (!(kOpDefs[i].dirs & (1u << d))) continue;
+                    t.op[kOpDefs[i].op].cls[d] = kOpDefs[i].cls;
+                    t.op[kOpDefs[i].op].lens[d] = kOpDefs[i].lens;
+                }
+            }
+            return t;
+        }
+        static constexpr OpTable kOpTable = buildOpTable();
+
+        static_assert(kOpTable.op['I'].cls[(int)Dir::ToRemote] == FrameClass::Status &&
+                      kOpTable.op['I'].cls[(int)Dir::ToBoard] == FrameClass::Cmd, "'I' is per direction");
+        static_assert(kOpTable.op[0].cls[0] == FrameClass::None && kOpTable.op[0xFF].cls[1] == FrameClass::None,
+                      "unlisted bytes are not frames");
+
+        // Class of a received frame, None for an unknown opcode or a length it never has
+        inline FrameClass classify(const uint8_t* data, int len, Dir dir) {
+            if (len < 2 || len > 15 || (len & 1)) return FrameClass::None;
+            const OpEntry& e = kOpTable.op[data[0]];
+            return (e.lens[(int)dir] & lenBit(len)) ? e.cls[(int)dir] : FrameClass::None;
+        }
+
+        // 0.5 PSI resolution helpers (v1). NaN and negatives map to 0.
+        constexpr uint8_t psiToByte05(float psi) {
+            return !(psi > 0.0f) ? 0 : psi >= 127.5f ? 255 : static_cast<uint8_t>(psi * 2.0f + 0.5f);
+        }
+        constexpr float byteToPsi05(uint8_t b) { return static_cast<float>(b) * 0.5f; }
+
+        // 0.01 PSI resolution helpers (v2). NaN and negatives map to 0.
+        static constexpr float kMaxPsi01 = 655.35f;
+        constexpr uint16_t psiToU16_01(float psi) {
+            return !(psi > 0.0f) ? 0 : psi >= kMaxPsi01 ? 0xFFFF : static_cast<uint16_t>(psi * 100.0f + 0.5f);
         }
-        inline float byteToPsi05(uint8_t b) { return static_cast<float>(b) * 0.5f; }
+        constexpr float u16ToPsi01(uint16_t v) { return static_cast<float>(v) * 0.01f; }
+        // psiToByte05(u16ToPsi01(v)) in integers (the same for every v)
+        constexpr uint8_t centiToByte05(uint16_t v) { return v >= 12750 ? 255 : static_cast<uint8_t>((v + 25) / 50); }
 
         // Unified typed messages
         struct Request {
             enum class Kind { Idle, Start, Manual, Ping } kind = Kind::Idle;
             float targetPsi = 0.0f;     // used when kind==Start
             ManualCode manual = ManualCode::Vent; // used when kind==Manual
+            uint8_t seq = 0;            // used when kind==Ping (echoed back in Pong), or a leased Manual
+            bool leased = false;        // Manual as a v2 lease (else the v1 refresh-timeout stream)
+            uint16_t leaseMs = 0;       // leased Manual: run this long unless renewed; 0 = stop
         };
 
+        // A leased Manual that ends the lease
+        constexpr bool isManualStop(const Request& r) {
+            return r.kind == Request::Kind::Manual && r.leased && r.leaseMs == 0;
+        }
+
         struct Response {
             // Same payload as legacy status frames
             Status status = Status::Idle;
             uint8_t value = 0; // PSI in 0.5 units for non-Error, or error code if status==Error
+            uint16_t centiPsi = 0; // PSI in 0.01 units for non-Error (v1 frames fill it from value)
+            uint8_t detail = 0;    // Error only: code-specific value (v2; 0 from v1 frames)
+            uint16_t targetCentiPsi = 0; // non-Error: effective seek target, 0 = not reported
         };
 
+        inline Response makeStatus(Status s, float psi) {
+            Response r; r.status = s; r.value = psiToByte05(psi); r.centiPsi = psiToU16_01(psi); return r;
+        }
+        inline Response makeStatus(Status s, float psi, float targetPsi) {
+            Response r = makeStatus(s, psi); r.targetCentiPsi = psiToU16_01(targetPsi); return r;
+        }
+        inline Response makeError(uint8_t code, uint8_t detail = 0) {
+            Response r; r.status = Status::Error; r.value = code; r.detail = detail; return r;
+        }
+        constexpr float responsePsi(const Response& r) { return u16ToPsi01(r.centiPsi); }
+        constexpr bool hasTarget(const Response& r) { return r.status != Status::Error && r.targetCentiPsi != 0; }
+        constexpr float responseTargetPsi(const Response& r) { return u16ToPsi01(r.targetCentiPsi); }
+
         // Serialize outbound requests (always 2 bytes)
         inline void packRequest(uint8_t out[kPayloadLen], const Request& r) {
             switch (r.kind) {
@@ -67,33 +226,99 @@ namespace ta {
                 case Request::Kind::Manual:
                     out[0] = static_cast<uint8_t>(Cmd::Manual); out[1] = static_cast<uint8_t>(r.manual); break;
                 case Request::Kind::Ping:
-                    out[0] = static_cast<uint8_t>(Cmd::Ping); out[1] = 0; break;
+                    out[0] = static_cast<uint8_t>(Cmd::Ping); out[1] = r.seq; break;
             }
         }
         inline bool parseRequest(const uint8_t* data, int len, Request& out) {
-            if (len != kPayloadLen) return false;
+            if (len == kWidePayloadLen) {
+                // v2 Start; anything else wide is not a request
+                if (data[0] != static_cast<uint8_t>(Cmd::Start) || data[1] != kProtoV2) return false;
+                out.kind = Request::Kind::Start;
+                out.targetPsi = u16ToPsi01((uint16_t)((data[2] << 8) | data[3]));
+                return true;
+            }
+            if (classify(data, len, Dir::ToBoard) != FrameClass::Cmd) return false;
+            if (len == kLeaseLen) {
+                // v2 manual lease (the table only admits this length for Manual)
+                if (data[1] != kProtoV2 || (data[2] != (uint8_t)ManualCode::Vent && data[2] != (uint8_t)ManualCode::Air)) return false;
+                out.kind = Request::Kind::Manual;
+                out.manual = static_cast<ManualCode>(data[2]);
+                out.seq = data[3];
+                out.leased = true;
+                out.leaseMs = (uint16_t)((data[4] << 8) | data[5]);
+                return true;
+            }
+            out.leased = false;
+            out.leaseMs = 0;
             switch (static_cast<Cmd>(data[0])) {
                 case Cmd::Idle:   out.kind = Request::Kind::Idle;   out.targetPsi = 0; break;
                 case Cmd::Start:  out.kind = Request::Kind::Start;  out.targetPsi = byteToPsi05(data[1]); break;
-                case Cmd::Manual: out.kind = Request::Kind::Manual; out.manual = static_cast<ManualCode>(data[1]); break;
-                case Cmd::Ping:   out.kind = Request::Kind::Ping;   break;
-                default: return false;
+                case Cmd::Manual:
+                    // Only the two defined codes; anything else would be an out-of-range enum
+                    if (data[1] != (uint8_t)ManualCode::Vent && data[1] != (uint8_t)ManualCode::Air) return false;
+                    out.kind = Request::Kind::Manual; out.manual = static_cast<ManualCode>(data[1]); break;
+                case Cmd::Ping:   out.kind = Request::Kind::Ping;   out.seq = data[1]; break;
             }
             return true;
         }
 
+        // Versioned packers: write the frame for a peer speaking `version` and return its
+        // length (out must hold kMaxPayloadLen). Only Start carries pressure in a request;
+        // a leased Manual needs a v2 peer (a v1 peer gets the plain Manual frame).
+        inline int packRequest(uint8_t out[kMaxPayloadLen], const Request& r, uint8_t version) {
+            if (version >= kProtoV2 && r.kind == Request::Kind::Manual && r.leased) {
+                out[0] = static_cast<uint8_t>(Cmd::Manual); out[1] = kProtoV2;
+                out[2] = static_cast<uint8_t>(r.manual); out[3] = r.seq;
+                out[4] = (uint8_t)(r.leaseMs >> 8); out[5] = (uint8_t)r.leaseMs;
+                return kLeaseLen;
+            }
+            if (version < kProtoV2 || r.kind != Request::Kind::Start) { packRequest(out, r); return kPayloadLen; }
+            uint16_t v = psiToU16_01(r.targetPsi);
+            out[0] = static_cast<uint8_t>(Cmd::Start); out[1] = kProtoV2;
+            out[2] = (uint8_t)(v >> 8); out[3] = (uint8_t)v;
+            return kWidePayloadLen;
+        }
+
+        inline int packResponse(uint8_t out[kMaxPayloadLen], const Response& r, uint8_t version) {
+            out[0] = static_cast<uint8_t>(r.status);
+            if (version < kProtoV2 || (r.status == Status::Error && r.detail == 0)) { out[1] = r.value; return kPayloadLen; }
+            out[1] = kProtoV2;
+            if (r.status == Status::Error) { out[2] = r.value; out[3] = r.detail; return kWidePayloadLen; }
+            out[2] = (uint8_t)(r.centiPsi >> 8); out[3] = (uint8_t)r.centiPsi;
+            if (r.targetCentiPsi == 0) return kWidePayloadLen;
+            out[4] = (uint8_t)(r.targetCentiPsi >> 8); out[5] = (uint8_t)r.targetCentiPsi;
+            return kExtStatusLen;
+        }
+
         // Parse inbound responses
         inline bool parseResponse(const uint8_t* data, int len, Response& out) {
-            if (len != kPayloadLen) return false;
-            switch (data[0]) {
-                case 'I': out.status = Status::Idle; break;
-                case 'U': out.status = Status::AirUp; break;
-                case 'V': out.status = Status::Venting; break;
-                case 'C': out.status = Status::Checking; break;
-                case 'E': out.status = Status::Error; break;
-                default: return false;
+            if (classify(data, len, Dir::ToRemote) != FrameClass::Status) return false;
+            Status s = static_cast<Status>(data[0]); // the table only admits Status letters
+            out.targetCentiPsi = 0;
+            if (len == kExtStatusLen) {
+                // Extended status (never Error: the table rejects that length for it)
+                if (data[1] != kProtoV2) return false;
+                out.targetCentiPsi = (uint16_t)((data[4] << 8) | data[5]);
+                len = kWidePayloadLen;
             }
+            if (len == kWidePayloadLen) {
+                if (data[1] != kProtoV2) return false;
+                out.status = s;
+                if (s == Status::Error) {
+                    out.value = data[2];
+                    out.detail = data[3];
+                    out.centiPsi = 0;
+                    return true;
+                }
+                out.detail = 0;
+                out.centiPsi = (uint16_t)((data[2] << 8) | data[3]);
+                out.value = centiToByte05(out.centiPsi);
+                return true;
+            }
+            out.status = s;
             out.value = data[1];
+            out.centiPsi = s == Status::Error ? 0 : (uint16_t)(data[1] * 50u);
+            out.detail = 0;
             return true;
         }
 
@@ -109,29 +334,126 @@ namespace ta {
         inline void packPairBusy(uint8_t out[kPayloadLen], uint8_t reason = 1)            { out[0] = (uint8_t)PairOp::Busy; out[1] = reason;  }
 
         // Quick classifier: returns true if first byte is a pairing opcode
+        // (Req/Ack/Busy; the Key frame is longer and has its own parser)
         inline bool isPairingFrame(const uint8_t* data, int len) {
-            if (len != kPayloadLen) return false;
-            switch (data[0]) {
-                case 'R': // Req
-                case 'A': // Ack
-                case 'B': // Busy
-                    return true;
-                default:
-                    return false;
-            }
+            return len == kPayloadLen && classify(data, len, Dir::ToBoard) == FrameClass::Pair;
         }
 
         inline bool parsePair(const uint8_t* data, int len, PairMsg& out) {
-            if (len != kPayloadLen) return false;
-            switch (data[0]) {
-                case 'R': out.op = PairOp::Req;  break;
-                case 'A': out.op = PairOp::Ack;  break;
-                case 'B': out.op = PairOp::Busy; break;
-                default: return false;
-            }
+            if (!isPairingFrame(data, len)) return false;
+            out.op = static_cast<PairOp>(data[0]);
             out.value = data[1];
             return true;
         }
 
+        // Key frame: sent in the clear before the peer is registered as encrypted. Carries
+        // the nonce both sides feed into the LMK derivation and the MAC of the remote it
+        // is meant for (it goes out as a broadcast).
+        static constexpr int kPairKeyLen = 12;
+
+        struct PairKey {
+            uint8_t groupId = 0;
+            uint32_t nonce = 0;
+            uint8_t target[6] = {0};
+        };
+
+        inline void packPairKey(uint8_t out[kPairKeyLen], const PairKey& k) {
+            out[0] = (uint8_t)PairOp::Key;
+            out[1] = k.groupId;
+            out[2] = (uint8_t)(k.nonce >> 24);
+            out[3] = (uint8_t)(k.nonce >> 16);
+            out[4] = (uint8_t)(k.nonce >> 8);
+            out[5] = (uint8_t)k.nonce;
+            for (int i = 0; i < 6; ++i) out[6 + i] = k.target[i];
+        }
+
+        inline bool parsePairKey(const uint8_t* data, int len, PairKey& out) {
+            if (len != kPairKeyLen || data[0] != (uint8_t)PairOp::Key) return false;
+            out.groupId = data[1];
+            out.nonce = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) |
+                        ((uint32_t)data[4] << 8) | (uint32_t)data[5];
+            for (int i = 0; i < 6; ++i) out.target[i] = data[6 + i];
+            return true;
+        }
+
+        // Pong: board echoes the Ping sequence byte so the remote can time the round trip
+        inline void packPong(uint8_t out[kPayloadLen], uint8_t seq) { out[0] = (uint8_t)LinkOp::Pong; out[1] = seq; }
+
+        inline bool parsePong(const uint8_t* data, int len, uint8_t& seq) {
+            if (len != kPayloadLen || data[0] != (uint8_t)LinkOp::Pong) return false;
+            seq = data[1];
+            return true;
+        }
+
+        // Hello: version negotiation. The board sends one to a remote it hasn't heard a
+        // version from (again every few seconds until it does); the remote answers with
+        // its own. A peer's version is the lower of the two. Old firmware ignores the
+        // opcode and stays v1.
+        inline void packHello(uint8_t out[kPayloadLen], uint8_t version = kProtoVersion) { out[0] = (uint8_t)LinkOp::Hello; out[1] = version; }
+
+        inline bool parseHello(const uint8_t* data, int len, uint8_t& version) {
+            if (len != kPayloadLen || data[0] != (uint8_t)LinkOp::Hello || data[1] == kProtoUnknown) return false;
+            version = data[1];
+            return true;
+        }
+
+        // Lease ack: board confirms a manual lease frame (grant or stop) by its sequence
+        inline void packLeaseAck(uint8_t out[kPayloadLen], uint8_t seq) { out[0] = (uint8_t)LinkOp::Lease; out[1] = seq; }
+
+        inline bool parseLeaseAck(const uint8_t* data, int len, uint8_t& seq) {
+            if (len != kPayloadLen || data[0] != (uint8_t)LinkOp::Lease) return false;
+            seq = data[1];
+            return true;
+        }
+
+        constexpr uint8_t negotiate(uint8_t theirs, uint8_t ours = kProtoVersion) { return theirs < ours ? theirs : ours; }
+
+        // Channel frame: value is a 2.4 GHz channel (1..13), or kChanRetuneRequest
+        inline void packChan(uint8_t out[kPayloadLen], uint8_t channel) { out[0] = (uint8_t)LinkOp::Chan; out[1] = channel; }
+
+        inline bool parseChan(const uint8_t* data, int len, uint8_t& channel) {
+            if (len != kPayloadLen || data[0] != (uint8_t)LinkOp::Chan) return false;
+            if (data[1] > 13) return false;
+            channel = data[1];
+            return true;
+        }
+
+        // ---------------------------------------------------------------------------
+        // One-call decode for receive callbacks: one table lookup picks the class, then
+        // that class's parser fills its member. Returns false for anything that isn't a
+        // valid frame for this receiver.
+        // ---------------------------------------------------------------------------
+        struct Frame {
+            FrameClass cls = FrameClass::None;
+            Request req;          // Cmd
+            Response resp;        // Status
+            PairMsg pair{};       // Pair, except Key
+            PairKey key;          // Pair with pair.op == PairOp::Key
+            LinkOp link = LinkOp::Pong; // Link
+            uint8_t linkValue = 0;      // Pong/Lease seq, channel or version
+        };
+
+        inline bool decodeFrame(const uint8_t* data, int len, Dir dir, Frame& out) {
+            out.cls = classify(data, len, dir);
+            switch (out.cls) {
+                case FrameClass::None:   return false;
+                case FrameClass::Status: return parseResponse(data, len, out.resp);
+                case FrameClass::Cmd:    return parseRequest(data, len, out.req);
+                case FrameClass::Pair:
+                    if (data[0] == (uint8_t)PairOp::Key) { out.pair.op = PairOp::Key; out.pair.value = data[1]; return parsePairKey(data, len, out.key); }
+                    return parsePair(data, len, out.pair);
+                case FrameClass::Link:
+                    out.link = static_cast<LinkOp>(data[0]);
+                    switch (out.link) {
+                        case LinkOp::Pong:  return parsePong(data, len, out.linkValue);
+                        case LinkOp::Chan:  return parseChan(data, len, out.linkValue);
+                        case LinkOp::Hello: return parseHello(data, len, out.linkValue);
+                        case LinkOp::Lease: return parseLeaseAck(data, len, out.linkValue);
+                    }
+                    return false;
+            }
+            return false;
+        }
+
     } // namespace protocol
 } // namespace ta
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace ta {
+namespace act {
+
+// ---------------------------------------------------------------------------
+// Relay timing, wear accounting and soft-start, kept free of Arduino so the board's
+// Actuators and native tests share it.
+//
+// A RelayGuard sits between what the controller asks for and the pin: a switch-on
+// is held until the output has been off minOffMs, a switch-off until it has been on
+// minOnMs. Forced offs (emergency stop) bypass the guard and are counted separately.
+// ---------------------------------------------------------------------------
+struct RelayConfig {
+  uint32_t minOnMs = 500;
+  uint32_t minOffMs = 500;
+  uint32_t ratedCycles = 100000UL;   // electrical life of a typical 30 A automotive relay
+  uint32_t cycleCostMs = 1000;       // fill time one relay cycle is worth when new
+  // PWM soft-start (MOSFET-driven compressors only; a relay can't be PWM'd)
+  bool softStart = false;
+  uint32_t rampMs = 400;
+  uint8_t startDuty = 80;            // of 255
+};
+
+class RelayGuard {
+public:
+  void begin(const RelayConfig& cfg) { cfg_ = cfg; want_ = on_ = false; started_ = false; }
+
+  void request(bool on) { want_ = on; }
+  bool wanted() const { return want_; }
+
+  // Apply the request if its minimum time allows. allowOn = false keeps the output off
+  // (interlock with another output). Returns true when the output changed.
+  bool service(uint32_t now, bool allowOn = true) {
+    if (!started_) { started_ = true; changedMs_ = now - cfg_.minOffMs; }
+    bool target = want_ && allowOn;
+    if (target == on_) { deferring_ = false; return false; }
+    uint32_t held = now - changedMs_;
+    if (held < (on_ ? cfg_.minOnMs : cfg_.minOffMs)) {
+      if (!deferring_) { deferring_ = true; deferred_++; }
+      return false;
+    }
+    set_(target, now);
+    return true;
+  }
+
+  // Immediate off regardless of minimum on time
+  bool forceOff(uint32_t now) {
+    want_ = false;
+    if (!on_) return false;
+    if (started_ && now - changedMs_ < cfg_.minOnMs) forced_++;
+    set_(false, now);
+    return true;
+  }
+
+  bool isOn() const { return on_; }
+  uint32_t onSinceMs(uint32_t now) const { return on_ ? now - changedMs_ : 0; }
+
+  // Counters
+  uint32_t cycles() const { return cycles_; }
+  void setCycles(uint32_t c) { cycles_ = c; }
+  uint32_t deferred() const { return deferred_; }   // switches held back by a minimum time
+  uint32_t forced() const { return forced_; }       // offs inside the minimum on time
+  uint32_t onMs() const { return onMs_; }           // total on time this boot
+  const RelayConfig& config() const { return cfg_; }
+
+private:
+  void set_(bool on, uint32_t now) {
+    if (on_) onMs_ += now - changedMs_;
+    if (on) cycles_++;
+    on_ = on;
+    changedMs_ = now;
+    deferring_ = false;
+  }
+
+  RelayConfig cfg_{};
+  bool want_ = false;
+  bool on_ = false;
+  bool started_ = false;
+  bool deferring_ = false;
+  uint32_t changedMs_ = 0;
+  uint32_t cycles_ = 0;
+  uint32_t deferred_ = 0;
+  uint32_t forced_ = 0;
+  uint32_t onMs_ = 0;
+};
+
+// Compressor and vent behind guards, never on together. set*() and stopAll() only
+// record requests; service() applies whatever the minimum times allow.
+class GuardedPair {
+public:
+  void begin(const RelayConfig& compressor, const RelayConfig& vent) {
+    comp_.begin(compressor);
+    vent_.begin(vent);
+  }
+
+  void setCompressor(bool on) { if (on) vent_.request(false); comp_.request(on); }
+  void setVent(bool open) { if (open) comp_.request(false); vent_.request(open); }
+  void stopAll() { comp_.request(false); vent_.request(false); }
+  void emergencyStop(uint32_t now) { comp_.forceOff(now); vent_.forceOff(now); }
+
+  void service(uint32_t now) {
+    // Releases first, so an output waiting on the interlock can follow in the same pass
+    comp_.service(now, !vent_.isOn() && !vent_.wanted());
+    vent_.service(now, !comp_.isOn());
+    comp_.service(now, !vent_.isOn());
+  }
+
+  RelayGuard& compressor() { return comp_; }
+  RelayGuard& vent() { return vent_; }
+  const RelayGuard& compressor() const { return comp_; }
+  const RelayGuard& vent() const { return vent_; }
+
+private:
+  RelayGuard comp_{};
+  RelayGuard vent_{};
+};
+
+// PWM duty (0..255) sinceOnMs into a soft start: linear from startDuty to full
+inline uint8_t softStartDuty(uint32_t sinceOnMs, const RelayConfig& cfg) {
+  if (!cfg.softStart || sinceOnMs >= cfg.rampMs || cfg.rampMs == 0) return 255;
+  return (uint8_t)(cfg.startDuty + (uint32_t)(255 - cfg.startDuty) * sinceOnMs / cfg.rampMs);
+}
+
+// Share of the rated life used so far
+inline float wearFraction(uint32_t cycles, const RelayConfig& cfg) {
+  return cfg.ratedCycles ? (float)cycles / cfg.ratedCycles : 0.0f;
+}
+
+// Fill time worth trading for one fewer relay cycle: the base cost, growing as the
+// relay wears (x4 at end of rated life)
+inline uint32_t cycleCostMs(uint32_t cycles, const RelayConfig& cfg) {
+  float w = wearFraction(cycles, cfg);
+  if (w > 1.0f) w = 1.0f;
+  return (uint32_t)(cfg.cycleCostMs * (1.0f + 3.0f * w));
+}
+
+// ---------------------------------------------------------------------------
+// NVS persistence of lifetime cycle counts. Templated on the store like
+// ta::pairkey's peer records. Counts are saved in batches (see kSaveEveryCycles)
+// since flash wears out faster than the relay would. They share the "trailair"
+// namespace with the peer records, under their own key.
+// ---------------------------------------------------------------------------
+static constexpr const char* kNvsNamespace = "trailair";
+static constexpr const char* kNvsCycles = "relay_cycles";
+static constexpr uint32_t kSaveEveryCycles = 32;
+
+struct CycleCounts {
+  uint32_t compressor = 0;
+  uint32_t vent = 0;
+};
+
+template <typename Prefs>
+bool loadCycles(Prefs& prefs, CycleCounts& out) {
+  if (!prefs.begin(kNvsNamespace, true)) return false;
+  uint8_t b[8];
+  bool ok = prefs.getBytesLength(kNvsCycles) == sizeof(b) && prefs.getBytes(kNvsCycles, b, sizeof(b)) == sizeof(b);
+  prefs.end();
+  if (!ok) return false;
+  out.compressor = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+  out.vent = (uint32_t)b[4] | (uint32_t)b[5] << 8 | (uint32_t)b[6] << 16 | (uint32_t)b[7] << 24;
+  return true;
+}
+
+template <typename Prefs>
+bool saveCycles(Prefs& prefs, const CycleCounts& c) {
+  uint8_t b[8];
+  for (int i = 0; i < 4; ++i) {
+    b[i] = (uint8_t)(c.compressor >> (8 * i));
+    b[4 + i] = (uint8_t)(c.vent >> (8 * i));
+  }
+  if (!prefs.begin(kNvsNamespace, false)) return false;
+  bool ok = prefs.putBytes(kNvsCycles, b, sizeof(b)) == sizeof(b);
+  prefs.end();
+  return ok;
+}
+
+} // namespace act
+} // namespace ta
@@ -0,0 +1,497 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+#include <TA_Protocol.h>
+#include <TA_Input.h>
+
+namespace ta {
+namespace replay {
+
+// ---------------------------------------------------------------------------
+// Session recording for replay on a workstation.
+//
+// The devices log what drives them: button events, parsed requests and responses,
+// the pressure the controller saw on every loop and the supply it planned with.
+// Replaying the stream into the same portable code (Controller, UiStateMachine,
+// BoardStatusSet) on a virtual clock reproduces its decisions exactly, as fast as
+// the host can run them.
+//
+// Records go into a byte ring that overwrites the oldest whole record, so a board
+// always holds its most recent stretch. Each record is one header byte
+// [kind:3 | dt:5] (dt = ms since the previous record, 31 = more follows as a varint)
+// and a kind-specific payload. A loop whose pressure didn't change is a lone Tick
+// header; a pressure change is a zigzag varint delta in centi-PSI, which is the
+// controller's resolution, so nothing is lost. Supply is logged when it changes, at
+// 0.01 V / 0.01 A; the board hands the controller the same rounded values.
+//
+// snapshot() linearises the ring behind a small header:
+//   ['T','A','R', version, startMs u32, startCentiPsi u16] records...   little-endian
+// ---------------------------------------------------------------------------
+enum class Kind : uint8_t { Button = 1, Request = 2, Response = 3, Pressure = 4, Tick = 5, Supply = 6 };
+
+static constexpr uint8_t kVersion = 1;
+static constexpr size_t kHeaderLen = 10;
+static constexpr size_t kMaxRecordLen = 16;
+static constexpr uint8_t kDtInlineMax = 30;
+
+struct Record {
+  Kind kind = Kind::Tick;
+  uint32_t ms = 0;
+  uint8_t slot = 0;                       // Request: sender; Response: board
+  ta::input::Event button{};
+  ta::protocol::Request request{};
+  ta::protocol::Response response{};
+  uint16_t centiPsi = 0;                  // Pressure and Tick: reading in effect
+  float volts = 0;                        // Supply
+  float amps = -1.0f;                     // Supply; negative = not measured
+  float psi() const { return centiPsi / 100.0f; }
+};
+
+// Supply values at the resolution they are logged with
+inline float centi(float v) { return roundf(v * 100.0f) / 100.0f; }
+
+// Varint and zigzag helpers; put returns bytes written
+inline size_t putVarint_(uint8_t* p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+inline uint32_t zigzag_(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag_(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Random-access bytes of a record stream, wrapping at cap (a ring or a flat buffer)
+struct ByteView {
+  const uint8_t* buf = nullptr;
+  size_t cap = 0;
+  size_t start = 0;
+  size_t len = 0;
+  uint8_t operator[](size_t i) const { return buf[(start + i) % cap]; }
+};
+
+// Decode the record at view offset `at` given the previous time and pressure. Returns
+// its length, 0 if truncated or unknown.
+inline size_t decodeRecord(const ByteView& v, size_t at, uint32_t prevMs, uint16_t prevCenti, Record& r) {
+  size_t n = at;
+  auto byte = [&](uint8_t& out) { if (n >= v.len) return false; out = v[n++]; return true; };
+  auto varint = [&](uint32_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t b;
+      if (!byte(b)) return false;
+      out |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return true;
+    }
+    return false;
+  };
+  auto u16 = [&](uint16_t& out) {
+    uint8_t lo, hi;
+    if (!byte(lo) || !byte(hi)) return false;
+    out = (uint16_t)(lo | hi << 8);
+    return true;
+  };
+
+  uint8_t h;
+  if (!byte(h)) return 0;
+  uint32_t dt = h & 0x1F;
+  if (dt > kDtInlineMax) {
+    uint32_t more;
+    if (!varint(more)) return 0;
+    dt += more;
+  }
+  r = Record();
+  r.kind = (Kind)(h >> 5);
+  r.ms = prevMs + dt;
+  r.centiPsi = prevCenti;
+
+  switch (r.kind) {
+    case Kind::Tick:
+      break;
+    case Kind::Pressure: {
+      uint32_t z;
+      if (!varint(z)) return 0;
+      r.centiPsi = (uint16_t)(prevCenti + unzigzag_(z));
+      break;
+    }
+    case Kind::Button: {
+      uint8_t ia, clicks;
+      uint32_t held;
+      if (!byte(ia) || !byte(clicks) || !varint(held)) return 0;
+      r.button.id = (ta::input::ButtonId)(ia >> 4);
+      r.button.action = (ta::input::Action)(ia & 0x0F);
+      r.button.clicks = clicks;
+      r.button.heldMs = held;
+      break;
+    }
+    case Kind::Request: {
+      uint8_t km;
+      if (!byte(r.slot) || !byte(km)) return 0;
+      using RK = ta::protocol::Request::Kind;
+      r.request.kind = (RK)(km >> 4);
+      r.request.manual = (km & 1) ? ta::protocol::ManualCode::Air : ta::protocol::ManualCode::Vent;
+      r.request.leased = (km & 2) != 0;
+      if (r.request.leased) {
+        if (!byte(r.request.seq) || !u16(r.request.leaseMs)) return 0;
+      } else if (r.request.kind == RK::Start) {
+        uint16_t c;
+        if (!u16(c)) return 0;
+        r.request.targetPsi = ta::protocol::u16ToPsi01(c);
+      } else if (r.request.kind == RK::Ping) {
+        if (!byte(r.request.seq)) return 0;
+      }
+      break;
+    }
+    case Kind::Supply: {
+      uint16_t cv, ca;
+      if (!u16(cv) || !u16(ca)) return 0;
+      r.volts = cv / 100.0f;
+      r.amps = (int16_t)ca / 100.0f;
+      break;
+    }
+    case Kind::Response: {
+      uint8_t st;
+      if (!byte(r.slot) || !byte(st)) return 0;
+      r.response.status = (ta::protocol::Status)st;
+      if (r.response.status == ta::protocol::Status::Error) {
+        if (!byte(r.response.value) || !byte(r.response.detail)) return 0;
+      } else {
+        if (!byte(r.response.value) || !u16(r.response.centiPsi) || !u16(r.response.targetCentiPsi)) return 0;
+      }
+      break;
+    }
+    default:
+      return 0;
+  }
+  return n - at;
+}
+
+class Recorder {
+public:
+  // The ring lives in caller storage; anything under a few records long is refused
+  void begin(uint8_t* buf, size_t len) {
+    buf_ = len >= 4 * kMaxRecordLen ? buf : nullptr;
+    cap_ = buf_ ? len : 0;
+    clear();
+  }
+  void clear() {
+    head_ = used_ = 0;
+    started_ = false;
+    haveSupply_ = false;
+    lastCenti_ = 0;
+    dropped_ = 0;
+    held_ = false;
+  }
+  bool enabled() const { return buf_ != nullptr; }
+
+  // Held: nothing is recorded, so a snapshot can be streamed out over several loops
+  // (see HexDump). What happens meanwhile is missing from the recording.
+  void hold(bool h) { held_ = h; }
+  bool held() const { return held_; }
+
+  void button(uint32_t now, const ta::input::Event& e) {
+    uint8_t p[kMaxRecordLen];
+    size_t n = 0;
+    p[n++] = (uint8_t)((uint8_t)e.id << 4 | ((uint8_t)e.action & 0x0F));
+    p[n++] = (uint8_t)(e.clicks < 0 ? 0 : e.clicks > 255 ? 255 : e.clicks);
+    n += putVarint_(p + n, e.heldMs);
+    append_(Kind::Button, now, p, n);
+  }
+
+  void request(uint32_t now, uint8_t slot, const ta::protocol::Request& req) {
+    using RK = ta::protocol::Request::Kind;
+    uint8_t p[kMaxRecordLen];
+    size_t n = 0;
+    p[n++] = slot;
+    bool leased = req.kind == RK::Manual && req.leased;
+    p[n++] = (uint8_t)((uint8_t)req.kind << 4 | (leased ? 2 : 0) | (req.manual == ta::protocol::ManualCode::Air ? 1 : 0));
+    if (leased) {
+      p[n++] = req.seq;
+      p[n++] = (uint8_t)req.leaseMs;
+      p[n++] = (uint8_t)(req.leaseMs >> 8);
+    } else if (req.kind == RK::Start) {
+      uint16_t c = ta::protocol::psiToU16_01(req.targetPsi);
+      p[n++] = (uint8_t)c;
+      p[n++] = (uint8_t)(c >> 8);
+    } else if (req.kind == RK::Ping) {
+      p[n++] = req.seq;
+    }
+    append_(Kind::Request, now, p, n);
+  }
+
+  void response(uint32_t now, uint8_t board, const ta::protocol::Response& r) {
+    uint8_t p[kMaxRecordLen];
+    size_t n = 0;
+    p[n++] = board;
+    p[n++] = (uint8_t)r.status;
+    p[n++] = r.value;
+    if (r.status == ta::protocol::Status::Error) {
+      p[n++] = r.detail;
+    } else {
+      p[n++] = (uint8_t)r.centiPsi;
+      p[n++] = (uint8_t)(r.centiPsi >> 8);
+      p[n++] = (uint8_t)r.targetCentiPsi;
+      p[n++] = (uint8_t)(r.targetCentiPsi >> 8);
+    }
+    append_(Kind::Response, now, p, n);
+  }
+
+  // The reading the controller is updated with this loop
+  void pressure(uint32_t now, float psi) { pressureCenti(now, ta::protocol::psiToU16_01(psi)); }
+  void pressureCenti(uint32_t now, uint16_t c) {
+    if (held_) return;
+    if (started_ && c == lastCenti_) {
+      append_(Kind::Tick, now, nullptr, 0);
+      return;
+    }
+    uint8_t p[kMaxRecordLen];
+    size_t n = putVarint_(p, zigzag_((int32_t)c - (int32_t)lastCenti_));
+    append_(Kind::Pressure, now, p, n);
+    lastCenti_ = c;
+  }
+
+  // Supply handed to the controller this loop (see centi()); logged only on change
+  void supply(uint32_t now, float volts, float amps) {
+    float a = amps < 0 ? -1.0f : amps > 327.0f ? 327.0f : amps;
+    supplyCenti(now, (uint16_t)(volts <= 0 ? 0 : volts >= 655.0f ? 65500 : lroundf(volts * 100.0f)),
+                (int16_t)lroundf(a * 100.0f));
+  }
+  void supplyCenti(uint32_t now, uint16_t cv, int16_t centiAmps) {
+    if (held_) return;
+    uint16_t ca = (uint16_t)(centiAmps < 0 ? -100 : centiAmps);
+    if (haveSupply_ && cv == lastVolts_ && ca == lastAmps_) return;
+    uint8_t p[4] = { (uint8_t)cv, (uint8_t)(cv >> 8), (uint8_t)ca, (uint8_t)(ca >> 8) };
+    append_(Kind::Supply, now, p, 4);
+    haveSupply_ = true;
+    lastVolts_ = cv;
+    lastAmps_ = ca;
+  }
+
+  size_t used() const { return used_; }
+  size_t capacity() const { return cap_; }
+  uint32_t dropped() const { return dropped_; }     // records overwritten so far
+  size_t snapshotSize() const { return kHeaderLen + used_; }
+
+  // Flat copy of the ring (see the format above); 0 if out is too small
+  size_t snapshot(uint8_t* out, size_t max) const {
+    if (max < snapshotSize()) return 0;
+    return readSnapshot(0, out, max);
+  }
+
+  // Part of the snapshot from `offset`, for streaming it out without a second buffer
+  size_t readSnapshot(size_t offset, uint8_t* out, size_t max) const {
+    uint8_t h[kHeaderLen] = { 'T', 'A', 'R', kVersion,
+                              (uint8_t)startMs_, (uint8_t)(startMs_ >> 8),
+                              (uint8_t)(startMs_ >> 16), (uint8_t)(startMs_ >> 24),
+                              (uint8_t)startCenti_, (uint8_t)(startCenti_ >> 8) };
+    ByteView v = view_();
+    size_t n = 0;
+    for (size_t i = offset; i < snapshotSize() && n < max; ++i, ++n) {
+      out[n] = i < kHeaderLen ? h[i] : v[i - kHeaderLen];
+    }
+    return n;
+  }
+
+private:
+  ByteView view_() const {
+    ByteView v;
+    v.buf = buf_;
+    v.cap = cap_;
+    v.start = head_;
+    v.len = used_;
+    return v;
+  }
+
+  void append_(Kind k, uint32_t now, const uint8_t* payload, size_t n) {
+    if (!buf_ || held_) return;
+    if (!started_) {
+      started_ = true;
+      startMs_ = lastMs_ = now;
+      startCenti_ = 0;
+    }
+    uint8_t rec[kMaxRecordLen + 6];
+    uint32_t dt = now - lastMs_;
+    size_t len = 1;
+    if (dt <= kDtInlineMax) {
+      rec[0] = (uint8_t)((uint8_t)k << 5 | dt);
+    } else {
+      rec[0] = (uint8_t)((uint8_t)k << 5 | (kDtInlineMax + 1));
+      len += putVarint_(rec + 1, dt - (kDtInlineMax + 1));
+    }
+    for (size_t i = 0; i < n; ++i) rec[len++] = payload[i];
+    lastMs_ = now;
+
+    // Make room by retiring whole records from the front; the header keeps the time
+    // and pressure the new front record is relative to
+    while (cap_ - used_ < len && used_ > 0) {
+      Record r;
+      size_t rl = decodeRecord(view_(), 0, startMs_, startCenti_, r);
+      if (rl == 0) { used_ = 0; break; }
+      startMs_ = r.ms;
+      startCenti_ = r.centiPsi;
+      head_ = (head_ + rl) % cap_;
+      used_ -= rl;
+      dropped_++;
+    }
+    size_t tail = (head_ + used_) % cap_;
+    for (size_t i = 0; i < len; ++i) buf_[(tail + i) % cap_] = rec[i];
+    used_ += len;
+  }
+
+  uint8_t* buf_ = nullptr;
+  size_t cap_ = 0;
+  size_t head_ = 0;
+  size_t used_ = 0;
+  bool started_ = false;
+  uint32_t startMs_ = 0;
+  uint16_t startCenti_ = 0;
+  uint32_t lastMs_ = 0;
+  uint16_t lastCenti_ = 0;
+  bool haveSupply_ = false;
+  uint16_t lastVolts_ = 0;
+  uint16_t lastAmps_ = 0;
+  uint32_t dropped_ = 0;
+  bool held_ = false;
+};
+
+// Walks a snapshot
+class Reader {
+public:
+  bool begin(const uint8_t* data, size_t len) {
+    ok_ = len >= kHeaderLen && data[0] == 'T' && data[1] == 'A' && data[2] == 'R' && data[3] == kVersion;
+    if (!ok_) return false;
+    v_.buf = data + kHeaderLen;
+    v_.cap = v_.len = len - kHeaderLen;
+    v_.start = 0;
+    if (v_.cap == 0) v_.cap = 1;
+    at_ = 0;
+    ms_ = (uint32_t)data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+    centi_ = (uint16_t)(data[8] | data[9] << 8);
+    return true;
+  }
+
+  // False at the end, or at a damaged record (ok() then turns false)
+  bool next(Record& r) {
+    if (!ok_ || at_ >= v_.len) return false;
+    size_t n = decodeRecord(v_, at_, ms_, centi_, r);
+    if (n == 0) { ok_ = false; return false; }
+    at_ += n;
+    ms_ = r.ms;
+    centi_ = r.centiPsi;
+    return true;
+  }
+
+  bool ok() const { return ok_; }
+
+private:
+  ByteView v_{};
+  size_t at_ = 0;
+  uint32_t ms_ = 0;
+  uint16_t centi_ = 0;
+  bool ok_ = false;
+};
+
+// Print a snapshot as hex lines "<tag> 0a1b..." closed by "<tag> end", to a console
+// (anything with print/println of a C string, e.g. Arduino's Serial). HexDump does it
+// a line per step() so a control loop can stream it without stalling; hold() the
+// recorder until it is done. dumpHex() is the whole thing at once.
+class HexDump {
+public:
+  void start(const char* tag) { tag_ = tag; off_ = 0; active_ = true; }
+  bool active() const { return active_; }
+
+  // One line; false once the closing line is out
+  template <typename Out>
+  bool step(Out& out, const Recorder& rec) {
+    if (!active_) return false;
+    if (off_ >= rec.snapshotSize()) {
+      out.print(tag_); out.println(" end");
+      active_ = false;
+      return false;
+    }
+    static const char kHex[] = "0123456789abcdef";
+    uint8_t chunk[32];
+    char line[2 * sizeof(chunk) + 1];
+    size_t n = rec.readSnapshot(off_, chunk, sizeof(chunk));
+    for (size_t i = 0; i < n; ++i) {
+      line[2 * i] = kHex[chunk[i] >> 4];
+      line[2 * i + 1] = kHex[chunk[i] & 0x0F];
+    }
+    line[2 * n] = 0;
+    out.print(tag_); out.print(" "); out.println(line);
+    off_ += n;
+    return true;
+  }
+
+private:
+  const char* tag_ = "";
+  size_t off_ = 0;
+  bool active_ = false;
+};
+
+template <typename Out>
+void dumpHex(Out& out, const Recorder& rec, const char* tag) {
+  HexDump d;
+  d.start(tag);
+  while (d.step(out, rec)) {}
+}
+
+// Recover a snapshot from a captured console log: the hex of every line starting
+// with "<tag> ", up to "<tag> end". Other lines are skipped. Returns the length.
+inline size_t parseHex(const char* text, const char* tag, uint8_t* out, size_t max) {
+  size_t tagLen = strlen(tag);
+  size_t n = 0;
+  auto nib = [](char c) { return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+                                 c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1; };
+  for (const char* line = text; line && *line;) {
+    const char* eol = strchr(line, '\n');
+    const char* end = eol ? eol : line + strlen(line);
+    if ((size_t)(end - line) > tagLen && !strncmp(line, tag, tagLen) && line[tagLen] == ' ') {
+      const char* p = line + tagLen + 1;
+      if (!strncmp(p, "end", 3)) break;
+      for (; p + 1 < end && n < max; p += 2) {
+        int hi = nib(p[0]), lo = nib(p[1]);
+        if (hi < 0 || lo < 0) break;
+        out[n++] = (uint8_t)(hi << 4 | lo);
+      }
+    }
+    line = eol ? eol + 1 : nullptr;
+  }
+  return n;
+}
+
+// What a replay drives. Pressure and Tick both arrive as onPressure: one per
+// recorded loop, with the reading the controller was updated with.
+struct Sink {
+  virtual ~Sink() = default;
+  virtual void onButton(uint32_t now, const ta::input::Event& e) { (void)now; (void)e; }
+  virtual void onRequest(uint32_t now, uint8_t slot, const ta::protocol::Request& req) { (void)now; (void)slot; (void)req; }
+  virtual void onResponse(uint32_t now, uint8_t board, const ta::protocol::Response& r) { (void)now; (void)board; (void)r; }
+  virtual void onPressure(uint32_t now, float psi) { (void)now; (void)psi; }
+  virtual void onSupply(uint32_t now, float volts, float amps) { (void)now; (void)volts; (void)amps; }
+};
+
+// Feed a snapshot to the sink in recorded order. Returns the records played, or -1
+// if the stream is not a snapshot or is damaged part way.
+inline long play(const uint8_t* data, size_t len, Sink& sink) {
+  Reader rd;
+  if (!rd.begin(data, len)) return -1;
+  Record r;
+  long count = 0;
+  while (rd.next(r)) {
+    switch (r.kind) {
+      case Kind::Button:   sink.onButton(r.ms, r.button); break;
+      case Kind::Request:  sink.onRequest(r.ms, r.slot, r.request); break;
+      case Kind::Response: sink.onResponse(r.ms, r.slot, r.response); break;
+      case Kind::Pressure:
+      case Kind::Tick:     sink.onPressure(r.ms, r.psi()); break;
+      case Kind::Supply:   sink.onSupply(r.ms, r.volts, r.amps); break;
+    }
+    count++;
+  }
+  return rd.ok() ? count : -1;
+}
+
+} // namespace replay
+} // namespace ta
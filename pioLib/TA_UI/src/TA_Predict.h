@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include "TA_UI.h"
+
+namespace ta { namespace ui {
+
+// ---------------------------------------------------------------------------
+// Optimistic controller state for a device that commands another over the link.
+//
+// The board reports its state about once a second, so a remote that only shows
+// what the board last said looks dead for up to a second after a press. Instead
+// the remote shows the state the command should produce straight away, and then
+// reconciles it against the board's reports:
+//
+//  - the predicted state is reported:      confirmed
+//  - another accepted state is reported:   corrected (e.g. a seek that vents when
+//                                          the remote guessed it would air up)
+//  - Error is reported:                    rolled back at once (unless clearing one)
+//  - anything else past timeoutMs:         rolled back to the board's report
+//
+// Until the timeout a disagreeing report is taken as sent before the command
+// arrived and ignored. Corrections and rollbacks count as mispredictions.
+// ---------------------------------------------------------------------------
+inline uint8_t ctrlBit(Ctrl c) { return (uint8_t)(1u << (uint8_t)c); }
+
+struct PredictStats {
+  uint32_t confirmed = 0;
+  uint32_t corrected = 0;
+  uint32_t rolledBack = 0;
+  uint32_t superseded = 0;  // replaced by another command before resolving; not scored
+
+  uint32_t resolved() const { return confirmed + corrected + rolledBack; }
+  uint32_t missed() const { return corrected + rolledBack; }
+  float missRate() const { return resolved() ? (float)missed() / resolved() : 0.0f; }
+};
+
+class CtrlPredictor {
+public:
+  void begin(uint32_t timeoutMs) { timeoutMs_ = timeoutMs; pending_ = false; stats_ = PredictStats{}; }
+
+  // A command expected to move the board to `expected` was just sent; `reported` is
+  // the board's last report. acceptMask (ctrlBit) lists other states that also show
+  // the command took. Returns the state to show.
+  Ctrl predict(uint32_t now, Ctrl reported, Ctrl expected, uint8_t acceptMask = 0) {
+    if (pending_) stats_.superseded++;
+    else prior_ = reported;
+    pending_ = true;
+    startMs_ = now;
+    expected_ = expected;
+    acceptMask_ = acceptMask;
+    return expected;
+  }
+
+  // Board's latest report -> state to show
+  Ctrl reconcile(uint32_t now, Ctrl reported) {
+    if (!pending_) return reported;
+    if (reported == expected_) {
+      stats_.confirmed++;
+    } else if (reported == Ctrl::Error && prior_ != Ctrl::Error) {
+      stats_.rolledBack++;
+    } else if ((acceptMask_ & ctrlBit(reported)) && reported != prior_) {
+      // The report from before the command can't confirm it
+      stats_.corrected++;
+    } else if ((uint32_t)(now - startMs_) >= timeoutMs_) {
+      stats_.rolledBack++;
+    } else {
+      return expected_;
+    }
+    pending_ = false;
+    return reported;
+  }
+
+  // Drop an open prediction without scoring it (link lost, board deselected)
+  void clear() { pending_ = false; }
+
+  bool pending() const { return pending_; }
+  Ctrl expected() const { return expected_; }
+  const PredictStats& stats() const { return stats_; }
+  void resetStats() { stats_ = PredictStats{}; }
+
+private:
+  uint32_t timeoutMs_ = 2500;
+  bool pending_ = false;
+  uint32_t startMs_ = 0;
+  Ctrl expected_ = Ctrl::Idle;
+  Ctrl prior_ = Ctrl::Idle;
+  uint8_t acceptMask_ = 0;
+  PredictStats stats_{};
+};
+
+}} // namespace ta::ui
@@ -1,4 +1,5 @@
 #include "TA_UI.h"
+#include <math.h>
 
 namespace ta { namespace ui {
 
@@ -42,6 +43,22 @@ void UiStateMachine::update(uint32_t now, DeviceActions& dev, Ctrl ctrlState) {
     }
   }
 
+  // Target stepped while seeking: send it once the buttons have been left alone, so a
+  // held Up/Down costs one retarget rather than one per repeat
+  if (view_ != View::Seeking) {
+    retargetDirty_ = retargetPending_ = false;
+  } else {
+    if (retargetDirty_) {
+      retargetDirty_ = false;
+      retargetPending_ = true;
+      retargetChangedMs_ = now;
+    }
+    if (retargetPending_ && now - retargetChangedMs_ >= cfg_.retargetDebounceMs) {
+      retargetPending_ = false;
+      dev.retarget(targetPsi_);
+    }
+  }
+
   if (view_ == View::Error && ctrlState != Ctrl::Error) {
     view_ = View::Idle;
   }
@@ -52,71 +69,70 @@ void UiStateMachine::update(uint32_t now, DeviceActions& dev, Ctrl ctrlState) {
 }
 
 void UiStateMachine::onButton(const ButtonEvent& e, DeviceActions& dev) {
-  switch (view_) {
-    case View::Idle: {
-      if (e.action == Action::Click) {
-        if (e.id == Button::Left) {
-          view_ = View::Manual;
-          manualVentActive_ = false;
-          manualAirActive_ = false;
-          dev.cancel();
-        } else if (e.id == Button::Right) {
-          dev.startSeek(targetPsi_);
-          view_ = View::Seeking;
-          seenSeekingActivity_ = false;
-          showDoneHold_ = false;
-        } else if (e.id == Button::Up) {
-          targetPsi_ += cfg_.stepSmall; clampTarget_();
-        } else if (e.id == Button::Down) {
-          targetPsi_ -= cfg_.stepSmall; clampTarget_();
-        }
-      }
-      break;
-    }
+  const UiCell& c = kUiTable.cell[(int)view_][uiEventIndex(e.id, e.action)];
+  apply_(c.op, e, dev);
+  view_ = c.next;
+}
 
-    case View::Manual: {
-      if (e.action == Action::Click && e.id == Button::Left) {
-        if (manualVentActive_) dev.manualVent(false);
-        if (manualAirActive_) dev.manualAirUp(false);
-        manualVentActive_ = manualAirActive_ = false;
-        view_ = View::Idle;
-        break;
-      }
-      if (e.action == Action::Pressed) {
-        if (e.id == Button::Down && !manualVentActive_) { dev.manualVent(true); manualVentActive_ = true; }
-        if (e.id == Button::Up   && !manualAirActive_)  { dev.manualAirUp(true); manualAirActive_ = true; }
-      } else if (e.action == Action::Released) {
-        if (e.id == Button::Down && manualVentActive_) { dev.manualVent(false); manualVentActive_ = false; }
-        if (e.id == Button::Up   && manualAirActive_)  { dev.manualAirUp(false); manualAirActive_ = false; }
-      }
+void UiStateMachine::apply_(UiOp op, const ButtonEvent& e, DeviceActions& dev) {
+  switch (op) {
+    case UiOp::None:
+    case UiOp::Count:
       break;
-    }
-
-    case View::Seeking: {
-      if (e.action == Action::Click && e.id == Button::Right) {
-        dev.cancel();
-        view_ = View::Idle; // base state; done-hold is independent flag
-        showDoneHold_ = false;
-      }
+    case UiOp::EnterManual:
+      manualVentActive_ = false;
+      manualAirActive_ = false;
+      dev.cancel();
       break;
-    }
-
-    case View::Error: {
-      if (e.action == Action::Click && e.id == Button::Right) {
-        dev.clearError();
-      }
+    case UiOp::ExitManual:
+      if (manualVentActive_) dev.manualVent(false);
+      if (manualAirActive_) dev.manualAirUp(false);
+      manualVentActive_ = manualAirActive_ = false;
       break;
-    }
-
-    case View::Disconnected: {
-      // shared layer doesn't do pairing; device may map buttons separately
+    case UiOp::StartSeek:
+      dev.startSeek(targetPsi_);
+      seenSeekingActivity_ = false;
+      showDoneHold_ = false;
+      retargetDirty_ = retargetPending_ = false;
       break;
-    }
-
-    case View::Pairing: {
+    case UiOp::CancelSeek:
+      dev.cancel();
+      showDoneHold_ = false; // done-hold is independent of the view
       break;
-    }
+    case UiOp::ClearError:
+      dev.clearError();
+      break;
+    case UiOp::TargetUp:         stepTarget_(+1, cfg_.stepSmall); break;
+    case UiOp::TargetDown:       stepTarget_(-1, cfg_.stepSmall); break;
+    case UiOp::TargetRepeatUp:   stepTarget_(+1, repeatStepPsi(cfg_, e.heldMs)); break;
+    case UiOp::TargetRepeatDown: stepTarget_(-1, repeatStepPsi(cfg_, e.heldMs)); break;
+    case UiOp::VentOn:
+      if (!manualVentActive_) { dev.manualVent(true); manualVentActive_ = true; }
+      break;
+    case UiOp::VentOff:
+      if (manualVentActive_) { dev.manualVent(false); manualVentActive_ = false; }
+      break;
+    case UiOp::AirOn:
+      if (!manualAirActive_) { dev.manualAirUp(true); manualAirActive_ = true; }
+      break;
+    case UiOp::AirOff:
+      if (manualAirActive_) { dev.manualAirUp(false); manualAirActive_ = false; }
+      break;
+  }
+}
+
+// Large steps snap to the step's grid (32 -> 35 -> 40) so a held button lands on round
+// numbers; small steps move by exactly one step
+void UiStateMachine::stepTarget_(int dir, float step) {
+  if (step > cfg_.stepSmall && step > 0) {
+    const float eps = 0.001f;
+    targetPsi_ = dir > 0 ? (floorf((targetPsi_ + eps) / step) + 1.0f) * step
+                         : (ceilf((targetPsi_ - eps) / step) - 1.0f) * step;
+  } else {
+    targetPsi_ += dir > 0 ? step : -step;
   }
+  clampTarget_();
+  if (view_ == View::Seeking) retargetDirty_ = true;
 }
 
 }} // namespace ta::ui
@@ -11,15 +11,149 @@ struct UiConfig {
   float maxPsi = 50.0f;
   float defaultTargetPsi = 32.0f;
   float stepSmall = 1.0f;
+  float stepLarge = 5.0f;           // hold-repeat step once held repeatLargeAfterMs
+  uint32_t repeatLargeAfterMs = 1500;
   uint32_t doneHoldMs = 1500;       // "Done" flash after seeking
+  uint32_t retargetDebounceMs = 400; // seeking: send an adjusted target once left alone this long
   uint32_t errorAutoClearMs = 4000; // optional auto-clear window
 };
 
 // Inputs common to both devices
 enum class Button { Left, Down, Up, Right };
-enum class Action { Pressed, Released, Click, LongHold };
+enum class Action { Pressed, Released, Click, LongHold, Repeat };
 
-struct ButtonEvent { Button id; Action action; };
+struct ButtonEvent {
+  Button id;
+  Action action;
+  uint32_t heldMs;     // Repeat/LongHold: how long the button has been down (0 otherwise)
+};
+
+// ---------------------------------------------------------------------------
+// Button transitions as a table: (view, button, action) -> (op, next view).
+//
+// kUiRules lists the handled events; buildUiTable() expands them at compile time
+// into a dense [view][event] table where every other event keeps the view and does
+// nothing, so UiStateMachine::onButton is one indexed lookup plus the op.
+// Connection, error and seek-completion changes come from the controller state,
+// not buttons, and stay in update().
+// ---------------------------------------------------------------------------
+enum class UiOp : uint8_t {
+  None,
+  EnterManual,      // cancel whatever runs, outputs follow Up/Down presses
+  ExitManual,       // release any held output
+  StartSeek,
+  CancelSeek,
+  ClearError,
+  TargetUp, TargetDown,               // one small step
+  TargetRepeatUp, TargetRepeatDown,   // hold-repeat, accelerating
+  VentOn, VentOff, AirOn, AirOff,
+  Count
+};
+
+static constexpr int kViewCount = (int)View::Pairing + 1;
+static constexpr int kButtonCount = (int)Button::Right + 1;
+static constexpr int kActionCount = (int)Action::Repeat + 1;
+static constexpr int kUiEventCount = kButtonCount * kActionCount;
+
+constexpr int uiEventIndex(Button b, Action a) { return (int)b * kActionCount + (int)a; }
+
+struct UiRule {
+  View view;
+  Button button;
+  Action action;
+  UiOp op;
+  View next;
+};
+
+static constexpr UiRule kUiRules[] = {
+  { View::Idle,    Button::Left,  Action::Click,    UiOp::EnterManual,      View::Manual  },
+  { View::Idle,    Button::Right, Action::Click,    UiOp::StartSeek,        View::Seeking },
+  { View::Idle,    Button::Up,    Action::Click,    UiOp::TargetUp,         View::Idle    },
+  { View::Idle,    Button::Down,  Action::Click,    UiOp::TargetDown,       View::Idle    },
+  { View::Idle,    Button::Up,    Action::Repeat,   UiOp::TargetRepeatUp,   View::Idle    },
+  { View::Idle,    Button::Down,  Action::Repeat,   UiOp::TargetRepeatDown, View::Idle    },
+  { View::Manual,  Button::Left,  Action::Click,    UiOp::ExitManual,       View::Idle    },
+  { View::Manual,  Button::Down,  Action::Pressed,  UiOp::VentOn,           View::Manual  },
+  { View::Manual,  Button::Down,  Action::Released, UiOp::VentOff,          View::Manual  },
+  { View::Manual,  Button::Up,    Action::Pressed,  UiOp::AirOn,            View::Manual  },
+  { View::Manual,  Button::Up,    Action::Released, UiOp::AirOff,           View::Manual  },
+  { View::Seeking, Button::Right, Action::Click,    UiOp::CancelSeek,       View::Idle    },
+  // Adjusting the target while seeking retargets the seek (debounced in update())
+  { View::Seeking, Button::Up,    Action::Click,    UiOp::TargetUp,         View::Seeking },
+  { View::Seeking, Button::Down,  Action::Click,    UiOp::TargetDown,       View::Seeking },
+  { View::Seeking, Button::Up,    Action::Repeat,   UiOp::TargetRepeatUp,   View::Seeking },
+  { View::Seeking, Button::Down,  Action::Repeat,   UiOp::TargetRepeatDown, View::Seeking },
+  // Leaving Error waits for the controller to recover (update())
+  { View::Error,   Button::Right, Action::Click,    UiOp::ClearError,       View::Error   },
+  // Disconnected and Pairing take no shared input; the remote handles them itself
+};
+static constexpr int kUiRuleCount = sizeof(kUiRules) / sizeof(kUiRules[0]);
+
+constexpr bool uiRulesDisjoint() {
+  for (int i = 0; i < kUiRuleCount; ++i) {
+    for (int j = i + 1; j < kUiRuleCount; ++j) {
+      if (kUiRules[i].view == kUiRules[j].view && kUiRules[i].button == kUiRules[j].button &&
+          kUiRules[i].action == kUiRules[j].action) return false;
+    }
+  }
+  return true;
+}
+static_assert(uiRulesDisjoint(), "two UI rules for the same view and event");
+
+constexpr bool uiOpsCovered() {
+  for (int op = (int)UiOp::None + 1; op < (int)UiOp::Count; ++op) {
+    bool used = false;
+    for (int i = 0; i < kUiRuleCount; ++i) used = used || (int)kUiRules[i].op == op;
+    if (!used) return false;
+  }
+  return true;
+}
+static_assert(uiOpsCovered(), "a UI op no rule triggers");
+
+// Every view a button can lead to has a button way back to Idle (Error's is the
+// controller recovering)
+constexpr bool uiViewsExit() {
+  for (int i = 0; i < kUiRuleCount; ++i) {
+    View v = kUiRules[i].next;
+    if (v == View::Idle || v == View::Error) continue;
+    bool exits = false;
+    for (int j = 0; j < kUiRuleCount; ++j) exits = exits || (kUiRules[j].view == v && kUiRules[j].next == View::Idle);
+    if (!exits) return false;
+  }
+  return true;
+}
+static_assert(uiViewsExit(), "a view entered by button has no button exit");
+
+struct UiCell {
+  UiOp op;
+  View next;
+};
+struct UiTable { UiCell cell[kViewCount][kUiEventCount]; };
+
+constexpr UiTable buildUiTable() {
+  UiTable t{};
+  for (int v = 0; v < kViewCount; ++v) {
+    for (int e = 0; e < kUiEventCount; ++e) t.cell[v][e] = UiCell{ UiOp::None, (View)v };
+  }
+  for (int i = 0; i < kUiRuleCount; ++i) {
+    const UiRule& r = kUiRules[i];
+    t.cell[(int)r.view][uiEventIndex(r.button, r.action)] = UiCell{ r.op, r.next };
+  }
+  return t;
+}
+static constexpr UiTable kUiTable = buildUiTable();
+
+static_assert(kUiTable.cell[(int)View::Idle][uiEventIndex(Button::Right, Action::Click)].next == View::Seeking,
+              "rules land in the table");
+static_assert(kUiTable.cell[(int)View::Seeking][uiEventIndex(Button::Left, Action::Click)].op == UiOp::None &&
+              kUiTable.cell[(int)View::Seeking][uiEventIndex(Button::Left, Action::Click)].next == View::Seeking,
+              "unlisted events keep the view");
+
+// Target step for a hold-repeat: small steps first so a short hold stays fine-grained,
+// then large ones (landing on multiples of the step) to cross the range quickly
+inline float repeatStepPsi(const UiConfig& cfg, uint32_t heldMs) {
+  return (cfg.stepLarge > cfg.stepSmall && heldMs >= cfg.repeatLargeAfterMs) ? cfg.stepLarge : cfg.stepSmall;
+}
 
 // Abstract device strategy for actions; implemented by board and remote
 struct DeviceActions {
@@ -27,6 +161,7 @@ struct DeviceActions {
   virtual void cancel() = 0;         // cancel manual/seek
   virtual void clearError() = 0;     // clear/acknowledge error
   virtual void startSeek(float targetPsi) = 0;
+  virtual void retarget(float targetPsi) { startSeek(targetPsi); } // new target, seek running
   virtual void manualVent(bool on) = 0;
   virtual void manualAirUp(bool on) = 0;
   virtual bool isConnected() const { return true; }
@@ -67,11 +202,14 @@ public:
   View view() const { return view_; }
   float minPsi() const { return cfg_.minPsi; }
   float maxPsi() const { return cfg_.maxPsi; }
+  const UiConfig& config() const { return cfg_; }
 
   // expose done-hold flag for model building
   bool isDoneHoldActive(uint32_t now) const { return showDoneHold_ && now < doneHoldUntil_; }
 
 private:
+  void apply_(UiOp op, const ButtonEvent& e, DeviceActions& dev);
+  void stepTarget_(int dir, float step);
   void clampTarget_() { if (targetPsi_ < cfg_.minPsi) targetPsi_ = cfg_.minPsi; if (targetPsi_ > cfg_.maxPsi) targetPsi_ = cfg_.maxPsi; }
   
   UiConfig cfg_{};
@@ -82,6 +220,9 @@ private:
   bool seenSeekingActivity_ = false;
   bool showDoneHold_ = false;
   uint32_t doneHoldUntil_ = 0;
+  bool retargetDirty_ = false;    // target stepped since the last update()
+  bool retargetPending_ = false;  // ... and not sent yet
+  uint32_t retargetChangedMs_ = 0;
 
   // error autoclear
   uint32_t errorEntryMs_ = 0;